@@ -84,6 +84,11 @@ public:
     {
         return false;
     }
+
+    bool canScanPluginsOutOfProcess() override
+    {
+        return true;
+    }
 };
 
 
@@ -216,5 +221,18 @@ int main (int argv, char** argc)
                 junitFile = String (argc[i + 1]);
     
     ScopedJuceInitialiser_GUI init;
+
+    // The plugin scanner tests launch this executable as their child scanning process
+    StringArray args;
+
+    for (int i = 1; i < argv; ++i)
+        args.add (argc[i]);
+
+    if (PluginManager::startChildProcessPluginScan (args.joinIntoString (" ")))
+    {
+        MessageManager::getInstance()->runDispatchLoop();
+        return 0;
+    }
+
     return TestRunner::runTests (junitFile);
 }
@@ -489,8 +489,10 @@ bool SmartThumbnail::areThumbnailsFullyLoaded (Engine& engine)
 {
     TRACKTION_ASSERT_MESSAGE_THREAD
 
-    for (auto thumb : engine.getAudioFileManager().activeThumbnails)
-        if (! thumb->isFullyLoaded())
+    auto& afm = engine.getAudioFileManager();
+
+    for (auto thumb : afm.activeThumbnails)
+        if (! thumb->isFullyLoaded() || afm.peakFileGenerator.isGenerating (thumb->file, thumb->edit))
             return false;
     
     return true;
@@ -501,6 +503,7 @@ void SmartThumbnail::setNewFile (const AudioFile& newFile)
     if (file != newFile)
     {
         file = newFile;
+        hasRequestedPeakFile = false;
 
         audioFileChanged();
         component.repaint();
@@ -511,6 +514,7 @@ void SmartThumbnail::releaseFile()
 {
     clear();
     thumbnailIsInvalid = true;
+    hasRequestedPeakFile = false;
     juce::MessageManager::callAsync ([ref = juce::WeakReference<SmartThumbnail> (this), this]() mutable
                                      {
                                          if (ref != nullptr)
@@ -525,8 +529,26 @@ void SmartThumbnail::createThumbnailReader()
 
     if (enabled)
     {
-        setReader (AudioFileUtils::createReaderFor (engine, file.getFile()), file.getHash());
-        thumbnailIsInvalid = false;
+        auto& peakFiles = engine.getAudioFileManager().peakFileGenerator;
+
+        if (auto peaks = peakFiles.openPeakFile (file, edit))
+        {
+            setPeakFile (std::move (peaks), new juce::FileInputSource (file.getFile()));
+            thumbnailIsInvalid = false;
+        }
+        else if (hasRequestedPeakFile && ! peakFiles.isGenerating (file, edit))
+        {
+            // The peak file couldn't be created so fall back to reading the levels directly
+            setReader (AudioFileUtils::createReaderFor (engine, file.getFile()), file.getHash());
+            thumbnailIsInvalid = false;
+        }
+        else
+        {
+            // Rather than reading the whole file here, wait for the peaks to be generated in the background
+            peakFiles.generate (file, edit);
+            hasRequestedPeakFile = true;
+            thumbnailIsInvalid = true;
+        }
     }
     else
     {
@@ -602,7 +624,7 @@ void SmartThumbnail::timerCallback()
 
 //==============================================================================
 AudioFileManager::AudioFileManager (Engine& e)
-    : engine (e), cache (e), thumbnailCache (new TracktionThumbnailCache (e))
+    : engine (e), cache (e), peakFileGenerator (e), thumbnailCache (new TracktionThumbnailCache (e))
 {
 }
 
@@ -654,6 +676,24 @@ AudioFileInfo AudioFileManager::getInfo (const AudioFile& file)
     return findOrCreateKnown (file).info;
 }
 
+void AudioFileManager::cacheInfo (const AudioFile& file)
+{
+    {
+        const juce::ScopedLock sl (knownFilesLock);
+
+        if (knownFiles.contains (file.getHash()))
+            return;
+    }
+
+    auto kf = std::make_unique<KnownFile> (file);
+
+    const juce::ScopedLock sl (knownFilesLock);
+
+    // Another thread may have added it whilst this one was parsing the file
+    if (! knownFiles.contains (file.getHash()))
+        knownFiles.set (file.getHash(), kf.release());
+}
+
 bool AudioFileManager::checkFileTime (KnownFile& f)
 {
     if (! f.info.wasParsedOk
@@ -13,6 +13,21 @@ namespace tracktion_engine
 
 #if TRACKTION_UNIT_TESTS
 
+/** Reads a block through the cache's int path and converts it to floats, as callers did before the float path. */
+static bool readSamplesThroughIntPath (AudioFileCache::Reader& reader, juce::AudioBuffer<float>& buffer,
+                                       bool isFloatingPoint, int timeoutMs)
+{
+    if (! reader.readSamples ((int**) buffer.getArrayOfWritePointers(), buffer.getNumChannels(), 0, buffer.getNumSamples(), timeoutMs))
+        return false;
+
+    if (! isFloatingPoint)
+        for (int c = 0; c < buffer.getNumChannels(); ++c)
+            juce::FloatVectorOperations::convertFixedToFloat (buffer.getWritePointer (c), (const int*) buffer.getReadPointer (c),
+                                                              1.0f / 0x7fffffff, buffer.getNumSamples());
+
+    return true;
+}
+
 //==============================================================================
 //==============================================================================
 class AudioFileTests    : public juce::UnitTest
@@ -26,6 +41,17 @@ public:
     void runTest() override
     {
         runFileInfoTest();
+        runEpochProtectedPointerStressTest();
+        runCacheReaderStressTest();
+
+        // WAV is little-endian and AIFF big-endian
+        juce::WavAudioFormat wav;
+        juce::AiffAudioFormat aiff;
+
+        for (auto format : { static_cast<juce::AudioFormat*> (&wav), static_cast<juce::AudioFormat*> (&aiff) })
+            for (int bitDepth : { 16, 24, 32 })
+                for (int numChannels : { 1, 2 })
+                    runFloatReadTest (*format, bitDepth, numChannels);
     }
 
 private:
@@ -80,10 +106,382 @@ private:
             expectEquals (info.getLengthInSeconds(), 1.0);
         }
     }
+
+    void runEpochProtectedPointerStressTest()
+    {
+        beginTest ("EpochProtectedPointer stress test");
+
+        struct Table
+        {
+            Table (int gen) : generation (gen), values (64, gen) {}
+            ~Table() { magic = 0; }
+
+            const int generation;
+            std::vector<int> values;
+            std::atomic<int> magic { 0x7ab1e };
+        };
+
+        EpochProtectedPointer<Table> pointer;
+        pointer.publish (std::make_unique<Table> (0));
+
+        std::atomic<bool> shouldStop { false };
+        std::atomic<int> numBadReads { 0 };
+        std::atomic<juce::int64> numReads { 0 };
+        std::vector<std::thread> readers;
+
+        for (int i = 0; i < 200; ++i)
+        {
+            readers.emplace_back ([&]
+            {
+                while (! shouldStop)
+                {
+                    const EpochProtectedPointer<Table>::ScopedRead sr (pointer);
+                    auto table = sr.get();
+
+                    if (table == nullptr || table->magic != 0x7ab1e)
+                    {
+                        ++numBadReads;
+                        continue;
+                    }
+
+                    for (auto v : table->values)
+                        if (v != table->generation)
+                            ++numBadReads;
+
+                    ++numReads;
+                }
+            });
+        }
+
+        // Churn the table whilst the readers are running
+        for (int gen = 1; gen < 5000; ++gen)
+        {
+            pointer.publish (std::make_unique<Table> (gen));
+
+            if (gen % 100 == 0)
+                std::this_thread::yield();
+        }
+
+        shouldStop = true;
+
+        for (auto& t : readers)
+            t.join();
+
+        expectEquals (numBadReads.load(), 0);
+        expect (numReads > 0);
+
+        // With no readers left all the retired tables should be deleted after two epochs
+        pointer.reclaim();
+        pointer.reclaim();
+        expectEquals (pointer.getNumRetired(), (size_t) 0);
+        expectEquals (pointer.get()->generation, 4999);
+    }
+
+    void runCacheReaderStressTest()
+    {
+        beginTest ("AudioFileCache reader stress test");
+
+        auto& engine = *Engine::getEngines().getFirst();
+
+        juce::WavAudioFormat format;
+        juce::TemporaryFile tempFile (format.getFileExtensions()[0]);
+        AudioFile audioFile (engine, tempFile.getFile());
+
+        const int numChannels = 2, numFrames = 44100 * 10;
+        auto getExpectedSample = [] (juce::int64 frame) { return ((float) (frame % 256) - 128.0f) / 256.0f; };
+
+        {
+            AudioFileWriter writer (audioFile, &format, numChannels, 44100.0, 16, {}, 0);
+            expect (writer.isOpen());
+
+            juce::AudioBuffer<float> buffer (numChannels, numFrames);
+
+            for (int i = 0; i < numFrames; ++i)
+                for (int c = 0; c < numChannels; ++c)
+                    buffer.setSample (c, i, getExpectedSample (i));
+
+            writer.appendBuffer (buffer, buffer.getNumSamples());
+        }
+
+        auto& audioFileManager = engine.getAudioFileManager();
+        std::vector<AudioFileCache::Reader::Ptr> cacheReaders;
+
+        for (int i = 0; i < 200; ++i)
+            if (auto r = audioFileManager.cache.createReader (audioFile))
+                cacheReaders.push_back (r);
+
+        expectEquals (cacheReaders.size(), (size_t) 200);
+
+        std::atomic<bool> shouldStop { false };
+        std::atomic<int> numBadReads { 0 };
+        std::atomic<juce::int64> numReads { 0 }, numMisses { 0 };
+        std::vector<std::thread> readThreads;
+        const int numReadThreads = 8;
+
+        for (int threadIndex = 0; threadIndex < numReadThreads; ++threadIndex)
+        {
+            readThreads.emplace_back ([&, threadIndex]
+            {
+                juce::Random random (threadIndex);
+                juce::AudioBuffer<float> buffer (numChannels, 512);
+
+                while (! shouldStop)
+                {
+                    // Each thread uses its own subset of the readers
+                    for (size_t i = (size_t) threadIndex; i < cacheReaders.size(); i += numReadThreads)
+                    {
+                        auto& r = *cacheReaders[i];
+                        const auto startFrame = (juce::int64) random.nextInt (numFrames - buffer.getNumSamples());
+                        r.setReadPosition (startFrame);
+
+                        if (! r.readSamples (buffer.getNumSamples(), buffer, juce::AudioChannelSet::stereo(), 0,
+                                             juce::AudioChannelSet::stereo(), 0))
+                        {
+                            ++numMisses;
+                            continue;
+                        }
+
+                        for (int c = 0; c < numChannels; ++c)
+                            for (int f = 0; f < buffer.getNumSamples(); ++f)
+                                if (std::abs (buffer.getSample (c, f) - getExpectedSample (startFrame + f)) > 1.0e-4f)
+                                    ++numBadReads;
+
+                        ++numReads;
+                    }
+                }
+            });
+        }
+
+        // Keep dropping the mapped blocks so the mapper thread has to keep replacing them
+        for (int i = 0; i < 200; ++i)
+        {
+            audioFileManager.releaseFile (audioFile);
+            juce::Thread::sleep (5);
+        }
+
+        shouldStop = true;
+
+        for (auto& t : readThreads)
+            t.join();
+
+        logMessage ("Reads: " + juce::String (numReads.load()) + ", misses: " + juce::String (numMisses.load()));
+        expectEquals (numBadReads.load(), 0);
+        expect (numReads > 0);
+
+        cacheReaders.clear();
+    }
+
+    void runFloatReadTest (juce::AudioFormat& format, int bitDepth, int numChannels)
+    {
+        beginTest ("AudioFileCache float reads match int reads: " + format.getFormatName()
+                    + ", " + juce::String (bitDepth) + " bit, " + juce::String (numChannels) + " channel");
+
+        auto& engine = *Engine::getEngines().getFirst();
+
+        juce::TemporaryFile tempFile (format.getFileExtensions()[0]);
+        AudioFile audioFile (engine, tempFile.getFile());
+        const int numFrames = 44100 * 2, blockSize = 512;
+        juce::AudioBuffer<float> source (numChannels, numFrames);
+
+        {
+            AudioFileWriter writer (audioFile, &format, numChannels, 44100.0, bitDepth, {}, 0);
+            expect (writer.isOpen());
+
+            juce::Random r (bitDepth * numChannels);
+
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < numFrames; ++i)
+                    source.setSample (c, i, r.nextFloat() * 1.8f - 0.9f);
+
+            writer.appendBuffer (source, source.getNumSamples());
+        }
+
+        {
+            // The layout should come from the header, WAV being little-endian and AIFF big-endian
+            std::unique_ptr<juce::AudioFormatReader> details (format.createReaderFor (tempFile.getFile().createInputStream().release(), true));
+            expect (details != nullptr);
+
+            if (details != nullptr)
+            {
+                const auto layout = readMappedDataLayout (tempFile.getFile(), format, *details);
+                const bool isWav = dynamic_cast<juce::WavAudioFormat*> (&format) != nullptr;
+
+                expect (layout.format != MappedSampleFormat::unknown);
+                expect (isLittleEndian (layout.format) == isWav);
+                expectEquals (layout.dataLength, (juce::int64) numFrames * numChannels * bitDepth / 8);
+            }
+        }
+
+        auto reader = engine.getAudioFileManager().cache.createReader (audioFile);
+        expect (reader != nullptr);
+
+        if (reader == nullptr)
+            return;
+
+        const bool isFloatingPoint = audioFile.getInfo().isFloatingPoint;
+        const auto channels = numChannels == 1 ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo();
+        const auto quantisationError = isFloatingPoint ? 1.0e-6f : juce::jmax (1.0e-6f, std::pow (2.0f, 2.0f - (float) bitDepth));
+
+        choc::buffer::ChannelArrayBuffer<float> floatBuffer ((choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) blockSize);
+        juce::AudioBuffer<float> intBuffer (numChannels, blockSize);
+        juce::Random random (bitDepth);
+        int numFloatMismatches = 0, numSourceMismatches = 0;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const auto startFrame = (juce::int64) random.nextInt (numFrames - blockSize);
+
+            reader->setReadPosition (startFrame);
+            expect (reader->readSamples (floatBuffer.getView(), channels, channels, 5000));
+
+            reader->setReadPosition (startFrame);
+            expect (readSamplesThroughIntPath (*reader, intBuffer, isFloatingPoint, 5000));
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                for (int f = 0; f < blockSize; ++f)
+                {
+                    const auto floatSample = floatBuffer.getSample ((choc::buffer::ChannelCount) c, (choc::buffer::FrameCount) f);
+
+                    if (std::abs (floatSample - intBuffer.getSample (c, f)) > 1.0e-6f)
+                        ++numFloatMismatches;
+
+                    if (std::abs (floatSample - source.getSample (c, (int) startFrame + f)) > quantisationError)
+                        ++numSourceMismatches;
+                }
+            }
+        }
+
+        expectEquals (numFloatMismatches, 0, "Float path doesn't match the int path");
+        expectEquals (numSourceMismatches, 0, "Float path doesn't match the written samples");
+    }
+
+    static bool isLittleEndian (MappedSampleFormat format)
+    {
+        return format == MappedSampleFormat::int16LittleEndian
+            || format == MappedSampleFormat::int24LittleEndian
+            || format == MappedSampleFormat::int32LittleEndian
+            || format == MappedSampleFormat::float32LittleEndian;
+    }
 };
 
 static AudioFileTests audioFileTests;
 
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+//==============================================================================
+//==============================================================================
+class AudioFileCacheBenchmarks    : public juce::UnitTest
+{
+public:
+    AudioFileCacheBenchmarks()
+        : juce::UnitTest ("AudioFileCache Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        juce::WavAudioFormat wav;
+        juce::AiffAudioFormat aiff;
+
+        // WAV is little-endian and AIFF big-endian
+        runReadBenchmark (wav, 16);
+        runReadBenchmark (wav, 24);
+        runReadBenchmark (wav, 32);
+        runReadBenchmark (aiff, 16);
+        runReadBenchmark (aiff, 24);
+        runReadBenchmark (aiff, 32);
+    }
+
+private:
+    void runReadBenchmark (juce::AudioFormat& format, int bitDepth)
+    {
+        auto& engine = *Engine::getEngines().getFirst();
+        const auto description = format.getFormatName() + ", " + juce::String (bitDepth) + " bit";
+
+        beginTest ("Cache read throughput: " + description);
+
+        juce::TemporaryFile tempFile (format.getFileExtensions()[0]);
+        AudioFile audioFile (engine, tempFile.getFile());
+        const int numChannels = 2, numFrames = 44100 * 30, blockSize = 512, numPasses = 10;
+
+        {
+            AudioFileWriter writer (audioFile, &format, numChannels, 44100.0, bitDepth, {}, 0);
+            expect (writer.isOpen());
+
+            juce::AudioBuffer<float> buffer (numChannels, numFrames);
+            juce::Random r;
+
+            for (int c = 0; c < numChannels; ++c)
+                for (int i = 0; i < numFrames; ++i)
+                    buffer.setSample (c, i, r.nextFloat() * 2.0f - 1.0f);
+
+            writer.appendBuffer (buffer, buffer.getNumSamples());
+        }
+
+        {
+            // The layout should come from the header, WAV being little-endian and AIFF big-endian
+            std::unique_ptr<juce::AudioFormatReader> details (format.createReaderFor (tempFile.getFile().createInputStream().release(), true));
+            expect (details != nullptr);
+
+            if (details != nullptr)
+            {
+                const auto layout = readMappedDataLayout (tempFile.getFile(), format, *details);
+                const bool isWav = dynamic_cast<juce::WavAudioFormat*> (&format) != nullptr;
+
+                expect (layout.format != MappedSampleFormat::unknown);
+                expect (isLittleEndian (layout.format) == isWav);
+                expectEquals (layout.dataLength, (juce::int64) numFrames * numChannels * bitDepth / 8);
+            }
+        }
+
+        auto reader = engine.getAudioFileManager().cache.createReader (audioFile);
+        expect (reader != nullptr);
+
+        if (reader == nullptr)
+            return;
+
+        choc::buffer::ChannelArrayBuffer<float> floatBuffer ((choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) blockSize);
+        juce::AudioBuffer<float> intBuffer (numChannels, blockSize);
+        const auto stereo = juce::AudioChannelSet::stereo();
+
+        auto measure = [&] (const juce::String& name, std::function<bool()> readBlock)
+        {
+            int numFailed = 0;
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+
+            for (int pass = 0; pass < numPasses; ++pass)
+            {
+                reader->setReadPosition (0);
+
+                for (int i = 0; i + blockSize <= numFrames; i += blockSize)
+                    if (! readBlock())
+                        ++numFailed;
+            }
+
+            const auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+            const auto framesPerSecond = (numPasses * (double) numFrames) / seconds;
+
+            std::cout << description << ", " << name << ": " << juce::String (seconds * 1000.0, 2) << "ms, "
+                      << juce::String (framesPerSecond / 1.0e6, 2) << "M frames/s\n";
+            expectEquals (numFailed, 0);
+        };
+
+        // Warm up so the file is mapped
+        reader->setReadPosition (0);
+        reader->readSamples (floatBuffer.getView(), stereo, stereo, 5000);
+
+        measure ("float", [&] { return reader->readSamples (floatBuffer.getView(), stereo, stereo, 5000); });
+
+        const bool isFloatingPoint = audioFile.getInfo().isFloatingPoint;
+        measure ("int", [&] { return readSamplesThroughIntPath (*reader, intBuffer, isFloatingPoint, 5000); });
+    }
+};
+
+static AudioFileCacheBenchmarks audioFileCacheBenchmarks;
+
+#endif
+
 #endif
 
 
@@ -18,8 +18,472 @@ static void clearSetOfChannels (int** channels, int numChannels, int offset, int
             juce::FloatVectorOperations::clear (chan + offset, numSamples);
 }
 
+static void convertSetOfChannelsToFloat (int** channels, int numChannels, int offset, int numSamples) noexcept
+{
+    for (int i = 0; i < numChannels; ++i)
+        if (auto chan = channels[i])
+            juce::FloatVectorOperations::convertFixedToFloat ((float*) chan + offset, chan + offset, 1.0f / 0x7fffffff, numSamples);
+}
+
+//==============================================================================
+/** The layout of samples in a memory mapped file, used to convert them directly to floats. */
+enum class MappedSampleFormat
+{
+    unknown,
+    int16LittleEndian,
+    int16BigEndian,
+    int24LittleEndian,
+    int24BigEndian,
+    int32LittleEndian,
+    int32BigEndian,
+    float32LittleEndian,
+    float32BigEndian
+};
+
+template<typename SourceFormat, typename Endianness>
+static float readIntSampleAsFloat (const juce::uint8* data) noexcept
+{
+    constexpr bool isLittleEndian = std::is_same<Endianness, juce::AudioData::LittleEndian>::value;
+
+    if constexpr (std::is_same<SourceFormat, juce::AudioData::Int16>::value)
+        return (float) (juce::int16) (isLittleEndian ? juce::ByteOrder::littleEndianShort (data)
+                                                     : juce::ByteOrder::bigEndianShort (data)) * (1.0f / 0x8000);
+    else
+        return (float) (isLittleEndian ? juce::ByteOrder::littleEndian24Bit (data)
+                                       : juce::ByteOrder::bigEndian24Bit (data)) * (1.0f / 0x800000);
+}
+
+template<typename SourceFormat, typename Endianness, typename DestFormat>
+static void convertInterleaved (const void* source, int numSourceChannels,
+                                void* const* destChannels, int numDestChannels,
+                                int destOffset, int numSamples) noexcept
+{
+    using namespace juce;
+    using SourceType = AudioData::Pointer<SourceFormat, Endianness, AudioData::Interleaved, AudioData::Const>;
+    using DestType   = AudioData::Pointer<DestFormat, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>;
+    constexpr bool isNativeEndian = std::is_same<Endianness, AudioData::NativeEndian>::value;
+    constexpr bool isFloatDest = std::is_same<DestFormat, AudioData::Float32>::value;
+    constexpr bool is16Or24Bit = std::is_same<SourceFormat, AudioData::Int16>::value || std::is_same<SourceFormat, AudioData::Int24>::value;
+
+    for (int i = 0; i < numDestChannels; ++i)
+    {
+        auto dest = static_cast<std::conditional_t<isFloatDest, float, int>*> (destChannels[i]);
+
+        if (dest == nullptr)
+            continue;
+
+        dest += destOffset;
+
+        if (i >= numSourceChannels)
+        {
+            zeromem (dest, sizeof (*dest) * (size_t) numSamples);
+            continue;
+        }
+
+        auto channelStart = static_cast<const char*> (source) + i * SourceFormat::bytesPerSample;
+
+        // Mono native data can be converted with the vectorised operations, and 16 and 24-bit data
+        // with a plain strided loop that avoids the per-sample overhead of the AudioData converters
+        if (isFloatDest && numSourceChannels == 1 && isNativeEndian && std::is_same<SourceFormat, AudioData::Float32>::value)
+        {
+            FloatVectorOperations::copy ((float*) dest, reinterpret_cast<const float*> (channelStart), numSamples);
+        }
+        else if (isFloatDest && numSourceChannels == 1 && isNativeEndian && std::is_same<SourceFormat, AudioData::Int32>::value)
+        {
+            FloatVectorOperations::convertFixedToFloat ((float*) dest, reinterpret_cast<const int*> (channelStart), 1.0f / 0x7fffffff, numSamples);
+        }
+        else if constexpr (isFloatDest && is16Or24Bit)
+        {
+            auto data = reinterpret_cast<const uint8*> (channelStart);
+            const auto stride = (size_t) (numSourceChannels * SourceFormat::bytesPerSample);
+
+            for (int n = 0; n < numSamples; ++n)
+                dest[n] = readIntSampleAsFloat<SourceFormat, Endianness> (data + (size_t) n * stride);
+        }
+        else
+        {
+            DestType (dest).convertSamples (SourceType (channelStart, numSourceChannels), numSamples);
+        }
+    }
+}
+
+/** Converts interleaved samples to non-interleaved floats, or to ints if DestFormat is AudioData::Int32. */
+template<typename DestFormat>
+static void convertInterleaved (MappedSampleFormat format, const void* source, int numSourceChannels,
+                                void* const* destChannels, int numDestChannels,
+                                int destOffset, int numSamples) noexcept
+{
+    using namespace juce;
+
+    switch (format)
+    {
+        case MappedSampleFormat::int16LittleEndian:     convertInterleaved<AudioData::Int16, AudioData::LittleEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::int16BigEndian:        convertInterleaved<AudioData::Int16, AudioData::BigEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::int24LittleEndian:     convertInterleaved<AudioData::Int24, AudioData::LittleEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::int24BigEndian:        convertInterleaved<AudioData::Int24, AudioData::BigEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::int32LittleEndian:     convertInterleaved<AudioData::Int32, AudioData::LittleEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::int32BigEndian:        convertInterleaved<AudioData::Int32, AudioData::BigEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::float32LittleEndian:   convertInterleaved<AudioData::Float32, AudioData::LittleEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::float32BigEndian:      convertInterleaved<AudioData::Float32, AudioData::BigEndian, DestFormat> (source, numSourceChannels, destChannels, numDestChannels, destOffset, numSamples); break;
+        case MappedSampleFormat::unknown:
+        default:                                        jassertfalse; break;
+    }
+}
+
+//==============================================================================
+/** Where a WAV or AIFF file's samples are and how they're laid out, read from its header. */
+struct MappedDataLayout
+{
+    MappedSampleFormat format = MappedSampleFormat::unknown;
+    juce::int64 dataChunkStart = 0, dataLength = 0;
+};
+
+static MappedSampleFormat getMappedSampleFormat (const juce::AudioFormatReader& details, bool isLittleEndian)
+{
+    if (details.usesFloatingPointData)
+    {
+        if (details.bitsPerSample == 32)
+            return isLittleEndian ? MappedSampleFormat::float32LittleEndian : MappedSampleFormat::float32BigEndian;
+
+        return MappedSampleFormat::unknown;
+    }
+
+    switch (details.bitsPerSample)
+    {
+        case 16:    return isLittleEndian ? MappedSampleFormat::int16LittleEndian : MappedSampleFormat::int16BigEndian;
+        case 24:    return isLittleEndian ? MappedSampleFormat::int24LittleEndian : MappedSampleFormat::int24BigEndian;
+        case 32:    return isLittleEndian ? MappedSampleFormat::int32LittleEndian : MappedSampleFormat::int32BigEndian;
+        default:    return MappedSampleFormat::unknown;
+    }
+}
+
+static int chunkName (const char* name) noexcept    { return (int) juce::ByteOrder::littleEndianInt (name); }
+
+/** WAV and RF64 files are always little-endian. */
+static MappedDataLayout readWavDataLayout (juce::InputStream& input, const juce::AudioFormatReader& details)
+{
+    const auto fileType = input.readInt();
+
+    if (fileType != chunkName ("RIFF") && fileType != chunkName ("RF64"))
+        return {};
+
+    input.skipNextBytes (4);
+
+    if (input.readInt() != chunkName ("WAVE"))
+        return {};
+
+    juce::int64 rf64DataLength = -1;
+
+    while (! input.isExhausted())
+    {
+        const auto chunkType = input.readInt();
+        const auto length = (juce::uint32) input.readInt();
+        const auto chunkEnd = input.getPosition() + length + (length & 1);
+
+        if (chunkType == chunkName ("ds64"))
+        {
+            input.skipNextBytes (8);
+            rf64DataLength = input.readInt64();
+        }
+        else if (chunkType == chunkName ("data"))
+        {
+            MappedDataLayout layout;
+            layout.format = getMappedSampleFormat (details, true);
+            layout.dataChunkStart = input.getPosition();
+            layout.dataLength = (fileType == chunkName ("RF64") && rf64DataLength >= 0) ? rf64DataLength : (juce::int64) length;
+            return layout;
+        }
+
+        if (! input.setPosition (chunkEnd))
+            break;
+    }
+
+    return {};
+}
+
+/** AIFF files are big-endian but AIFC files can be little-endian if their compression type is 'sowt'. */
+static MappedDataLayout readAiffDataLayout (juce::InputStream& input, const juce::AudioFormatReader& details)
+{
+    if (input.readInt() != chunkName ("FORM"))
+        return {};
+
+    input.skipNextBytes (4);
+    const auto fileType = input.readInt();
+
+    if (fileType != chunkName ("AIFF") && fileType != chunkName ("AIFC"))
+        return {};
+
+    MappedDataLayout layout;
+    bool isLittleEndian = false, hasSoundData = false;
+
+    while (! input.isExhausted())
+    {
+        const auto chunkType = input.readInt();
+        const auto length = (juce::uint32) input.readIntBigEndian();
+        const auto chunkEnd = input.getPosition() + length + (length & 1);
+
+        if (chunkType == chunkName ("COMM") && fileType == chunkName ("AIFC"))
+        {
+            // Skip the channels, frames, bits and sample rate to get to the compression type
+            input.skipNextBytes (18);
+            const auto compressionType = input.readInt();
+
+            if (compressionType == chunkName ("sowt"))
+                isLittleEndian = true;
+            else if (compressionType != chunkName ("NONE") && compressionType != chunkName ("twos")
+                      && compressionType != chunkName ("fl32") && compressionType != chunkName ("FL32"))
+                return {};
+        }
+        else if (chunkType == chunkName ("SSND"))
+        {
+            const auto offset = (juce::uint32) input.readIntBigEndian();
+            input.skipNextBytes (4);
+            layout.dataChunkStart = input.getPosition() + offset;
+            layout.dataLength = (juce::int64) length - 8 - offset;
+            hasSoundData = layout.dataLength > 0;
+        }
+
+        if (! input.setPosition (chunkEnd))
+            break;
+    }
+
+    if (hasSoundData)
+        layout.format = getMappedSampleFormat (details, isLittleEndian);
+
+    return layout;
+}
+
+/** Reads the layout of a WAV or AIFF file's samples from its header.
+    The format will be unknown if the file isn't one of these or its samples can't be converted directly.
+*/
+static MappedDataLayout readMappedDataLayout (const juce::File& file, juce::AudioFormat& format,
+                                              const juce::AudioFormatReader& details)
+{
+    auto input = file.createInputStream();
+
+    if (input == nullptr)
+        return {};
+
+    if (dynamic_cast<juce::WavAudioFormat*> (&format) != nullptr)
+        return readWavDataLayout (*input, details);
+
+    if (dynamic_cast<juce::AiffAudioFormat*> (&format) != nullptr)
+        return readAiffDataLayout (*input, details);
+
+    return {};
+}
+
+//==============================================================================
+/**
+    A memory mapped reader for files whose sample layout has been read from their
+    header, so mapped blocks can be converted straight to floats.
+*/
+class LayoutMappedReader  : public juce::MemoryMappedAudioFormatReader
+{
+public:
+    LayoutMappedReader (const juce::File& f, const juce::AudioFormatReader& details, const MappedDataLayout& layout)
+        : juce::MemoryMappedAudioFormatReader (f, details, layout.dataChunkStart, layout.dataLength,
+                                               (int) (details.numChannels * details.bitsPerSample / 8)),
+          format (layout.format)
+    {
+        jassert (format != MappedSampleFormat::unknown);
+    }
+
+    /** Converts samples in the mapped section to floats. */
+    void readFloatSamples (float* const* destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                           juce::int64 startSampleInFile, int numSamples) const noexcept
+    {
+        jassert (mappedSection.contains (juce::Range<juce::int64> (startSampleInFile, startSampleInFile + numSamples)));
+        convertInterleaved<juce::AudioData::Float32> (format, sampleToPointer (startSampleInFile), (int) numChannels,
+                                                      (void* const*) destSamples, numDestChannels, startOffsetInDestBuffer, numSamples);
+    }
+
+    //==============================================================================
+    bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                      juce::int64 startSampleInFile, int numSamples) override
+    {
+        clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                           startSampleInFile, numSamples, lengthInSamples);
+
+        if (map == nullptr || ! mappedSection.contains (juce::Range<juce::int64> (startSampleInFile, startSampleInFile + numSamples)))
+        {
+            jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
+            return false;
+        }
+
+        // Floating point readers fill the int buffers with floats
+        if (usesFloatingPointData)
+            readFloatSamples ((float* const*) destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+        else
+            convertInterleaved<juce::AudioData::Int32> (format, sampleToPointer (startSampleInFile), (int) numChannels,
+                                                        (void* const*) destSamples, numDestChannels, startOffsetInDestBuffer, numSamples);
+
+        return true;
+    }
+
+    void getSample (juce::int64 sample, float* result) const noexcept override
+    {
+        if (map == nullptr || ! mappedSection.contains (sample))
+        {
+            jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
+            juce::zeromem (result, sizeof (float) * (size_t) numChannels);
+            return;
+        }
+
+        auto frame = static_cast<const char*> (sampleToPointer (sample));
+        const auto bytesPerSample = (int) bitsPerSample / 8;
+
+        for (int c = 0; c < (int) numChannels; ++c)
+        {
+            void* dest = result + c;
+            convertInterleaved<juce::AudioData::Float32> (format, frame + c * bytesPerSample, (int) numChannels, &dest, 1, 0, 1);
+        }
+    }
+
+private:
+    const MappedSampleFormat format;
+};
+
+//==============================================================================
+/**
+    Holds a pointer to an immutable object which can be read without taking any locks.
+
+    Writers publish new objects and the old ones are retired, only being deleted once
+    every reader that could have seen them has finished. Readers register in one of
+    two epochs and the epoch is only advanced once all readers from the previous one
+    have finished so a retired object is safe to delete two epochs after it was retired.
+
+    publish and reclaim must be serialised by the caller.
+*/
+template<typename ObjectType>
+class EpochProtectedPointer
+{
+public:
+    EpochProtectedPointer() = default;
+
+    ~EpochProtectedPointer()
+    {
+        delete current.load();
+    }
+
+    //==============================================================================
+    /** Registers the calling thread as a reader, returning the epoch to pass to exitRead. */
+    juce::uint64 enterRead() noexcept
+    {
+        for (;;)
+        {
+            const auto epoch = currentEpoch.load();
+            activeReaders[epoch & 1].fetch_add (1);
+
+            // If the epoch moved on before we were registered the writer may not have seen us
+            if (currentEpoch.load() == epoch)
+                return epoch;
+
+            activeReaders[epoch & 1].fetch_sub (1);
+        }
+    }
+
+    /** Unregisters a reader previously registered with enterRead. */
+    void exitRead (juce::uint64 epoch) noexcept
+    {
+        activeReaders[epoch & 1].fetch_sub (1);
+    }
+
+    /** Returns the current object.
+        This must only be called by the writer or a thread between enterRead and exitRead.
+    */
+    ObjectType* get() const noexcept
+    {
+        return current.load (std::memory_order_acquire);
+    }
+
+    /** Marks a scope in which the current object can be safely used. */
+    struct ScopedRead
+    {
+        ScopedRead (EpochProtectedPointer& p) noexcept
+            : owner (p), epoch (p.enterRead())
+        {
+        }
+
+        ~ScopedRead() noexcept
+        {
+            owner.exitRead (epoch);
+        }
+
+        ObjectType* get() const noexcept    { return owner.get(); }
+
+        EpochProtectedPointer& owner;
+        const juce::uint64 epoch;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRead)
+    };
+
+    //==============================================================================
+    /** Replaces the current object, retiring the old one to be deleted later. */
+    void publish (std::unique_ptr<ObjectType> newObject)
+    {
+        if (auto oldObject = current.exchange (newObject.release()))
+            retired.push_back ({ std::unique_ptr<ObjectType> (oldObject), currentEpoch.load() });
+
+        reclaim();
+    }
+
+    /** Deletes any retired objects that can no longer be seen by any readers. */
+    void reclaim()
+    {
+        auto epoch = currentEpoch.load();
+
+        // Move on to the next epoch if all the readers from the previous one have finished
+        if (activeReaders[(epoch + 1) & 1].load() == 0)
+            currentEpoch.store (++epoch);
+
+        retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                       [epoch] (const auto& r) { return epoch >= r.epoch + 2; }),
+                       retired.end());
+    }
+
+    /** Returns the number of objects waiting to be deleted. */
+    size_t getNumRetired() const
+    {
+        return retired.size();
+    }
+
+private:
+    struct RetiredObject
+    {
+        std::unique_ptr<ObjectType> object;
+        juce::uint64 epoch;
+    };
+
+    std::atomic<ObjectType*> current { nullptr };
+    std::atomic<juce::uint64> currentEpoch { 0 };
+    std::atomic<int> activeReaders[2] = {};
+    std::vector<RetiredObject> retired;
+
+    JUCE_DECLARE_NON_COPYABLE (EpochProtectedPointer)
+};
+
+//==============================================================================
 class AudioFileCache::CachedFile
 {
+    /** An immutable set of mapped blocks, replaced as a whole by the mapper thread. */
+    struct BlockTable
+    {
+        std::vector<std::shared_ptr<juce::MemoryMappedAudioFormatReader>> readers;
+        juce::Array<int> blocks;
+
+        juce::MemoryMappedAudioFormatReader* findReaderFor (juce::int64 sample) const
+        {
+            for (auto& r : readers)
+                if (r->getMappedSection().contains (sample))
+                    return r.get();
+
+            return {};
+        }
+    };
+
+    using BlockTablePointer = EpochProtectedPointer<BlockTable>;
+
 public:
     CachedFile (AudioFileCache& c, const AudioFile& f)
         : cache (c), file (f), info (f.getInfo())
@@ -56,58 +520,55 @@ public:
             }
         }
 
-        const juce::ScopedReadLock sl (readerLock);
+        const BlockTablePointer::ScopedRead sr (blockTable);
 
-        for (auto pos : readPoints)
-            touchAllReaders ({ pos, pos + 128 });
-
-        for (auto pos : readPoints)
-            touchAllReaders ({ pos + 128, pos + 4096 });
+        if (auto table = sr.get())
+        {
+            for (auto pos : readPoints)
+                touchAllReaders (*table, { pos, pos + 128 });
 
-        for (int distanceAhead = 4096; distanceAhead < 48000; distanceAhead += 8192)
             for (auto pos : readPoints)
-                touchAllReaders ({ pos + distanceAhead, pos + distanceAhead + 8192 });
+                touchAllReaders (*table, { pos + 128, pos + 4096 });
+
+            for (int distanceAhead = 4096; distanceAhead < 48000; distanceAhead += 8192)
+                for (auto pos : readPoints)
+                    touchAllReaders (*table, { pos + distanceAhead, pos + distanceAhead + 8192 });
+        }
     }
 
-    void touchAllReaders (juce::Range<juce::int64> range) const
+    static void touchAllReaders (const BlockTable& table, juce::Range<juce::int64> range)
     {
-        for (auto* r : readers)
+        for (auto& r : table.readers)
         {
-            if (r != nullptr)
-            {
-                range = range.getIntersectionWith (r->getMappedSection());
+            range = range.getIntersectionWith (r->getMappedSection());
 
-                for (auto i = range.getStart(); i < range.getEnd(); i += 64)
-                    r->touchSample (i);
-            }
+            for (auto i = range.getStart(); i < range.getEnd(); i += 64)
+                r->touchSample (i);
         }
     }
 
     bool updateBlocks()
     {
-        {
-            const juce::ScopedReadLock sl (readerLock);
-            
-            if (mapEntireFile && readers.size() > 0)
-                return false;
-        }
-
         const juce::ScopedLock scl (blockUpdateLock);
+        blockTable.reclaim();
+
+        // Only threads holding the blockUpdateLock can replace the table so this is safe to use here
+        auto table = blockTable.get();
 
         if (mapEntireFile)
         {
-            if (readers.isEmpty())
+            if (table == nullptr || table->readers.empty())
             {
                 if (failedToOpenFile
                      && juce::Time::getApproximateMillisecondCounter()
                             < lastFailedOpenAttempt + 4000 + (juce::uint32) random.nextInt (3000))
                     return false;
 
-                const juce::ScopedWriteLock sl (readerLock);
-
                 if (auto r = createNewReader (nullptr))
                 {
-                    readers.add (r);
+                    auto newTable = std::make_unique<BlockTable>();
+                    newTable->readers.emplace_back (r);
+                    blockTable.publish (std::move (newTable));
                 }
                 else
                 {
@@ -164,51 +625,49 @@ public:
             }
         }
 
+        juce::Array<int> currentBlocks;
+
+        if (table != nullptr)
+            currentBlocks = table->blocks;
+
         if (blocksNeeded != currentBlocks)
         {
-            juce::OwnedArray<juce::MemoryMappedAudioFormatReader> newReaders;
+            auto newTable = std::make_unique<BlockTable>();
 
+            for (int i = 0; i < blocksNeeded.size(); ++i)
             {
-                const juce::ScopedReadLock sl (readerLock);
-
-                for (int i = 0; i < blocksNeeded.size(); ++i)
-                {
-                    const int block = blocksNeeded.getUnchecked(i);
-                    const int existingIndex = currentBlocks.indexOf (block);
-
-                    juce::MemoryMappedAudioFormatReader* newReader;
+                const int block = blocksNeeded.getUnchecked(i);
+                const int existingIndex = currentBlocks.indexOf (block);
 
-                    if (existingIndex >= 0)
-                    {
-                        newReader = readers.getUnchecked (existingIndex);
-                        readers.set (existingIndex, nullptr, false);
-                    }
-                    else
-                    {
-                        auto pos = block * (juce::int64) blockSize;
-                        const juce::Range<juce::int64> range (pos, pos + blockSize);
-                        newReader = createNewReader (&range);
-                    }
+                std::shared_ptr<juce::MemoryMappedAudioFormatReader> newReader;
 
-                    if (newReader != nullptr)
-                        newReaders.add (newReader);
-                    else
-                        blocksNeeded.remove (i--);
+                if (existingIndex >= 0)
+                {
+                    newReader = table->readers[(size_t) existingIndex];
+                }
+                else
+                {
+                    auto pos = block * (juce::int64) blockSize;
+                    const juce::Range<juce::int64> range (pos, pos + blockSize);
+                    newReader.reset (createNewReader (&range));
                 }
-            }
-
-            {
-                const juce::ScopedWriteLock sl (readerLock);
-                newReaders.swapWith (readers);
-                currentBlocks.swapWith (blocksNeeded);
 
-                jassert (readers.size() == currentBlocks.size());
+                if (newReader != nullptr)
+                    newTable->readers.push_back (std::move (newReader));
+                else
+                    blocksNeeded.remove (i--);
             }
 
-            for (auto m : newReaders)
-                if (m != nullptr)
-                    totalBytesInUse -= static_cast<juce::int64> (m->getNumBytesUsed());
+            newTable->blocks.swapWith (blocksNeeded);
+            jassert (newTable->readers.size() == (size_t) newTable->blocks.size());
+
+            // The old blocks will be unmapped once the readers have finished with the old table
+            if (table != nullptr)
+                for (auto& r : table->readers)
+                    if (std::find (newTable->readers.begin(), newTable->readers.end(), r) == newTable->readers.end())
+                        totalBytesInUse -= static_cast<juce::int64> (r->getNumBytesUsed());
 
+            blockTable.publish (std::move (newTable));
             anythingChanged = true;
         }
 
@@ -226,10 +685,13 @@ public:
 
     void dumpBlocks()
     {
-        for (int i = 0; i < currentBlocks.size(); ++i)
-            DBG ("File " << file.getFile().getFileName() << "    " << currentBlocks[i]
-                 << "  " << readers[i]->getMappedSection().getStart()
-                 << " - " << readers[i]->getMappedSection().getEnd());
+        const BlockTablePointer::ScopedRead sr (blockTable);
+
+        if (auto table = sr.get())
+            for (int i = 0; i < table->blocks.size(); ++i)
+                DBG ("File " << file.getFile().getFileName() << "    " << table->blocks[i]
+                     << "  " << table->readers[(size_t) i]->getMappedSection().getStart()
+                     << " - " << table->readers[(size_t) i]->getMappedSection().getEnd());
     }
 
     juce::MemoryMappedAudioFormatReader* createNewReader (const juce::Range<juce::int64>* range)
@@ -237,6 +699,19 @@ public:
         juce::AudioFormat* af;
         std::unique_ptr<juce::MemoryMappedAudioFormatReader> r (AudioFileUtils::createMemoryMappedReader (cache.engine, file.getFile(), af));
 
+        if (r != nullptr)
+        {
+            // The callers hold the blockUpdateLock so the header only needs reading once
+            if (! hasReadDataLayout)
+            {
+                dataLayout = readMappedDataLayout (file.getFile(), *af, *r);
+                hasReadDataLayout = true;
+            }
+
+            if (dataLayout.format != MappedSampleFormat::unknown)
+                r = std::make_unique<LayoutMappedReader> (file.getFile(), *r, dataLayout);
+        }
+
         if (r != nullptr
              && (range != nullptr ? r->mapSectionOfFile (*range)
                                   : r->mapEntireFile())
@@ -270,9 +745,8 @@ public:
 
     void releaseReader()
     {
-        const juce::ScopedWriteLock sl (readerLock);
-        readers.clear();
-        currentBlocks.clear();
+        const juce::ScopedLock scl (blockUpdateLock);
+        blockTable.publish ({});
     }
 
     void validateFile()
@@ -281,24 +755,29 @@ public:
         failedToOpenFile = false;
     }
 
-    struct LockedReaderFinder
+    /** Finds the reader for a sample, keeping the block table it came from alive whilst in scope.
+        This never blocks, if the block isn't mapped it will either fail or retry until the timeout.
+    */
+    struct ReaderFinder
     {
-        LockedReaderFinder (CachedFile& f, juce::int64 startSample, int timeoutMs)  : lock (f.readerLock)
+        ReaderFinder (CachedFile& f, juce::int64 startSample, int timeoutMs)  : blockTable (f.blockTable)
         {
             juce::uint32 startTime = 0;
 
             for (;;)
             {
-                if (lock.tryEnterRead())
+                epoch = blockTable.enterRead();
+
+                if (auto table = blockTable.get())
                 {
-                    reader = f.findReaderFor (startSample);
+                    reader = table->findReaderFor (startSample);
 
                     if (reader != nullptr)
                         return;
-
-                    lock.exitRead();
                 }
 
+                blockTable.exitRead (epoch);
+
                 if (timeoutMs < 0)
                 {
                     if (startTime != 0) // second failed after calling updateBlocks failed
@@ -326,24 +805,24 @@ public:
                     juce::Thread::yield();
             }
 
-            isLocked = false;
+            reader = nullptr;
         }
 
-        ~LockedReaderFinder()
+        ~ReaderFinder()
         {
-            if (isLocked)
-                lock.exitRead();
+            if (reader != nullptr)
+                blockTable.exitRead (epoch);
         }
 
         juce::MemoryMappedAudioFormatReader* reader = nullptr;
-        juce::ReadWriteLock& lock;
-        bool isLocked = true;
+        BlockTablePointer& blockTable;
+        juce::uint64 epoch = 0;
 
-        JUCE_DECLARE_NON_COPYABLE (LockedReaderFinder)
+        JUCE_DECLARE_NON_COPYABLE (ReaderFinder)
     };
 
     bool read (juce::int64 startSample, int** destSamples, int numDestChannels,
-               int startOffsetInDestBuffer, int numSamples, int timeoutMs)
+               int startOffsetInDestBuffer, int numSamples, int timeoutMs, bool convertToFloat)
     {
         jassert (destSamples != nullptr);
         jassert (startSample >= 0);
@@ -358,14 +837,17 @@ public:
                 break;
             }
 
-            const LockedReaderFinder l (*this, startSample, timeoutMs);
+            const ReaderFinder l (*this, startSample, timeoutMs);
             SCOPED_REALTIME_CHECK
 
-            if (l.isLocked && l.reader != nullptr)
+            if (l.reader != nullptr)
             {
                 auto numThisTime = std::min (numSamples, (int) (l.reader->getMappedSection().getEnd() - startSample));
 
-                l.reader->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSample, numThisTime);
+                if (convertToFloat)
+                    readFloatSamples (*l.reader, (float**) destSamples, numDestChannels, startOffsetInDestBuffer, startSample, numThisTime);
+                else
+                    l.reader->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSample, numThisTime);
 
                 startSample += numThisTime;
                 startOffsetInDestBuffer += numThisTime;
@@ -393,9 +875,9 @@ public:
 
         while (numSamples > 0)
         {
-            const LockedReaderFinder l (*this, startSample, timeoutMs);
+            const ReaderFinder l (*this, startSample, timeoutMs);
 
-            if (l.isLocked && l.reader != nullptr)
+            if (l.reader != nullptr)
             {
                 auto numThisTime = std::min (numSamples, (int) (l.reader->getMappedSection().getEnd() - startSample));
 
@@ -433,6 +915,21 @@ public:
         return allDataRead;
     }
 
+    void readFloatSamples (juce::MemoryMappedAudioFormatReader& r, float** destSamples, int numDestChannels,
+                           int startOffsetInDestBuffer, juce::int64 startSample, int numSamples)
+    {
+        if (auto layoutReader = dynamic_cast<LayoutMappedReader*> (&r))
+        {
+            layoutReader->readFloatSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSample, numSamples);
+            return;
+        }
+
+        r.readSamples ((int**) destSamples, numDestChannels, startOffsetInDestBuffer, startSample, numSamples);
+
+        if (! r.usesFloatingPointData)
+            convertSetOfChannelsToFloat ((int**) destSamples, numDestChannels, startOffsetInDestBuffer, numSamples);
+    }
+
     void addClient (Reader* r)
     {
         juce::ScopedWriteLock sl (clientListLock);
@@ -447,27 +944,19 @@ public:
     juce::int64 totalBytesInUse = 0;
 
 private:
-    juce::OwnedArray<juce::MemoryMappedAudioFormatReader> readers;
+    BlockTablePointer blockTable;
     juce::ReferenceCountedArray<Reader> clients;
 
     juce::CriticalSection blockUpdateLock;
-    juce::Array<int> currentBlocks;
 
+    MappedDataLayout dataLayout;
+    bool hasReadDataLayout = false;
     bool mapEntireFile = false;
     bool failedToOpenFile = false;
     juce::uint32 lastFailedOpenAttempt = 0;
     juce::Random random;
     
-    juce::ReadWriteLock clientListLock, readerLock;
-
-    juce::MemoryMappedAudioFormatReader* findReaderFor (juce::int64 sample) const
-    {
-        for (auto r : readers)
-            if (r != nullptr && r->getMappedSection().contains (sample))
-                return r;
-
-        return {};
-    }
+    juce::ReadWriteLock clientListLock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CachedFile)
 };
@@ -800,9 +1289,41 @@ bool AudioFileCache::Reader::readSamples (int numSamples,
                                           int startOffsetInDestBuffer,
                                           const juce::AudioChannelSet& sourceBufferChannels,
                                           int timeoutMs)
+{
+    static constexpr int maxNumChannels = 32;
+    float* destChannels[maxNumChannels] = {};
+    const auto numDestChans = std::min (maxNumChannels, destBuffer.getNumChannels());
+    jassert (destBuffer.getNumChannels() <= maxNumChannels);
+
+    for (int i = 0; i < numDestChans; ++i)
+        destChannels[i] = destBuffer.getWritePointer (i, startOffsetInDestBuffer);
+
+    return readFloatSamples (destChannels, numDestChans, numSamples, destBufferChannels, sourceBufferChannels, timeoutMs);
+}
+
+bool AudioFileCache::Reader::readSamples (choc::buffer::ChannelArrayView<float> destBuffer,
+                                          const juce::AudioChannelSet& destBufferChannels,
+                                          const juce::AudioChannelSet& sourceBufferChannels,
+                                          int timeoutMs)
+{
+    static constexpr int maxNumChannels = 32;
+    float* destChannels[maxNumChannels] = {};
+    const auto numDestChans = std::min (maxNumChannels, (int) destBuffer.getNumChannels());
+    jassert ((int) destBuffer.getNumChannels() <= maxNumChannels);
+
+    for (int i = 0; i < numDestChans; ++i)
+        destChannels[i] = destBuffer.getIterator ((choc::buffer::ChannelCount) i).sample;
+
+    return readFloatSamples (destChannels, numDestChans, (int) destBuffer.getNumFrames(),
+                             destBufferChannels, sourceBufferChannels, timeoutMs);
+}
+
+bool AudioFileCache::Reader::readFloatSamples (float* const* destChannels, int numDestChans, int numSamples,
+                                               const juce::AudioChannelSet& destBufferChannels,
+                                               const juce::AudioChannelSet& sourceBufferChannels,
+                                               int timeoutMs)
 {
     jassert (numSamples < CachedFile::readAheadSamples); // this method fails unless broken down into chunks smaller than this
-    const auto numDestChans = destBuffer.getNumChannels();
 
     // This may need to deal with the generic surround case if destBuffer number of channels > channelsToUse.size()
     if (cache.engine.getEngineBehaviour().isDescriptionOfWaveDevicesSupported())
@@ -810,94 +1331,67 @@ bool AudioFileCache::Reader::readSamples (int numSamples,
         static constexpr int maxNumChannels = 32;
         float* chans[maxNumChannels] = {};
         auto numSourceChans = std::min (maxNumChannels, sourceBufferChannels.size());
-        int highestUsedSourceChan = 0;
 
         for (int destIndex = 0; destIndex < numDestChans; ++destIndex)
         {
             auto destType = destBufferChannels.getTypeOfChannel (destIndex);
-            auto destData = destBuffer.getWritePointer (destIndex, startOffsetInDestBuffer);
+            auto destData = destChannels[destIndex];
             auto sourceIndex = sourceBufferChannels.getChannelIndexForType (destType);
 
             if (sourceIndex >= 0 && sourceIndex < maxNumChannels)
-            {
                 chans[sourceIndex] = destData;
-                highestUsedSourceChan = std::max (highestUsedSourceChan, sourceIndex);
-            }
             else
-            {
                 juce::FloatVectorOperations::clear (destData, numSamples);
-            }
         }
 
-        if (readSamples ((int**) chans, numSourceChans, 0, numSamples, timeoutMs))
-        {
-            bool isFloatingPoint = (file != nullptr) ? static_cast<CachedFile*> (file)->info.isFloatingPoint
-                                                     : fallbackReader->usesFloatingPointData;
+        return readSamples ((int**) chans, numSourceChans, 0, numSamples, timeoutMs, true);
+    }
 
-            if (! isFloatingPoint)
-                for (int i = 0; i <= highestUsedSourceChan; ++i)
-                    if (auto chan = chans[i])
-                        juce::FloatVectorOperations::convertFixedToFloat (chan, (const int*) chan, 1.0f / 0x7fffffff, numSamples);
+    float* chans[2] = {};
+    bool dupeChannel = false;
 
-            return true;
-        }
-    }
-    else
+    if (numDestChans > 1)
     {
-        float* chans[2] = {};
-        bool dupeChannel = false;
-
-        if (numDestChans > 1)
+        if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0
+             && sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::right) >= 0)
         {
-            if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0
-                 && sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::right) >= 0)
-            {
-                chans[0] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
+            chans[0] = destChannels[0];
 
-                if (getNumChannels() > 1)
-                    chans[1] = destBuffer.getWritePointer (1, startOffsetInDestBuffer);
-                else
-                    dupeChannel = true;
-            }
-            else if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0)
-            {
-                chans[0] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
-                dupeChannel = true;
-            }
+            if (getNumChannels() > 1)
+                chans[1] = destChannels[1];
             else
-            {
-                chans[1] = destBuffer.getWritePointer (1, startOffsetInDestBuffer);
                 dupeChannel = true;
-            }
+        }
+        else if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0)
+        {
+            chans[0] = destChannels[0];
+            dupeChannel = true;
         }
         else
         {
-            if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0 || getNumChannels() < 2)
-                chans[0] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
-            else
-                chans[1] = destBuffer.getWritePointer (0, startOffsetInDestBuffer);
+            chans[1] = destChannels[1];
+            dupeChannel = true;
         }
+    }
+    else
+    {
+        if (sourceBufferChannels.getChannelIndexForType (juce::AudioChannelSet::left) >= 0 || getNumChannels() < 2)
+            chans[0] = destChannels[0];
+        else
+            chans[1] = destChannels[0];
+    }
 
-        if (readSamples ((int**) chans, 2, 0, numSamples, timeoutMs))
+    if (readSamples ((int**) chans, 2, 0, numSamples, timeoutMs, true))
+    {
+        if (dupeChannel)
         {
-            const bool isFloatingPoint = (file != nullptr) ? static_cast<CachedFile*> (file)->info.isFloatingPoint
-                                                           : fallbackReader->usesFloatingPointData;
-
-            if (! isFloatingPoint)
-                for (int i = 0; i < 2; ++i)
-                    if (auto* chan = chans[i])
-                        juce::FloatVectorOperations::convertFixedToFloat (chan, (const int*) chan, 1.0f / 0x7fffffff, numSamples);
-
-            if (dupeChannel)
-            {
-                if (chans[0] == nullptr)
-                    juce::FloatVectorOperations::copy (destBuffer.getWritePointer (0), chans[1], numSamples);
-                else if (chans[1] == nullptr)
-                    juce::FloatVectorOperations::copy (destBuffer.getWritePointer (1), chans[0], numSamples);
-            }
-
-            return true;
+            if (chans[0] == nullptr)
+                juce::FloatVectorOperations::copy (destChannels[0], chans[1], numSamples);
+            else if (chans[1] == nullptr)
+                juce::FloatVectorOperations::copy (destChannels[1], chans[0], numSamples);
         }
+
+        return true;
     }
 
     return false;
@@ -905,6 +1399,13 @@ bool AudioFileCache::Reader::readSamples (int numSamples,
 
 bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels,
                                           int startOffsetInDestBuffer, int numSamples, int timeoutMs)
+{
+    return readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, numSamples, timeoutMs, false);
+}
+
+bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels,
+                                          int startOffsetInDestBuffer, int numSamples, int timeoutMs,
+                                          bool convertToFloat)
 {
     jassert (numSamples < CachedFile::readAheadSamples); // this method fails unless broken down into chunks smaller than this
     jassert (getReferenceCount() > 1 || file == nullptr); // may be being used after the cache has been deleted
@@ -926,19 +1427,25 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
             return true;
     }
 
+    auto readFallback = [&] (int startOffset, int numToRead)
+    {
+        fallbackReader->setReadTimeout (timeoutMs);
+        const bool ok = fallbackReader->readSamples (destSamples, numDestChannels, startOffset, readPos, numToRead);
+
+        if (convertToFloat && ! fallbackReader->usesFloatingPointData)
+            convertSetOfChannelsToFloat (destSamples, numDestChannels, startOffset, numToRead);
+
+        return ok;
+    };
+
     bool allOk = true;
 
     if (loopLength == 0)
     {
         if (auto cf = static_cast<CachedFile*> (file))
-        {
-            allOk = cf->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numSamples, timeoutMs);
-        }
+            allOk = cf->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numSamples, timeoutMs, convertToFloat);
         else
-        {
-            fallbackReader->setReadTimeout (timeoutMs);
-            allOk = fallbackReader->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, readPos, numSamples);
-        }
+            allOk = readFallback (startOffsetInDestBuffer, numSamples);
 
         readPos += numSamples;
     }
@@ -951,14 +1458,9 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
             auto numToRead = (int) std::min ((juce::int64) numSamples, loopStart + loopLength - readPos);
 
             if (auto cf = static_cast<CachedFile*> (file))
-            {
-                allOk = cf->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numToRead, timeoutMs) && allOk;
-            }
+                allOk = cf->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numToRead, timeoutMs, convertToFloat) && allOk;
             else
-            {
-                fallbackReader->setReadTimeout (timeoutMs);
-                allOk = fallbackReader->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, readPos, numToRead) && allOk;
-            }
+                allOk = readFallback (startOffsetInDestBuffer, numToRead) && allOk;
 
             readPos += numToRead;
 
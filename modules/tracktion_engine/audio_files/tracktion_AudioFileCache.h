@@ -38,6 +38,15 @@ public:
                           const juce::AudioChannelSet& sourceBufferChannels,
                           int timeoutMs);
 
+        /** Reads samples directly into a float buffer.
+            Mapped files are converted straight from their native sample format
+            rather than going through an intermediate int buffer.
+        */
+        bool readSamples (choc::buffer::ChannelArrayView<float> destBuffer,
+                          const juce::AudioChannelSet& destBufferChannels,
+                          const juce::AudioChannelSet& sourceBufferChannels,
+                          int timeoutMs);
+
         bool readSamples (int** destSamples,
                           int numDestChannels,
                           int startOffsetInDestBuffer,
@@ -54,6 +63,11 @@ public:
         int getNumChannels() const noexcept;
         double getSampleRate() const noexcept;
 
+        /** Returns true if this reads from the cache's memory-mapped blocks, or false if
+            the file couldn't be mapped and is being buffered from disk by a fallback reader.
+        */
+        bool isMapped() const noexcept                  { return file != nullptr; }
+
     private:
         friend class AudioFileCache;
 
@@ -64,6 +78,13 @@ public:
 
         Reader (AudioFileCache&, void*, juce::BufferingAudioReader* fallback);
 
+        bool readFloatSamples (float* const* destChannels, int numDestChannels, int numSamples,
+                               const juce::AudioChannelSet& destBufferChannels,
+                               const juce::AudioChannelSet& sourceBufferChannels,
+                               int timeoutMs);
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int numSamples, int timeoutMs, bool convertToFloat);
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Reader)
     };
 
@@ -23,6 +23,12 @@ public:
     AudioFile getAudioFile (ProjectItemID);
     AudioFileInfo getInfo (const AudioFile&);
 
+    /** Reads and caches the info for a file if it isn't already known.
+        Unlike getInfo() the file is parsed without holding the lock, so a number of
+        threads can call this at once to load the info for a set of files.
+    */
+    void cacheInfo (const AudioFile&);
+
     void checkFileForChangesAsync (const AudioFile&);
     void checkFileForChanges (const AudioFile&);
     void checkFilesForChanges();
@@ -37,6 +43,7 @@ public:
     Engine& engine;
     AudioProxyGenerator proxyGenerator;
     AudioFileCache cache;
+    PeakFileGenerator peakFileGenerator;
 
 private:
     struct KnownFile;
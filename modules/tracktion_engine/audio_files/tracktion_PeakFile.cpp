@@ -0,0 +1,449 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace peak_file_utils
+{
+    static constexpr const char* magic = "tpks";
+    static constexpr int version = 1;
+
+    static int getSamplesPerPeak (int level) noexcept
+    {
+        int samplesPerPeak = PeakFile::baseSamplesPerPeak;
+
+        for (int i = 0; i < level; ++i)
+            samplesPerPeak *= PeakFile::decimationFactor;
+
+        return samplesPerPeak;
+    }
+
+    /** The number of source samples each chunk covers, so each chunk has whole values at every level. */
+    static juce::int64 getChunkSize() noexcept
+    {
+        return getSamplesPerPeak (PeakFile::maxNumLevels - 1);
+    }
+
+    static juce::int8 toPeakValue (float value) noexcept
+    {
+        return (juce::int8) juce::jlimit (-128, 127, juce::roundToInt (value * 127.0f));
+    }
+}
+
+//==============================================================================
+PeakFile::PeakFile (const juce::File& f)
+    : file (f)
+{
+    if (! file.existsAsFile())
+        return;
+
+    mappedFile = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+
+    auto data = static_cast<const char*> (mappedFile->getData());
+    auto size = (juce::int64) mappedFile->getSize();
+
+    if (data == nullptr || size < headerSize || std::memcmp (data, peak_file_utils::magic, 4) != 0)
+    {
+        mappedFile.reset();
+        return;
+    }
+
+    auto readInt = [data] (int offset)      { return (int) juce::ByteOrder::littleEndianInt (data + offset); };
+    auto readInt64 = [data] (int offset)    { return (juce::int64) juce::ByteOrder::littleEndianInt64 (data + offset); };
+
+    const auto fileVersion = readInt (4);
+    const auto numChannelsInFile = readInt (8);
+    const auto numLevelsInFile = readInt (12);
+
+    if (fileVersion != peak_file_utils::version
+        || numChannelsInFile <= 0
+        || ! juce::isPositiveAndNotGreaterThan (numLevelsInFile, maxNumLevels))
+    {
+        mappedFile.reset();
+        return;
+    }
+
+    const auto sampleRateBits = readInt64 (16);
+    std::memcpy (&sampleRate, &sampleRateBits, sizeof (sampleRate));
+    lengthInSamples = readInt64 (24);
+    sourceHash = readInt64 (32);
+    numChannels = numChannelsInFile;
+
+    for (int i = 0; i < numLevelsInFile; ++i)
+    {
+        const auto numPeaks = readInt64 (40 + i * 16);
+        const auto offset = readInt64 (48 + i * 16);
+
+        if (numPeaks < 0 || offset < headerSize || offset + numPeaks * numChannels * 2 > size)
+        {
+            mappedFile.reset();
+            return;
+        }
+
+        levels[i] = { reinterpret_cast<const juce::int8*> (data + offset), numPeaks, peak_file_utils::getSamplesPerPeak (i) };
+    }
+
+    numLevels = numLevelsInFile;
+}
+
+PeakFile::~PeakFile()
+{
+}
+
+int PeakFile::getSamplesPerPeak (int level) const noexcept
+{
+    jassert (juce::isPositiveAndBelow (level, numLevels));
+    return levels[level].samplesPerPeak;
+}
+
+juce::Range<float> PeakFile::getMinMax (int channel, juce::int64 startSample, juce::int64 endSample) const noexcept
+{
+    if (! (isValid() && juce::isPositiveAndBelow (channel, numChannels)))
+        return {};
+
+    startSample = std::max ((juce::int64) 0, startSample);
+    endSample = std::min (lengthInSamples, endSample);
+
+    if (endSample <= startSample)
+        return {};
+
+    int levelIndex = 0;
+
+    while (levelIndex + 1 < numLevels && levels[levelIndex + 1].samplesPerPeak <= endSample - startSample)
+        ++levelIndex;
+
+    auto& level = levels[levelIndex];
+    const auto firstPeak = startSample / level.samplesPerPeak;
+    const auto lastPeak = std::min (level.numPeaks - 1, (endSample - 1) / level.samplesPerPeak);
+
+    if (lastPeak < firstPeak)
+        return {};
+
+    juce::int8 mn = 127, mx = -128;
+
+    for (auto peak = firstPeak; peak <= lastPeak; ++peak)
+    {
+        auto value = level.data + (peak * numChannels + channel) * 2;
+        mn = std::min (mn, value[0]);
+        mx = std::max (mx, value[1]);
+    }
+
+    return { mn / 127.0f, mx / 127.0f };
+}
+
+float PeakFile::getApproximatePeak() const noexcept
+{
+    if (! isValid())
+        return 0.0f;
+
+    auto& level = levels[numLevels - 1];
+    int peak = 0;
+
+    for (juce::int64 i = level.numPeaks * numChannels * 2; --i >= 0;)
+        peak = std::max (peak, std::abs ((int) level.data[i]));
+
+    return juce::jlimit (0, 127, peak) / 127.0f;
+}
+
+//==============================================================================
+struct PeakFileGenerator::Generation
+{
+    Generation (Engine& e, juce::ThreadPool& p)
+        : engine (e), pool (p)
+    {
+    }
+
+    Engine& engine;
+    juce::ThreadPool& pool;
+    juce::File sourceFile, destFile;
+    juce::int64 sourceHash = 0;
+
+    /** Called on whichever thread finishes the generation. */
+    std::function<void (bool)> onFinished;
+
+    int numChannels = 0;
+    double sampleRate = 0;
+    juce::int64 lengthInSamples = 0;
+    int numChunks = 0;
+
+    // Each chunk only writes to its own region of these
+    std::vector<juce::int8> levels[PeakFile::maxNumLevels];
+    juce::int64 numPeaks[PeakFile::maxNumLevels] = {};
+
+    std::atomic<int> numChunksRemaining { 0 };
+    std::atomic<bool> failed { false };
+
+    void finish()
+    {
+        const bool ok = ! failed && writeFile (*this);
+
+        if (onFinished)
+            onFinished (ok);
+    }
+};
+
+//==============================================================================
+PeakFileGenerator::PeakFileGenerator (Engine& e)
+    : engine (e), pool (juce::jmax (1, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+PeakFileGenerator::~PeakFileGenerator()
+{
+    pool.removeAllJobs (true, 10000);
+}
+
+juce::File PeakFileGenerator::getPeakFileFor (const AudioFile& file, Edit* edit) const
+{
+    auto folder = edit != nullptr ? edit->getTempDirectory (false)
+                                  : engine.getTemporaryFileManager().getThumbnailsFolder();
+
+    return folder.getChildFile ("peaks_" + file.getHashString() + PeakFile::getFileExtension());
+}
+
+std::unique_ptr<PeakFile> PeakFileGenerator::openPeakFile (const AudioFile& file, Edit* edit) const
+{
+    auto peakFile = getPeakFileFor (file, edit);
+
+    if (! peakFile.existsAsFile() || isGenerating (file, edit))
+        return {};
+
+    if (file.getFile().getLastModificationTime() > peakFile.getLastModificationTime() + juce::RelativeTime::seconds (0.1))
+    {
+        peakFile.deleteFile();
+        return {};
+    }
+
+    auto peaks = std::make_unique<PeakFile> (peakFile);
+
+    if (! peaks->isValid() || peaks->getSourceHash() != file.getHash())
+        return {};
+
+    return peaks;
+}
+
+void PeakFileGenerator::generate (const AudioFile& file, Edit* edit)
+{
+    auto destFile = getPeakFileFor (file, edit);
+
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (filesInProgress.contains (destFile))
+            return;
+
+        filesInProgress.add (destFile);
+    }
+
+    auto generation = std::make_shared<Generation> (engine, pool);
+    generation->sourceFile = file.getFile();
+    generation->sourceHash = file.getHash();
+    generation->destFile = destFile;
+    generation->onFinished = [this, destFile] (bool)
+    {
+        const juce::ScopedLock sl (lock);
+        filesInProgress.removeFirstMatchingValue (destFile);
+    };
+
+    pool.addJob ([generation] { startGeneration (generation); });
+}
+
+bool PeakFileGenerator::isGenerating (const AudioFile& file, Edit* edit) const
+{
+    const juce::ScopedLock sl (lock);
+    return filesInProgress.contains (getPeakFileFor (file, edit));
+}
+
+bool PeakFileGenerator::generate (Engine& e, const juce::File& sourceFile, juce::int64 sourceHash,
+                                  const juce::File& destFile, juce::ThreadPool& threadPool)
+{
+    jassert (! threadPool.contains (juce::ThreadPoolJob::getCurrentThreadPoolJob()));
+
+    juce::WaitableEvent finishedEvent;
+    std::atomic<bool> succeeded { false };
+
+    auto generation = std::make_shared<Generation> (e, threadPool);
+    generation->sourceFile = sourceFile;
+    generation->sourceHash = sourceHash;
+    generation->destFile = destFile;
+    generation->onFinished = [&] (bool ok)
+    {
+        succeeded = ok;
+        finishedEvent.signal();
+    };
+
+    startGeneration (generation);
+    finishedEvent.wait();
+
+    return succeeded;
+}
+
+//==============================================================================
+void PeakFileGenerator::startGeneration (std::shared_ptr<Generation> generation)
+{
+    auto& g = *generation;
+
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (AudioFileUtils::createReaderFor (g.engine, g.sourceFile));
+
+        if (reader == nullptr || reader->lengthInSamples <= 0 || reader->numChannels <= 0)
+        {
+            g.failed = true;
+            g.finish();
+            return;
+        }
+
+        g.numChannels = (int) reader->numChannels;
+        g.sampleRate = reader->sampleRate;
+        g.lengthInSamples = reader->lengthInSamples;
+    }
+
+    for (int i = 0; i < PeakFile::maxNumLevels; ++i)
+    {
+        const auto samplesPerPeak = peak_file_utils::getSamplesPerPeak (i);
+        g.numPeaks[i] = (g.lengthInSamples + samplesPerPeak - 1) / samplesPerPeak;
+        g.levels[i].resize ((size_t) (g.numPeaks[i] * g.numChannels * 2));
+    }
+
+    const auto chunkSize = peak_file_utils::getChunkSize();
+    g.numChunks = (int) ((g.lengthInSamples + chunkSize - 1) / chunkSize);
+    g.numChunksRemaining = g.numChunks;
+
+    for (int i = 0; i < g.numChunks; ++i)
+        g.pool.addJob ([generation, i] { generateChunk (generation, i); });
+}
+
+void PeakFileGenerator::generateChunk (std::shared_ptr<Generation> generation, int chunkIndex)
+{
+    auto& g = *generation;
+
+    if (! g.failed)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader (AudioFileUtils::createReaderFor (g.engine, g.sourceFile));
+
+        const auto chunkSize = peak_file_utils::getChunkSize();
+        const auto chunkStart = chunkIndex * chunkSize;
+        const auto numSamples = (int) std::min (chunkSize, g.lengthInSamples - chunkStart);
+        juce::AudioBuffer<float> buffer (g.numChannels, numSamples);
+
+        if (reader == nullptr)
+        {
+            g.failed = true;
+        }
+        else
+        {
+            reader->read (&buffer, 0, numSamples, chunkStart, true, true);
+
+            // Find the levels of the source for the first level
+            {
+                const auto firstPeak = chunkStart / PeakFile::baseSamplesPerPeak;
+                const auto numPeaksInChunk = (numSamples + PeakFile::baseSamplesPerPeak - 1) / PeakFile::baseSamplesPerPeak;
+                auto dest = g.levels[0].data() + firstPeak * g.numChannels * 2;
+
+                for (int peak = 0; peak < numPeaksInChunk; ++peak)
+                {
+                    const auto start = peak * PeakFile::baseSamplesPerPeak;
+                    const auto num = std::min (PeakFile::baseSamplesPerPeak, numSamples - start);
+
+                    for (int chan = 0; chan < g.numChannels; ++chan)
+                    {
+                        auto range = juce::FloatVectorOperations::findMinAndMax (buffer.getReadPointer (chan, start), num);
+                        *dest++ = peak_file_utils::toPeakValue (range.getStart());
+                        *dest++ = peak_file_utils::toPeakValue (range.getEnd());
+                    }
+                }
+            }
+
+            // Then each level summarises the one below it
+            for (int level = 1; level < PeakFile::maxNumLevels; ++level)
+            {
+                const auto samplesPerPeak = peak_file_utils::getSamplesPerPeak (level);
+                const auto firstPeak = chunkStart / samplesPerPeak;
+                const auto endPeak = std::min (g.numPeaks[level], (chunkStart + numSamples + samplesPerPeak - 1) / samplesPerPeak);
+                const auto numSourcePeaks = g.numPeaks[level - 1];
+                auto source = g.levels[level - 1].data();
+                auto dest = g.levels[level].data();
+
+                for (auto peak = firstPeak; peak < endPeak; ++peak)
+                {
+                    const auto firstSourcePeak = peak * PeakFile::decimationFactor;
+                    const auto endSourcePeak = std::min (numSourcePeaks, firstSourcePeak + PeakFile::decimationFactor);
+
+                    for (int chan = 0; chan < g.numChannels; ++chan)
+                    {
+                        juce::int8 mn = 127, mx = -128;
+
+                        for (auto i = firstSourcePeak; i < endSourcePeak; ++i)
+                        {
+                            auto value = source + (i * g.numChannels + chan) * 2;
+                            mn = std::min (mn, value[0]);
+                            mx = std::max (mx, value[1]);
+                        }
+
+                        auto d = dest + (peak * g.numChannels + chan) * 2;
+                        d[0] = mn;
+                        d[1] = mx;
+                    }
+                }
+            }
+        }
+    }
+
+    if (--g.numChunksRemaining == 0)
+        g.finish();
+}
+
+bool PeakFileGenerator::writeFile (Generation& g)
+{
+    g.destFile.getParentDirectory().createDirectory();
+
+    // Write to a temporary file first so a half-written file can't be opened
+    juce::TemporaryFile tempFile (g.destFile);
+
+    {
+        juce::FileOutputStream out (tempFile.getFile());
+
+        if (! out.openedOk())
+            return false;
+
+        out.write (peak_file_utils::magic, 4);
+        out.writeInt (peak_file_utils::version);
+        out.writeInt (g.numChannels);
+        out.writeInt (PeakFile::maxNumLevels);
+        out.writeDouble (g.sampleRate);
+        out.writeInt64 (g.lengthInSamples);
+        out.writeInt64 (g.sourceHash);
+
+        auto offset = (juce::int64) PeakFile::headerSize;
+
+        for (int i = 0; i < PeakFile::maxNumLevels; ++i)
+        {
+            out.writeInt64 (g.numPeaks[i]);
+            out.writeInt64 (offset);
+            offset += (juce::int64) g.levels[i].size();
+        }
+
+        jassert (out.getPosition() == PeakFile::headerSize);
+
+        for (auto& level : g.levels)
+            if (! out.write (level.data(), level.size()))
+                return false;
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return tempFile.overwriteTargetFileWithTemporary();
+}
+
+} // namespace tracktion_engine
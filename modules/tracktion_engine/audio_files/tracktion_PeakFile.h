@@ -0,0 +1,154 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    A read-only, memory-mapped summary of the levels in an audio file.
+
+    The file holds several levels of min/max pairs, each level summarising four
+    times as many samples per value as the one before, with the channels of each
+    value interleaved. As it's memory-mapped, only the parts of the levels that
+    are actually looked at get read from disk so opening one is cheap however
+    long the source is.
+
+    Use a PeakFileGenerator to create these.
+*/
+class PeakFile
+{
+public:
+    /** Opens a peak file. If it doesn't exist or isn't valid, isValid() will return false. */
+    PeakFile (const juce::File&);
+
+    /** Destructor. */
+    ~PeakFile();
+
+    /** Returns true if the file was opened and its header makes sense. */
+    bool isValid() const noexcept                           { return numLevels > 0; }
+
+    /** Returns the file this is reading. */
+    const juce::File& getFile() const noexcept              { return file; }
+
+    /** Returns the hash of the AudioFile this was created from. */
+    juce::int64 getSourceHash() const noexcept              { return sourceHash; }
+
+    int getNumChannels() const noexcept                     { return numChannels; }
+    double getSampleRate() const noexcept                   { return sampleRate; }
+    juce::int64 getLengthInSamples() const noexcept         { return lengthInSamples; }
+
+    /** Returns the number of levels in the file. */
+    int getNumLevels() const noexcept                       { return numLevels; }
+
+    /** Returns the number of source samples each value of a level summarises. */
+    int getSamplesPerPeak (int level) const noexcept;
+
+    /** Returns the min and max of a channel between two source samples, from -1 to 1.
+        This uses the coarsest level which can still resolve the range, so the
+        result can include up to a value's worth of samples either side.
+        If there's no data in the range, the result will be empty.
+    */
+    juce::Range<float> getMinMax (int channel, juce::int64 startSample, juce::int64 endSample) const noexcept;
+
+    /** Returns the highest absolute level in the file, from 0 to 1. */
+    float getApproximatePeak() const noexcept;
+
+    //==============================================================================
+    static constexpr int baseSamplesPerPeak = 256;
+    static constexpr int decimationFactor = 4;
+    static constexpr int maxNumLevels = 6;
+
+    /** Returns the file extension used for peak files. */
+    static const char* getFileExtension() noexcept          { return ".tpeaks"; }
+
+private:
+    //==============================================================================
+    friend class PeakFileGenerator;
+
+    struct Level
+    {
+        const juce::int8* data = nullptr;
+        juce::int64 numPeaks = 0;
+        int samplesPerPeak = 0;
+    };
+
+    const juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    Level levels[maxNumLevels];
+    int numLevels = 0, numChannels = 0;
+    double sampleRate = 0;
+    juce::int64 lengthInSamples = 0, sourceHash = 0;
+
+    static constexpr int headerSize = 40 + maxNumLevels * 16;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakFile)
+};
+
+//==============================================================================
+/**
+    Creates PeakFiles in the background.
+
+    Each file is split in to chunks which are read and summarised in parallel on
+    a thread pool, with each chunk using its own reader. When all the chunks have
+    finished, the levels are written to a temporary file which then replaces the
+    target so a partially written peak file is never opened.
+*/
+class PeakFileGenerator
+{
+public:
+    /** Creates a generator for an Engine. */
+    PeakFileGenerator (Engine&);
+
+    /** Destructor. Any files being generated are abandoned. */
+    ~PeakFileGenerator();
+
+    //==============================================================================
+    /** Returns the file the peaks of an AudioFile are stored in.
+        If an Edit is supplied, its temporary directory is used, otherwise the Engine's
+        thumbnail folder is.
+    */
+    juce::File getPeakFileFor (const AudioFile&, Edit*) const;
+
+    /** Opens the peak file for an AudioFile if it exists and is newer than the AudioFile.
+        Returns nullptr if it needs generating.
+    */
+    std::unique_ptr<PeakFile> openPeakFile (const AudioFile&, Edit*) const;
+
+    /** Starts generating the peak file for an AudioFile if it's not already being generated. */
+    void generate (const AudioFile&, Edit*);
+
+    /** Returns true if a peak file is being generated for an AudioFile. */
+    bool isGenerating (const AudioFile&, Edit*) const;
+
+    /** Generates a peak file synchronously, summarising the chunks on a ThreadPool.
+        This mustn't be called from one of the pool's threads.
+        Returns true if the file was written.
+    */
+    static bool generate (Engine&, const juce::File& sourceFile, juce::int64 sourceHash,
+                          const juce::File& destFile, juce::ThreadPool&);
+
+private:
+    //==============================================================================
+    struct Generation;
+
+    Engine& engine;
+    juce::ThreadPool pool;
+    juce::Array<juce::File> filesInProgress;
+    juce::CriticalSection lock;
+
+    static void startGeneration (std::shared_ptr<Generation>);
+    static void generateChunk (std::shared_ptr<Generation>, int chunkIndex);
+    static bool writeFile (Generation&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PeakFileGenerator)
+};
+
+} // namespace tracktion_engine
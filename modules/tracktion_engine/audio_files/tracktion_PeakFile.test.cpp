@@ -0,0 +1,118 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if TRACKTION_UNIT_TESTS
+
+//==============================================================================
+//==============================================================================
+class PeakFileTests    : public juce::UnitTest
+{
+public:
+    PeakFileTests()
+        : juce::UnitTest ("PeakFile", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines().getFirst();
+
+        // Long enough to span several chunks and not end on a whole value at any level
+        const double sampleRate = 44100.0;
+        const double duration = 30.1;
+        auto sourceFile = tracktion_graph::test_utilities::getSinFile<juce::WavAudioFormat> (sampleRate, duration, 2, 2.0f);
+        AudioFile audioFile (engine, sourceFile->getFile());
+
+        juce::TemporaryFile peakFile (PeakFile::getFileExtension());
+        juce::ThreadPool pool (4);
+
+        beginTest ("Generating");
+        {
+            expect (PeakFileGenerator::generate (engine, audioFile.getFile(), audioFile.getHash(), peakFile.getFile(), pool));
+        }
+
+        beginTest ("Header");
+        {
+            PeakFile peaks (peakFile.getFile());
+            expect (peaks.isValid());
+            expectEquals (peaks.getNumChannels(), 2);
+            expectEquals (peaks.getSampleRate(), sampleRate);
+            expectEquals (peaks.getLengthInSamples(), (juce::int64) (sampleRate * duration));
+            expectEquals (peaks.getSourceHash(), audioFile.getHash());
+            expectEquals (peaks.getNumLevels(), PeakFile::maxNumLevels);
+
+            for (int i = 1; i < peaks.getNumLevels(); ++i)
+                expectEquals (peaks.getSamplesPerPeak (i), peaks.getSamplesPerPeak (i - 1) * PeakFile::decimationFactor);
+        }
+
+        beginTest ("Levels match the source");
+        {
+            PeakFile peaks (peakFile.getFile());
+            std::unique_ptr<juce::AudioFormatReader> reader (AudioFileUtils::createReaderFor (engine, audioFile.getFile()));
+            expect (reader != nullptr);
+
+            const float tolerance = 1.5f / 127.0f;
+
+            auto whole = peaks.getMinMax (0, 0, peaks.getLengthInSamples());
+            expectWithinAbsoluteError (whole.getStart(), -1.0f, tolerance);
+            expectWithinAbsoluteError (whole.getEnd(), 1.0f, tolerance);
+            expectWithinAbsoluteError (peaks.getApproximatePeak(), 1.0f, tolerance);
+
+            juce::Random r (42);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                const auto start = (juce::int64) (r.nextDouble() * peaks.getLengthInSamples());
+                const auto length = (juce::int64) std::pow (2.0, r.nextDouble() * 21.0);
+                const auto end = std::min (peaks.getLengthInSamples(), start + length);
+
+                // The peaks cover whole values of whichever level was used
+                int samplesPerPeak = peaks.getSamplesPerPeak (0);
+
+                for (int level = 1; level < peaks.getNumLevels() && peaks.getSamplesPerPeak (level) <= end - start; ++level)
+                    samplesPerPeak = peaks.getSamplesPerPeak (level);
+
+                const auto alignedStart = (start / samplesPerPeak) * samplesPerPeak;
+                const auto alignedEnd = std::min (peaks.getLengthInSamples(),
+                                                  ((end + samplesPerPeak - 1) / samplesPerPeak) * samplesPerPeak);
+
+                juce::Range<float> expected[2];
+                reader->readMaxLevels (alignedStart, alignedEnd - alignedStart, expected, 2);
+
+                for (int chan = 0; chan < 2; ++chan)
+                {
+                    auto actual = peaks.getMinMax (chan, start, end);
+                    expectWithinAbsoluteError (actual.getStart(), expected[chan].getStart(), tolerance);
+                    expectWithinAbsoluteError (actual.getEnd(), expected[chan].getEnd(), tolerance);
+                }
+            }
+        }
+
+        beginTest ("Invalid files");
+        {
+            expect (! PeakFile (peakFile.getFile().getSiblingFile ("doesnt_exist")).isValid());
+
+            juce::TemporaryFile truncated (PeakFile::getFileExtension());
+            juce::MemoryBlock data;
+            peakFile.getFile().loadFileAsData (data);
+            truncated.getFile().replaceWithData (data.getData(), data.getSize() / 2);
+            expect (! PeakFile (truncated.getFile()).isValid());
+        }
+    }
+};
+
+static PeakFileTests peakFileTests;
+
+#endif
+
+} // namespace tracktion_engine
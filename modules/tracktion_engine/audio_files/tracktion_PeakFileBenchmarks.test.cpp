@@ -0,0 +1,172 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class PeakFileBenchmarks : public juce::UnitTest
+{
+public:
+    PeakFileBenchmarks()
+        : juce::UnitTest ("PeakFile Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+
+        juce::TemporaryFile folder;
+        folder.getFile().createDirectory();
+        const auto files = createFiles (engine, folder.getFile());
+
+        runInMemoryThumbnailTest (engine, files);
+        runPeakFileTest (engine, files);
+
+        folder.getFile().deleteRecursively();
+    }
+
+private:
+    static constexpr int numFiles = 1000;
+    static constexpr int numChannels = 2;
+    static constexpr double sampleRate = 44100.0;
+    static constexpr double duration = 2.0;
+    static constexpr int samplesPerThumbSample = 256;
+    static constexpr int numPixels = 1000;
+
+    static juce::Array<AudioFile> createFiles (Engine& engine, const juce::File& folder)
+    {
+        auto sourceFile = tracktion_graph::test_utilities::getSinFile<juce::WavAudioFormat> (sampleRate, duration, numChannels);
+        juce::Array<AudioFile> files;
+
+        for (int i = 0; i < numFiles; ++i)
+        {
+            auto f = folder.getChildFile ("file_" + juce::String (i) + ".wav");
+            sourceFile->getFile().copyFileTo (f);
+            files.add (AudioFile (engine, f));
+        }
+
+        return files;
+    }
+
+    static juce::String getDescription()
+    {
+        return juce::String (numFiles) + " files, " + juce::String (duration, 1) + "s";
+    }
+
+    static juce::String getMemoryDescription (juce::int64 numBytes)
+    {
+        return juce::File::descriptionOfSizeInBytes (numBytes);
+    }
+
+    /** Reads every file in to an in-memory min/max cache, the way a TracktionThumbnail
+        loads a file without a cached thumbnail.
+    */
+    void runInMemoryThumbnailTest (Engine& engine, const juce::Array<AudioFile>& files)
+    {
+        beginTest ("In-memory thumbnails: " + getDescription());
+
+        std::vector<std::vector<juce::int8>> thumbnails;
+        juce::int64 numBytesHeld = 0;
+
+        const StopwatchTimer sw;
+
+        for (auto& file : files)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader (AudioFileUtils::createReaderFor (engine, file.getFile()));
+            const auto numThumbSamples = (int) ((reader->lengthInSamples + samplesPerThumbSample - 1) / samplesPerThumbSample);
+            std::vector<juce::int8> levels ((size_t) (numThumbSamples * numChannels * 2));
+
+            for (int i = 0; i < numThumbSamples; ++i)
+            {
+                juce::Range<float> results[numChannels];
+                reader->readMaxLevels ((juce::int64) i * samplesPerThumbSample, samplesPerThumbSample, results, numChannels);
+
+                for (int chan = 0; chan < numChannels; ++chan)
+                {
+                    levels[(size_t) ((i * numChannels + chan) * 2)]     = (juce::int8) juce::roundToInt (results[chan].getStart() * 127.0f);
+                    levels[(size_t) ((i * numChannels + chan) * 2 + 1)] = (juce::int8) juce::roundToInt (results[chan].getEnd() * 127.0f);
+                }
+            }
+
+            numBytesHeld += (juce::int64) levels.size();
+            thumbnails.push_back (std::move (levels));
+        }
+
+        std::cout << "Loaded in " << sw.getDescription() << ", holding " << getMemoryDescription (numBytesHeld) << "\n";
+        expectEquals ((int) thumbnails.size(), numFiles);
+    }
+
+    /** Generates the peak files in the background then opens them and draws a screen's worth
+        from each, the way SmartThumbnails do when an Edit is opened.
+    */
+    void runPeakFileTest (Engine& engine, const juce::Array<AudioFile>& files)
+    {
+        beginTest ("Peak files: " + getDescription());
+
+        PeakFileGenerator generator (engine);
+
+        {
+            const StopwatchTimer sw;
+
+            for (auto& file : files)
+                generator.generate (file, nullptr);
+
+            for (auto& file : files)
+                while (generator.isGenerating (file, nullptr))
+                    juce::Thread::sleep (1);
+
+            std::cout << "Generated in " << sw.getDescription() << "\n";
+        }
+
+        std::vector<std::unique_ptr<PeakFile>> peakFiles;
+        juce::int64 numBytesMapped = 0;
+
+        {
+            const StopwatchTimer sw;
+            const auto samplesPerPixel = (juce::int64) (sampleRate * duration) / numPixels;
+
+            for (auto& file : files)
+            {
+                if (auto peaks = generator.openPeakFile (file, nullptr))
+                {
+                    for (int chan = 0; chan < numChannels; ++chan)
+                        for (int i = 0; i < numPixels; ++i)
+                            peaks->getMinMax (chan, i * samplesPerPixel, (i + 1) * samplesPerPixel);
+
+                    numBytesMapped += peaks->getFile().getSize();
+                    peakFiles.push_back (std::move (peaks));
+                }
+            }
+
+            std::cout << "Opened and drawn in " << sw.getDescription()
+                      << ", holding " << getMemoryDescription ((juce::int64) (peakFiles.size() * sizeof (PeakFile)))
+                      << " with " << getMemoryDescription (numBytesMapped) << " mapped\n";
+        }
+
+        expectEquals ((int) peakFiles.size(), numFiles);
+        peakFiles.clear();
+
+        for (auto& file : files)
+            generator.getPeakFileFor (file, nullptr).deleteFile();
+    }
+};
+
+static PeakFileBenchmarks peakFileBenchmarks;
+
+}
+
+#endif
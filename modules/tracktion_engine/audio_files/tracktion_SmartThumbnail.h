@@ -67,7 +67,7 @@ private:
     //==============================================================================
     juce::Component& component;
     bool wasGeneratingProxy = false;
-    std::atomic<bool> thumbnailIsInvalid { true };
+    std::atomic<bool> thumbnailIsInvalid { true }, hasRequestedPeakFile { false };
     float lastProgress = 0.0f;
 
     void timerCallback() override;
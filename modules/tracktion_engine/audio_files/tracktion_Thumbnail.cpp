@@ -342,10 +342,11 @@ public:
     void drawChannel (juce::Graphics& g, juce::Rectangle<int> area, bool useHighRes,
                       EditTimeRange time, int channelNum, float verticalZoomFactor,
                       double rate, int numChans, int sampsPerThumbSample,
-                      LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans)
+                      LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans,
+                      const PeakFile* peakFile)
     {
         if (refillCache (area.getWidth(), time, rate,
-                         numChans, sampsPerThumbSample, levelData, chans)
+                         numChans, sampsPerThumbSample, levelData, chans, peakFile)
             && juce::isPositiveAndBelow (channelNum, numChannelsCached))
         {
             auto clip = g.getClipBounds().withTrimmedRight (useHighRes ? -1 : 0)
@@ -431,7 +432,8 @@ private:
 
     bool refillCache (int numSamples, EditTimeRange time,
                       double rate, int numChans, int sampsPerThumbSample,
-                      LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans)
+                      LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans,
+                      const PeakFile* peakFile)
     {
         auto timePerPixel = time.getLength() / numSamples;
 
@@ -506,6 +508,28 @@ private:
 
             numSamplesCached = i;
         }
+        else if (peakFile != nullptr)
+        {
+            for (int channelNum = 0; channelNum < numChannelsCached; ++channelNum)
+            {
+                MinMaxValue* cacheData = getData (channelNum, 0);
+
+                startTime = cachedStart;
+                auto sample = (juce::int64) (startTime * rate + 0.5);
+
+                for (int i = numSamples; --i >= 0;)
+                {
+                    auto nextSample = (juce::int64) ((startTime + timePerPixel) * rate + 0.5);
+                    auto range = peakFile->getMinMax (channelNum, sample, std::max (sample + 1, nextSample));
+
+                    cacheData->setFloat (range.getStart(), range.getEnd());
+
+                    ++cacheData;
+                    startTime += timePerPixel;
+                    sample = nextSample;
+                }
+            }
+        }
         else
         {
             jassert (chans.size() == numChannelsCached);
@@ -584,6 +608,7 @@ void TracktionThumbnail::clearChannelData()
     const juce::ScopedLock sl (lock);
     window->invalidate();
     channels.clear();
+    peakFile.reset();
     totalSamples = numSamplesFinished = 0;
     numChannels = 0;
     sampleRate = 0;
@@ -716,6 +741,42 @@ void TracktionThumbnail::releaseResources()
         source->releaseResources();
 }
 
+void TracktionThumbnail::setPeakFile (std::unique_ptr<PeakFile> newPeakFile, juce::InputSource* sourceForFineDetail)
+{
+    std::unique_ptr<juce::InputSource> fineDetailSource (sourceForFineDetail);
+    clear();
+
+    if (newPeakFile == nullptr || ! newPeakFile->isValid())
+        return;
+
+    const juce::ScopedLock sl (sourceLock);
+    const juce::ScopedLock sl2 (lock);
+
+    numChannels = newPeakFile->getNumChannels();
+    sampleRate = newPeakFile->getSampleRate();
+    totalSamples = numSamplesFinished = newPeakFile->getLengthInSamples();
+    peakFile = std::move (newPeakFile);
+
+    // The source will only open a reader when it's asked for levels
+    if (fineDetailSource != nullptr)
+    {
+        source = std::make_unique<LevelDataSource> (*this, fineDetailSource.release());
+        source->lengthInSamples = totalSamples;
+        source->sampleRate = sampleRate;
+        source->numChannels = (unsigned int) numChannels;
+        source->numSamplesFinished = totalSamples;
+    }
+
+    window->invalidate();
+    sendChangeMessage();
+}
+
+bool TracktionThumbnail::isUsingPeakFile() const noexcept
+{
+    const juce::ScopedLock sl (lock);
+    return peakFile != nullptr;
+}
+
 juce::int64 TracktionThumbnail::getHashCode() const
 {
     const juce::ScopedLock sl (sourceLock);
@@ -808,6 +869,10 @@ juce::int64 TracktionThumbnail::getNumSamplesFinished() const noexcept
 float TracktionThumbnail::getApproximatePeak() const
 {
     const juce::ScopedLock sl (lock);
+
+    if (peakFile != nullptr)
+        return peakFile->getApproximatePeak();
+
     int peak = 0;
 
     for (int i = channels.size(); --i >= 0;)
@@ -820,6 +885,16 @@ void TracktionThumbnail::getApproximateMinMax (double startTime, double endTime,
                                                float& minValue, float& maxValue) const noexcept
 {
     const juce::ScopedLock sl (lock);
+
+    if (peakFile != nullptr)
+    {
+        auto range = peakFile->getMinMax (channelIndex, (juce::int64) (startTime * sampleRate),
+                                          (juce::int64) std::ceil (endTime * sampleRate));
+        minValue = range.getStart();
+        maxValue = range.getEnd();
+        return;
+    }
+
     MinMaxValue result;
     auto* data = channels[channelIndex];
 
@@ -852,7 +927,8 @@ void TracktionThumbnail::drawChannel (juce::Graphics& g, juce::Rectangle<int> ar
     const juce::ScopedLock sl (lock);
 
     window->drawChannel (g, area, useHighRes, time, channelNum, verticalZoomFactor,
-                         sampleRate, numChannels, samplesPerThumbSample, source.get(), channels);
+                         sampleRate, numChannels, samplesPerThumbSample, source.get(), channels,
+                         peakFile.get());
 }
 
 void TracktionThumbnail::drawChannels (juce::Graphics& g, juce::Rectangle<int> area, bool useHighRes,
@@ -36,6 +36,16 @@ public:
 
     void releaseResources();
 
+    /** Uses a PeakFile for the levels rather than reading the whole source and
+        holding the levels in memory.
+        If a source is supplied, it's only read when zoomed in closer than the peak
+        file's resolution. This takes ownership of the source.
+    */
+    void setPeakFile (std::unique_ptr<PeakFile>, juce::InputSource* sourceForFineDetail);
+
+    /** Returns true if the levels are coming from a PeakFile. */
+    bool isUsingPeakFile() const noexcept;
+
     juce::int64 getHashCode() const override;
 
     void addBlock (juce::int64 startSample, const juce::AudioBuffer<float>& incoming,
@@ -70,6 +80,7 @@ private:
     std::unique_ptr<LevelDataSource> source;
     std::unique_ptr<CachedWindow> window;
     juce::OwnedArray<ThumbData> channels;
+    std::unique_ptr<PeakFile> peakFile;
 
     juce::int32 samplesPerThumbSample = 0;
     juce::int64 totalSamples = 0, numSamplesFinished = 0;
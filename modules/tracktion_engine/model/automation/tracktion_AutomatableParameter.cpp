@@ -171,10 +171,18 @@ public:
 
     void triggerAsyncCurveUpdate()
     {
+        invalidateSnapshot();
+
         if (! parameter.getEdit().isLoading())
             deferredUpdateTimer.startTimer (10);
     }
 
+    /** Marks the message thread snapshot as stale so it gets rebuilt the next time it's needed. */
+    void invalidateSnapshot()
+    {
+        snapshotNeedsUpdating = true;
+    }
+
     void updateInterpolatedPoints()
     {
         jassert (! parameter.getEdit().isLoading());
@@ -185,26 +193,42 @@ public:
 
         if (curve.getNumPoints() > 0)
         {
-            auto s = std::make_unique<AutomationIterator> (parameter);
+            auto s = std::make_unique<AutomationIterator> (getSnapshot());
 
             if (! s->isEmpty())
                 newStream = std::move (s);
         }
 
-        {
-            const juce::ScopedLock sl (parameterStreamLock);
-            automationActive.store (newStream != nullptr, std::memory_order_relaxed);
-            parameterStream = std::move (newStream);
+        const bool hasStream = newStream != nullptr;
+        double timeToUpdateTo;
 
-            if (! parameterStream)
-                parameter.updateToFollowCurve (lastTime);
-
-            lastTime = -1.0;
+        {
+            // Only swap the pointer under the lock, the old stream gets deleted once it's been released
+            const std::lock_guard<tracktion_graph::RealTimeSpinLock> sl (parameterStreamLock);
+            automationActive.store (hasStream, std::memory_order_relaxed);
+            std::swap (parameterStream, newStream);
+            timeToUpdateTo = lastTime.exchange (-1.0);
         }
 
+        if (! hasStream)
+            parameter.updateToFollowCurve (timeToUpdateTo);
+
         parameter.automatableEditElement.updateActiveParameters();
     }
 
+    /** Rebuilds the snapshot if it's stale.
+        This is called from other threads whilst the Edit is loading so mustn't touch anything else.
+    */
+    void updateSnapshot()
+    {
+        if (snapshot == nullptr || snapshotNeedsUpdating)
+        {
+            snapshot = curve.createSnapshot();
+            snapshotNeedsUpdating = false;
+            messageThreadCursor = 0;
+        }
+    }
+
     bool isActive() const noexcept
     {
         return automationActive.load (std::memory_order_relaxed);
@@ -213,7 +237,12 @@ public:
     float getValueAt (double time) override
     {
         TRACKTION_ASSERT_MESSAGE_THREAD
-        return curve.getValueAt (time);
+        auto& s = getSnapshot();
+
+        if (s->isEmpty())
+            return curve.getValueAt (time);
+
+        return s->getValueAt (time, messageThreadCursor);
     }
 
     bool isEnabledAt (double) override
@@ -228,10 +257,17 @@ public:
                 if (! plugin->isClipEffectPlugin())
                     return;
 
-        const juce::ScopedLock sl (parameterStreamLock);
+        // If the stream is being swapped, just keep the last value for this block
+        std::unique_lock<tracktion_graph::RealTimeSpinLock> sl (parameterStreamLock, std::try_to_lock);
+
+        if (! sl.owns_lock() || parameterStream == nullptr)
+            return;
 
         if (lastTime.exchange (time) != time)
+        {
             parameterStream->setPosition (time);
+            lastValue.store (parameterStream->getCurrentValue(), std::memory_order_relaxed);
+        }
     }
 
     bool isEnabled() override
@@ -241,8 +277,18 @@ public:
 
     float getCurrentValue() override
     {
-        const juce::ScopedLock sl (parameterStreamLock);
-        return parameterStream->getCurrentValue();
+        return lastValue.load (std::memory_order_relaxed);
+    }
+
+    /** Returns the time of the next point after the given time, for splitting automation ramps. */
+    double getNextPointTimeAfter (double time)
+    {
+        std::unique_lock<tracktion_graph::RealTimeSpinLock> sl (parameterStreamLock, std::try_to_lock);
+
+        if (! sl.owns_lock() || parameterStream == nullptr)
+            return std::numeric_limits<double>::max();
+
+        return parameterStream->getNextPointTimeAfter (time);
     }
 
     AutomatableParameter& parameter;
@@ -250,10 +296,22 @@ public:
 
 private:
     LambdaTimer deferredUpdateTimer;
-    juce::CriticalSection parameterStreamLock;
+    tracktion_graph::RealTimeSpinLock parameterStreamLock;
     std::unique_ptr<AutomationIterator> parameterStream;
     std::atomic<bool> automationActive { false };
     std::atomic<double> lastTime { -1.0 };
+    std::atomic<float> lastValue { 0.0f };
+
+    std::shared_ptr<const AutomationCurveSnapshot> snapshot;
+    bool snapshotNeedsUpdating = true;
+    int messageThreadCursor = 0;
+
+    const std::shared_ptr<const AutomationCurveSnapshot>& getSnapshot()
+    {
+        TRACKTION_ASSERT_MESSAGE_THREAD
+        updateSnapshot();
+        return snapshot;
+    }
 
     static juce::ValueTree getState (AutomatableParameter& ap)
     {
@@ -769,12 +827,68 @@ void AutomatableParameter::updateStream()
     curveSource->updateInterpolatedPoints();
 }
 
+void AutomatableParameter::prepareStream()
+{
+    curveSource->updateSnapshot();
+}
+
 void AutomatableParameter::updateFromAutomationSources (double time)
 {
     if (updateParametersRecursionCheck)
         return;
 
     const juce::ScopedValueSetter<bool> svs (updateParametersRecursionCheck, true);
+    const auto values = getBaseAndModifierValuesAt (time);
+
+    currentModifierValue = values.second;
+    setParameterValue (values.first, true);
+}
+
+void AutomatableParameter::fillAutomationRamp (AutomationRamp& ramp, double startTime, double sampleRate,
+                                               int numSamples, int intervalSamples)
+{
+    if (updateParametersRecursionCheck || ! isAutomationActive())
+    {
+        ramp.setConstant (currentValue, numSamples);
+        return;
+    }
+
+    const juce::ScopedValueSetter<bool> svs (updateParametersRecursionCheck, true);
+
+    // Each interval takes up to two segments so widen it if the block wouldn't fit
+    const auto maxNumIntervals = std::max (1, ramp.getMaxNumSegments() / 2);
+    const auto interval = std::max (intervalSamples > 0 ? intervalSamples : numSamples,
+                                    (numSamples + maxNumIntervals - 1) / maxNumIntervals);
+
+    ramp.clear();
+    float startValue = currentValue;
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        auto end = std::min ((pos / interval + 1) * interval, numSamples);
+
+        // End the segment on a point so the corners of the curve aren't smoothed out,
+        // but only once per interval so the number of segments is bounded
+        if (pos % interval == 0)
+        {
+            const auto nextPointTime = curveSource->isActive() ? curveSource->getNextPointTimeAfter (startTime + pos / sampleRate)
+                                                               : std::numeric_limits<double>::max();
+
+            if (nextPointTime < startTime + end / sampleRate)
+                end = juce::jlimit (pos + 1, end, (int) std::ceil ((nextPointTime - startTime) * sampleRate));
+        }
+
+        const auto values = getBaseAndModifierValuesAt (startTime + end / sampleRate);
+        const auto endValue = getValueFromBaseAndModifier (values.first, values.second);
+
+        ramp.addSegment (end - pos, startValue, endValue);
+        startValue = endValue;
+        pos = end;
+    }
+}
+
+std::pair<float, float> AutomatableParameter::getBaseAndModifierValuesAt (double time)
+{
     float newModifierValue = 0.0f;
 
     getAutomationSourceList()
@@ -804,14 +918,21 @@ void AutomatableParameter::updateFromAutomationSources (double time)
     if (newModifierValue != 0.0f)
     {
         auto normalisedBase = valueRange.convertTo0to1 (newBaseValue);
-        currentModifierValue = valueRange.convertFrom0to1 (juce::jlimit (0.0f, 1.0f, normalisedBase + newModifierValue)) - newBaseValue;
-    }
-    else
-    {
-        currentModifierValue = 0.0f;
+        return { newBaseValue, valueRange.convertFrom0to1 (juce::jlimit (0.0f, 1.0f, normalisedBase + newModifierValue)) - newBaseValue };
     }
 
-    setParameterValue (newBaseValue, true);
+    return { newBaseValue, 0.0f };
+}
+
+float AutomatableParameter::getValueFromBaseAndModifier (float baseValue, float modifierValue) const
+{
+    // This should match the value setParameterValue calculates
+    const auto value = snapToState (getValueRange().clipValue (baseValue));
+
+    if (modifierValue != 0.0f)
+        return snapToState (getValueRange().clipValue (value + modifierValue));
+
+    return value;
 }
 
 //==============================================================================
@@ -839,7 +960,10 @@ void AutomatableParameter::valueTreeChildAdded (juce::ValueTree& parent, juce::V
     if (parent == getCurve().state || parent == modifiersState)
         curveHasChanged();
     else if (parent == parentState && newChild[IDs::name] == paramID)
+    {
         getCurve().setState (newChild);
+        curveSource->invalidateSnapshot();
+    }
 }
 
 void AutomatableParameter::valueTreeChildRemoved (juce::ValueTree& parent, juce::ValueTree&, int)
@@ -1217,128 +1341,128 @@ AutomatableParameter* getParameter (AutomatableParameter::ModifierAssignment& as
 
 //==============================================================================
 AutomationIterator::AutomationIterator (const AutomatableParameter& p)
+    : AutomationIterator (p.getCurve().createSnapshot())
 {
-    const auto& curve = p.getCurve();
+}
 
-    jassert (curve.getNumPoints() > 0);
+AutomationIterator::AutomationIterator (std::shared_ptr<const AutomationCurveSnapshot> s)
+    : snapshot (std::move (s))
+{
+    jassert (snapshot != nullptr);
 
-    const double timeDelta      = 1.0 / 100.0;
-    const double minValueDelta  = (p.getValueRange().getLength()) / 256.0;
+    if (! snapshot->isEmpty())
+        currentValue = snapshot->getPointValue (0);
+}
 
-    int curveIndex = 0;
-    int lastCurveIndex = -1;
-    double t = 0.0;
-    float lastValue = 1.0e10;
-    auto lastTime = curve.getPointTime (curve.getNumPoints() - 1) + 1.0;
-    double t1 = 0.0;
-    double t2 = curve.getPointTime (0);
-    float v1 = curve.getValueAt (0.0);
-    float v2 = v1;
-    float c  = 0;
-    CurvePoint bp;
-    double x1end = 0;
-    double x2end = 0;
-    float y1end = 0;
-    float y2end = 0;
+void AutomationIterator::setPosition (double newTime) noexcept
+{
+    jassert (! snapshot->isEmpty());
+    currentValue = snapshot->getValueAt (newTime, cursor);
+}
 
-    while (t < lastTime)
-    {
-        while (t >= t2)
-        {
-            if (curveIndex >= curve.getNumPoints() - 1)
-            {
-                t1 = t2;
-                v1 = v2;
-                t2 = lastTime;
-                break;
-            }
+double AutomationIterator::getNextPointTimeAfter (double time) const noexcept
+{
+    const auto index = snapshot->indexBefore (time) + 1;
 
-            t1 = t2;
-            v1 = v2;
-            c  = curve.getPointCurve (curveIndex);
+    if (index < snapshot->getNumPoints())
+        return snapshot->getPointTime (index);
 
-            if (c != 0.0f)
-            {
-                bp = curve.getBezierPoint (curveIndex);
+    return std::numeric_limits<double>::max();
+}
 
-                if (c < -0.5 || c > 0.5)
-                    curve.getBezierEnds (curveIndex, x1end, y1end, x2end, y2end);
-            }
+//==============================================================================
+void AutomationRamp::prepare (int maxNumSegmentsToHold)
+{
+    segments.resize ((size_t) std::max (1, maxNumSegmentsToHold));
+    numSegments = std::min (numSegments, getMaxNumSegments());
+}
 
-            t2 = curve.getPointTime (++curveIndex);
-            v2 = curve.getPointValue (curveIndex);
-        }
+int AutomationRamp::getMaxNumSegments (int blockSize, int intervalSamples) noexcept
+{
+    const auto numIntervals = intervalSamples > 0 ? (blockSize + intervalSamples - 1) / intervalSamples : 1;
+    return 2 * std::max (1, numIntervals);
+}
 
-        float v = v2;
+void AutomationRamp::setConstant (float value, int numSamples) noexcept
+{
+    segments[0] = { 0, numSamples, value, value };
+    numSegments = 1;
+}
 
-        if (t2 != t1)
-        {
-            if (c == 0.0f)
-            {
-                v = v1 + (v2 - v1) * (float) ((t - t1) / (t2 - t1));
-            }
-            else if (c >= -0.5 && c <= 0.5)
-            {
-                v = AutomationCurve::getBezierYFromX (t, t1, v1, bp.time, bp.value, t2, v2);
-            }
-            else
-            {
-                if (t >= t1 && t <= x1end)
-                    v = v1;
-                else if (t >= x2end && t <= t2)
-                    v = v2;
-                else
-                    v = AutomationCurve::getBezierYFromX (t, x1end, y1end, bp.time, bp.value, x2end, y2end);
-            }
-        }
+void AutomationRamp::addSegment (int numSamples, float startValue, float endValue) noexcept
+{
+    jassert (numSamples > 0);
 
-        if (std::abs (v - lastValue) >= minValueDelta || curveIndex != lastCurveIndex)
-        {
-            jassert (t >= t1 && t <= t2);
+    if (numSegments == getMaxNumSegments())
+    {
+        // Out of space so stretch the last segment to the end, this
+        // means the ramp hasn't been prepared for the block size
+        jassertfalse;
+        auto& last = segments[(size_t) numSegments - 1];
+        last.numSamples += numSamples;
+        last.endValue = endValue;
+        return;
+    }
+
+    segments[(size_t) numSegments] = { getNumSamples(), numSamples, startValue, endValue };
+    ++numSegments;
+}
 
-            AutoPoint point;
-            point.time = t;
-            point.value = v;
+const AutomationRamp::Segment& AutomationRamp::getSegment (int index) const noexcept
+{
+    jassert (juce::isPositiveAndBelow (index, numSegments));
+    return segments[(size_t) index];
+}
 
-            jassert (points.isEmpty() || points.getLast().time <= t);
-            points.add (point);
+int AutomationRamp::getNumSamples() const noexcept
+{
+    return numSegments > 0 ? segments[(size_t) numSegments - 1].getEndSample() : 0;
+}
 
-            lastValue = v;
-            lastCurveIndex = curveIndex;
-        }
+bool AutomationRamp::isConstant() const noexcept
+{
+    for (auto& segment : *this)
+        if (segment.startValue != segments[0].startValue || segment.endValue != segments[0].startValue)
+            return false;
 
-        t += timeDelta;
-    }
+    return true;
 }
 
-void AutomationIterator::setPosition (double newTime) noexcept
+int AutomationRamp::getSegmentEnd (int sample) const noexcept
 {
-    jassert (points.size() > 0);
+    const auto index = findSegment (sample);
 
-    auto newIndex = currentIndex;
+    if (index < 0)
+        return std::max (sample + 1, getNumSamples());
 
-    if (! juce::isPositiveAndBelow (newIndex, points.size()))
-        newIndex = 0;
+    return segments[(size_t) index].getEndSample();
+}
 
-    if (newIndex > 0 && points.getReference (newIndex).time >= newTime)
-    {
-        --newIndex;
+float AutomationRamp::getValueAt (int sample) const noexcept
+{
+    if (numSegments == 0)
+        return 0.0f;
 
-        while (newIndex > 0 && points.getReference (newIndex).time >= newTime)
-            --newIndex;
-    }
-    else
-    {
-        while (newIndex < points.size() - 1 && points.getReference (newIndex + 1).time < newTime)
-            ++newIndex;
-    }
+    const auto index = findSegment (sample);
 
-    if (currentIndex != newIndex)
-    {
-        jassert (juce::isPositiveAndBelow (newIndex, points.size()));
-        currentIndex = newIndex;
-        currentValue = points.getReference (newIndex).value;
-    }
+    if (index < 0)
+        return segments[(size_t) numSegments - 1].endValue;
+
+    auto& segment = segments[(size_t) index];
+    const auto alpha = (sample - segment.startSample) / (float) segment.numSamples;
+
+    return segment.startValue + alpha * (segment.endValue - segment.startValue);
+}
+
+int AutomationRamp::findSegment (int sample) const noexcept
+{
+    auto found = std::upper_bound (begin(), end(), sample,
+                                   [] (int s, const Segment& segment) { return s < segment.getEndSample(); });
+
+    if (found == end())
+        return -1;
+
+    return (int) std::distance (begin(), found);
 }
 
 //==============================================================================
@@ -162,9 +162,26 @@ public:
     /**  Forces the parameter to update its automation stream for reading automation. */
     void updateStream();
 
+    /** Builds the copy of the automation curve that updateStream() will use.
+        Unlike updateStream() this can be called from any thread, as long as nothing else can
+        be using the parameter or changing its curve at the time, e.g. whilst its Edit is loading.
+    */
+    void prepareStream();
+
     /** Updates the parameter and modifier values from its current automation sources. */
     void updateFromAutomationSources (double);
 
+    /** Fills a ramp with the values this parameter takes over a block, starting at the given time.
+        The ramp is split every intervalSamples and at the first automation point within
+        each interval so it follows the curve closely. If the block is too long for the
+        ramp's segments the interval is widened to fit. This moves the automation sources so should only
+        be called from the audio thread, after updateFromAutomationSources has been called
+        for the start of the block. If the parameter isn't automated this is a single
+        segment at the current value.
+    */
+    void fillAutomationRamp (AutomationRamp&, double startTime, double sampleRate,
+                             int numSamples, int intervalSamples);
+
     //==============================================================================
     virtual bool isParameterActive() const                          { return true; }
     virtual bool isDiscrete() const                                 { return false; }
@@ -245,6 +262,8 @@ protected:
 
     AutomationSourceList& getAutomationSourceList() const;
 
+    std::pair<float, float> getBaseAndModifierValuesAt (double time);
+    float getValueFromBaseAndModifier (float baseValue, float modifierValue) const;
     void setParameterValue (float value, bool isFollowingCurve);
 
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
@@ -391,28 +410,115 @@ public:
 
 
 //==============================================================================
-// A pre-rendered set of interpolated points along a curve, with a cursor which moves through it.
+/** Reads the value of an AutomationCurveSnapshot, with a cursor which moves through it.
+    This doesn't touch the ValueTree so can be used on the audio thread.
+*/
 struct AutomationIterator
 {
     AutomationIterator (const AutomatableParameter&);
+    AutomationIterator (std::shared_ptr<const AutomationCurveSnapshot>);
 
-    bool isEmpty() const noexcept               { return points.size() <= 1; }
+    bool isEmpty() const noexcept               { return snapshot->getNumPoints() <= 1; }
 
     void setPosition (double newTime) noexcept;
     float getCurrentValue() noexcept            { return currentValue; }
 
+    /** Returns the time of the first point after the given time, or the maximum double if there isn't one. */
+    double getNextPointTimeAfter (double time) const noexcept;
+
 private:
-    struct AutoPoint
+    std::shared_ptr<const AutomationCurveSnapshot> snapshot;
+    int cursor = 0;
+    float currentValue = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AutomationIterator)
+};
+
+//==============================================================================
+/**
+    The values of a parameter over a block of samples, as a series of linear segments.
+
+    Plugins that support automation ramps fill these with Plugin::fillAutomationRamp
+    and read them to follow their automation across a whole block, rather than being
+    called with lots of smaller blocks. Space for the segments is reserved by prepare
+    so they can be filled on the audio thread without allocating.
+*/
+class AutomationRamp
+{
+public:
+    /** A linear change in value between two sample positions. */
+    struct Segment
     {
-        double time;
-        float value;
+        int startSample = 0, numSamples = 0;
+        float startValue = 0.0f, endValue = 0.0f;
+
+        int getEndSample() const noexcept           { return startSample + numSamples; }
     };
 
-    juce::Array<AutoPoint> points;
-    int currentIndex = -1;
-    float currentValue = 0.0f;
+    /** Creates a ramp with space for a constant value. Call prepare before filling it. */
+    AutomationRamp() = default;
 
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AutomationIterator)
+    /** Reserves space for a number of segments. This allocates so call it from
+        Plugin::initialise, e.g. with Plugin::prepareAutomationRamps.
+    */
+    void prepare (int maxNumSegmentsToHold);
+
+    /** Returns the most segments this ramp can hold. */
+    int getMaxNumSegments() const noexcept          { return (int) segments.size(); }
+
+    /** Returns the number of segments needed to follow a block of automation split every
+        intervalSamples. Each interval can be split once more at an automation point.
+    */
+    static int getMaxNumSegments (int blockSize, int intervalSamples) noexcept;
+
+    //==============================================================================
+    /** Removes all the segments. */
+    void clear() noexcept                           { numSegments = 0; }
+
+    /** Sets the ramp to a single segment with a fixed value. */
+    void setConstant (float value, int numSamples) noexcept;
+
+    /** Adds a segment after the last one.
+        This mustn't be called when the ramp is full.
+    */
+    void addSegment (int numSamples, float startValue, float endValue) noexcept;
+
+    //==============================================================================
+    int getNumSegments() const noexcept             { return numSegments; }
+    const Segment& getSegment (int index) const noexcept;
+
+    const Segment* begin() const noexcept           { return segments.data(); }
+    const Segment* end() const noexcept             { return segments.data() + numSegments; }
+
+    /** Returns the total number of samples the segments cover. */
+    int getNumSamples() const noexcept;
+
+    /** Returns true if the value doesn't change over the whole ramp. */
+    bool isConstant() const noexcept;
+
+    /** Returns the sample at which the segment containing the given sample ends.
+        This can be used to step through several ramps at once, e.g.
+        @code
+        for (int pos = 0; pos < numSamples;)
+        {
+            const auto end = std::min (ramp1.getSegmentEnd (pos), ramp2.getSegmentEnd (pos));
+            // process from pos to end
+            pos = end;
+        }
+        @endcode
+    */
+    int getSegmentEnd (int sample) const noexcept;
+
+    /** Returns the value at a given sample, interpolated within its segment.
+        Samples at or past the end return the last segment's end value.
+    */
+    float getValueAt (int sample) const noexcept;
+
+private:
+    std::vector<Segment> segments = std::vector<Segment> (1);
+    int numSegments = 0;
+
+    int findSegment (int sample) const noexcept;
 };
 
 } // namespace tracktion_engine
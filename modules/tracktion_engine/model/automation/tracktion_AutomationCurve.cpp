@@ -11,6 +11,65 @@
 namespace tracktion_engine
 {
 
+namespace AutomationCurveHelpers
+{
+    static CurvePoint getBezierPoint (double x1, float y1, double x2, float y2, float curve) noexcept
+    {
+        auto c = jlimit (-1.0f, 1.0f, curve * 2.0f);
+
+        if (y2 > y1)
+        {
+            auto run  = x2 - x1;
+            auto rise = y2 - y1;
+
+            auto xc = x1 + run / 2;
+            auto yc = y1 + rise / 2;
+
+            auto x = xc - run / 2 * -c;
+            auto y = yc + rise / 2 * -c;
+
+            return { x, y };
+        }
+
+        auto run  = x2 - x1;
+        auto rise = y1 - y2;
+
+        auto xc = x1 + run / 2;
+        auto yc = y2 + rise / 2;
+
+        auto x = xc - run / 2 * -c;
+        auto y = yc - rise / 2 * -c;
+
+        return { x, y };
+    }
+
+    static void getBezierEnds (double x1, float y1, double x2, float y2, float c,
+                               double& x1out, float& y1out, double& x2out, float& y2out) noexcept
+    {
+        auto minic = (std::abs (c) - 0.5f) * 2.0f;
+        auto run   = (minic) * (x2 - x1);
+        auto rise  = (minic) * ((y2 > y1) ? (y2 - y1) : (y1 - y2));
+
+        if (c > 0.0f)
+        {
+            x1out = x1 + run;
+            y1out = y1;
+
+            x2out = x2;
+            y2out = (y1 < y2) ? (y2 - rise) : (y2 + rise);
+        }
+        else
+        {
+            x1out = x1;
+            y1out = (y1 < y2) ? (y1 + rise) : (y1 - rise);
+
+            x2out = x2 - run;
+            y2out = y2;
+        }
+    }
+}
+
+//==============================================================================
 AutomationCurve::AutomationCurve()  : state (IDs::AUTOMATIONCURVE)
 {
 }
@@ -102,22 +161,37 @@ float AutomationCurve::getPointCurve (int index) const noexcept
 
 int AutomationCurve::indexBefore (double time) const
 {
-    for (int i = getNumPoints(); --i >= 0;)
-        if (getPointTime (i) <= time)
-            return i;
+    // Points are always kept in time order so this can be a binary search
+    int start = 0, end = getNumPoints();
+
+    while (start < end)
+    {
+        auto mid = (start + end) / 2;
 
-    return -1;
+        if (getPointTime (mid) <= time)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start - 1;
 }
 
 int AutomationCurve::nextIndexAfter (double t) const
 {
-    auto num = getNumPoints();
+    int start = 0, end = getNumPoints();
 
-    for (int i = 0; i < num; ++i)
-        if (getPointTime(i) >= t)
-            return i;
+    while (start < end)
+    {
+        auto mid = (start + end) / 2;
 
-    return num;
+        if (getPointTime (mid) < t)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
 }
 
 double AutomationCurve::getLength() const
@@ -667,36 +741,9 @@ void AutomationCurve::addToValues (float valueDelta, EditTimeRange range)
 
 CurvePoint AutomationCurve::getBezierPoint (int index) const noexcept
 {
-    auto x1 = getPointTime  (index);
-    auto y1 = getPointValue (index);
-    auto x2 = getPointTime  (index + 1);
-    auto y2 = getPointValue (index + 1);
-    auto c  = jlimit (-1.0f, 1.0f, getPointCurve (index) * 2.0f);
-
-    if (y2 > y1)
-    {
-        auto run  = x2 - x1;
-        auto rise = y2 - y1;
-
-        auto xc = x1 + run / 2;
-        auto yc = y1 + rise / 2;
-
-        auto x = xc - run / 2 * -c;
-        auto y = yc + rise / 2 * -c;
-
-        return { x, y };
-    }
-
-    auto run  = x2 - x1;
-    auto rise = y1 - y2;
-
-    auto xc = x1 + run / 2;
-    auto yc = y2 + rise / 2;
-
-    auto x = xc - run / 2 * -c;
-    auto y = yc - rise / 2 * -c;
-
-    return { x, y };
+    return AutomationCurveHelpers::getBezierPoint (getPointTime (index), getPointValue (index),
+                                                   getPointTime (index + 1), getPointValue (index + 1),
+                                                   getPointCurve (index));
 }
 
 double AutomationCurve::getBezierXfromT (double t, double x1, double xb, double x2)
@@ -786,33 +833,10 @@ CurvePoint AutomationCurve::getBezierHandle (int index) const noexcept
 
 void AutomationCurve::getBezierEnds (int index, double& x1out, float& y1out, double& x2out, float& y2out) const noexcept
 {
-    auto x1 = getPointTime (index);
-    auto y1 = getPointValue (index);
-    auto c  = getPointCurve (index);
-
-    auto x2 = getPointTime (index + 1);
-    auto y2 = getPointValue (index + 1);
-
-    auto minic = (std::abs (c) - 0.5f) * 2.0f;
-    auto run   = (minic) * (x2 - x1);
-    auto rise  = (minic) * ((y2 > y1) ? (y2 - y1) : (y1 - y2));
-
-    if (c > 0.0f)
-    {
-        x1out = x1 + run;
-        y1out = y1;
-
-        x2out = x2;
-        y2out = (y1 < y2) ? (y2 - rise) : (y2 + rise);
-    }
-    else
-    {
-        x1out = x1;
-        y1out = (y1 < y2) ? (y1 + rise) : (y1 - rise);
-
-        x2out = x2 - run;
-        y2out = y2;
-    }
+    AutomationCurveHelpers::getBezierEnds (getPointTime (index), getPointValue (index),
+                                           getPointTime (index + 1), getPointValue (index + 1),
+                                           getPointCurve (index),
+                                           x1out, y1out, x2out, y2out);
 }
 
 void AutomationCurve::removeAllAutomationCurvesRecursively (const ValueTree& v)
@@ -834,6 +858,139 @@ Range<float> AutomationCurve::getValueLimits() const
     return { 0.0f, 1.0f };
 }
 
+std::shared_ptr<const AutomationCurveSnapshot> AutomationCurve::createSnapshot() const
+{
+    return std::make_shared<const AutomationCurveSnapshot> (*this);
+}
+
+//==============================================================================
+AutomationCurveSnapshot::AutomationCurveSnapshot (const AutomationCurve& curve)
+{
+    const auto numPoints = (size_t) curve.getNumPoints();
+
+    times.reserve (numPoints);
+    values.reserve (numPoints);
+    curves.reserve (numPoints);
+
+    for (const auto& p : curve.state)
+    {
+        times.push_back (p.getProperty (IDs::t));
+        values.push_back (p.getProperty (IDs::v));
+        curves.push_back (p.getProperty (IDs::c));
+    }
+
+    if (numPoints > 1)
+    {
+        segments.resize (numPoints - 1);
+
+        for (size_t i = 0; i < segments.size(); ++i)
+        {
+            const auto c = curves[i];
+
+            if (c == 0.0f)
+                continue;
+
+            auto& seg = segments[i];
+            const auto x1 = times[i], x2 = times[i + 1];
+            const auto y1 = values[i], y2 = values[i + 1];
+
+            auto bp = AutomationCurveHelpers::getBezierPoint (x1, y1, x2, y2, c);
+            seg.bezierTime = bp.time;
+            seg.bezierValue = bp.value;
+
+            if (c < -0.5f || c > 0.5f)
+                AutomationCurveHelpers::getBezierEnds (x1, y1, x2, y2, c,
+                                                       seg.x1end, seg.y1end, seg.x2end, seg.y2end);
+        }
+    }
+}
+
+int AutomationCurveSnapshot::indexBefore (double time) const noexcept
+{
+    auto iter = std::upper_bound (times.begin(), times.end(), time);
+    return (int) std::distance (times.begin(), iter) - 1;
+}
+
+int AutomationCurveSnapshot::nextIndexAfter (double time) const noexcept
+{
+    auto iter = std::lower_bound (times.begin(), times.end(), time);
+    return (int) std::distance (times.begin(), iter);
+}
+
+int AutomationCurveSnapshot::findNextIndexAfter (double time, int& cursor) const noexcept
+{
+    const auto numPoints = getNumPoints();
+
+    // Most reads are contiguous so first check the segment we were last in and the one after it
+    for (int index = juce::jlimit (0, numPoints, cursor); index <= juce::jmin (cursor + 1, numPoints); ++index)
+    {
+        const bool isAfterPrevious = index == 0 || times[(size_t) index - 1] < time;
+        const bool isAtOrBeforeNext = index == numPoints || times[(size_t) index] >= time;
+
+        if (isAfterPrevious && isAtOrBeforeNext)
+        {
+            cursor = index;
+            return index;
+        }
+    }
+
+    cursor = nextIndexAfter (time);
+    return cursor;
+}
+
+float AutomationCurveSnapshot::getValueAt (double time) const noexcept
+{
+    if (times.empty())
+        return 0.0f;
+
+    return getValueForSegment (nextIndexAfter (time), time);
+}
+
+float AutomationCurveSnapshot::getValueAt (double time, int& cursor) const noexcept
+{
+    if (times.empty())
+        return 0.0f;
+
+    return getValueForSegment (findNextIndexAfter (time, cursor), time);
+}
+
+float AutomationCurveSnapshot::getValueForSegment (int index, double time) const noexcept
+{
+    if (index <= 0)
+        return values.front();
+
+    if (index >= getNumPoints())
+        return values.back();
+
+    const auto i1 = (size_t) index - 1;
+    const auto i2 = (size_t) index;
+
+    const auto time1 = times[i1];
+    const auto value1 = values[i1];
+    const auto curve1 = curves[i1];
+    const auto time2 = times[i2];
+    const auto value2 = values[i2];
+
+    if (curve1 == 0.0f)
+    {
+        auto alpha = (float) ((time - time1) / (time2 - time1));
+        return value1 + alpha * (value2 - value1);
+    }
+
+    const auto& seg = segments[i1];
+
+    if (curve1 >= -0.5f && curve1 <= 0.5f)
+        return AutomationCurve::getBezierYFromX (time, time1, value1, seg.bezierTime, seg.bezierValue, time2, value2);
+
+    if (time >= time1 && time <= seg.x1end)
+        return value1;
+
+    if (time >= seg.x2end && time <= time2)
+        return value2;
+
+    return AutomationCurve::getBezierYFromX (time, seg.x1end, seg.y1end, seg.bezierTime, seg.bezierValue, seg.x2end, seg.y2end);
+}
+
 //==============================================================================
 int simplify (AutomationCurve& curve, int strength, EditTimeRange time)
 {
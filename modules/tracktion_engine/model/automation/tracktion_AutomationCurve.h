@@ -11,6 +11,9 @@
 namespace tracktion_engine
 {
 
+class AutomationCurveSnapshot;
+
+//==============================================================================
 class AutomationCurve
 {
 public:
@@ -70,6 +73,12 @@ public:
 
     int countPointsInRegion (EditTimeRange) const;
 
+    /** Creates an immutable, flattened copy of the curve's current points that can be
+        evaluated without touching the ValueTree e.g. from the audio thread.
+        This must be called from the message thread.
+    */
+    std::shared_ptr<const AutomationCurveSnapshot> createSnapshot() const;
+
     //==============================================================================
     void clear();
 
@@ -120,6 +129,67 @@ private:
     JUCE_LEAK_DETECTOR (AutomationCurve)
 };
 
+//==============================================================================
+/**
+    An immutable, contiguous copy of an AutomationCurve's points.
+
+    The times, values and curves are stored in separate arrays with the bezier
+    control points for each segment precomputed so evaluating the curve is a
+    binary search (or a cursor check for contiguous reads) and a bit of maths.
+    Create one with AutomationCurve::createSnapshot() on the message thread and
+    then read it from any thread.
+*/
+class AutomationCurveSnapshot
+{
+public:
+    /** Creates an empty snapshot. */
+    AutomationCurveSnapshot() = default;
+
+    /** Creates a snapshot of the given curve.
+        Must be called on the message thread, or whilst nothing can be changing the curve.
+    */
+    AutomationCurveSnapshot (const AutomationCurve&);
+
+    //==============================================================================
+    int getNumPoints() const noexcept                   { return (int) times.size(); }
+    bool isEmpty() const noexcept                       { return times.empty(); }
+
+    double getPointTime (int index) const noexcept      { return times[(size_t) index]; }
+    float getPointValue (int index) const noexcept      { return values[(size_t) index]; }
+    float getPointCurve (int index) const noexcept      { return curves[(size_t) index]; }
+
+    /** Returns the index of the last point at or before the given time, or -1. */
+    int indexBefore (double time) const noexcept;
+
+    /** Returns the index of the first point at or after the given time, or getNumPoints(). */
+    int nextIndexAfter (double time) const noexcept;
+
+    /** Returns the value of the curve at a given time, as AutomationCurve::getValueAt().
+        If the snapshot is empty this returns 0.
+    */
+    float getValueAt (double time) const noexcept;
+
+    /** Returns the value of the curve at a given time using a cursor to speed up the search.
+        The cursor should start at 0 and be kept by the caller between calls. When calls
+        are made with increasing times (i.e. during playback), this avoids the binary search.
+    */
+    float getValueAt (double time, int& cursor) const noexcept;
+
+private:
+    struct Segment
+    {
+        double bezierTime = 0, x1end = 0, x2end = 0;
+        float bezierValue = 0, y1end = 0, y2end = 0;
+    };
+
+    std::vector<double> times;
+    std::vector<float> values, curves;
+    std::vector<Segment> segments;
+
+    int findNextIndexAfter (double time, int& cursor) const noexcept;
+    float getValueForSegment (int nextIndex, double time) const noexcept;
+};
+
 //==============================================================================
 /** Removes points from the curve to simplfy it and returns the number of points removed. */
 int simplify (AutomationCurve&, int strength, EditTimeRange range);
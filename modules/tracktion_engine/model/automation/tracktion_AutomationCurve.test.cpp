@@ -0,0 +1,163 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if TRACKTION_UNIT_TESTS
+
+//==============================================================================
+//==============================================================================
+class AutomationCurveSnapshotTests  : public juce::UnitTest
+{
+public:
+    AutomationCurveSnapshotTests()
+        : juce::UnitTest ("AutomationCurveSnapshot", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        juce::ValueTree parent ("TEST");
+        AutomationCurve curve (parent, {});
+
+        // Every kind of segment, rising and falling, starting after 0 so there's time before the first point
+        const float segmentCurves[] = { 0.0f, 0.3f, -0.3f, 0.5f, -0.5f, 0.8f, -0.8f, 1.0f, -1.0f };
+        double time = 1.0;
+
+        for (int i = 0; i < 2; ++i)
+        {
+            for (auto c : segmentCurves)
+            {
+                curve.addPoint (time, 0.1f, c);
+                curve.addPoint (time + 0.5, 0.9f, c);
+                time += 1.0;
+            }
+        }
+
+        // Coincident points make steps in the curve
+        curve.addPoint (time, 0.2f, 0.0f);
+        curve.addPoint (time, 0.7f, 0.4f);
+        curve.addPoint (time, 0.4f, 0.0f);
+        curve.addPoint (time + 1.0, 0.6f, -0.7f);
+        curve.addPoint (time + 1.0, 0.0f, 0.0f);
+        curve.addPoint (time + 2.0, 1.0f, 0.0f);
+
+        const auto snapshot = curve.createSnapshot();
+        const auto times = getTimesToTest (curve);
+
+        beginTest ("Snapshot matches the curve's points");
+        {
+            expectEquals (snapshot->getNumPoints(), curve.getNumPoints());
+
+            for (int i = 0; i < curve.getNumPoints(); ++i)
+            {
+                expectEquals (snapshot->getPointTime (i), curve.getPointTime (i));
+                expectEquals (snapshot->getPointValue (i), curve.getPointValue (i));
+                expectEquals (snapshot->getPointCurve (i), curve.getPointCurve (i));
+            }
+
+            for (auto t : times)
+            {
+                expectEquals (snapshot->indexBefore (t), curve.indexBefore (t));
+                expectEquals (snapshot->nextIndexAfter (t), curve.nextIndexAfter (t));
+            }
+        }
+
+        beginTest ("Snapshot values match the curve");
+        {
+            for (auto t : times)
+                expectValue (snapshot->getValueAt (t), curve.getValueAt (t), t);
+        }
+
+        beginTest ("Cursor reads match the curve");
+        {
+            int cursor = 0;
+
+            for (auto t : times)
+                expectValue (snapshot->getValueAt (t, cursor), curve.getValueAt (t), t);
+
+            for (auto iter = times.rbegin(); iter != times.rend(); ++iter)
+                expectValue (snapshot->getValueAt (*iter, cursor), curve.getValueAt (*iter), *iter);
+
+            auto& r = getRandom();
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                const auto t = times[(size_t) r.nextInt ((int) times.size())];
+                expectValue (snapshot->getValueAt (t, cursor), curve.getValueAt (t), t);
+            }
+        }
+
+        beginTest ("AutomationIterator matches the curve");
+        {
+            AutomationIterator iter (snapshot);
+            expect (! iter.isEmpty());
+
+            for (auto t : times)
+            {
+                iter.setPosition (t);
+                expectValue (iter.getCurrentValue(), curve.getValueAt (t), t);
+
+                const auto nextIndex = curve.indexBefore (t) + 1;
+                expectEquals (iter.getNextPointTimeAfter (t), nextIndex < curve.getNumPoints() ? curve.getPointTime (nextIndex)
+                                                                                                : std::numeric_limits<double>::max());
+            }
+        }
+
+        beginTest ("Empty and single point snapshots");
+        {
+            juce::ValueTree emptyParent ("TEST");
+            AutomationCurve emptyCurve (emptyParent, {});
+            int cursor = 0;
+
+            auto emptySnapshot = emptyCurve.createSnapshot();
+            expect (emptySnapshot->isEmpty());
+            expectEquals (emptySnapshot->getValueAt (1.0), 0.0f);
+            expectEquals (emptySnapshot->getValueAt (1.0, cursor), 0.0f);
+
+            emptyCurve.addPoint (2.0, 0.5f, 0.0f);
+            auto singlePointSnapshot = emptyCurve.createSnapshot();
+            expect (AutomationIterator (singlePointSnapshot).isEmpty());
+
+            for (auto t : { 0.0, 2.0, 4.0 })
+                expectValue (singlePointSnapshot->getValueAt (t, cursor), emptyCurve.getValueAt (t), t);
+        }
+    }
+
+private:
+    //==============================================================================
+    /** Returns the times of all the points, plus times before, after and in between them. */
+    static std::vector<double> getTimesToTest (const AutomationCurve& curve)
+    {
+        std::vector<double> times;
+        const auto endTime = curve.getLength() + 1.0;
+
+        for (double t = -0.5; t < endTime; t += 0.01)
+            times.push_back (t);
+
+        for (int i = 0; i < curve.getNumPoints(); ++i)
+            times.push_back (curve.getPointTime (i));
+
+        std::sort (times.begin(), times.end());
+        return times;
+    }
+
+    void expectValue (float snapshotValue, float curveValue, double time)
+    {
+        expectWithinAbsoluteError (snapshotValue, curveValue, 1.0e-6f, "at time " + juce::String (time));
+    }
+};
+
+static AutomationCurveSnapshotTests automationCurveSnapshotTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -11,6 +11,76 @@
 namespace tracktion_engine
 {
 
+//==============================================================================
+ModifierTimerList::ModifierTimerList()
+    : currentTimers (new TimerArray())
+{
+}
+
+ModifierTimerList::~ModifierTimerList()
+{
+    delete currentTimers.exchange (nullptr);
+}
+
+void ModifierTimerList::add (ModifierTimer& mt)
+{
+    const juce::ScopedLock sl (writeLock);
+    auto newTimers = std::make_unique<TimerArray> (*currentTimers.load());
+    jassert (std::find (newTimers->begin(), newTimers->end(), &mt) == newTimers->end());
+    newTimers->push_back (&mt);
+    swapTimers (std::move (newTimers));
+}
+
+void ModifierTimerList::remove (ModifierTimer& mt)
+{
+    const juce::ScopedLock sl (writeLock);
+    auto newTimers = std::make_unique<TimerArray> (*currentTimers.load());
+    newTimers->erase (std::remove (newTimers->begin(), newTimers->end(), &mt), newTimers->end());
+    swapTimers (std::move (newTimers));
+}
+
+void ModifierTimerList::update (double editTime, int numSamples) const
+{
+    const ScopedRead read (*this);
+
+    for (auto mt : read.getTimers())
+        mt->updateStreamTime (editTime, numSamples);
+}
+
+void ModifierTimerList::swapTimers (std::unique_ptr<TimerArray> newTimers)
+{
+    std::unique_ptr<TimerArray> oldTimers (currentTimers.exchange (newTimers.release()));
+
+    // New readers will now see the new list so wait for any still using the old one
+    const auto oldEpochIndex = (size_t) (epoch.fetch_add (1) & 1);
+
+    while (numReaders[oldEpochIndex].load() > 0)
+        std::this_thread::yield();
+}
+
+ModifierTimerList::ScopedRead::ScopedRead (const ModifierTimerList& l) noexcept
+    : list (l)
+{
+    // If the epoch changes whilst registering, try again with the new one
+    for (;;)
+    {
+        epochIndex = (size_t) (list.epoch.load() & 1);
+        list.numReaders[epochIndex].fetch_add (1);
+
+        if ((size_t) (list.epoch.load() & 1) == epochIndex)
+            break;
+
+        list.numReaders[epochIndex].fetch_sub (1);
+    }
+
+    timers = list.currentTimers.load();
+}
+
+ModifierTimerList::ScopedRead::~ScopedRead() noexcept
+{
+    list.numReaders[epochIndex].fetch_sub (1);
+}
+
 //==============================================================================
 class Modifier::ValueFifo
 {
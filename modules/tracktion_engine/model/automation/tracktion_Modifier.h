@@ -20,6 +20,81 @@ struct ModifierTimer
     virtual void updateStreamTime (double editTime, int numSamples) = 0;
 };
 
+//==============================================================================
+/**
+    Holds the ModifierTimers an Edit updates each block.
+
+    Timers are added and removed by swapping in a new list so updating them never
+    takes a lock and groups of them can be updated concurrently. Removing a timer
+    waits until any updates that could still be using it have finished.
+*/
+class ModifierTimerList
+{
+public:
+    ModifierTimerList();
+    ~ModifierTimerList();
+
+    /** Adds a timer. */
+    void add (ModifierTimer&);
+
+    /** Removes a timer, waiting for any updates in progress to finish. */
+    void remove (ModifierTimer&);
+
+    /** Updates all the timers on the calling thread. */
+    void update (double editTime, int numSamples) const;
+
+    /** The number of timers each task updates. */
+    static constexpr size_t numTimersPerTask = 16;
+
+    /** Updates the timers in groups of numTimersPerTask.
+        runTasks will be called with the number of groups and a function to update a
+        group by index. It can call this concurrently but must return once all the
+        groups have been updated e.g. LockFreeMultiThreadedNodePlayer::runTasks.
+    */
+    template<typename RunTasksFunction>
+    void update (double editTime, int numSamples, RunTasksFunction&& runTasks) const
+    {
+        const ScopedRead read (*this);
+        const auto& timers = read.getTimers();
+        const auto numTasks = (timers.size() + numTimersPerTask - 1) / numTimersPerTask;
+
+        runTasks (numTasks, [&timers, editTime, numSamples] (size_t taskIndex)
+                  {
+                      const auto end = std::min (timers.size(), (taskIndex + 1) * numTimersPerTask);
+
+                      for (auto i = taskIndex * numTimersPerTask; i < end; ++i)
+                          timers[i]->updateStreamTime (editTime, numSamples);
+                  });
+    }
+
+private:
+    using TimerArray = std::vector<ModifierTimer*>;
+
+    // Readers register with the counter for the current epoch so a writer can swap the
+    // list, move to the next epoch and wait for the readers of the previous one to leave
+    struct ScopedRead
+    {
+        ScopedRead (const ModifierTimerList&) noexcept;
+        ~ScopedRead() noexcept;
+
+        const TimerArray& getTimers() const noexcept    { return *timers; }
+
+    private:
+        const ModifierTimerList& list;
+        size_t epochIndex = 0;
+        const TimerArray* timers = nullptr;
+    };
+
+    std::atomic<TimerArray*> currentTimers;
+    mutable std::atomic<uint32_t> epoch { 0 };
+    mutable std::atomic<int> numReaders[2] {};
+    juce::CriticalSection writeLock;
+
+    void swapTimers (std::unique_ptr<TimerArray>);
+
+    JUCE_DECLARE_NON_COPYABLE (ModifierTimerList)
+};
+
 //==============================================================================
 /**
     Bass class for parameter Modifiers.
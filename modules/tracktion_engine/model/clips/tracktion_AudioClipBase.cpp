@@ -1834,6 +1834,27 @@ bool AudioClipBase::usesTimeStretchedProxy() const
                && TimeStretcher::canProcessFor (timeStretchMode));
 }
 
+static TimeStretcher::Mode getTimeStretchModeForProxy (TimeStretcher::Mode clipMode)
+{
+    return (clipMode != TimeStretcher::disabled && clipMode != TimeStretcher::melodyne)
+             ? clipMode : TimeStretcher::defaultMode;
+}
+
+bool AudioClipBase::usesRealtimeTimeStretching() const
+{
+    if (! usesTimeStretchedProxy() || isUsingMelodyne()
+        || ! TimeStretcher::canProcessFor (getTimeStretchModeForProxy (timeStretchMode)))
+        return false;
+
+    // Speed ramp fades are only supported when playing the proxy
+    if ((getFadeInBehaviour() == speedRamp && getFadeIn() > 0.0)
+        || (getFadeOutBehaviour() == speedRamp && getFadeOut() > 0.0))
+        return false;
+
+    return useTimestretchedPreview
+            || edit.engine.getEngineBehaviour().shouldUseRealtimeTimeStretching();
+}
+
 AudioClipBase::ProxyRenderingInfo::ProxyRenderingInfo() {}
 AudioClipBase::ProxyRenderingInfo::~ProxyRenderingInfo() {}
 
@@ -2049,9 +2070,7 @@ std::unique_ptr<AudioClipBase::ProxyRenderingInfo> AudioClipBase::createProxyRen
     p->audioSegmentList = AudioSegmentList::create (*this, true, true);
     p->clipTime = getEditTimeRange();
     p->speedRatio = getSpeedRatio();
-    p->mode = (timeStretchMode != TimeStretcher::disabled && timeStretchMode != TimeStretcher::melodyne)
-                 ? timeStretchMode
-                 : TimeStretcher::defaultMode;
+    p->mode = getTimeStretchModeForProxy (timeStretchMode);
     p->options = elastiqueProOptions;
 
     return p;
@@ -2165,6 +2184,8 @@ void AudioClipBase::beginRenderingNewProxyIfNeeded()
 {
     if (! canUseProxy())
         return;
+
+    proxyRequestedForRender = true;
     
     if (isTimerRunning())
     {
@@ -2239,6 +2260,11 @@ void AudioClipBase::timerCallback()
         return;
 
     const bool isTimeStretched = usesTimeStretchedProxy();
+    const bool proxyRequested = std::exchange (proxyRequestedForRender, false);
+
+    // Clips stretched in real time only need a proxy when an offline render asks for one
+    if (isTimeStretched && ! proxyRequested && usesRealtimeTimeStretching())
+        return;
 
     const AudioFile originalFile (getAudioFile());
     const AudioFile newProxy (getPlaybackFile());
@@ -487,6 +487,14 @@ public:
     /** Returns true if this clp should use a time-stretched preview. */
     bool usesTimestretchedPreview() const noexcept                      { return useTimestretchedPreview; }
 
+    /** Returns true if this clip should be time-stretched in real time during playback
+        rather than playing a proxy file.
+        In this case a proxy is only rendered when one is needed for an offline render.
+        Clips with speed ramp fades always play a proxy.
+        @see EngineBehaviour::shouldUseRealtimeTimeStretching
+    */
+    bool usesRealtimeTimeStretching() const;
+
     //==============================================================================
     /** Reverses the loop points to expose the same section of the source file but reversed. */
     void reverseLoopPoints();
@@ -626,7 +634,7 @@ protected:
     bool proxyAllowed = true, useTimestretchedPreview = false;
     PluginList pluginList;
 
-    bool lastRenderJobFailed = false;
+    bool lastRenderJobFailed = false, proxyRequestedForRender = false;
 
     RenderManager::Job::Ptr renderJob;
     AudioFile lastProxy;
@@ -167,11 +167,24 @@ bool EditRenderJob::completeRender()
 
 //==============================================================================
 EditRenderJob::RenderPass::RenderPass (EditRenderJob& j, Renderer::Parameters& renderParams, const String& description)
-    : owner (j), r (renderParams), desc (description), originalCategory (r.category),
-      tempFile (r.destFile, TemporaryFile::useHiddenFile)
+    : owner (j), r (renderParams), desc (description), originalCategory (r.category)
 {
     r.category = ProjectItem::Category::none;
-    r.destFile = tempFile.getFile();
+
+    // Render to temporary files which replace the targets once finished
+    if (r.stems.empty())
+    {
+        tempFiles.add (new TemporaryFile (r.destFile, TemporaryFile::useHiddenFile));
+        r.destFile = tempFiles.getFirst()->getFile();
+    }
+    else
+    {
+        for (auto& stem : r.stems)
+        {
+            tempFiles.add (new TemporaryFile (stem.destFile, TemporaryFile::useHiddenFile));
+            stem.destFile = tempFiles.getLast()->getFile();
+        }
+    }
 }
 
 EditRenderJob::RenderPass::~RenderPass()
@@ -184,6 +197,12 @@ EditRenderJob::RenderPass::~RenderPass()
     if (owner.editDeleter.willDeleteObject())
         callBlocking ([this] { Renderer::turnOffAllPlugins (*r.edit); });
 
+    for (auto tempFile : tempFiles)
+        finaliseFile (*tempFile, completedOk, errorMessage);
+}
+
+void EditRenderJob::RenderPass::finaliseFile (TemporaryFile& tempFile, bool completedOk, const String& errorMessage)
+{
     // overwite with temp file
     if (! errorMessage.isEmpty() && owner.silenceOnBackup)
         owner.generateSilence (tempFile.getFile());
@@ -193,25 +212,23 @@ EditRenderJob::RenderPass::~RenderPass()
     else
         tempFile.getTargetFile().deleteFile();
 
-    // swap this back to the original
-    r.destFile = tempFile.getTargetFile();
-    r.category = originalCategory;
+    const auto destFile = tempFile.getTargetFile();
 
     // reverse if needed
     if (owner.reverse)
     {
-        TemporaryFile tempReverseFile (r.destFile);
+        TemporaryFile tempReverseFile (destFile);
 
-        if (r.destFile.existsAsFile())
-            if (AudioFileUtils::reverse (owner.engine, r.destFile, tempReverseFile.getFile(), owner.progress, nullptr))
+        if (destFile.existsAsFile())
+            if (AudioFileUtils::reverse (owner.engine, destFile, tempReverseFile.getFile(), owner.progress, nullptr))
                 if (tempReverseFile.getFile().existsAsFile())
                     tempReverseFile.overwriteTargetFileWithTemporary();
     }
 
-    if (! r.destFile.existsAsFile())
+    if (! destFile.existsAsFile())
         return;
 
-    if (r.category != ProjectItem::Category::none && r.destFile.existsAsFile())
+    if (originalCategory != ProjectItem::Category::none && destFile.existsAsFile())
     {
         CRASH_TRACER
 
@@ -234,7 +251,7 @@ EditRenderJob::RenderPass::~RenderPass()
             if (! r.createMidiFile && errorMessage.isNotEmpty())
             {
                 ok = false;
-                r.destFile.deleteFile();
+                destFile.deleteFile();
             }
 
             if (ok)
@@ -243,12 +260,12 @@ EditRenderJob::RenderPass::~RenderPass()
                 newItemDesc << TRANS("Rendered from edit") << r.edit->getName().quoted() << " " << TRANS("On") << " "
                             << Time::getCurrentTime().toString (true, true);
 
-                if (auto item = proj->createNewItem (r.destFile,
+                if (auto item = proj->createNewItem (destFile,
                                                      r.createMidiFile ? ProjectItem::midiItemType()
                                                                       : ProjectItem::waveItemType(),
-                                                     r.destFile.getFileNameWithoutExtension().trim(),
+                                                     destFile.getFileNameWithoutExtension().trim(),
                                                      newItemDesc,
-                                                     r.category,
+                                                     originalCategory,
                                                      true))
                 {
                     jassert (item->getID().isValid());
@@ -263,7 +280,7 @@ EditRenderJob::RenderPass::~RenderPass()
     }
 
     // validates the AudioFile by giving it a sample rate etc.
-    owner.engine.getAudioFileManager().checkFileForChangesAsync (AudioFile (owner.engine, r.destFile));
+    owner.engine.getAudioFileManager().checkFileForChangesAsync (AudioFile (owner.engine, destFile));
 }
 
 bool EditRenderJob::RenderPass::initialise()
@@ -278,30 +295,21 @@ bool EditRenderJob::RenderPass::initialise()
                       r.edit->getTransport().stop (false, true);
                   });
 
-    if (r.tracksToDo.countNumberOfSetBits() > 0
-        && r.destFile.hasWriteAccess()
-        && ! r.destFile.isDirectory())
-    {
-        auto tracksToDo = toTrackArray (*r.edit, r.tracksToDo);
+    auto canWriteTo = [] (const File& f) { return f.hasWriteAccess() && ! f.isDirectory(); };
+    bool canWriteToAllFiles = true;
+
+    for (auto tempFile : tempFiles)
+        canWriteToAllFiles = canWriteToAllFiles && canWriteTo (tempFile->getFile());
 
+    if (r.tracksToDo.countNumberOfSetBits() > 0 && canWriteToAllFiles)
+    {
         // Initialise playhead and continuity
         auto playHead = std::make_unique<tracktion_graph::PlayHead>();
         auto playHeadState = std::make_unique<tracktion_graph::PlayHeadState> (*playHead);
         auto processState = std::make_unique<ProcessState> (*playHeadState);
 
-        CreateNodeParams cnp { *processState };
-        cnp.sampleRate = r.sampleRateForAudio;
-        cnp.blockSize = r.blockSizeForAudio;
-        cnp.allowedClips = r.allowedClips.isEmpty() ? nullptr : &r.allowedClips;
-        cnp.allowedTracks = r.tracksToDo.isZero() ? nullptr : &tracksToDo;
-        cnp.forRendering = true;
-        cnp.includePlugins = r.usePlugins;
-        cnp.includeMasterPlugins = r.useMasterPlugins;
-        cnp.addAntiDenormalisationNoise = r.addAntiDenormalisationNoise;
-        cnp.includeBypassedPlugins = false;
-
         std::unique_ptr<tracktion_graph::Node> node;
-        callBlocking ([this, &node, &cnp] { node = createNodeForEdit (*r.edit, cnp); });
+        callBlocking ([this, &node, &processState] { node = Renderer::createNodeForRender (r, *processState); });
 
         if (node)
         {
@@ -328,6 +336,10 @@ void EditRenderJob::renderSeparateTracks()
     auto originalTracksToDo = params.tracksToDo;
     Array<File> createdFiles;
 
+    // Master plugins can only be processed once per block so these need a pass per track
+    const bool renderStemsInSinglePass = ! (params.useMasterPlugins || params.createMidiFile);
+    std::vector<Renderer::Parameters::Stem> stems;
+
     for (int i = 0; i <= originalTracksToDo.getHighestBit(); ++i)
     {
         if (originalTracksToDo[i])
@@ -376,7 +388,12 @@ void EditRenderJob::renderSeparateTracks()
                 params.tracksToDo = tracksToDo;
 
                 if (Renderer::checkTargetFile (track->edit.engine, params.destFile))
-                    renderPasses.add (new RenderPass (*this, params, getDescription()));
+                {
+                    if (renderStemsInSinglePass)
+                        stems.push_back ({ tracksToDo, params.destFile });
+                    else
+                        renderPasses.add (new RenderPass (*this, params, getDescription()));
+                }
 
                 // Temporarily create the output file so that it affects the next call to
                 // getNonExistentSiblingWithIncrementedNumberSuffix
@@ -390,6 +407,15 @@ void EditRenderJob::renderSeparateTracks()
         f.deleteFile();
 
     params.tracksToDo = originalTracksToDo;
+
+    if (! stems.empty())
+    {
+        auto stemParams = params;
+        stemParams.stems = std::move (stems);
+
+        renderPasses.add (new RenderPass (*this, stemParams,
+                                          TRANS("Rendering Tracks") + " (" + String ((int) stemParams.stems.size()) + ")..."));
+    }
 }
 
 bool EditRenderJob::generateSilence (const File& fileToWriteTo)
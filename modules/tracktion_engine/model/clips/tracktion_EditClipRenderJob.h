@@ -73,12 +73,13 @@ private:
         ~RenderPass();
 
         bool initialise();
+        void finaliseFile (juce::TemporaryFile&, bool completedOk, const juce::String& errorMessage);
 
         EditRenderJob& owner;
         Renderer::Parameters r;
         const juce::String desc;
         ProjectItem::Category originalCategory;
-        juce::TemporaryFile tempFile;
+        juce::OwnedArray<juce::TemporaryFile> tempFiles; // One for each file being rendered
         std::unique_ptr<Renderer::RenderTask> task;
     };
 
@@ -0,0 +1,217 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    Runs the parts of loading an Edit that don't depend on each other on a number
+    of threads. Everything that touches the Edit's model still happens on the thread
+    loading the Edit, only reading files, creating plugin instances and building
+    caches is done by the worker threads.
+
+    (This is an internal class, not intended for public use)
+    @see Edit::Options::loadConcurrently
+*/
+class ConcurrentEditLoader
+{
+public:
+    ConcurrentEditLoader (Edit& e, Edit::LoadContext* context)
+        : edit (e), loadContext (context)
+    {
+    }
+
+    //==============================================================================
+    /** Reads the info for all the audio files used by the Edit's clips, before the clips are created. */
+    void cacheAudioFileInfo (float startProgress, float endProgress)
+    {
+        CRASH_TRACER
+        juce::Array<AudioFile> files;
+
+        // The files are resolved on this thread as the resolver and ProjectManager may not be thread safe
+        findAudioClipStates (edit.state, [&] (const juce::ValueTree& clipState)
+        {
+            auto file = SourceFileReference::findFileFromString (edit, clipState[IDs::source].toString());
+
+            if (file != juce::File())
+                files.addIfNotAlreadyThere (AudioFile (edit.engine, file));
+        });
+
+        auto& audioFileManager = edit.engine.getAudioFileManager();
+
+        runInParallel (files.size(), startProgress, endProgress,
+                       [&] (int index) { audioFileManager.cacheInfo (files.getReference (index)); });
+    }
+
+    //==============================================================================
+    /** Creates the instances of all the plugins that deferred their initialisation and
+        then fully initialises them.
+        Instances that can be created on other threads are loaded by the worker threads,
+        whilst this thread dispatches the ones that need the message thread one at a time.
+    */
+    void initialisePlugins (float startProgress, float endProgress)
+    {
+        CRASH_TRACER
+
+        struct PluginToLoad
+        {
+            ExternalPlugin::Ptr plugin;
+            std::unique_ptr<ExternalPlugin::InstanceLoader> loader;
+        };
+
+        std::vector<PluginToLoad> pluginsToLoad;
+        std::vector<ExternalPlugin::InstanceLoader*> backgroundLoaders, messageThreadLoaders;
+
+        // This includes all the plugins created whilst loading, wherever they are in the Edit
+        for (auto p : edit.getPluginCache().getPlugins())
+        {
+            if (auto ep = dynamic_cast<ExternalPlugin*> (p))
+            {
+                auto loader = ep->createInstanceLoader();
+
+                if (loader != nullptr)
+                    (loader->mustLoadOnMessageThread() ? messageThreadLoaders : backgroundLoaders).push_back (loader.get());
+
+                pluginsToLoad.push_back ({ ep, std::move (loader) });
+            }
+        }
+
+        const auto numToLoad = (int) (backgroundLoaders.size() + messageThreadLoaders.size());
+        std::atomic<int> numLoaded { 0 };
+
+        if (loadContext != nullptr)
+        {
+            loadContext->numPluginsLoaded = 0;
+            loadContext->numPluginsToLoad = numToLoad;
+        }
+
+        auto pluginLoaded = [&]
+        {
+            const auto num = ++numLoaded;
+            setProgress (startProgress, endProgress, num, numToLoad);
+
+            if (loadContext != nullptr)
+                loadContext->numPluginsLoaded = num;
+        };
+
+        // The message thread instances are created whilst the workers load the others
+        runInParallel ((int) backgroundLoaders.size(), -1.0f, -1.0f,
+                       [&] (int index)
+                       {
+                           backgroundLoaders[(size_t) index]->load();
+                           pluginLoaded();
+                       },
+                       [&]
+                       {
+                           for (auto loader : messageThreadLoaders)
+                           {
+                               if (shouldExit())
+                                   break;
+
+                               callBlocking ([loader] { loader->load(); });
+                               pluginLoaded();
+                           }
+                       });
+
+        for (auto& p : pluginsToLoad)
+        {
+            if (p.loader != nullptr)
+                p.plugin->initialiseFully (*p.loader);
+            else
+                p.plugin->initialiseFully();
+        }
+
+        // Connections can't be checked until the plugins know their channels
+        for (auto rack : edit.getRackList().getTypes())
+            rack->checkConnections();
+    }
+
+    //==============================================================================
+    /** Builds the automation curve snapshots for a set of parameters.
+        This must be called whilst nothing else can be changing the Edit.
+    */
+    void prepareAutomationStreams (const juce::Array<AutomatableParameter*>& params)
+    {
+        CRASH_TRACER
+        runInParallel (params.size(), -1.0f, -1.0f,
+                       [&] (int index) { params.getUnchecked (index)->prepareStream(); });
+    }
+
+private:
+    Edit& edit;
+    Edit::LoadContext* loadContext;
+
+    bool shouldExit() const
+    {
+        return loadContext != nullptr && loadContext->shouldExit;
+    }
+
+    void setProgress (float startProgress, float endProgress, int numDone, int numItems)
+    {
+        if (loadContext != nullptr && startProgress >= 0.0f && numItems > 0)
+            loadContext->progress = startProgress + (endProgress - startProgress) * ((float) numDone / (float) numItems);
+    }
+
+    /** Calls a function for each index on a number of worker threads and this one.
+        If a function is given for this thread it's called first, before this thread helps
+        the workers. The progress is updated as each item finishes.
+    */
+    template<typename TaskFunction>
+    void runInParallel (int numItems, float startProgress, float endProgress,
+                        TaskFunction&& taskFunction, std::function<void()> thisThreadFunction = {})
+    {
+        std::atomic<int> nextIndex { 0 }, numDone { 0 };
+
+        auto runTasks = [&]
+        {
+            for (;;)
+            {
+                const int index = nextIndex++;
+
+                if (index >= numItems || shouldExit())
+                    break;
+
+                taskFunction (index);
+                setProgress (startProgress, endProgress, ++numDone, numItems);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        const auto numThreads = juce::jmin (numItems, juce::SystemStats::getNumCpus()) - (thisThreadFunction ? 0 : 1);
+
+        for (int i = 0; i < numThreads; ++i)
+            threads.emplace_back (runTasks);
+
+        if (thisThreadFunction)
+            thisThreadFunction();
+
+        runTasks();
+
+        for (auto& t : threads)
+            t.join();
+    }
+
+    template<typename Function>
+    static void findAudioClipStates (const juce::ValueTree& v, Function&& fn)
+    {
+        for (const auto& child : v)
+        {
+            if (child.hasType (IDs::AUDIOCLIP))
+                fn (child);
+            else
+                findAudioClipStates (child, fn);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConcurrentEditLoader)
+};
+
+} // namespace tracktion_engine
@@ -0,0 +1,223 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if TRACKTION_UNIT_TESTS
+
+//==============================================================================
+//==============================================================================
+class ConcurrentEditLoadTests  : public juce::UnitTest
+{
+public:
+    ConcurrentEditLoadTests()
+        : juce::UnitTest ("ConcurrentEditLoad", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto& pluginManager = engine.getPluginManager();
+        const auto testDesc = TestInstance::getDescription();
+
+        pluginManager.knownPluginList.addType (testDesc);
+        auto oldCreateFunction = pluginManager.createPluginInstance;
+        pluginManager.createPluginInstance = [oldCreateFunction] (const juce::PluginDescription& d, double rate, int blockSize, juce::String& error)
+                                             -> std::unique_ptr<juce::AudioPluginInstance>
+        {
+            if (d.pluginFormatName == TestInstance::getDescription().pluginFormatName)
+                return std::make_unique<TestInstance>();
+
+            return oldCreateFunction (d, rate, blockSize, error);
+        };
+
+        auto editState = createEditState (engine, testDesc);
+
+        juce::StringArray loadedStates[2];
+
+        for (bool concurrently : { false, true })
+        {
+            beginTest (juce::String (concurrently ? "Concurrent" : "Sequential") + " load restores plugins");
+
+            Edit::LoadContext loadContext;
+            Edit::Options options { engine, editState.createCopy(), ProjectItemID::createNewID (0) };
+            options.loadContext = &loadContext;
+            options.numUndoLevelsToStore = 0;
+            options.loadConcurrently = concurrently;
+
+            auto edit = std::make_unique<Edit> (options);
+
+            expect (loadContext.completed);
+            expectWithinAbsoluteError (loadContext.progress.load(), 1.0f, 0.0001f);
+
+            int numExternalPlugins = 0;
+
+            for (auto p : getAllPlugins (*edit, false))
+            {
+                for (auto param : p->getAutomatableParameters())
+                    loadedStates[concurrently ? 1 : 0].add (param->getCurrentValueAsString()
+                                                            + (param->isAutomationActive() ? " active" : ""));
+
+                if (auto ep = dynamic_cast<ExternalPlugin*> (p))
+                {
+                    ++numExternalPlugins;
+                    auto instance = dynamic_cast<TestInstance*> (ep->getAudioPluginInstance());
+                    expect (instance != nullptr);
+
+                    if (instance == nullptr)
+                        continue;
+
+                    loadedStates[concurrently ? 1 : 0].add (juce::String (ep->getCurrentProgram()) + " " + juce::String (instance->value));
+
+                    // Only plugins with a state should have had their program changed
+                    if (instance->value > 0)
+                        expectEquals (ep->getCurrentProgram(), savedProgram);
+                    else
+                        expectEquals (ep->getCurrentProgram(), 0);
+                }
+            }
+
+            expectEquals (numExternalPlugins, numTracks * 2);
+        }
+
+        beginTest ("Sequential and concurrent loads restore the same state");
+        {
+            expect (! loadedStates[0].isEmpty());
+            expect (loadedStates[0] == loadedStates[1]);
+        }
+
+        pluginManager.createPluginInstance = oldCreateFunction;
+        pluginManager.knownPluginList.removeType (testDesc);
+    }
+
+private:
+    //==============================================================================
+    static constexpr int numTracks = 4, savedProgram = 2;
+
+    /** A plugin instance with some programs and a value that's saved in its state. */
+    struct TestInstance  : public juce::AudioPluginInstance
+    {
+        void fillInPluginDescription (juce::PluginDescription& d) const override  { d = getDescription(); }
+        const juce::String getName() const override                         { return "Concurrent Load Test"; }
+        void prepareToPlay (double, int) override                           {}
+        void releaseResources() override                                    {}
+        void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+        double getTailLengthSeconds() const override                        { return 0.0; }
+        bool acceptsMidi() const override                                   { return false; }
+        bool producesMidi() const override                                  { return false; }
+        juce::AudioProcessorEditor* createEditor() override                 { return nullptr; }
+        bool hasEditor() const override                                     { return false; }
+        int getNumPrograms() override                                       { return 4; }
+        int getCurrentProgram() override                                    { return program; }
+        void setCurrentProgram (int index) override                         { program = index; }
+        const juce::String getProgramName (int index) override              { return juce::String (index); }
+        void changeProgramName (int, const juce::String&) override          {}
+
+        void getStateInformation (juce::MemoryBlock& mb) override
+        {
+            mb.append (&value, sizeof (value));
+        }
+
+        void setStateInformation (const void* data, int size) override
+        {
+            if (size >= (int) sizeof (value))
+                std::memcpy (&value, data, sizeof (value));
+        }
+
+        static juce::PluginDescription getDescription()
+        {
+            juce::PluginDescription d;
+            d.name = "Concurrent Load Test";
+            d.pluginFormatName = "ConcurrentLoadTest";
+            d.fileOrIdentifier = "ConcurrentLoadTest";
+            d.uniqueId = 0x10adc0de;
+            d.numInputChannels = 2;
+            d.numOutputChannels = 2;
+            return d;
+        }
+
+        int program = 0, value = 0;
+    };
+
+    /** Creates an Edit with automated internal plugins and two external plugins per track.
+        The first has a saved state and program, the second only has a program number,
+        which shouldn't be used without a state.
+    */
+    juce::ValueTree createEditState (Engine& engine, const juce::PluginDescription& desc)
+    {
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (numTracks);
+
+        int trackNum = 0;
+
+        for (auto track : getAudioTracks (*edit))
+        {
+            auto& pluginCache = edit->getPluginCache();
+
+            for (auto type : { EqualiserPlugin::xmlTypeName, CompressorPlugin::xmlTypeName, ReverbPlugin::xmlTypeName })
+            {
+                auto plugin = pluginCache.createNewPlugin (type, {});
+                track->pluginList.insertPlugin (plugin, -1, nullptr);
+
+                for (auto param : plugin->getAutomatableParameters())
+                    for (int i = 0; i < 10; ++i)
+                        param->getCurve().addPoint (i * 0.5, (float) ((i % 4) / 4.0), 0.0f);
+            }
+
+            for (int i = 0; i < 2; ++i)
+                track->pluginList.insertPlugin (ExternalPlugin::create (engine, desc), -1);
+
+            ++trackNum;
+
+            if (auto ep = dynamic_cast<ExternalPlugin*> (track->pluginList.getPlugins()[track->pluginList.size() - 2].get()))
+            {
+                auto instance = dynamic_cast<TestInstance*> (ep->getAudioPluginInstance());
+                expect (instance != nullptr);
+
+                if (instance != nullptr)
+                    instance->value = trackNum;
+
+                ep->setCurrentProgram (savedProgram, false);
+            }
+        }
+
+        edit->flushState();
+        auto state = edit->state.createCopy();
+
+        // Leave the second plugin on each track with a program number but no state
+        int index = 0;
+        auto stripState = [&index] (juce::ValueTree v, auto& self) -> void
+        {
+            if (v.hasType (IDs::PLUGIN) && v[IDs::type].toString() == ExternalPlugin::xmlTypeName)
+            {
+                if (index++ % 2 == 1)
+                {
+                    v.removeProperty (IDs::state, nullptr);
+                    v.setProperty (IDs::programNum, savedProgram + 1, nullptr);
+                }
+            }
+
+            for (auto child : v)
+                self (child, self);
+        };
+
+        stripState (state, stripState);
+
+        return state;
+    }
+};
+
+static ConcurrentEditLoadTests concurrentEditLoadTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -280,6 +280,8 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
 
     void childAddedOrRemoved (juce::ValueTree& p, juce::ValueTree& c)
     {
+        updateEditItemIndex (c);
+
         if (c.hasType (IDs::NOTE)
              || c.hasType (IDs::CONTROL)
              || c.hasType (IDs::SYSEX)
@@ -333,7 +335,24 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
         }
     }
 
-    void valueTreeChildOrderChanged (juce::ValueTree&, int, int) override {}
+    void valueTreeChildOrderChanged (juce::ValueTree& p, int, int newIndex) override
+    {
+        updateEditItemIndex (p.getChild (newIndex));
+    }
+
+    void updateEditItemIndex (const juce::ValueTree& c)
+    {
+        // N.B. The object lists also invalidate the index once they've updated as the
+        // top level TrackList listens to the same tree and may not have been called yet
+        if (TrackList::isTrack (c))
+            edit.getEditItemIndex().invalidateTracks();
+        else if (Clip::isClipState (c))
+            edit.getEditItemIndex().invalidateClips();
+        else if (c.hasType (IDs::PLUGIN) || c.hasType (IDs::PLUGININSTANCE) || c.hasType (IDs::RACK)
+                 || c.hasType (IDs::EFFECT) || c.hasType (IDs::EFFECTS))
+            edit.getEditItemIndex().invalidatePlugins();
+    }
+
     void valueTreeParentChanged (juce::ValueTree&) override {}
 
     void clipMovedOrAdded (const juce::ValueTree& v)
@@ -504,6 +523,7 @@ Edit::Edit (Options options)
       state (options.editState),
       instanceId (getNextInstanceId()),
       editProjectItemID (options.editProjectItemID),
+      loadConcurrently (options.loadConcurrently),
       loadContext (options.loadContext),
       editRole (options.role)
 {
@@ -540,6 +560,7 @@ Edit::Edit (Options options)
             return {};
         };
 
+    editItemIndex               = std::make_unique<EditItemIndex> (*this);
     pluginCache                 = std::make_unique<PluginCache> (*this);
     mirroredPluginUpdateTimer   = std::make_unique<MirroredPluginUpdateTimer> (*this);
     transportControl            = std::make_unique<TransportControl> (*this, state.getOrCreateChildWithName (IDs::TRANSPORT, nullptr));
@@ -692,6 +713,14 @@ void Edit::initialise()
     isLoadInProgress = true;
     tempDirectory = juce::File();
 
+    std::unique_ptr<ConcurrentEditLoader> concurrentLoader;
+
+    if (loadConcurrently)
+    {
+        concurrentLoader = std::make_unique<ConcurrentEditLoader> (*this, loadContext);
+        deferPluginInitialisation = true;
+    }
+
     if (! state.hasProperty (IDs::creationTime))
         state.setProperty (IDs::creationTime, juce::Time::getCurrentTime().toMilliseconds(), nullptr);
 
@@ -710,10 +739,23 @@ void Edit::initialise()
     initialiseMasterPlugins();
     initialiseAuxBusses();
     initialiseAudioDevices();
+
+    if (concurrentLoader != nullptr)
+        concurrentLoader->cacheAudioFileInfo (0.0f, 0.1f);
+
     loadTracks();
 
+    if (concurrentLoader != nullptr)
+    {
+        if (loadContext != nullptr)
+            loadContext->progress = 0.3f;
+
+        deferPluginInitialisation = false;
+        concurrentLoader->initialisePlugins (0.3f, 0.8f);
+    }
+
     if (loadContext != nullptr)
-        loadContext->progress = 1.0f;
+        loadContext->progress = 0.8f;
 
     initialiseTracks();
     initialiseARA();
@@ -728,7 +770,10 @@ void Edit::initialise()
     initialiseControllerMappings();
     TemporaryFileManager::purgeOrphanFreezeAndProxyFiles (*this);
 
-    callBlocking ([this]
+    if (loadContext != nullptr)
+        loadContext->progress = 0.9f;
+
+    callBlocking ([this, &concurrentLoader]
                   {
                       // Must be set to false before curve updates
                       // but set inside here to give the message loop some time to dispatch async updates
@@ -738,7 +783,13 @@ void Edit::initialise()
                           for (auto mp : mpl->getMacroParameters())
                               mp->initialise();
 
-                      for (auto ap : getAllAutomatableParams (true))
+                      const auto allParams = getAllAutomatableParams (true);
+
+                      // The message thread is blocked here so the curves can't change whilst they're read
+                      if (concurrentLoader != nullptr)
+                          concurrentLoader->prepareAutomationStreams (allParams);
+
+                      for (auto ap : allParams)
                           ap->updateStream();
 
                       for (auto effect : getAllClipEffects (*this))
@@ -758,6 +809,9 @@ void Edit::initialise()
 
     getUndoManager().clearUndoHistory();
 
+    if (loadContext != nullptr)
+        loadContext->progress = 1.0f;
+
     DBG ("Edit loaded in: " << loadTimer.getDescription());
 }
 
@@ -1992,21 +2046,17 @@ void Edit::sendStartStopMessageToPlugins()
 
 void Edit::addModifierTimer (ModifierTimer& mt)
 {
-    jassert (! modifierTimers.contains (&mt));
-    modifierTimers.add (&mt);
+    modifierTimers.add (mt);
 }
 
 void Edit::removeModifierTimer (ModifierTimer& mt)
 {
-    modifierTimers.removeFirstMatchingValue (&mt);
+    modifierTimers.remove (mt);
 }
 
 void Edit::updateModifierTimers (double editTime, int numSamples) const
 {
-    const juce::ScopedLock sl (modifierTimers.getLock());
-
-    for (auto mt : modifierTimers)
-        mt->updateStreamTime (editTime, numSamples);
+    modifierTimers.update (editTime, numSamples);
 }
 
 //==============================================================================
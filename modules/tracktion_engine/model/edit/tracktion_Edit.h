@@ -83,6 +83,9 @@ public:
         std::atomic<float> progress  { 0.0f };  /**< Progress will be updated as the Edit loads. */
         std::atomic<bool> completed  { false }; /**< Set to true once the Edit has loaded. */
         std::atomic<bool> shouldExit { false }; /**< Can be set to true to cancel loading the Edit. */
+
+        std::atomic<int> numPluginsToLoad { 0 }; /**< When loading concurrently, the number of plugin instances being created. */
+        std::atomic<int> numPluginsLoaded { 0 }; /**< When loading concurrently, the number of plugin instances that have been created. */
     };
 
     //==============================================================================
@@ -99,6 +102,13 @@ public:
 
         std::function<juce::File()> editFileRetriever;                      /**< An optional editFileRetriever to use. */
         std::function<juce::File (const juce::String&)> filePathResolver;   /**< An optional filePathResolver to use. */
+
+        /** If true, the parts of loading that don't depend on each other are done on a number of threads.
+            Plugin instances are created and have their state restored concurrently, apart from
+            those that need the message thread (see PluginManager::canCreatePluginInstanceOnBackgroundThread),
+            and the audio file info and automation caches are built concurrently.
+        */
+        bool loadConcurrently = false;
     };
 
     /** Creates an Edit from a set of Options. */
@@ -191,6 +201,9 @@ public:
     /** Returns true if the Edit's not yet fully loaded */
     bool isLoading() const                                              { return isLoadInProgress; }
 
+    /** @internal Returns true if newly created plugins should wait to be initialised with the rest of the Edit's plugins. */
+    bool shouldDeferPluginInitialisation() const noexcept               { return deferPluginInitialisation; }
+
     /** Creates an Edit for previewing a file. */
     static std::unique_ptr<Edit> createEditForPreviewingFile (Engine&, const juce::File&, const Edit* editToMatch,
                                                               bool tryToMatchTempo, bool tryToMatchPitch, bool* couldMatchTempo,
@@ -342,6 +355,11 @@ public:
     */
     void visitAllTracks (std::function<bool(Track&)>, bool recursive) const;
 
+    /** Returns the cached lists of the tracks, clips and plugins in the Edit and their EditItemIDs.
+        @see EditItemIndex
+    */
+    EditItemIndex& getEditItemIndex() const noexcept            { return *editItemIndex; }
+
     //==============================================================================
     /** Inserts a new AudioTrack in the Edit. */
     juce::ReferenceCountedObjectPtr<AudioTrack> insertNewAudioTrack (TrackInsertPoint, SelectionManager*);
@@ -459,6 +477,15 @@ public:
     /** Updates all the ModifierTimers with a given edit time and number of samples. */
     void updateModifierTimers (double editTime, int numSamples) const;
 
+    /** Updates the ModifierTimers in groups that runTasks can update concurrently.
+        @see ModifierTimerList::update
+    */
+    template<typename RunTasksFunction>
+    void updateModifierTimers (double editTime, int numSamples, RunTasksFunction&& runTasks) const
+    {
+        modifierTimers.update (editTime, numSamples, std::forward<RunTasksFunction> (runTasks));
+    }
+
     /** Holds the global Macros for the Edit. */
     struct GlobalMacros : public MacroParameterElement
     {
@@ -804,6 +831,9 @@ private:
     const int instanceId;
     std::atomic<ProjectItemID> editProjectItemID { ProjectItemID() };
 
+    // N.B. This must outlive the tracks and plugin lists which notify it when they're deleted
+    std::unique_ptr<EditItemIndex> editItemIndex;
+
     // persistent properties (i.e. stuff that gets saved)
     juce::CachedValue<juce::String> clickTrackDevice;
     juce::CachedValue<juce::String> midiTimecodeSourceDevice, midiMachineControlSourceDevice, midiMachineControlDestDevice;
@@ -830,11 +860,13 @@ private:
     std::unique_ptr<ParameterChangeHandler> parameterChangeHandler;
     std::unique_ptr<PluginCache> pluginCache;
     std::unique_ptr<TrackCompManager> trackCompManager;
-    juce::Array<ModifierTimer*, juce::CriticalSection> modifierTimers;
+    ModifierTimerList modifierTimers;
     std::unique_ptr<GlobalMacros> globalMacros;
 
     mutable double totalEditLength = -1.0;
     std::atomic<bool> isLoadInProgress { true };
+    const bool loadConcurrently = false;
+    bool deferPluginInitialisation = false;
     std::atomic<int> performingRenderCount { 0 };
     bool shouldRestartPlayback = false;
     bool blinkBright = false;
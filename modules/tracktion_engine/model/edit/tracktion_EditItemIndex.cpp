@@ -0,0 +1,252 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+EditItemIndex::EditItemIndex (Edit& e)
+    : edit (e),
+      tracks (std::make_shared<juce::Array<Track*>>()),
+      clips (std::make_shared<juce::Array<Clip*>>()),
+      plugins (std::make_shared<juce::Array<Plugin*>>())
+{
+}
+
+EditItemIndex::~EditItemIndex()
+{
+}
+
+//==============================================================================
+juce::Array<Track*> EditItemIndex::getAllTracks()
+{
+    return *getTrackList();
+}
+
+juce::Array<Clip*> EditItemIndex::getAllClips()
+{
+    return *getClipList();
+}
+
+Plugin::Array EditItemIndex::getAllPlugins (bool includeMasterVolume)
+{
+    auto pluginList = getPluginList();
+
+    Plugin::Array list;
+    list.ensureStorageAllocated (pluginList->size() + 1);
+
+    for (auto p : *pluginList)
+        list.add (p);
+
+    if (includeMasterVolume)
+        list.add (edit.getMasterVolumePlugin().get());
+
+    return list;
+}
+
+//==============================================================================
+void EditItemIndex::visitAllTracks (const std::function<bool (Track&)>& visit)
+{
+    for (auto t : *getTrackList())
+        if (! visit (*t))
+            return;
+}
+
+void EditItemIndex::visitAllClips (const std::function<bool (Clip&)>& visit)
+{
+    for (auto c : *getClipList())
+        if (! visit (*c))
+            return;
+}
+
+void EditItemIndex::visitAllPlugins (const std::function<bool (Plugin&)>& visit)
+{
+    for (auto p : *getPluginList())
+        if (! visit (*p))
+            return;
+}
+
+//==============================================================================
+Track* EditItemIndex::findTrack (EditItemID id)
+{
+    const juce::ScopedLock sl (lock);
+    updateTracks();
+
+    auto found = tracksByID.find (id);
+    return found != tracksByID.end() ? found->second : nullptr;
+}
+
+Clip* EditItemIndex::findClip (EditItemID id)
+{
+    const juce::ScopedLock sl (lock);
+    updateClips();
+
+    auto found = clipsByID.find (id);
+    return found != clipsByID.end() ? found->second : nullptr;
+}
+
+Plugin* EditItemIndex::findPlugin (EditItemID id)
+{
+    const juce::ScopedLock sl (lock);
+    updatePlugins();
+
+    auto found = pluginsByID.find (id);
+    return found != pluginsByID.end() ? found->second : nullptr;
+}
+
+//==============================================================================
+void EditItemIndex::invalidateTracks()
+{
+    const juce::ScopedLock sl (lock);
+    tracksNeedUpdating = true;
+    clipsNeedUpdating = true;
+    pluginsNeedUpdating = true;
+}
+
+void EditItemIndex::invalidateClips()
+{
+    const juce::ScopedLock sl (lock);
+    clipsNeedUpdating = true;
+    pluginsNeedUpdating = true;
+}
+
+void EditItemIndex::invalidatePlugins()
+{
+    const juce::ScopedLock sl (lock);
+    pluginsNeedUpdating = true;
+}
+
+//==============================================================================
+// N.B. The flags are cleared before the lists are built so anything invalidated
+// whilst building them will be picked up the next time they're used.
+// Where IDs are duplicated the first item is kept, matching a walk of the Edit.
+void EditItemIndex::updateTracks()
+{
+    if (! tracksNeedUpdating)
+        return;
+
+    tracksNeedUpdating = false;
+    auto newTracks = std::make_shared<juce::Array<Track*>>();
+    newTracks->ensureStorageAllocated (tracks->size());
+    tracksByID.clear();
+
+    edit.visitAllTracksRecursive ([this, &newTracks] (Track& t)
+                                  {
+                                      newTracks->add (&t);
+                                      tracksByID.emplace (t.itemID, &t);
+                                      return true;
+                                  });
+
+    tracks = std::move (newTracks);
+}
+
+void EditItemIndex::updateClips()
+{
+    updateTracks();
+
+    if (! clipsNeedUpdating)
+        return;
+
+    clipsNeedUpdating = false;
+    auto newClips = std::make_shared<juce::Array<Clip*>>();
+    newClips->ensureStorageAllocated (clips->size());
+    clipsByID.clear();
+
+    for (auto t : *tracks)
+    {
+        if (auto ct = dynamic_cast<ClipTrack*> (t))
+        {
+            for (auto c : ct->getClips())
+            {
+                newClips->add (c);
+                clipsByID.emplace (c->itemID, c);
+            }
+        }
+    }
+
+    clips = std::move (newClips);
+}
+
+void EditItemIndex::updatePlugins()
+{
+    updateClips();
+
+    if (! pluginsNeedUpdating)
+        return;
+
+    CRASH_TRACER
+    pluginsNeedUpdating = false;
+    auto newPlugins = std::make_shared<juce::Array<Plugin*>>();
+    newPlugins->ensureStorageAllocated (plugins->size());
+    pluginsByID.clear();
+
+    auto addPlugin = [this, &newPlugins] (Plugin* p)
+    {
+        newPlugins->add (p);
+        pluginsByID.emplace (p->itemID, p);
+    };
+
+    for (auto t : *tracks)
+    {
+        for (auto p : t->getAllPlugins())
+            addPlugin (p);
+
+        if (auto at = dynamic_cast<AudioTrack*> (t))
+        {
+            for (auto clip : at->getClips())
+            {
+                if (auto abc = dynamic_cast<AudioClipBase*> (clip))
+                {
+                    if (auto pluginList = abc->getPluginList())
+                        for (auto p : pluginList->getPlugins())
+                            addPlugin (p);
+
+                    if (auto clipEffects = abc->getClipEffects())
+                        for (auto effect : *clipEffects)
+                            if (auto pluginEffect = dynamic_cast<PluginEffect*> (effect))
+                                if (pluginEffect->plugin != nullptr)
+                                    addPlugin (pluginEffect->plugin.get());
+                }
+            }
+        }
+    }
+
+    for (auto p : edit.getMasterPluginList().getPlugins())
+        addPlugin (p);
+
+    for (auto r : edit.getRackList().getTypes())
+        for (auto p : r->getPlugins())
+            addPlugin (p);
+
+    plugins = std::move (newPlugins);
+}
+
+//==============================================================================
+std::shared_ptr<const juce::Array<Track*>> EditItemIndex::getTrackList()
+{
+    const juce::ScopedLock sl (lock);
+    updateTracks();
+    return tracks;
+}
+
+std::shared_ptr<const juce::Array<Clip*>> EditItemIndex::getClipList()
+{
+    const juce::ScopedLock sl (lock);
+    updateClips();
+    return clips;
+}
+
+std::shared_ptr<const juce::Array<Plugin*>> EditItemIndex::getPluginList()
+{
+    const juce::ScopedLock sl (lock);
+    updatePlugins();
+    return plugins;
+}
+
+} // namespace tracktion_engine
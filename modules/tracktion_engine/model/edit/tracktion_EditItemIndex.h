@@ -0,0 +1,116 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    Holds flattened lists of all the Track[s], Clip[s] and Plugin[s] in an Edit,
+    along with a map from their EditItemID[s] to the objects.
+
+    The lists are built when they're first needed and then kept until the Edit's
+    structure changes. The TrackList, ClipList and PluginList objects and the Edit's
+    tree listener invalidate them when items are added, removed or reordered, so
+    looking things up in between changes doesn't need to walk the whole Edit.
+
+    Most of the time you'll want to use the functions in tracktion_EditUtilities.h
+    such as getAllTracks, findTrackForID or getAllPlugins which use this.
+
+    @see Edit::getEditItemIndex
+*/
+class EditItemIndex
+{
+public:
+    EditItemIndex (Edit&);
+    ~EditItemIndex();
+
+    //==============================================================================
+    /** Returns all the tracks in the Edit in the order Edit::visitAllTracksRecursive visits them. */
+    juce::Array<Track*> getAllTracks();
+
+    /** Returns all the clips on the Edit's ClipTrack[s], ordered by track. */
+    juce::Array<Clip*> getAllClips();
+
+    /** Returns all the plugins in the Edit, including the ones on clips and in racks. */
+    Plugin::Array getAllPlugins (bool includeMasterVolume);
+
+    //==============================================================================
+    /** Calls a function for each of the tracks getAllTracks would return, without copying them.
+        Return false from the function to stop visiting. If the Edit changes whilst visiting,
+        the rest of the tracks that were in it beforehand are still visited.
+    */
+    void visitAllTracks (const std::function<bool (Track&)>&);
+
+    /** Calls a function for each of the clips getAllClips would return, without copying them.
+        @see visitAllTracks
+    */
+    void visitAllClips (const std::function<bool (Clip&)>&);
+
+    /** Calls a function for each of the plugins getAllPlugins would return, not including
+        the master volume plugin, without copying them.
+        @see visitAllTracks
+    */
+    void visitAllPlugins (const std::function<bool (Plugin&)>&);
+
+    //==============================================================================
+    /** Returns the Track with a given ID if it's in the Edit. */
+    Track* findTrack (EditItemID);
+
+    /** Returns the Clip with a given ID if it's in the Edit. */
+    Clip* findClip (EditItemID);
+
+    /** Returns the Plugin with a given ID if it's in the Edit.
+        This doesn't include the master volume plugin.
+    */
+    Plugin* findPlugin (EditItemID);
+
+    //==============================================================================
+    /** Call when tracks have been added, removed or moved.
+        This also invalidates the clips and plugins as they're found via the tracks.
+    */
+    void invalidateTracks();
+
+    /** Call when clips have been added, removed or moved.
+        This also invalidates the plugins as some of them live on clips.
+    */
+    void invalidateClips();
+
+    /** Call when plugins, racks or clip effects have been added, removed or moved. */
+    void invalidatePlugins();
+
+private:
+    Edit& edit;
+    juce::CriticalSection lock;
+
+    bool tracksNeedUpdating = true, clipsNeedUpdating = true, pluginsNeedUpdating = true;
+
+    // These are replaced rather than changed when they're rebuilt so the visitors
+    // can keep using a list without holding the lock
+    std::shared_ptr<const juce::Array<Track*>> tracks;
+    std::shared_ptr<const juce::Array<Clip*>> clips;
+    std::shared_ptr<const juce::Array<Plugin*>> plugins;
+
+    std::unordered_map<EditItemID, Track*> tracksByID;
+    std::unordered_map<EditItemID, Clip*> clipsByID;
+    std::unordered_map<EditItemID, Plugin*> pluginsByID;
+
+    void updateTracks();
+    void updateClips();
+    void updatePlugins();
+
+    std::shared_ptr<const juce::Array<Track*>> getTrackList();
+    std::shared_ptr<const juce::Array<Clip*>> getClipList();
+    std::shared_ptr<const juce::Array<Plugin*>> getPluginList();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EditItemIndex)
+};
+
+} // namespace tracktion_engine
@@ -63,9 +63,12 @@ void insertSpaceIntoEditFromBeatRange (Edit& edit, juce::Range<double> beatRange
 //==============================================================================
 juce::Array<Track*> getAllTracks (const Edit& edit)
 {
-    juce::Array<Track*> tracks;
-    edit.visitAllTracks ([&] (Track& t) { tracks.add (&t); return true; }, true);
-    return tracks;
+    return edit.getEditItemIndex().getAllTracks();
+}
+
+void visitAllTracks (const Edit& edit, const std::function<bool (Track&)>& visit)
+{
+    edit.getEditItemIndex().visitAllTracks (visit);
 }
 
 juce::Array<Track*> getTopLevelTracks (const Edit& edit)
@@ -87,14 +90,12 @@ juce::Array<ClipTrack*> getClipTracks (const Edit& edit)
 
 int getTotalNumTracks (const Edit& edit)
 {
-    int count = 0;
-    edit.visitAllTracksRecursive ([&] (Track&) { ++count; return true; });
-    return count;
+    return getAllTracks (edit).size();
 }
 
 Track* findTrackForID (const Edit& edit, EditItemID id)
 {
-    return findTrackForPredicate (edit, [id] (Track& t) { return t.itemID == id; });
+    return edit.getEditItemIndex().findTrack (id);
 }
 
 Array<Track*> findTracksForIDs (const Edit& edit, Array<EditItemID> ids)
@@ -114,6 +115,10 @@ Array<Track*> findTracksForIDs (const Edit& edit, Array<EditItemID> ids)
 
 Track* findTrackForState (const Edit& edit, const juce::ValueTree& v)
 {
+    if (auto t = findTrackForID (edit, EditItemID::fromID (v)))
+        if (t->state == v)
+            return t;
+
     return findTrackForPredicate (edit, [&] (Track& t) { return t.state == v; });
 }
 
@@ -576,26 +581,27 @@ juce::Array<ClipEffect*> getAllClipEffects (Edit& edit)
 }
 
 //==============================================================================
-Clip* findClipForID (const Edit& edit, EditItemID clipID)
+juce::Array<Clip*> getAllClips (const Edit& edit)
 {
-    Clip* result = nullptr;
-
-    edit.visitAllTracksRecursive ([&] (Track& t)
-                                  {
-                                      if (auto c = t.findClipForID (clipID))
-                                      {
-                                          result = c;
-                                          return false;
-                                      }
+    return edit.getEditItemIndex().getAllClips();
+}
 
-                                      return true;
-                                  });
+void visitAllClips (const Edit& edit, const std::function<bool (Clip&)>& visit)
+{
+    edit.getEditItemIndex().visitAllClips (visit);
+}
 
-    return result;
+Clip* findClipForID (const Edit& edit, EditItemID clipID)
+{
+    return edit.getEditItemIndex().findClip (clipID);
 }
 
 Clip* findClipForState (const Edit& edit, const juce::ValueTree& v)
 {
+    if (auto c = findClipForID (edit, EditItemID::fromID (v)))
+        if (c->state == v)
+            return c;
+
     Clip* result = nullptr;
 
     visitAllTrackItems (edit, [&] (TrackItem& t)
@@ -736,47 +742,32 @@ juce::Result mergeMidiClips (juce::Array<MidiClip*> clips)
 //==============================================================================
 Plugin::Array getAllPlugins (const Edit& edit, bool includeMasterVolume)
 {
-    CRASH_TRACER
-    Plugin::Array list;
-    edit.visitAllTracksRecursive ([&] (Track& t)
-                                  {
-                                      list.addArray (t.getAllPlugins());
-        
-                                      if (auto at = dynamic_cast<AudioTrack*> (&t))
-                                      {
-                                          for (auto clip : at->getClips())
-                                          {
-                                              if (auto abc = dynamic_cast<AudioClipBase*> (clip))
-                                              {
-                                                  if (auto pluginList = abc->getPluginList())
-                                                      list.addArray (pluginList->getPlugins());
-
-                                                  if (auto clipEffects = abc->getClipEffects())
-                                                      for (auto effect : *clipEffects)
-                                                          if (auto pluginEffect = dynamic_cast<PluginEffect*> (effect))
-                                                              if (pluginEffect->plugin != nullptr)
-                                                                  list.add (pluginEffect->plugin);
-                                              }
-                                          }
-                                      }
-        
-                                      return true;
-                                  });
+    return edit.getEditItemIndex().getAllPlugins (includeMasterVolume);
+}
 
-    list.addArray (edit.getMasterPluginList().getPlugins());
+void visitAllPlugins (const Edit& edit, const std::function<bool (Plugin&)>& visit)
+{
+    edit.getEditItemIndex().visitAllPlugins (visit);
+}
 
-    for (auto r : edit.getRackList().getTypes())
-        for (auto p : r->getPlugins())
-            list.add (p);
+Plugin::Ptr findPluginForID (const Edit& edit, EditItemID id)
+{
+    if (auto p = edit.getEditItemIndex().findPlugin (id))
+        return p;
 
-    if (includeMasterVolume)
-        list.add (edit.getMasterVolumePlugin().get());
+    if (auto masterVolume = edit.getMasterVolumePlugin())
+        if (masterVolume->itemID == id)
+            return masterVolume;
 
-    return list;
+    return {};
 }
 
 Plugin::Ptr findPluginForState (const Edit& edit, const juce::ValueTree& v)
 {
+    if (auto p = findPluginForID (edit, EditItemID::fromID (v)))
+        if (p->state == v)
+            return p;
+
     for (auto p : getAllPlugins (edit, true))
         if (p->state == v)
             return p;
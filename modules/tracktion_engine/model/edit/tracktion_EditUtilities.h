@@ -39,6 +39,12 @@ void insertSpaceIntoEditFromBeatRange (Edit&, juce::Range<double> beatRange);
 /** Returns all the tracks in an Edit. */
 juce::Array<Track*> getAllTracks (const Edit&);
 
+/** Calls a function for each of the tracks getAllTracks would return without copying
+    them, which is quicker when you don't need to keep the list.
+    Return false from the function to stop visiting.
+*/
+void visitAllTracks (const Edit&, const std::function<bool (Track&)>&);
+
 /** Returns all of the non-foldered tracks in an Edit. */
 juce::Array<Track*> getTopLevelTracks (const Edit&);
 
@@ -94,6 +100,14 @@ juce::Array<Track*> toTrackArray (Edit&, const juce::BigInteger&);
 // Clips
 //==============================================================================
 
+/** Returns all the clips on the ClipTrack[s] in an Edit. */
+juce::Array<Clip*> getAllClips (const Edit&);
+
+/** Calls a function for each of the clips getAllClips would return without copying them.
+    Return false from the function to stop visiting.
+*/
+void visitAllClips (const Edit&, const std::function<bool (Clip&)>&);
+
 /** Returns the Clip with a given ID if contained in the Edit. */
 Clip* findClipForID (const Edit&, EditItemID);
 
@@ -168,6 +182,15 @@ juce::Result mergeMidiClips (juce::Array<MidiClip*>);
 /** Returns all the plugins in a given Edit. */
 Plugin::Array getAllPlugins (const Edit&, bool includeMasterVolume);
 
+/** Calls a function for each of the plugins getAllPlugins would return, not including
+    the master volume plugin, without copying them.
+    Return false from the function to stop visiting.
+*/
+void visitAllPlugins (const Edit&, const std::function<bool (Plugin&)>&);
+
+/** Returns the plugin with a given ID if contained in the Edit. */
+Plugin::Ptr findPluginForID (const Edit&, EditItemID);
+
 /** Returns the plugin with given state. */
 Plugin::Ptr findPluginForState (const Edit&, const juce::ValueTree&);
 
@@ -236,6 +259,19 @@ inline juce::Array<TrackType*> getTracksOfType (const Edit& edit, bool recursive
     juce::Array<TrackType*> result;
     result.ensureStorageAllocated (32);
 
+    if (recursive)
+    {
+        visitAllTracks (edit, [&] (Track& t)
+                        {
+                            if (auto type = dynamic_cast<TrackType*> (&t))
+                                result.add (type);
+
+                            return true;
+                        });
+
+        return result;
+    }
+
     edit.visitAllTracks ([&] (Track& t)
                          {
                              if (auto type = dynamic_cast<TrackType*> (&t))
@@ -0,0 +1,141 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if TRACKTION_UNIT_TESTS
+
+//==============================================================================
+//==============================================================================
+class EditItemIndexTests  : public juce::UnitTest
+{
+public:
+    EditItemIndexTests()
+        : juce::UnitTest ("EditItemIndex", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (8);
+
+        for (auto track : getAudioTracks (*edit))
+        {
+            for (int i = 0; i < 4; ++i)
+                track->insertMIDIClip ({ i * 2.0, i * 2.0 + 1.0 }, nullptr);
+
+            for (int i = 0; i < 2; ++i)
+                track->pluginList.insertPlugin (edit->getPluginCache().createNewPlugin (EqualiserPlugin::xmlTypeName, {}), -1, nullptr);
+        }
+
+        beginTest ("Index matches Edit");
+        {
+            expectIndexMatchesEdit (*edit);
+        }
+
+        beginTest ("Index matches Edit after structural changes");
+        {
+            auto audioTracks = getAudioTracks (*edit);
+            auto firstTrack = audioTracks.getFirst();
+            auto removedClipID = firstTrack->getClips().getFirst()->itemID;
+            firstTrack->getClips().getFirst()->removeFromParentTrack();
+            expect (findClipForID (*edit, removedClipID) == nullptr);
+
+            auto removedTrackID = audioTracks.getLast()->itemID;
+            edit->deleteTrack (audioTracks.getLast());
+            expect (findTrackForID (*edit, removedTrackID) == nullptr);
+
+            edit->moveTrack (audioTracks[1], { nullptr, audioTracks[3] });
+
+            auto plugin = firstTrack->pluginList.getPlugins().getFirst();
+            plugin->removeFromParent();
+            audioTracks[2]->pluginList.insertPlugin (plugin, 0, nullptr);
+            expect (getTrackContainingPlugin (*edit, plugin.get()) == audioTracks[2]);
+
+            edit->insertNewAudioTrack ({ nullptr, audioTracks[4] }, nullptr);
+
+            expectIndexMatchesEdit (*edit);
+        }
+
+        beginTest ("Visitors can stop early");
+        {
+            int numVisited = 0;
+            visitAllTracks (*edit, [&] (Track&) { return ++numVisited < 2; });
+            expectEquals (numVisited, 2);
+
+            numVisited = 0;
+            visitAllClips (*edit, [&] (Clip&) { return ++numVisited < 3; });
+            expectEquals (numVisited, 3);
+        }
+    }
+
+private:
+    //==============================================================================
+    void expectIndexMatchesEdit (Edit& edit)
+    {
+        // Walk the Edit the way the utilities did before they used the index
+        juce::Array<Track*> walkedTracks;
+        juce::Array<Clip*> walkedClips;
+        juce::Array<Plugin*> walkedTrackPlugins;
+
+        edit.visitAllTracksRecursive ([&] (Track& t)
+                                      {
+                                          walkedTracks.add (&t);
+
+                                          for (auto p : t.getAllPlugins())
+                                              walkedTrackPlugins.add (p);
+
+                                          if (auto ct = dynamic_cast<ClipTrack*> (&t))
+                                              walkedClips.addArray (ct->getClips());
+
+                                          return true;
+                                      });
+
+        expect (getAllTracks (edit) == walkedTracks);
+        expect (getAllClips (edit) == walkedClips);
+
+        for (auto t : walkedTracks)
+            expect (findTrackForID (edit, t->itemID) == t);
+
+        for (auto c : walkedClips)
+            expect (findClipForID (edit, c->itemID) == c);
+
+        const auto allPlugins = getAllPlugins (edit, false);
+
+        for (auto p : walkedTrackPlugins)
+        {
+            expect (allPlugins.contains (p));
+            expect (findPluginForID (edit, p->itemID) == p);
+        }
+
+        // The visitors should see the same items in the same order
+        juce::Array<Track*> visitedTracks;
+        visitAllTracks (edit, [&] (Track& t) { visitedTracks.add (&t); return true; });
+        expect (visitedTracks == walkedTracks);
+
+        juce::Array<Clip*> visitedClips;
+        visitAllClips (edit, [&] (Clip& c) { visitedClips.add (&c); return true; });
+        expect (visitedClips == walkedClips);
+
+        Plugin::Array visitedPlugins;
+        visitAllPlugins (edit, [&] (Plugin& p) { visitedPlugins.add (&p); return true; });
+        expect (visitedPlugins == allPlugins);
+    }
+};
+
+static EditItemIndexTests editItemIndexTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -127,34 +127,108 @@ juce::uint32 TempoSequence::TempoSections::getChangeCount() const
     return changeCounter;
 }
 
-double TempoSequence::TempoSections::timeToBeats (double time) const
+namespace TempoSectionHelpers
 {
-    for (int i = tempos.size(); --i > 0;)
+    inline double getStartTime (const TempoSequence::SectionDetails& s)    { return s.startTime; }
+    inline double getStartBeat (const TempoSequence::SectionDetails& s)    { return s.startBeatInEdit; }
+
+    /** Returns the last section starting at or before the position, or 0 if there isn't one.
+        The sections are always in time order so this can be a binary search.
+    */
+    template<typename GetStartFn>
+    int findSection (const TempoSequence::TempoSections& sections, double position, GetStartFn getStart)
     {
-        auto& it = tempos.getReference (i);
+        int start = 1, end = sections.size();
 
-        if (it.startTime <= time)
-            return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
+        while (start < end)
+        {
+            auto mid = (start + end) / 2;
+
+            if (getStart (sections.getReference (mid)) <= position)
+                start = mid + 1;
+            else
+                end = mid;
+        }
+
+        return start - 1;
     }
 
-    auto& it = tempos.getReference (0);
-    return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
+    template<typename GetStartFn>
+    int findSection (const TempoSequence::TempoSections& sections, double position,
+                     TempoSequence::TempoSections::Cursor& cursor, GetStartFn getStart)
+    {
+        const int numSections = sections.size();
+
+        auto isInSection = [&] (int i)
+        {
+            return isPositiveAndBelow (i, numSections)
+                    && (i == 0 || getStart (sections.getReference (i)) <= position)
+                    && (i == numSections - 1 || getStart (sections.getReference (i + 1)) > position);
+        };
+
+        // Contiguous playback will nearly always be in the same or next section
+        if (! isInSection (cursor.index))
+        {
+            if (isInSection (cursor.index + 1))
+                ++cursor.index;
+            else
+                cursor.index = findSection (sections, position, getStart);
+        }
+
+        return cursor.index;
+    }
 }
 
-double TempoSequence::TempoSections::beatsToTime (double beats) const
+int TempoSequence::TempoSections::indexOfSectionAtTime (double time) const
 {
-    for (int i = tempos.size(); --i > 0;)
-    {
-        auto& it = tempos.getReference(i);
+    return TempoSectionHelpers::findSection (*this, time, TempoSectionHelpers::getStartTime);
+}
 
-        if (beats - it.startBeatInEdit >= 0)
-            return it.startTime + it.secondsPerBeat * (beats - it.startBeatInEdit);
-    }
+int TempoSequence::TempoSections::indexOfSectionAtTime (double time, Cursor& cursor) const
+{
+    return TempoSectionHelpers::findSection (*this, time, cursor, TempoSectionHelpers::getStartTime);
+}
+
+int TempoSequence::TempoSections::indexOfSectionAtBeat (double beats) const
+{
+    return TempoSectionHelpers::findSection (*this, beats, TempoSectionHelpers::getStartBeat);
+}
+
+int TempoSequence::TempoSections::indexOfSectionAtBeat (double beats, Cursor& cursor) const
+{
+    return TempoSectionHelpers::findSection (*this, beats, cursor, TempoSectionHelpers::getStartBeat);
+}
 
-    auto& it = tempos.getReference(0);
+static double timeToBeatsInSection (const TempoSequence::SectionDetails& it, double time)
+{
+    return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
+}
+
+static double beatsToTimeInSection (const TempoSequence::SectionDetails& it, double beats)
+{
     return it.startTime + it.secondsPerBeat * (beats - it.startBeatInEdit);
 }
 
+double TempoSequence::TempoSections::timeToBeats (double time) const
+{
+    return timeToBeatsInSection (tempos.getReference (indexOfSectionAtTime (time)), time);
+}
+
+double TempoSequence::TempoSections::timeToBeats (double time, Cursor& cursor) const
+{
+    return timeToBeatsInSection (tempos.getReference (indexOfSectionAtTime (time, cursor)), time);
+}
+
+double TempoSequence::TempoSections::beatsToTime (double beats) const
+{
+    return beatsToTimeInSection (tempos.getReference (indexOfSectionAtBeat (beats)), beats);
+}
+
+double TempoSequence::TempoSections::beatsToTime (double beats, Cursor& cursor) const
+{
+    return beatsToTimeInSection (tempos.getReference (indexOfSectionAtBeat (beats, cursor)), beats);
+}
+
 //==============================================================================
 TempoSequence::TempoSequence (Edit& e) : edit (e)
 {
@@ -524,15 +598,11 @@ int TempoSequence::indexOfTempo (const TempoSetting* const t) const
 double TempoSequence::getBpmAt (double time) const
 {
     updateTempoDataIfNeeded();
-    for (int i = internalTempos.size(); --i >= 0;)
-    {
-        auto& it = internalTempos.getReference (i);
 
-        if (it.startTime <= time || i == 0)
-            return it.bpm;
-    }
+    if (internalTempos.size() == 0)
+        return 120.0;
 
-    return 120.0;
+    return internalTempos.getReference (internalTempos.indexOfSectionAtTime (time)).bpm;
 }
 
 double TempoSequence::getBeatsPerSecondAt (double time, bool lengthOfOneBeatDependsOnTimeSignature) const
@@ -540,13 +610,9 @@ double TempoSequence::getBeatsPerSecondAt (double time, bool lengthOfOneBeatDepe
     if (lengthOfOneBeatDependsOnTimeSignature)
     {
         updateTempoDataIfNeeded();
-        for (int i = internalTempos.size(); --i >= 0;)
-        {
-            auto& it = internalTempos.getReference (i);
 
-            if (it.startTime <= time || i == 0)
-                return it.beatsPerSecond;
-        }
+        if (internalTempos.size() > 0)
+            return internalTempos.getReference (internalTempos.indexOfSectionAtTime (time)).beatsPerSecond;
     }
 
     return getBpmAt (time) / 60.0;
@@ -564,30 +630,25 @@ double TempoSequence::BarsAndBeats::getFractionalBeats() const  { return beats -
 TempoSequence::BarsAndBeats TempoSequence::timeToBarsBeats (double t) const
 {
     updateTempoDataIfNeeded();
-    for (int i = internalTempos.size(); --i >= 0;)
-    {
-        auto& it = internalTempos.getReference (i);
 
-        if (it.startTime <= t || i == 0)
-        {
-            auto beatsSinceFirstBar = (t - it.timeOfFirstBar) * it.beatsPerSecond;
+    if (internalTempos.size() == 0)
+        return { 0, 0.0 };
 
-            if (beatsSinceFirstBar < 0)
-            {
-                if (t < 0)
-                    return { (int) std::floor (beatsSinceFirstBar / it.numerator),
-                             it.numerator - std::fmod (-beatsSinceFirstBar, it.numerator) };
+    auto& it = internalTempos.getReference (internalTempos.indexOfSectionAtTime (t));
+    auto beatsSinceFirstBar = (t - it.timeOfFirstBar) * it.beatsPerSecond;
 
-                return { it.barNumberOfFirstBar - 1,
-                         it.prevNumerator + beatsSinceFirstBar };
-            }
+    if (beatsSinceFirstBar < 0)
+    {
+        if (t < 0)
+            return { (int) std::floor (beatsSinceFirstBar / it.numerator),
+                     it.numerator - std::fmod (-beatsSinceFirstBar, it.numerator) };
 
-            return { it.barNumberOfFirstBar + (int) std::floor (beatsSinceFirstBar / it.numerator),
-                      std::fmod (beatsSinceFirstBar, it.numerator) };
-        }
+        return { it.barNumberOfFirstBar - 1,
+                 it.prevNumerator + beatsSinceFirstBar };
     }
 
-    return { 0, 0.0 };
+    return { it.barNumberOfFirstBar + (int) std::floor (beatsSinceFirstBar / it.numerator),
+              std::fmod (beatsSinceFirstBar, it.numerator) };
 }
 
 double TempoSequence::barsBeatsToTime (BarsAndBeats barsBeats) const
@@ -981,27 +1042,10 @@ TempoSequence::BarsAndBeats TempoSequencePosition::getBarsBeatsTime() const
 
 void TempoSequencePosition::setTime (double t)
 {
-    const int maxIndex = sequence.internalTempos.size() - 1;
-
-    if (maxIndex >= 0)
+    if (sequence.internalTempos.size() > 0)
     {
-        if (index > maxIndex)
-        {
-            index = maxIndex;
-            time = sequence.internalTempos.getReference (index).startTime;
-        }
-
-        if (t >= time)
-        {
-            while (index < maxIndex && sequence.internalTempos.getReference (index + 1).startTime <= t)
-                ++index;
-        }
-        else
-        {
-            while (index > 0 && sequence.internalTempos.getReference (index).startTime > t)
-                --index;
-        }
-
+        TempoSequence::TempoSections::Cursor cursor { index };
+        index = sequence.internalTempos.indexOfSectionAtTime (t, cursor);
         time = t;
     }
 }
@@ -1237,6 +1281,7 @@ public:
     {
         runPositionTests();
         runModificationTests();
+        runLookupTests();
     }
 
 private:
@@ -1362,8 +1407,123 @@ private:
             expectTempoSetting (ts.getTempoAt (3.0), 2.8, 300.0, 0.0f);
         }
     }
+
+    void runLookupTests()
+    {
+        auto edit = Edit::createSingleTrackEdit (*Engine::getEngines()[0]);
+        auto& ts = edit->tempoSequence;
+
+        for (int i = 1; i <= 100; ++i)
+            ts.insertTempo (i * 4.0, 60.0 + (i % 7) * 20.0, (i % 3) == 0 ? 0.0f : 1.0f);
+
+        ts.updateTempoData();
+        auto& sections = ts.getTempoSections();
+        const auto endTime = sections.getReference (sections.size() - 1).startTime + 10.0;
+
+        beginTest ("Cursor lookups");
+        {
+            TempoSequence::TempoSections::Cursor timeCursor, beatCursor;
+
+            for (double t = -1.0; t < endTime; t += 0.01)
+            {
+                const auto beats = sections.timeToBeats (t);
+                expectEquals (sections.timeToBeats (t, timeCursor), beats);
+                expectEquals (sections.beatsToTime (beats, beatCursor), sections.beatsToTime (beats));
+                expectWithinAbsoluteError (sections.beatsToTime (beats), t, 0.0001);
+            }
+        }
+
+        beginTest ("Non-contiguous cursor lookups");
+        {
+            TempoSequence::TempoSections::Cursor cursor;
+            auto& r = getRandom();
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                const auto t = r.nextDouble() * endTime;
+                expectEquals (sections.timeToBeats (t, cursor), sections.timeToBeats (t));
+                expect (cursor.index == 0 || sections.getReference (cursor.index).startTime <= t);
+            }
+        }
+
+        beginTest ("Positions use the cursor lookups");
+        {
+            TempoSequencePosition pos (ts);
+
+            for (double t = 0.0; t < endTime; t += 0.05)
+            {
+                pos.setTime (t);
+                expect (&pos.getCurrentTempo() == &sections.getReference (sections.indexOfSectionAtTime (t)));
+            }
+        }
+    }
 };
 
 static TempoSequenceTests tempoSequenceTests;
 
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+//==============================================================================
+//==============================================================================
+class TempoSequenceBenchmarks : public UnitTest
+{
+public:
+    TempoSequenceBenchmarks() : UnitTest ("TempoSequence Benchmarks", "tracktion_graph_performance") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        auto edit = Edit::createSingleTrackEdit (*Engine::getEngines()[0]);
+        auto& ts = edit->tempoSequence;
+
+        for (int i = 1; i <= 5000; ++i)
+            ts.insertTempo (i * 2.0, 60.0 + (i % 120), (i % 2) == 0 ? 0.0f : 1.0f);
+
+        ts.updateTempoData();
+        const auto& sections = ts.getTempoSections();
+        const auto endTime = sections.getReference (sections.size() - 1).startTime + 10.0;
+        const int numBlocks = 1000000;
+        const auto blockLength = endTime / numBlocks;
+        const auto description = String (sections.size()) + " sections, " + String (numBlocks) + " blocks";
+
+        // This is how the lookup used to be done, kept here for comparison
+        auto linearTimeToBeats = [&sections] (double time)
+        {
+            for (int i = sections.size(); --i > 0;)
+            {
+                auto& it = sections.getReference (i);
+
+                if (it.startTime <= time)
+                    return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
+            }
+
+            auto& it = sections.getReference (0);
+            return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
+        };
+
+        auto benchmark = [&] (const String& name, auto&& timeToBeats)
+        {
+            beginTest ("timeToBeats - " + name + ": " + description);
+            double total = 0.0;
+            const StopwatchTimer sw;
+
+            for (int i = 0; i < numBlocks; ++i)
+                total += timeToBeats (i * blockLength);
+
+            std::cout << sw.getDescription() << "\n";
+            expect (total > 0.0);
+        };
+
+        benchmark ("linear scan", linearTimeToBeats);
+        benchmark ("binary search", [&sections] (double t) { return sections.timeToBeats (t); });
+
+        TempoSequence::TempoSections::Cursor cursor;
+        benchmark ("cursor", [&sections, &cursor] (double t) { return sections.timeToBeats (t, cursor); });
+    }
+};
+
+static TempoSequenceBenchmarks tempoSequenceBenchmarks;
+
+#endif
+
 }
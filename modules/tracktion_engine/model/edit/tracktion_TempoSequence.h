@@ -121,8 +121,31 @@ public:
         int size() const;
         const SectionDetails& getReference (int i) const;
 
+        /** Remembers the section that was last used for a lookup.
+            Keeping one across contiguous lookups means only the current and next
+            sections need checking rather than searching the whole list.
+            TempoSequencePosition::setTime uses one, so the modifiers, plugin playheads
+            and render contexts that keep a position across blocks get this for free.
+            It's only a hint so it's safe to keep using one after the sections have changed.
+        */
+        struct Cursor
+        {
+            int index = 0;
+        };
+
+        /** Returns the index of the section the given time lies in. */
+        int indexOfSectionAtTime (double time) const;
+        int indexOfSectionAtTime (double time, Cursor&) const;
+
+        /** Returns the index of the section the given beat lies in. */
+        int indexOfSectionAtBeat (double beats) const;
+        int indexOfSectionAtBeat (double beats, Cursor&) const;
+
         double timeToBeats (double time) const;
+        double timeToBeats (double time, Cursor&) const;
+
         double beatsToTime (double beats) const;
+        double beatsToTime (double beats, Cursor&) const;
 
         /** The only modifying operation */
         void swapWith (juce::Array<SectionDetails>& newTempos);
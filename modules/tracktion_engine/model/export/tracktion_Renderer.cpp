@@ -24,26 +24,13 @@ namespace render_utils
                                                             std::atomic<float>* progressToUpdate,
                                                             juce::AudioFormatWriter::ThreadedWriter::IncomingDataReceiver* thumbnail)
     {
-        auto tracksToDo = toTrackArray (*r.edit, r.tracksToDo);
-        
         // Initialise playhead and continuity
         auto playHead = std::make_unique<tracktion_graph::PlayHead>();
         auto playHeadState = std::make_unique<tracktion_graph::PlayHeadState> (*playHead);
         auto processState = std::make_unique<ProcessState> (*playHeadState);
 
-        CreateNodeParams cnp { *processState };
-        cnp.sampleRate = r.sampleRateForAudio;
-        cnp.blockSize = r.blockSizeForAudio;
-        cnp.allowedClips = r.allowedClips.isEmpty() ? nullptr : &r.allowedClips;
-        cnp.allowedTracks = r.tracksToDo.isZero() ? nullptr : &tracksToDo;
-        cnp.forRendering = true;
-        cnp.includePlugins = r.usePlugins;
-        cnp.includeMasterPlugins = r.useMasterPlugins;
-        cnp.addAntiDenormalisationNoise = r.addAntiDenormalisationNoise;
-        cnp.includeBypassedPlugins = false;
-
         std::unique_ptr<tracktion_graph::Node> node;
-        callBlocking ([&r, &node, &cnp] { node = createNodeForEdit (*r.edit, cnp); });
+        callBlocking ([&r, &node, &processState] { node = Renderer::createNodeForRender (r, *processState); });
 
         if (! node)
             return {};
@@ -77,6 +64,53 @@ struct Ditherers
     juce::Array<Ditherer> ditherers;
 };
 
+//==============================================================================
+juce::String Renderer::Parameters::StageTimings::getDescription() const
+{
+    auto toMs = [] (double seconds) { return juce::String (seconds * 1000.0, 1) + "ms"; };
+
+    return "graph: " + toMs (graphSeconds) + " (waiting " + toMs (graphWaitSeconds) + "), "
+            + "writing: " + toMs (writeSeconds) + " (waiting " + toMs (writerWaitSeconds) + ")";
+}
+
+//==============================================================================
+std::unique_ptr<tracktion_graph::Node> Renderer::createNodeForRender (Parameters& r, ProcessState& processState)
+{
+    CreateNodeParams cnp { processState };
+    cnp.sampleRate = r.sampleRateForAudio;
+    cnp.blockSize = r.blockSizeForAudio;
+    cnp.allowedClips = r.allowedClips.isEmpty() ? nullptr : &r.allowedClips;
+    cnp.forRendering = true;
+    cnp.includePlugins = r.usePlugins;
+    cnp.includeMasterPlugins = r.useMasterPlugins;
+    cnp.addAntiDenormalisationNoise = r.addAntiDenormalisationNoise;
+    cnp.includeBypassedPlugins = false;
+
+    if (r.stems.empty())
+    {
+        auto tracksToDo = toTrackArray (*r.edit, r.tracksToDo);
+        cnp.allowedTracks = r.tracksToDo.isZero() ? nullptr : &tracksToDo;
+
+        return createNodeForEdit (*r.edit, cnp);
+    }
+
+    // Master plugins can't be shared between stems
+    jassert (! r.useMasterPlugins);
+    std::vector<juce::Array<Track*>> stemTracks;
+
+    std::vector<int> numStemChannels;
+
+    for (auto& stem : r.stems)
+        stemTracks.push_back (toTrackArray (*r.edit, stem.tracksToDo));
+
+    auto node = createNodeForEditStems (*r.edit, stemTracks, cnp, &numStemChannels);
+
+    for (size_t i = 0; i < r.stems.size(); ++i)
+        r.stems[i].numChannels = numStemChannels[i];
+
+    return node;
+}
+
 //==============================================================================
 static void addAcidInfo (Edit& edit, Renderer::Parameters& r)
 {
@@ -118,25 +152,12 @@ Renderer::RenderTask::RenderTask (const juce::String& taskDescription,
       progress (progressToUpdate == nullptr ? progressInternal : *progressToUpdate),
       sourceToUpdate (source)
 {
-    auto tracksToDo = toTrackArray (*r.edit, r.tracksToDo);
-    
     // Initialise playhead and continuity
     playHead = std::make_unique<tracktion_graph::PlayHead>();
     playHeadState = std::make_unique<tracktion_graph::PlayHeadState> (*playHead);
     processState = std::make_unique<ProcessState> (*playHeadState);
 
-    CreateNodeParams cnp { *processState };
-    cnp.sampleRate = r.sampleRateForAudio;
-    cnp.blockSize = r.blockSizeForAudio;
-    cnp.allowedClips = r.allowedClips.isEmpty() ? nullptr : &r.allowedClips;
-    cnp.allowedTracks = r.tracksToDo.isZero() ? nullptr : &tracksToDo;
-    cnp.forRendering = true;
-    cnp.includePlugins = r.usePlugins;
-    cnp.includeMasterPlugins = r.useMasterPlugins;
-    cnp.addAntiDenormalisationNoise = r.addAntiDenormalisationNoise;
-    cnp.includeBypassedPlugins = false;
-
-    callBlocking ([this, &r, &cnp] { graphNode = createNodeForEdit (*r.edit, cnp); });
+    callBlocking ([this] { graphNode = createNodeForRender (params, *processState); });
 }
 
 Renderer::RenderTask::RenderTask (const juce::String& taskDescription,
@@ -574,6 +595,7 @@ Renderer::Statistics Renderer::measureStatistics (const String& taskDescription,
             result.peak          = task->params.resultMagnitude;
             result.average       = task->params.resultRMS;
             result.audioDuration = task->params.resultAudioDuration;
+            result.timings       = task->params.resultTimings;
         }
     }
 
@@ -68,6 +68,24 @@ public:
         bool separateTracks = false;
         bool addAntiDenormalisationNoise = false;
 
+        /** A subset of the tracks to render to its own file. */
+        struct Stem
+        {
+            juce::BigInteger tracksToDo;
+            juce::File destFile;
+
+            /** Set by createNodeForRender to the number of channels the stem's tracks produce. */
+            int numChannels = 2;
+        };
+
+        /** If this isn't empty, each stem is rendered to its own file in a single pass
+            over the Edit instead of rendering tracksToDo to destFile.
+            Anything shared by the stems such as racks and aux returns is only processed
+            once. The stems mustn't have any tracks in common and master plugins can't
+            be used as there's only one instance of each of them.
+        */
+        std::vector<Stem> stems;
+
         int quality = 0;
         juce::StringPairArray metadata;
         ProjectItem::Category category = ProjectItem::Category::none;
@@ -75,6 +93,23 @@ public:
         float resultMagnitude = 0;
         float resultRMS = 0;
         float resultAudioDuration = 0;
+
+        /** The time spent in each stage of an audio render.
+            If the writers were waiting the render was bound by the graph, if the graph
+            was waiting it was bound by the encoding and disk.
+        */
+        struct StageTimings
+        {
+            double graphSeconds = 0;        /**< Processing the graph. */
+            double graphWaitSeconds = 0;    /**< The graph waiting for the writers to free a block. */
+            double writeSeconds = 0;        /**< Measuring, dithering and encoding, summed over the writer threads. */
+            double writerWaitSeconds = 0;   /**< The writers waiting for blocks from the graph, summed over the threads. */
+
+            juce::String getDescription() const;
+        };
+
+        /** Set when an audio render finishes, rather than being logged, so callers can report it. */
+        StageTimings resultTimings;
     };
 
     //==============================================================================
@@ -132,6 +167,13 @@ public:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderTask)
     };
 
+    //==============================================================================
+    /** Creates the Node to render some Parameters with.
+        If the Parameters have any stems, they'll be laid out as described by createNodeForEditStems
+        and each Stem::numChannels will be updated.
+    */
+    static std::unique_ptr<tracktion_graph::Node> createNodeForRender (Parameters&, ProcessState&);
+
     //==============================================================================
     /** Cheks a file for write access etc. and presents pop-up options to the user
         if problems occur.
@@ -166,6 +208,7 @@ public:
         float peak = 0;
         float average = 0;
         float audioDuration = 0;
+        Parameters::StageTimings timings;
     };
 
     /** Renders a section of an edit to measure various details about its audio content */
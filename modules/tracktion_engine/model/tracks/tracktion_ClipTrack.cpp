@@ -19,6 +19,7 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
           clipTrack (ct)
     {
         rebuildObjects();
+        clipTrack.edit.getEditItemIndex().invalidateClips();
 
         editLoadedCallback.reset (new Edit::LoadFinishedCallback<ClipList> (*this, ct.edit));
         clipTrack.trackItemsDirty = true;
@@ -30,6 +31,7 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
             c->setTrack (nullptr);
 
         freeObjects();
+        clipTrack.edit.getEditItemIndex().invalidateClips();
     }
 
     Clip::Ptr getClipForTree (const ValueTree& v) const
@@ -79,6 +81,8 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
 
     void objectAddedOrRemoved (Clip* c)
     {
+        clipTrack.edit.getEditItemIndex().invalidateClips();
+
         if (c == nullptr || c->type != TrackItem::Type::unknown)
         {
             clipTrack.changed();
@@ -73,11 +73,13 @@ TrackList::TrackList (Edit& e, const juce::ValueTree& parentTree)
 {
     rebuildObjects();
     rebuilding = false;
+    edit.getEditItemIndex().invalidateTracks();
 }
 
 TrackList::~TrackList()
 {
     freeObjects();
+    edit.getEditItemIndex().invalidateTracks();
 }
 
 Track* TrackList::getTrackFor (const juce::ValueTree& v) const
@@ -202,6 +204,8 @@ void TrackList::deleteObject (Track* t)
 
 void TrackList::newObjectAdded (Track* t)
 {
+    edit.getEditItemIndex().invalidateTracks();
+
     if (! edit.isLoading())
     {
         triggerAsyncUpdate();
@@ -216,10 +220,14 @@ void TrackList::newObjectAdded (Track* t)
     }
 }
 
-void TrackList::objectRemoved (Track*) {}
+void TrackList::objectRemoved (Track*)
+{
+    edit.getEditItemIndex().invalidateTracks();
+}
 
 void TrackList::objectOrderChanged()
 {
+    edit.getEditItemIndex().invalidateTracks();
     edit.updateTrackStatusesAsync();
 }
 
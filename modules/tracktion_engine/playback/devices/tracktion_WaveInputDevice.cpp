@@ -237,10 +237,10 @@ public:
     
     bool shouldTrackContentsBeMuted() override
     {
-        const ScopedLock sl (contextLock);
+        const ScopedContextUser user (*this);
 
-        return recordingContext != nullptr
-                && recordingContext->recordingWithPunch
+        return user.context != nullptr
+                && user.context->recordingWithPunch
                 && muteTrackNow
                 && getWaveInput().mergeMode == 1;
     }
@@ -250,7 +250,10 @@ public:
         const ScopedLock sl (contextLock);
 
         if (recordingContext != nullptr)
+        {
+            setActiveContext (nullptr);
             closeFileWriter (*recordingContext);
+        }
     }
 
     AudioFormat* getFormatToUse() const
@@ -304,7 +307,7 @@ public:
         return Result::ok();
     }
 
-    String prepareToRecord (double playStart, double punchIn, double sr, int /*blockSizeSamples*/, bool isLivePunch) override
+    String prepareToRecord (double playStart, double punchIn, double sr, int blockSizeSamples, bool isLivePunch) override
     {
         CRASH_TRACER
 
@@ -379,6 +382,7 @@ public:
                 }
 
                 rc->punchTimes = { punchInTime, endRecTime };
+                rc->punchInTime = punchInTime;
                 rc->hasHitThreshold = (wi.recordTriggerDb <= -50.0f);
 
                 if (edit.engine.getUIBehaviour().shouldGenerateLiveWaveformsWhenRecording())
@@ -390,8 +394,12 @@ public:
                     }
                 }
 
+                rc->queue = edit.engine.getWaveInputRecordingThread().createQueue (*rc->fileWriter, rc->thumbnail,
+                                                                                   sr, blockSizeSamples);
+
                 const ScopedLock sl (contextLock);
                 recordingContext = std::move (rc);
+                setActiveContext (recordingContext.get());
             }
             else
             {
@@ -425,7 +433,7 @@ public:
     double getPunchInTime() override
     {
         const ScopedLock sl (contextLock);
-        return recordingContext != nullptr ? recordingContext->punchTimes.getStart()
+        return recordingContext != nullptr ? recordingContext->punchInTime.load()
                                            : edit.getTransport().getTimeWhenStarted();
     }
 
@@ -444,7 +452,7 @@ public:
             return {};
 
         return context.stopRecording (*this,
-                                      { recordingContext->punchTimes.getStart(),
+                                      { recordingContext->punchInTime.load(),
                                         context.getUnloopedPosition() },
                                       false);
     }
@@ -465,6 +473,7 @@ public:
 
         {
             const ScopedLock sl (contextLock);
+            setActiveContext (nullptr);
             rc = std::move (recordingContext);
         }
 
@@ -493,6 +502,13 @@ public:
               threadInitialiser (e.getWaveInputRecordingThread())
         {}
 
+        ~RecordingContext()
+        {
+            // Make sure the writer isn't deleted while the thread is still using it
+            if (queue != nullptr)
+                engine.getWaveInputRecordingThread().waitForQueueToFinish (*queue);
+        }
+
         Engine& engine;
         File file;
         double sampleRate = 44100.0;
@@ -500,16 +516,20 @@ public:
         bool hasHitThreshold = false, firstRecCallback = false, recordingWithPunch = false;
         int adjustSamples = 0;
 
+        // The audio thread moves the start of punchTimes when the threshold is hit,
+        // this lets the message thread read it while recording
+        std::atomic<double> punchInTime { 0.0 };
+
         std::unique_ptr<AudioFileWriter> fileWriter;
         DiskSpaceCheckTask diskSpaceChecker;
         RecordingThumbnailManager::Thumbnail::Ptr thumbnail;
+        std::shared_ptr<WaveInputRecordingThread::InputQueue> queue;
         WaveInputRecordingThread::ScopedInitialiser threadInitialiser;
 
         void addBlockToRecord (const juce::AudioBuffer<float>& buffer, int start, int numSamples)
         {
-            if (fileWriter != nullptr)
-                engine.getWaveInputRecordingThread().addBlockToRecord (*fileWriter, buffer,
-                                                                       start, numSamples, thumbnail);
+            if (queue != nullptr)
+                engine.getWaveInputRecordingThread().addBlockToRecord (*queue, buffer, start, numSamples);
         }
     };
 
@@ -527,6 +547,7 @@ public:
 
         {
             const ScopedLock sl (contextLock);
+            setActiveContext (nullptr);
             rc = std::move (recordingContext);
         }
 
@@ -1042,40 +1063,42 @@ public:
                                                                             (choc::buffer::FrameCount) numSamples));
         }
 
-        const ScopedLock sl (contextLock);
+        // This is a snapshot of the context so the audio thread never waits on the message thread
+        const ScopedContextUser user (*this);
 
-        if (recordingContext != nullptr)
+        if (auto rc = user.context)
         {
             auto blockStart = context.globalStreamTimeToEditTimeUnlooped (streamTime);
-            const EditTimeRange blockRange (blockStart, blockStart + numSamples / recordingContext->sampleRate);
+            const EditTimeRange blockRange (blockStart, blockStart + numSamples / rc->sampleRate);
 
-            muteTrackNow = recordingContext->muteTimes.overlaps (blockRange);
+            muteTrackNow = rc->muteTimes.overlaps (blockRange);
 
-            if (recordingContext->punchTimes.overlaps (blockRange))
+            if (rc->punchTimes.overlaps (blockRange))
             {
-                if (! recordingContext->hasHitThreshold)
+                if (! rc->hasHitThreshold)
                 {
                     auto bufferLevelDb = gainToDb (inputBuffer.getMagnitude (0, numSamples));
-                    recordingContext->hasHitThreshold = bufferLevelDb > getWaveInput().recordTriggerDb;
+                    rc->hasHitThreshold = bufferLevelDb > getWaveInput().recordTriggerDb;
 
-                    if (! recordingContext->hasHitThreshold)
+                    if (! rc->hasHitThreshold)
                         return;
 
-                    recordingContext->punchTimes.start = blockRange.getStart();
+                    rc->punchTimes.start = blockRange.getStart();
+                    rc->punchInTime = blockRange.getStart();
 
-                    if (recordingContext->thumbnail != nullptr)
-                        recordingContext->thumbnail->punchInTime = blockRange.getStart();
+                    if (rc->thumbnail != nullptr)
+                        rc->thumbnail->punchInTime = blockRange.getStart();
                 }
 
-                if (recordingContext->firstRecCallback)
+                if (rc->firstRecCallback)
                 {
-                    recordingContext->firstRecCallback = false;
+                    rc->firstRecCallback = false;
 
-                    auto timeDiff = blockRange.getStart() - recordingContext->punchTimes.getStart();
-                    recordingContext->adjustSamples -= roundToInt (timeDiff * recordingContext->sampleRate);
+                    auto timeDiff = blockRange.getStart() - rc->punchTimes.getStart();
+                    rc->adjustSamples -= roundToInt (timeDiff * rc->sampleRate);
                 }
 
-                const int adjustSamples = recordingContext->adjustSamples;
+                const int adjustSamples = rc->adjustSamples;
 
                 if (adjustSamples < 0)
                 {
@@ -1083,26 +1106,26 @@ public:
                     AudioScratchBuffer silence (inputBuffer.getNumChannels(), -adjustSamples);
                     silence.buffer.clear();
 
-                    addBlockToRecord (silence.buffer, 0, -adjustSamples);
+                    rc->addBlockToRecord (silence.buffer, 0, -adjustSamples);
 
-                    recordingContext->adjustSamples = 0;
+                    rc->adjustSamples = 0;
                 }
                 else if (adjustSamples > 0)
                 {
                     // drop samples
                     if (adjustSamples >= numSamples)
                     {
-                        recordingContext->adjustSamples -= numSamples;
+                        rc->adjustSamples -= numSamples;
                     }
                     else
                     {
-                        addBlockToRecord (inputBuffer, adjustSamples, numSamples - adjustSamples);
-                        recordingContext->adjustSamples = 0;
+                        rc->addBlockToRecord (inputBuffer, adjustSamples, numSamples - adjustSamples);
+                        rc->adjustSamples = 0;
                     }
                 }
                 else
                 {
-                    addBlockToRecord (inputBuffer, 0, numSamples);
+                    rc->addBlockToRecord (inputBuffer, 0, numSamples);
                 }
             }
         }
@@ -1112,21 +1135,53 @@ protected:
     CriticalSection contextLock;
     std::unique_ptr<RecordingContext> recordingContext;
 
-    volatile bool muteTrackNow = false;
+    // The context the audio threads record to. The message thread changes this under the
+    // contextLock and waits until the audio threads have finished with the old one
+    std::atomic<RecordingContext*> activeContext { nullptr };
+    std::atomic<int> numActiveContextUsers { 0 };
+
+    std::atomic<bool> muteTrackNow { false };
     juce::AudioBuffer<float> inputBuffer;
 
-    void addBlockToRecord (const juce::AudioBuffer<float>& buffer, int start, int numSamples)
+    /** Takes a snapshot of the active context that stays valid until this is destroyed. */
+    struct ScopedContextUser
     {
-        const ScopedLock sl (contextLock);
-        recordingContext->addBlockToRecord (buffer, start, numSamples);
+        ScopedContextUser (WaveInputDeviceInstance& o)  : owner (o)
+        {
+            ++owner.numActiveContextUsers;
+            context = owner.activeContext.load();
+        }
+
+        ~ScopedContextUser()
+        {
+            --owner.numActiveContextUsers;
+        }
+
+        WaveInputDeviceInstance& owner;
+        RecordingContext* context = nullptr;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedContextUser)
+    };
+
+    /** Changes the context the audio threads use, returning once nothing's using the old one.
+        Callers must hold the contextLock.
+    */
+    void setActiveContext (RecordingContext* newContext)
+    {
+        activeContext = newContext;
+
+        while (numActiveContextUsers.load() > 0)
+            std::this_thread::yield();
     }
 
     static void closeFileWriter (RecordingContext& rc)
     {
         CRASH_TRACER
 
-        if (auto localCopy = std::move (rc.fileWriter))
-            rc.engine.getWaveInputRecordingThread().waitForWriterToFinish (*localCopy);
+        auto localCopy = std::move (rc.fileWriter);
+
+        if (auto queue = std::move (rc.queue))
+            rc.engine.getWaveInputRecordingThread().waitForQueueToFinish (*queue);
     }
 
     WaveInputDevice& getWaveInput() const noexcept    { return static_cast<WaveInputDevice&> (owner); }
@@ -1490,145 +1545,116 @@ void WaveInputDevice::updateRetrospectiveBufferLength (double length)
 }
 
 //==============================================================================
-struct WaveInputRecordingThread::BlockQueue
+/** Gives each input enough room for at least half a second, or a few seconds if
+    there's room for that within the total budget shared by all the inputs.
+*/
+static int getWaveInputQueueCapacity (double sampleRate, int blockSize, int numChannels, int numInputs)
 {
-    BlockQueue()
-    {
-        for (int i = 32; --i >= 0;)
-            addToFreeQueue (new QueuedBlock());
-    }
-
-    struct QueuedBlock
-    {
-        QueuedBlock() = default;
+    constexpr size_t maxTotalBytes = 64 * 1024 * 1024;
 
-        void load (AudioFileWriter& w, const juce::AudioBuffer<float>& newBuffer,
-                   int start, int numSamples, const RecordingThumbnailManager::Thumbnail::Ptr& thumb)
-        {
-            buffer.setSize (newBuffer.getNumChannels(), numSamples);
-
-            for (int i = buffer.getNumChannels(); --i >= 0;)
-                buffer.copyFrom (i, 0, newBuffer, i, start, numSamples);
+    const auto minSamples = std::max (blockSize * 16, (int) (sampleRate * 0.5));
+    const auto maxSamples = std::max (minSamples, (int) (sampleRate * 4.0));
+    const auto budgetSamples = (int) (maxTotalBytes / (sizeof (float) * (size_t) std::max (1, numChannels)
+                                                                        * (size_t) std::max (1, numInputs)));
 
-            writer = &w;
-            thumbnail = thumb;
-        }
+    return juce::jlimit (minSamples, maxSamples, budgetSamples);
+}
 
-        std::atomic<AudioFileWriter*> writer { nullptr };
-        QueuedBlock* next = nullptr;
-        juce::AudioBuffer<float> buffer { 2, 512 };
-        RecordingThumbnailManager::Thumbnail::Ptr thumbnail;
+//==============================================================================
+WaveInputRecordingThread::InputQueue::InputQueue (AudioFileWriter& w, const RecordingThumbnailManager::Thumbnail::Ptr& thumb,
+                                                  int numChannels, int capacity)
+    : writer (w), thumbnail (thumb),
+      fifo (capacity + 1),
+      buffer (std::max (1, numChannels), capacity + 1)
+{
+    buffer.clear();
+}
 
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (QueuedBlock)
-    };
+WaveInputRecordingThread::InputQueue::~InputQueue()
+{
+}
 
-    CriticalSection freeQueueLock, pendingQueueLock;
-    QueuedBlock* firstPending = nullptr;
-    QueuedBlock* lastPending = nullptr;
-    QueuedBlock* firstFree = nullptr;
-    std::atomic<int> numPending { 0 };
+bool WaveInputRecordingThread::InputQueue::push (const juce::AudioBuffer<float>& source, int start, int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return true;
 
-    QueuedBlock* findFreeBlock()
+    if (fifo.getFreeSpace() < numSamples)
     {
-        const ScopedLock sl (freeQueueLock);
-
-        if (firstFree == nullptr)
-            return new QueuedBlock();
-
-        auto* b = firstFree;
-        firstFree = b->next;
-        b->next = nullptr;
-        return b;
+        numOverruns.fetch_add (1, std::memory_order_relaxed);
+        return false;
     }
 
-    void addToFreeQueue (QueuedBlock* b) noexcept
-    {
-        jassert (b != nullptr);
-        const ScopedLock sl (freeQueueLock);
-        b->writer = nullptr;
-        b->next = firstFree;
-        firstFree = b;
-    }
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+    const auto numSourceChannels = std::min (buffer.getNumChannels(), source.getNumChannels());
 
-    void addToPendingQueue (QueuedBlock* b) noexcept
+    for (int i = 0; i < buffer.getNumChannels(); ++i)
     {
-        jassert (b != nullptr);
-        b->next = nullptr;
-        const ScopedLock sl (pendingQueueLock);
-
-        if (lastPending != nullptr)
-            lastPending->next = b;
+        if (i < numSourceChannels)
+        {
+            if (size1 > 0)  buffer.copyFrom (i, start1, source, i, start, size1);
+            if (size2 > 0)  buffer.copyFrom (i, start2, source, i, start + size1, size2);
+        }
         else
-            firstPending = b;
-
-        lastPending = b;
-        ++numPending;
+        {
+            if (size1 > 0)  buffer.clear (i, start1, size1);
+            if (size2 > 0)  buffer.clear (i, start2, size2);
+        }
     }
 
-    QueuedBlock* removeFirstPending() noexcept
-    {
-        const ScopedLock sl (pendingQueueLock);
+    fifo.finishedWrite (size1 + size2);
 
-        if (auto b = firstPending)
-        {
-            firstPending = b->next;
+    const auto numReady = fifo.getNumReady();
 
-            if (firstPending == nullptr)
-                lastPending = nullptr;
+    if (numReady > peakNumReady.load (std::memory_order_relaxed))
+        peakNumReady.store (numReady, std::memory_order_relaxed);
 
-            --numPending;
-            return b;
-        }
+    return true;
+}
 
-        return {};
-    }
+bool WaveInputRecordingThread::InputQueue::write (bool& writeFailed)
+{
+    const ScopedLock sl (writeLock);
+    const auto numReady = fifo.getNumReady();
 
-    void moveAnyPendingBlocksToFree() noexcept
-    {
-        while (auto b = removeFirstPending())
-            addToFreeQueue (b);
+    if (numReady == 0)
+        return false;
 
-        jassert (numPending == 0);
-        numPending = 0;
-    }
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numReady, start1, size1, start2, size2);
 
-    bool isWriterInQueue (AudioFileWriter& writer) const
+    for (auto region : { juce::Range<int>::withStartAndLength (start1, size1),
+                         juce::Range<int>::withStartAndLength (start2, size2) })
     {
-        const ScopedLock sl (pendingQueueLock);
+        if (region.isEmpty())
+            continue;
 
-        for (auto b = firstPending; b != nullptr; b = b->next)
-            if (b->writer == &writer)
-                return true;
+        // References the queue's buffer so nothing is copied
+        juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                        region.getStart(), region.getLength());
 
-        return false;
-    }
+        if (! writer.appendBuffer (block, block.getNumSamples()))
+            writeFailed = true;
 
-    void deleteFreeQueue() noexcept
-    {
-        auto b = firstFree;
-        firstFree = nullptr;
-
-        while (b != nullptr)
-        {
-            std::unique_ptr<QueuedBlock> toDelete (b);
-            b = b->next;
-        }
+        if (thumbnail != nullptr)
+            thumbnail->addBlock (block, 0, block.getNumSamples());
     }
-};
+
+    fifo.finishedRead (size1 + size2);
+    return true;
+}
 
 //==============================================================================
 WaveInputRecordingThread::WaveInputRecordingThread (Engine& e)
     : Thread ("WaveInputRecordingThread"),
-      engine (e),
-      queue (new BlockQueue())
+      engine (e)
 {
 }
 
 WaveInputRecordingThread::~WaveInputRecordingThread()
 {
     flushAndStop();
-    queue->deleteFreeQueue();
-    queue.reset();
 }
 
 void WaveInputRecordingThread::addUser()
@@ -1644,63 +1670,112 @@ void WaveInputRecordingThread::removeUser()
 }
 
 //==============================================================================
-void WaveInputRecordingThread::addBlockToRecord (AudioFileWriter& writer, const juce::AudioBuffer<float>& buffer,
-                                                 int start, int numSamples, const RecordingThumbnailManager::Thumbnail::Ptr& thumbnail)
+std::shared_ptr<WaveInputRecordingThread::InputQueue> WaveInputRecordingThread::createQueue (AudioFileWriter& writer,
+                                                                                             const RecordingThumbnailManager::Thumbnail::Ptr& thumbnail,
+                                                                                             double sampleRate, int blockSize)
 {
+    const auto numChannels = writer.getNumChannels();
+    const auto numInputs = engine.getDeviceManager().getNumWaveInDevices();
+
+    auto queue = std::make_shared<InputQueue> (writer, thumbnail, numChannels,
+                                               getWaveInputQueueCapacity (sampleRate, blockSize, numChannels, numInputs));
+
+    const ScopedLock sl (queuesLock);
+    queues.push_back (queue);
+
+    return queue;
+}
+
+void WaveInputRecordingThread::addBlockToRecord (InputQueue& queue, const juce::AudioBuffer<float>& buffer,
+                                                 int start, int numSamples)
+{
+    // The writer polls the queues so there's no need to notify it from the audio thread
     if (! threadShouldExit())
+        queue.push (buffer, start, numSamples);
+}
+
+void WaveInputRecordingThread::waitForQueueToFinish (InputQueue& queue)
+{
+    queue.isFinishing = true;
+    notify();
+
+    while (! queue.finishedEvent.wait (200))
     {
-        auto block = queue->findFreeBlock();
-        block->load (writer, buffer, start, numSamples, thumbnail);
-        queue->addToPendingQueue (block);
-        notify();
+        // If the thread has stopped nothing else will write the queue
+        if (! isThreadRunning())
+        {
+            bool writeFailed = false;
+            queue.write (writeFailed);
+            break;
+        }
     }
+
+    const ScopedLock sl (queuesLock);
+    queues.erase (std::remove_if (queues.begin(), queues.end(),
+                                  [&queue] (auto& q) { return q.get() == &queue; }),
+                  queues.end());
 }
 
-void WaveInputRecordingThread::waitForWriterToFinish (AudioFileWriter& writer)
+std::vector<std::shared_ptr<WaveInputRecordingThread::InputQueue>> WaveInputRecordingThread::getQueues() const
 {
-    while (queue->isWriterInQueue (writer) && isThreadRunning())
-        Thread::sleep (2);
+    const ScopedLock sl (queuesLock);
+    return queues;
 }
 
+//==============================================================================
 void WaveInputRecordingThread::run()
 {
     CRASH_TRACER
     FloatVectorOperations::disableDenormalisedNumberSupport();
 
+    std::vector<std::shared_ptr<InputQueue>> queuesToWrite;
+
     for (;;)
     {
-        if (queue->numPending > 500 && ! hasWarned)
+        {
+            const ScopedLock sl (queuesLock);
+            queuesToWrite = queues;
+        }
+
+        bool hasWritten = false, writeFailed = false;
+        int numOverruns = 0;
+
+        for (auto& queue : queuesToWrite)
+        {
+            if (queue->write (writeFailed))
+                hasWritten = true;
+
+            numOverruns += queue->getNumOverruns();
+
+            if (queue->isFinishing && queue->getNumReady() == 0)
+                queue->finishedEvent.signal();
+        }
+
+        queuesToWrite.clear();
+
+        if (numOverruns > 0 && ! hasWarned)
         {
             hasWarned = true;
             TRACKTION_LOG_ERROR ("Audio recording can't keep up!");
         }
 
-        if (auto block = queue->removeFirstPending())
+        if (writeFailed && ! hasSentStop)
         {
-            if (! block->writer.load()->appendBuffer (block->buffer, block->buffer.getNumSamples()))
-            {
-                if (! hasSentStop)
-                {
-                    hasSentStop = true;
-                    TRACKTION_LOG_ERROR ("Audio recording failed to write to disk!");
-                    startTimer (1);
-                }
-            }
-
-            if (block->thumbnail != nullptr)
-            {
-                block->thumbnail->addBlock (block->buffer, 0, block->buffer.getNumSamples());
-                block->thumbnail = nullptr;
-            }
+            hasSentStop = true;
+            TRACKTION_LOG_ERROR ("Audio recording failed to write to disk!");
+            startTimer (1);
+        }
 
-            queue->addToFreeQueue (block);
+        if (threadShouldExit())
+        {
+            // Keep going until everything's been written
+            if (! hasWritten)
+                break;
         }
         else
         {
-            if (threadShouldExit())
-                break;
-
-            wait (401);
+            // Waiting between passes lets the blocks build up so they're written in larger chunks
+            wait (10);
         }
     }
 }
@@ -1724,9 +1799,20 @@ void WaveInputRecordingThread::flushAndStop()
     signalThreadShouldExit();
     notify();
     stopThread (30000);
-    queue->moveAnyPendingBlocksToFree();
+    finishAllQueues();
     hasSentStop = false;
     hasWarned = false;
 }
 
+void WaveInputRecordingThread::finishAllQueues()
+{
+    const ScopedLock sl (queuesLock);
+
+    // The thread will have written everything before stopping so release anyone waiting
+    for (auto& queue : queues)
+        queue->finishedEvent.signal();
+
+    queues.clear();
+}
+
 }
@@ -108,6 +108,13 @@ private:
 
 
 //==============================================================================
+/**
+    Writes the audio recorded from WaveInputDevices to disk.
+
+    Each recording gets its own InputQueue which the audio thread pushes blocks in
+    to without locking or allocating. This thread periodically drains each queue,
+    writing everything that's waiting in as few writes as possible.
+*/
 class WaveInputRecordingThread  : public juce::Thread,
                                   private juce::Timer
 {
@@ -129,9 +136,83 @@ public:
     void removeUser();
 
     //==============================================================================
-    void addBlockToRecord (AudioFileWriter&, const juce::AudioBuffer<float>&,
-                           int start, int numSamples, const RecordingThumbnailManager::Thumbnail::Ptr&);
-    void waitForWriterToFinish (AudioFileWriter&);
+    /**
+        A single producer, single consumer FIFO of the audio waiting to be written
+        for one input. Use createQueue to create one.
+    */
+    class InputQueue
+    {
+    public:
+        /** Creates a queue that can hold a number of samples for a writer.
+            You'd normally use WaveInputRecordingThread::createQueue rather than calling this directly.
+        */
+        InputQueue (AudioFileWriter&, const RecordingThumbnailManager::Thumbnail::Ptr&,
+                    int numChannels, int capacity);
+
+        /** Destructor. */
+        ~InputQueue();
+
+        /** Copies a block in to the queue. This is real-time safe and should only be
+            called from one thread at a time.
+            If there isn't room for the whole block, it's dropped, counted as an overrun
+            and this returns false.
+        */
+        bool push (const juce::AudioBuffer<float>&, int start, int numSamples) noexcept;
+
+        /** Writes everything in the queue to the writer and thumbnail.
+            Returns true if anything was written and sets writeFailed if the writer failed.
+        */
+        bool write (bool& writeFailed);
+
+        /** Returns the number of samples the queue can hold. */
+        int getCapacity() const noexcept                { return fifo.getTotalSize() - 1; }
+
+        /** Returns the number of samples waiting to be written. */
+        int getNumReady() const noexcept                { return fifo.getNumReady(); }
+
+        /** Returns how full the queue is, from 0 to 1. */
+        float getFillLevel() const noexcept             { return getNumReady() / (float) getCapacity(); }
+
+        /** Returns the fullest the queue has been, from 0 to 1. */
+        float getPeakFillLevel() const noexcept         { return peakNumReady.load (std::memory_order_relaxed) / (float) getCapacity(); }
+
+        /** Returns the number of blocks that were dropped because the queue was full. */
+        int getNumOverruns() const noexcept             { return numOverruns.load (std::memory_order_relaxed); }
+
+    private:
+        friend class WaveInputRecordingThread;
+
+        AudioFileWriter& writer;
+        const RecordingThumbnailManager::Thumbnail::Ptr thumbnail;
+        juce::AbstractFifo fifo;
+        juce::AudioBuffer<float> buffer;
+        std::atomic<int> numOverruns { 0 }, peakNumReady { 0 };
+        std::atomic<bool> isFinishing { false };
+        juce::WaitableEvent finishedEvent { true };
+        juce::CriticalSection writeLock;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InputQueue)
+    };
+
+    /** Creates a queue to record to a writer.
+        The queue is sized from the device's sample rate and block size and the number
+        of inputs that could be recording at once.
+    */
+    std::shared_ptr<InputQueue> createQueue (AudioFileWriter&, const RecordingThumbnailManager::Thumbnail::Ptr&,
+                                             double sampleRate, int blockSize);
+
+    /** Adds a block to a queue. This is real-time safe.
+        If the queue is full, the block is dropped and counted as an overrun.
+    */
+    void addBlockToRecord (InputQueue&, const juce::AudioBuffer<float>&, int start, int numSamples);
+
+    /** Blocks until all the audio in a queue has been written, then stops writing it. */
+    void waitForQueueToFinish (InputQueue&);
+
+    /** Returns the queues currently being written, e.g. to display their fill levels. */
+    std::vector<std::shared_ptr<InputQueue>> getQueues() const;
+
+    //==============================================================================
     void run() override;
     void timerCallback() override;
 
@@ -141,11 +222,12 @@ private:
     int activeUsers = 0;
     bool hasWarned = false, hasSentStop = false;
 
-    struct BlockQueue;
-    std::unique_ptr<BlockQueue> queue;
+    juce::CriticalSection queuesLock;
+    std::vector<std::shared_ptr<InputQueue>> queues;
 
     void prepareToStart();
     void flushAndStop();
+    void finishAllQueues();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveInputRecordingThread)
 };
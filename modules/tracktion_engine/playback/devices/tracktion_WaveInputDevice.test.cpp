@@ -0,0 +1,172 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if TRACKTION_UNIT_TESTS
+
+//==============================================================================
+//==============================================================================
+class WaveInputQueueTests  : public juce::UnitTest
+{
+public:
+    WaveInputQueueTests()
+        : juce::UnitTest ("WaveInputQueue", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines().getFirst();
+
+        beginTest ("Blocks are written in order when the queue wraps around");
+        {
+            constexpr int capacity = 100, blockSize = 30;
+            juce::TemporaryFile tempFile (".wav");
+            int numSamplesPushed = 0;
+
+            {
+                auto writer = createWriter (engine, tempFile.getFile());
+                WaveInputRecordingThread::InputQueue queue (*writer, nullptr, numChannels, capacity);
+                expectEquals (queue.getCapacity(), capacity);
+
+                bool writeFailed = false;
+                expect (! queue.write (writeFailed));
+
+                // Pushing three blocks at a time then writing them means the
+                // start of the queue moves on by 90 samples each pass
+                for (int pass = 0; pass < 10; ++pass)
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        expect (queue.push (createRamp (numSamplesPushed, blockSize), 0, blockSize));
+                        numSamplesPushed += blockSize;
+                    }
+
+                    expectEquals (queue.getNumReady(), 3 * blockSize);
+                    expect (queue.write (writeFailed));
+                    expectEquals (queue.getNumReady(), 0);
+                }
+
+                // Part of a block
+                expect (queue.push (createRamp (numSamplesPushed - 10, blockSize), 10, blockSize - 10));
+                numSamplesPushed += blockSize - 10;
+                expect (queue.write (writeFailed));
+
+                expect (! writeFailed);
+                expectEquals (queue.getNumOverruns(), 0);
+                expectWithinAbsoluteError (queue.getPeakFillLevel(), 0.9f, 0.001f);
+            }
+
+            expectRamp (tempFile.getFile(), numSamplesPushed);
+        }
+
+        beginTest ("Blocks that don't fit are dropped and counted");
+        {
+            constexpr int capacity = 100, blockSize = 40;
+            juce::TemporaryFile tempFile (".wav");
+            int numSamplesPushed = 0;
+
+            {
+                auto writer = createWriter (engine, tempFile.getFile());
+                WaveInputRecordingThread::InputQueue queue (*writer, nullptr, numChannels, capacity);
+
+                expect (queue.push (createRamp (0, blockSize), 0, blockSize));
+                expect (queue.push (createRamp (blockSize, blockSize), 0, blockSize));
+                numSamplesPushed += 2 * blockSize;
+
+                // Only 20 samples free so this whole block is dropped
+                expect (! queue.push (createRamp (-1000, blockSize), 0, blockSize));
+                expectEquals (queue.getNumOverruns(), 1);
+                expectEquals (queue.getNumReady(), 2 * blockSize);
+
+                // A block that fits exactly is still accepted
+                expect (queue.push (createRamp (numSamplesPushed, 20), 0, 20));
+                numSamplesPushed += 20;
+                expectEquals (queue.getNumReady(), capacity);
+                expectEquals (queue.getFillLevel(), 1.0f);
+
+                expect (! queue.push (createRamp (-1000, 1), 0, 1));
+                expectEquals (queue.getNumOverruns(), 2);
+
+                // Once written there's room again and the dropped blocks don't appear in the file
+                bool writeFailed = false;
+                expect (queue.write (writeFailed));
+                expect (queue.push (createRamp (numSamplesPushed, blockSize), 0, blockSize));
+                numSamplesPushed += blockSize;
+                expect (queue.write (writeFailed));
+
+                expect (! writeFailed);
+                expectEquals (queue.getNumOverruns(), 2);
+                expectEquals (queue.getPeakFillLevel(), 1.0f);
+            }
+
+            expectRamp (tempFile.getFile(), numSamplesPushed);
+        }
+    }
+
+private:
+    static constexpr int numChannels = 2;
+    static constexpr double sampleRate = 44100.0;
+
+    static std::unique_ptr<AudioFileWriter> createWriter (Engine& engine, const juce::File& file)
+    {
+        return std::make_unique<AudioFileWriter> (AudioFile (engine, file), engine.getAudioFileFormatManager().getWavFormat(),
+                                                  numChannels, sampleRate, 32, juce::StringPairArray(), 0);
+    }
+
+    /** Returns a block where each sample holds its index in the recording, negated on the second channel. */
+    static juce::AudioBuffer<float> createRamp (int startIndex, int numSamples)
+    {
+        juce::AudioBuffer<float> buffer (numChannels, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            buffer.setSample (0, i, getRampSample (startIndex + i));
+            buffer.setSample (1, i, -getRampSample (startIndex + i));
+        }
+
+        return buffer;
+    }
+
+    static float getRampSample (int index)
+    {
+        return index / 1024.0f;
+    }
+
+    void expectRamp (const juce::File& file, int numSamplesExpected)
+    {
+        auto& formatManager = Engine::getEngines().getFirst()->getAudioFileFormatManager().readFormatManager;
+        std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+        expect (reader != nullptr);
+
+        if (reader == nullptr)
+            return;
+
+        expectEquals (reader->lengthInSamples, (juce::int64) numSamplesExpected);
+
+        juce::AudioBuffer<float> buffer (numChannels, (int) reader->lengthInSamples);
+        reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        int numWrong = 0;
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            if (buffer.getSample (0, i) != getRampSample (i) || buffer.getSample (1, i) != -getRampSample (i))
+                ++numWrong;
+
+        expectEquals (numWrong, 0, "Samples written out of order");
+    }
+};
+
+static WaveInputQueueTests waveInputQueueTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -0,0 +1,178 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+
+#include "tracktion_BenchmarkUtilities.h"
+
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class ConcurrentContextBenchmarks : public juce::UnitTest
+{
+public:
+    ConcurrentContextBenchmarks()
+        : juce::UnitTest ("Concurrent Context Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+        engine.getPluginManager().createBuiltInType<ToneGeneratorPlugin>();
+
+        for (int numEdits : { 4, 8 })
+            runContextTest (engine, numEdits, 16);
+    }
+
+    void runContextTest (Engine& engine, int numEdits, int numTracks)
+    {
+        using namespace benchmark_utilities;
+        using namespace tracktion_graph;
+
+        constexpr int numBlocks = 2000;
+
+        // Each Edit has a number of tracks playing a sin wave through a few plugins
+        std::vector<std::unique_ptr<Edit>> edits;
+
+        for (int i = 0; i < numEdits; ++i)
+        {
+            auto edit = Edit::createSingleTrackEdit (engine);
+            edit->ensureNumberOfAudioTracks (numTracks);
+
+            for (auto track : getAudioTracks (*edit))
+            {
+                track->pluginList.insertPlugin (edit->getPluginCache().createNewPlugin (ToneGeneratorPlugin::xmlTypeName, {}), 0, nullptr);
+                track->pluginList.insertPlugin (edit->getPluginCache().createNewPlugin (ReverbPlugin::xmlTypeName, {}), 1, nullptr);
+            }
+
+            edits.push_back (std::move (edit));
+        }
+
+        struct Context
+        {
+            Context (Edit& e, LockFreeMultiThreadedNodePlayer::ThreadPoolCreator poolCreator, int numThreads)
+                : edit (e), player (processState, std::move (poolCreator))
+            {
+                player.setNumThreads ((size_t) numThreads);
+                player.setNode (createNode (edit, processState, sampleRate, blockSize), sampleRate, blockSize);
+                playHead.playSyncedToRange ({ 0, std::numeric_limits<int64_t>::max() });
+            }
+
+            ~Context()
+            {
+                player.clearNode();
+            }
+
+            void process()
+            {
+                audio.clear();
+                midi.clear();
+                const auto range = juce::Range<int64_t>::withStartAndLength (referenceSamplePosition, blockSize);
+                player.process ({ range, { audio.getView(), midi } });
+                referenceSamplePosition += blockSize;
+            }
+
+            Edit& edit;
+            PlayHead playHead;
+            PlayHeadState playHeadState { playHead };
+            ProcessState processState { playHeadState };
+            TracktionNodePlayer player;
+            choc::buffer::ChannelArrayBuffer<float> audio { 2, (choc::buffer::FrameCount) blockSize };
+            MidiMessageArray midi;
+            int64_t referenceSamplePosition = 0;
+        };
+
+        const int numThreads = std::max (1, juce::SystemStats::getNumCpus() - 1);
+        const auto description = String (numEdits) + " Edits, " + String (numTracks) + " tracks";
+
+        auto runBlocks = [&] (const juce::String& name, std::vector<std::unique_ptr<Context>>& contexts,
+                              std::function<void()> processContexts)
+        {
+            beginTest (name + ": " + description);
+
+            std::vector<double> blockSeconds;
+            blockSeconds.reserve ((size_t) numBlocks);
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                const StopwatchTimer blockTimer;
+                processContexts();
+                blockSeconds.push_back (blockTimer.getSeconds());
+            }
+
+            std::sort (blockSeconds.begin(), blockSeconds.end());
+            double totalSeconds = 0.0;
+
+            for (auto s : blockSeconds)
+                totalSeconds += s;
+
+            std::cout << name << ": average block " << String (totalSeconds * 1.0e6 / numBlocks, 2) << "us, "
+                      << "99th percentile " << String (blockSeconds[(size_t) (numBlocks * 99 / 100)] * 1.0e6, 2) << "us, "
+                      << "max " << String (blockSeconds.back() * 1.0e6, 2) << "us\n";
+
+            for (auto& c : contexts)
+                expectEquals<int64_t> (c->referenceSamplePosition, (int64_t) numBlocks * blockSize);
+        };
+
+        // Each player has its own threads and they are processed one after the other
+        {
+            std::vector<std::unique_ptr<Context>> contexts;
+
+            for (auto& edit : edits)
+                contexts.push_back (std::make_unique<Context> (*edit, getPoolCreatorFunction (ThreadPoolStrategy::lightweightSemHybrid), numThreads));
+
+            runBlocks ("Sequential, separate pools", contexts, [&]
+                       {
+                           for (auto& c : contexts)
+                               c->process();
+                       });
+        }
+
+        // The players share one pool which also processes them concurrently
+        {
+            SharedNodePlayerThreadPool sharedPool ((size_t) numThreads);
+            std::vector<std::unique_ptr<Context>> contexts;
+
+            for (auto& edit : edits)
+                contexts.push_back (std::make_unique<Context> (*edit, sharedPool.getPoolCreatorFunction(), numThreads));
+
+            runBlocks ("Sequential, shared pool", contexts, [&]
+                       {
+                           for (auto& c : contexts)
+                               c->process();
+                       });
+
+            runBlocks ("Concurrent, shared pool", contexts, [&]
+                       {
+                           sharedPool.runTasks (contexts.size(), [&] (size_t i) { contexts[i]->process(); });
+                       });
+
+            // The players must be removed before the pool
+            contexts.clear();
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 44100.0;
+    static constexpr int blockSize = 256;
+};
+
+static ConcurrentContextBenchmarks concurrentContextBenchmarks;
+
+}
+
+#endif
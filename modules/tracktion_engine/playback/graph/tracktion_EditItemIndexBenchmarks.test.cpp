@@ -0,0 +1,129 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+
+#include "tracktion_BenchmarkUtilities.h"
+
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class EditItemIndexBenchmarks : public juce::UnitTest
+{
+public:
+    EditItemIndexBenchmarks()
+        : juce::UnitTest ("Edit Item Index Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        runLookupTest (engine, 200, 20, 3);
+    }
+
+    //==============================================================================
+    /** These find items the way the Edit utilities did before they used the EditItemIndex. */
+    static Track* walkForTrack (const Edit& edit, EditItemID id)
+    {
+        Track* result = nullptr;
+
+        edit.visitAllTracksRecursive ([&] (Track& t)
+                                      {
+                                          if (t.itemID == id)
+                                              result = &t;
+
+                                          return result == nullptr;
+                                      });
+
+        return result;
+    }
+
+    static Clip* walkForClip (const Edit& edit, EditItemID id)
+    {
+        Clip* result = nullptr;
+
+        edit.visitAllTracksRecursive ([&] (Track& t)
+                                      {
+                                          result = t.findClipForID (id);
+                                          return result == nullptr;
+                                      });
+
+        return result;
+    }
+
+    //==============================================================================
+    void runLookupTest (Engine& engine, int numTracks, int numClipsPerTrack, int numPluginsPerTrack)
+    {
+        using namespace benchmark_utilities;
+        using namespace tracktion_graph;
+
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (numTracks);
+
+        for (auto track : getAudioTracks (*edit))
+        {
+            for (int i = 0; i < numClipsPerTrack; ++i)
+                track->insertMIDIClip ({ i * 2.0, i * 2.0 + 1.0 }, nullptr);
+
+            for (int i = 0; i < numPluginsPerTrack; ++i)
+                track->pluginList.insertPlugin (edit->getPluginCache().createNewPlugin (EqualiserPlugin::xmlTypeName, {}), -1, nullptr);
+        }
+
+        const auto description = String (numTracks) + " tracks, "
+                                  + String (numTracks * numClipsPerTrack) + " clips";
+
+        // Look up every clip and track as things like selection and undo restore do
+        juce::Array<EditItemID> clipIDs, trackIDs;
+
+        for (auto c : edit->getEditItemIndex().getAllClips())
+            clipIDs.add (c->itemID);
+
+        for (auto t : getAllTracks (*edit))
+            trackIDs.add (t->itemID);
+
+        auto runLookups = [&] (const juce::String& name, std::function<Track*(EditItemID)> findTrack, std::function<Clip*(EditItemID)> findClip)
+        {
+            beginTest (name + ": " + description);
+
+            int numFound = 0;
+            const StopwatchTimer timer;
+
+            for (auto id : trackIDs)
+                numFound += findTrack (id) != nullptr ? 1 : 0;
+
+            for (auto id : clipIDs)
+                numFound += findClip (id) != nullptr ? 1 : 0;
+
+            std::cout << name << ": " << timer.getDescription() << "\n";
+            expectEquals (numFound, trackIDs.size() + clipIDs.size());
+        };
+
+        runLookups ("Walked lookups",
+                    [&] (EditItemID id) { return walkForTrack (*edit, id); },
+                    [&] (EditItemID id) { return walkForClip (*edit, id); });
+        runLookups ("Indexed lookups",
+                    [&] (EditItemID id) { return findTrackForID (*edit, id); },
+                    [&] (EditItemID id) { return findClipForID (*edit, id); });
+    }
+};
+
+static EditItemIndexBenchmarks editItemIndexBenchmarks;
+
+}
+
+#endif
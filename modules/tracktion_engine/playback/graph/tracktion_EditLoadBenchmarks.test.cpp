@@ -0,0 +1,201 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+
+#include "tracktion_BenchmarkUtilities.h"
+
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class EditLoadBenchmarks : public juce::UnitTest
+{
+public:
+    EditLoadBenchmarks()
+        : juce::UnitTest ("Edit Load Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        runLoadTest (engine, 100, 0);
+        runLoadTest (engine, 100, 2);
+    }
+
+    //==============================================================================
+    /** A plugin instance that does some work when it's created and has its state restored,
+        similar to building the wavetables or loading the samples of a real plugin.
+    */
+    struct SlowLoadingInstance  : public juce::AudioPluginInstance
+    {
+        SlowLoadingInstance()                                               { buildTable(); }
+
+        void fillInPluginDescription (juce::PluginDescription& d) const override  { d = getDescription(); }
+        const juce::String getName() const override                         { return "Slow Loading"; }
+        void prepareToPlay (double, int) override                           {}
+        void releaseResources() override                                    {}
+        void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+        double getTailLengthSeconds() const override                        { return 0.0; }
+        bool acceptsMidi() const override                                   { return false; }
+        bool producesMidi() const override                                  { return false; }
+        juce::AudioProcessorEditor* createEditor() override                 { return nullptr; }
+        bool hasEditor() const override                                     { return false; }
+        int getNumPrograms() override                                       { return 1; }
+        int getCurrentProgram() override                                    { return 0; }
+        void setCurrentProgram (int) override                               {}
+        const juce::String getProgramName (int) override                    { return {}; }
+        void changeProgramName (int, const juce::String&) override          {}
+
+        void getStateInformation (juce::MemoryBlock& mb) override
+        {
+            mb.append (&tableSize, sizeof (tableSize));
+        }
+
+        void setStateInformation (const void* data, int size) override
+        {
+            if (size >= (int) sizeof (tableSize))
+            {
+                std::memcpy (&tableSize, data, sizeof (tableSize));
+                buildTable();
+            }
+        }
+
+        static juce::PluginDescription getDescription()
+        {
+            juce::PluginDescription d;
+            d.name = "Slow Loading";
+            d.pluginFormatName = "LoadBenchmark";
+            d.fileOrIdentifier = "LoadBenchmark";
+            d.uniqueId = 0x10adbe4c;
+            d.numInputChannels = 2;
+            d.numOutputChannels = 2;
+            return d;
+        }
+
+        void buildTable()
+        {
+            table.resize ((size_t) tableSize);
+
+            for (size_t i = 0; i < table.size(); ++i)
+                table[i] = std::sin ((float) i * juce::MathConstants<float>::twoPi / (float) table.size())
+                            + 0.5f * std::sin ((float) i * juce::MathConstants<float>::twoPi * 3.0f / (float) table.size());
+        }
+
+        int tableSize = 1 << 18;
+        std::vector<float> table;
+    };
+
+    //==============================================================================
+    void runLoadTest (Engine& engine, int numTracks, int numExternalPluginsPerTrack)
+    {
+        using namespace benchmark_utilities;
+
+        auto& pluginManager = engine.getPluginManager();
+        const auto slowDesc = SlowLoadingInstance::getDescription();
+
+        pluginManager.knownPluginList.addType (slowDesc);
+        auto oldCreateFunction = pluginManager.createPluginInstance;
+        pluginManager.createPluginInstance = [oldCreateFunction] (const juce::PluginDescription& d, double rate, int blockSize, juce::String& error)
+                                             -> std::unique_ptr<juce::AudioPluginInstance>
+        {
+            if (d.pluginFormatName == "LoadBenchmark")
+                return std::make_unique<SlowLoadingInstance>();
+
+            return oldCreateFunction (d, rate, blockSize, error);
+        };
+
+        // Each track has some internal plugins with automation and a few slow loading plugins
+        juce::ValueTree editState;
+
+        {
+            auto edit = Edit::createSingleTrackEdit (engine);
+            edit->ensureNumberOfAudioTracks (numTracks);
+
+            for (auto track : getAudioTracks (*edit))
+            {
+                auto& pluginCache = edit->getPluginCache();
+
+                for (auto type : { EqualiserPlugin::xmlTypeName, CompressorPlugin::xmlTypeName, ReverbPlugin::xmlTypeName })
+                {
+                    auto plugin = pluginCache.createNewPlugin (type, {});
+                    track->pluginList.insertPlugin (plugin, -1, nullptr);
+
+                    for (auto param : plugin->getAutomatableParameters())
+                        for (int i = 0; i < 50; ++i)
+                            param->getCurve().addPoint (i * 0.5, (float) ((i % 4) / 4.0), 0.0f);
+                }
+
+                for (int i = 0; i < numExternalPluginsPerTrack; ++i)
+                    track->pluginList.insertPlugin (ExternalPlugin::create (engine, slowDesc), -1);
+            }
+
+            edit->flushState();
+            editState = edit->state.createCopy();
+        }
+
+        const auto description = String (numTracks) + " tracks, "
+                                  + String (numExternalPluginsPerTrack * numTracks) + " slow loading plugins";
+
+        auto loadEdit = [&] (bool concurrently, Edit::LoadContext& loadContext)
+        {
+            Edit::Options options { engine, editState.createCopy(), ProjectItemID::createNewID (0) };
+            options.loadContext = &loadContext;
+            options.numUndoLevelsToStore = 0;
+            options.loadConcurrently = concurrently;
+
+            return std::make_unique<Edit> (options);
+        };
+
+        for (bool concurrently : { false, true })
+        {
+            const juce::String name (concurrently ? "Concurrent load" : "Sequential load");
+            beginTest (name + ": " + description);
+
+            Edit::LoadContext loadContext;
+            const StopwatchTimer timer;
+            auto edit = loadEdit (concurrently, loadContext);
+            std::cout << name << ": " << timer.getDescription() << "\n";
+
+            expect (loadContext.completed);
+            expectWithinAbsoluteError (loadContext.progress.load(), 1.0f, 0.0001f);
+
+            if (concurrently)
+                expectEquals (loadContext.numPluginsLoaded.load(), numTracks * numExternalPluginsPerTrack);
+
+            // The results are checked in the ConcurrentEditLoad unit tests, this just
+            // makes sure the timing includes loading the slow plugins
+            int numSlowPluginsLoaded = 0;
+
+            for (auto p : getAllPlugins (*edit, false))
+                if (auto ep = dynamic_cast<ExternalPlugin*> (p))
+                    if (dynamic_cast<SlowLoadingInstance*> (ep->getAudioPluginInstance()) != nullptr)
+                        ++numSlowPluginsLoaded;
+
+            expectEquals (numSlowPluginsLoaded, numTracks * numExternalPluginsPerTrack);
+        }
+
+        pluginManager.createPluginInstance = oldCreateFunction;
+        pluginManager.knownPluginList.removeType (slowDesc);
+    }
+};
+
+static EditLoadBenchmarks editLoadBenchmarks;
+
+}
+
+#endif
@@ -231,96 +231,91 @@ std::unique_ptr<tracktion_graph::Node> createNodeForAudioClip (AudioClipBase& cl
     // Otherwise use audio file
     auto original = clip.getAudioFile();
 
-    double nodeOffset = 0.0, speed = 1.0;
-    EditTimeRange loopRange;
-    const bool usesTimestretchedProxy = clip.usesTimeStretchedProxy();
-
-    // Trigger proxy render if it needs it
-    clip.beginRenderingNewProxyIfNeeded();
-
-    if (! usesTimestretchedProxy)
-    {
-        nodeOffset = clip.getPosition().getOffset();
-        loopRange = clip.getLoopRange();
-        speed = clip.getSpeedRatio();
-    }
+    std::unique_ptr<Node> node;
 
-    if (clip.usesTimestretchedPreview())
+    // Offline renders still use the proxy so they're sample accurate and can't drop out
+    if (! params.forRendering && clip.usesRealtimeTimeStretching())
     {
-        auto& li = clip.getLoopInfo();
-
-        if (li.getNumBeats() > 0.0 || li.getRootNote() != -1)
-        {
-            auto node = makeNode<TimeStretchingWaveNode> (clip, playHeadState);
+        node = makeNode<TimeStretchingWaveNode> (clip, params.processState, params.forRendering);
 
-            const auto sourceChannels = juce::AudioChannelSet::canonicalChannelSet (clip.getAudioFile().getNumChannels());
-            const auto destChannels = juce::AudioChannelSet::canonicalChannelSet (std::max (2, sourceChannels.size()));
+        const auto sourceChannels = juce::AudioChannelSet::canonicalChannelSet (std::max (1, original.getNumChannels()));
+        const auto destChannels = juce::AudioChannelSet::canonicalChannelSet (std::max (2, sourceChannels.size()));
 
-            if (sourceChannels.size() != destChannels.size())
-                node = makeNode<ChannelRemappingNode> (std::move (node),
-                                                       makeChannelMapRepeatingLastChannel (sourceChannels, destChannels),
-                                                       false);
-            
-            return node;
-        }
+        if (sourceChannels.size() != destChannels.size())
+            node = makeNode<ChannelRemappingNode> (std::move (node),
+                                                   makeChannelMapRepeatingLastChannel (sourceChannels, destChannels),
+                                                   false);
     }
-
-    std::unique_ptr<Node> node;
-    
-    if (clip.getFadeInBehaviour() == AudioClipBase::speedRamp
-        || clip.getFadeOutBehaviour() == AudioClipBase::speedRamp)
+    else
     {
-        SpeedFadeDescription desc;
-        const auto clipPos = clip.getPosition();
-        
-        if (clip.getFadeInBehaviour() == AudioClipBase::speedRamp)
-        {
-            desc.inTimeRange = EditTimeRange::withStartAndLength (clipPos.getStart(), clip.getFadeIn());
-            desc.fadeInType = clip.getFadeInType();
-        }
-        else
+        double nodeOffset = 0.0, speed = 1.0;
+        EditTimeRange loopRange;
+
+        // Trigger proxy render if it needs it
+        clip.beginRenderingNewProxyIfNeeded();
+
+        if (! clip.usesTimeStretchedProxy())
         {
-            desc.inTimeRange = EditTimeRange::withStartAndLength (clipPos.getStart(), 0.0);
+            nodeOffset = clip.getPosition().getOffset();
+            loopRange = clip.getLoopRange();
+            speed = clip.getSpeedRatio();
         }
-        
-        if (clip.getFadeOutBehaviour() == AudioClipBase::speedRamp)
+
+        if (clip.getFadeInBehaviour() == AudioClipBase::speedRamp
+            || clip.getFadeOutBehaviour() == AudioClipBase::speedRamp)
         {
-            desc.outTimeRange = EditTimeRange::withStartAndLength (clipPos.getEnd() - clip.getFadeOut(), clip.getFadeOut());
-            desc.fadeOutType = clip.getFadeOutType();
+            SpeedFadeDescription desc;
+            const auto clipPos = clip.getPosition();
+
+            if (clip.getFadeInBehaviour() == AudioClipBase::speedRamp)
+            {
+                desc.inTimeRange = EditTimeRange::withStartAndLength (clipPos.getStart(), clip.getFadeIn());
+                desc.fadeInType = clip.getFadeInType();
+            }
+            else
+            {
+                desc.inTimeRange = EditTimeRange::withStartAndLength (clipPos.getStart(), 0.0);
+            }
+
+            if (clip.getFadeOutBehaviour() == AudioClipBase::speedRamp)
+            {
+                desc.outTimeRange = EditTimeRange::withStartAndLength (clipPos.getEnd() - clip.getFadeOut(), clip.getFadeOut());
+                desc.fadeOutType = clip.getFadeOutType();
+            }
+            else
+            {
+                desc.outTimeRange = EditTimeRange::withStartAndLength (clipPos.getEnd(), 0.0);
+            }
+
+            node = tracktion_graph::makeNode<SpeedRampWaveNode> (playFile,
+                                                                 clip.getEditTimeRange(),
+                                                                 nodeOffset,
+                                                                 loopRange,
+                                                                 clip.getLiveClipLevel(),
+                                                                 speed,
+                                                                 clip.getActiveChannels(),
+                                                                 juce::AudioChannelSet::canonicalChannelSet (std::max (2, clip.getActiveChannels().size())),
+                                                                 params.processState,
+                                                                 clip.itemID,
+                                                                 params.forRendering,
+                                                                 desc);
         }
         else
         {
-            desc.outTimeRange = EditTimeRange::withStartAndLength (clipPos.getEnd(), 0.0);
+            node = tracktion_graph::makeNode<WaveNode> (playFile,
+                                                        clip.getEditTimeRange(),
+                                                        nodeOffset,
+                                                        loopRange,
+                                                        clip.getLiveClipLevel(),
+                                                        speed,
+                                                        clip.getActiveChannels(),
+                                                        juce::AudioChannelSet::canonicalChannelSet (std::max (2, clip.getActiveChannels().size())),
+                                                        params.processState,
+                                                        clip.itemID,
+                                                        params.forRendering);
         }
-
-        node = tracktion_graph::makeNode<SpeedRampWaveNode> (playFile,
-                                                             clip.getEditTimeRange(),
-                                                             nodeOffset,
-                                                             loopRange,
-                                                             clip.getLiveClipLevel(),
-                                                             speed,
-                                                             clip.getActiveChannels(),
-                                                             juce::AudioChannelSet::canonicalChannelSet (std::max (2, clip.getActiveChannels().size())),
-                                                             params.processState,
-                                                             clip.itemID,
-                                                             params.forRendering,
-                                                             desc);
-    }
-    else
-    {
-        node = tracktion_graph::makeNode<WaveNode> (playFile,
-                                                    clip.getEditTimeRange(),
-                                                    nodeOffset,
-                                                    loopRange,
-                                                    clip.getLiveClipLevel(),
-                                                    speed,
-                                                    clip.getActiveChannels(),
-                                                    juce::AudioChannelSet::canonicalChannelSet (std::max (2, clip.getActiveChannels().size())),
-                                                    params.processState,
-                                                    clip.itemID,
-                                                    params.forRendering);
     }
-    
+
     // Plugins
     if (params.includePlugins)
     {
@@ -491,6 +486,85 @@ std::unique_ptr<tracktion_graph::Node> createNodeForClips (const juce::Array<Cli
     return combiner;
 }
 
+void hashValueTree (size_t& hash, const juce::ValueTree& v)
+{
+    tracktion_graph::hash_combine (hash, v.getType().toString().hash());
+
+    for (int i = 0; i < v.getNumProperties(); ++i)
+    {
+        const auto name = v.getPropertyName (i);
+        tracktion_graph::hash_combine (hash, name.toString().hash());
+        tracktion_graph::hash_combine (hash, v[name].toString().hash());
+    }
+
+    for (const auto& child : v)
+        hashValueTree (hash, child);
+}
+
+/** Returns a hash of everything the Nodes for a track's clips are built from, or 0 if they
+    can't be shared with later graphs. MIDI clips use the track's mute state for this graph
+    and clip plugins can have sidechains and latency so only plain audio clips are shared.
+*/
+size_t getHashForSharedClipsNode (const juce::Array<Clip*>& clips, const CreateNodeParams& params)
+{
+    if (params.forRendering || params.allowedClips != nullptr || clips.isEmpty())
+        return 0;
+
+    size_t hash = 0;
+    tracktion_graph::hash_combine (hash, &params.processState);
+    tracktion_graph::hash_combine (hash, params.sampleRate);
+    tracktion_graph::hash_combine (hash, params.blockSize);
+    tracktion_graph::hash_combine (hash, params.includePlugins);
+
+    // Realtime time-stretching reads the tempo and pitch as it plays
+    auto& edit = clips.getFirst()->edit;
+    hashValueTree (hash, edit.tempoSequence.state);
+    hashValueTree (hash, edit.pitchSequence.state);
+
+    for (auto clip : clips)
+    {
+        auto audioClip = dynamic_cast<AudioClipBase*> (clip);
+
+        if (audioClip == nullptr || audioClip->isUsingMelodyne())
+            return 0;
+
+        if (params.includePlugins && audioClip->getPluginList()->size() > 0)
+            return 0;
+
+        // The playback file changes when a new proxy is needed and its time when the proxy has rendered
+        const AudioFile playFile (audioClip->getPlaybackFile());
+        tracktion_graph::hash_combine (hash, clip);
+        tracktion_graph::hash_combine (hash, playFile.getHash());
+        tracktion_graph::hash_combine (hash, playFile.getFile().getLastModificationTime().toMilliseconds());
+        hashValueTree (hash, clip->state);
+    }
+
+    return hash != 0 ? hash : 1;
+}
+
+/** Creates the Node for a track's clips, reusing the one from the graph being replaced if
+    none of the clips have changed.
+*/
+std::unique_ptr<tracktion_graph::Node> createSharedNodeForClips (const juce::Array<Clip*>& clips, const TrackMuteState& trackMuteState,
+                                                                 const CreateNodeParams& params)
+{
+    const auto contentHash = params.nodesToShare != nullptr ? getHashForSharedClipsNode (clips, params) : 0;
+
+    if (contentHash == 0)
+        return createNodeForClips (clips, trackMuteState, params);
+
+    constexpr size_t sharedClipsNodeMagicHash = 0x5c1a7e0d5e;
+    const auto nodeID = tracktion_graph::hash ((size_t) clips.getFirst()->getTrack()->itemID.getRawID(), sharedClipsNodeMagicHash);
+
+    if (auto sharedNode = tracktion_graph::SharedNode::createFrom (*params.nodesToShare, nodeID, contentHash))
+        return sharedNode;
+
+    if (auto clipsNode = createNodeForClips (clips, trackMuteState, params))
+        return makeNode<tracktion_graph::SharedNode> (std::move (clipsNode), nodeID, contentHash);
+
+    return {};
+}
+
 //==============================================================================
 std::unique_ptr<tracktion_graph::Node> createNodeForFrozenAudioTrack (AudioTrack& track, tracktion_graph::PlayHeadState& playHeadState, const CreateNodeParams& params)
 {
@@ -549,7 +623,7 @@ std::unique_ptr<tracktion_graph::Node> createClipsNode (const juce::Array<Clip*>
 {
     std::vector<std::unique_ptr<Node>> nodes;
 
-    if (auto clipsNode = createNodeForClips (clips, trackMuteState, params))
+    if (auto clipsNode = createSharedNodeForClips (clips, trackMuteState, params))
         nodes.push_back (std::move (clipsNode));
     
     if (auto araNode = createARAClipsNode (clips, trackMuteState, params.processState.playHeadState, params))
@@ -794,16 +868,26 @@ std::unique_ptr<tracktion_graph::Node> createPluginNodeForTrack (Track& t, Track
 
 juce::Array<Track*> getDirectInputTracks (AudioTrack& at)
 {
-    juce::Array<Track*> inputTracks;
-
-    for (auto track : getAudioTracks (at.edit))
-        if (! track->isPartOfSubmix() && track != &at && track->getOutput().outputsToDestTrack (at))
-            inputTracks.add (track);
-
-    for (auto track : getTracksOfType<FolderTrack> (at.edit, true))
-        if (! track->isPartOfSubmix() && track->getOutput() != nullptr && track->getOutput()->outputsToDestTrack (at))
-            inputTracks.add (track);
+    juce::Array<Track*> inputTracks, folderTracks;
 
+    // This is called for every track so avoid copying the track list each time
+    visitAllTracks (at.edit, [&] (Track& t)
+                    {
+                        if (auto track = dynamic_cast<AudioTrack*> (&t))
+                        {
+                            if (! track->isPartOfSubmix() && track != &at && track->getOutput().outputsToDestTrack (at))
+                                inputTracks.add (track);
+                        }
+                        else if (auto folder = dynamic_cast<FolderTrack*> (&t))
+                        {
+                            if (! folder->isPartOfSubmix() && folder->getOutput() != nullptr && folder->getOutput()->outputsToDestTrack (at))
+                                folderTracks.add (folder);
+                        }
+
+                        return true;
+                    });
+
+    inputTracks.addArray (folderTracks);
     return inputTracks;
 }
 
@@ -1209,6 +1293,31 @@ std::unique_ptr<tracktion_graph::Node> createMasterFadeInOutNode (Edit& edit, tr
     return node;
 }
 
+/** Creates the Nodes for the allowed tracks that output to a device rather than another track. */
+std::vector<std::unique_ptr<tracktion_graph::Node>> createNodesForOutputTracks (Edit& edit, const CreateNodeParams& params)
+{
+    std::vector<std::unique_ptr<tracktion_graph::Node>> trackNodes;
+
+    visitAllTracks (edit, [&] (Track& t)
+                    {
+                        if (params.allowedTracks != nullptr && ! params.allowedTracks->contains (&t))
+                            return true;
+
+                        // Skip tracks that don't output to a device or feed in to other tracks
+                        auto output = getTrackOutput (t);
+
+                        if (output == nullptr || output->getDestinationTrack() != nullptr)
+                            return true;
+
+                        if (auto node = createNodeForTrack (t, params))
+                            trackNodes.push_back (std::move (node));
+
+                        return true;
+                    });
+
+    return trackNodes;
+}
+
 }
 
 //==============================================================================
@@ -1222,23 +1331,23 @@ std::unique_ptr<tracktion_graph::Node> createNodeForEdit (EditPlaybackContext& e
     std::map<OutputDevice*, TrackNodeVector> deviceNodes;
     std::vector<OutputDevice*> devicesWithFrozenNodes;
 
-    for (auto t : getAllTracks (edit))
+    visitAllTracks (edit, [&] (Track& t)
     {
-        if (params.allowedTracks != nullptr && ! params.allowedTracks->contains (t))
-            continue;
+        if (params.allowedTracks != nullptr && ! params.allowedTracks->contains (&t))
+            return true;
 
-        if (auto output = getTrackOutput (*t))
+        if (auto output = getTrackOutput (t))
         {
             if (auto device = output->getOutputDevice (false))
             {
                 if (! device->isEnabled())
-                    continue;
+                    return true;
                 
-                if (t->isFrozen (Track::groupFreeze))
+                if (t.isFrozen (Track::groupFreeze))
                 {
                     if (std::find (devicesWithFrozenNodes.begin(), devicesWithFrozenNodes.end(), device)
                         != devicesWithFrozenNodes.end())
-                       continue;
+                       return true;
 
                     if (auto node = createGroupFreezeNodeForDevice (edit, *device, params.processState))
                     {
@@ -1246,13 +1355,15 @@ std::unique_ptr<tracktion_graph::Node> createNodeForEdit (EditPlaybackContext& e
                         devicesWithFrozenNodes.push_back (device);
                     }
                 }
-                else if (auto node = createNodeForTrack (*t, params))
+                else if (auto node = createNodeForTrack (t, params))
                 {
                     deviceNodes[device].push_back (std::move (node));
                 }
             }
         }
-    }
+
+        return true;
+    });
 
     // Add deviceNodes for any devices only being used by InsertPlugins
     for (auto ins : insertPlugins)
@@ -1349,30 +1460,9 @@ std::unique_ptr<tracktion_graph::Node> createNodeForEdit (EditPlaybackContext& e
 
 std::unique_ptr<tracktion_graph::Node> createNodeForEdit (Edit& edit, const CreateNodeParams& params)
 {
-    std::vector<std::unique_ptr<tracktion_graph::Node>> trackNodes;
     auto& playHeadState = params.processState.playHeadState;
 
-    for (auto t : getAllTracks (edit))
-    {
-        if (params.allowedTracks != nullptr && ! params.allowedTracks->contains (t))
-            continue;
-
-        // Skip tracks that don't output to a device or feed in to other tracks
-        if (auto output = getTrackOutput (*t))
-        {
-            if (output->getDestinationTrack() != nullptr)
-                continue;
-        }
-        else
-        {
-            continue;
-        }
-
-        if (auto node = createNodeForTrack (*t, params))
-            trackNodes.push_back (std::move (node));
-    }
-
-    auto sumNode = std::make_unique<SummingNode> (std::move (trackNodes));
+    auto sumNode = std::make_unique<SummingNode> (createNodesForOutputTracks (edit, params));
     sumNode->setDoubleProcessingPrecision (edit.engine.getPropertyStorage().getProperty (SettingID::use64Bit, false));
 
     auto node = std::unique_ptr<Node> (std::move (sumNode));
@@ -1383,6 +1473,46 @@ std::unique_ptr<tracktion_graph::Node> createNodeForEdit (Edit& edit, const Crea
     return node;
 }
 
+std::unique_ptr<tracktion_graph::Node> createNodeForEditStems (Edit& edit, const std::vector<juce::Array<Track*>>& stemTracks, const CreateNodeParams& params,
+                                                                std::vector<int>* numStemChannels)
+{
+    auto& playHeadState = params.processState.playHeadState;
+    const bool use64Bit = edit.engine.getPropertyStorage().getProperty (SettingID::use64Bit, false);
+    auto outputNode = std::make_unique<SummingNode>();
+    int firstChannel = 0;
+
+    for (auto& tracks : stemTracks)
+    {
+        auto stemParams = params;
+        stemParams.allowedTracks = &tracks;
+
+        auto sumNode = std::make_unique<SummingNode> (createNodesForOutputTracks (edit, stemParams));
+        sumNode->setDoubleProcessingPrecision (use64Bit);
+
+        // Every stem needs a node to keep the channel layout the same
+        std::unique_ptr<Node> node;
+
+        if (sumNode->getDirectInputNodes().empty())
+            node = makeNode<SilentNode> (2);
+        else
+            node = createMasterFadeInOutNode (edit, playHeadState, std::move (sumNode), params);
+
+        const bool isMono = node->getNodeProperties().numberOfChannels == 1;
+
+        if (numStemChannels != nullptr)
+            numStemChannels->push_back (isMono ? 1 : 2);
+
+        node = makeNode<ChannelRemappingNode> (std::move (node),
+                                               std::vector<std::pair<int, int>> { { 0, firstChannel },
+                                                                                  { isMono ? 0 : 1, firstChannel + 1 } },
+                                               false);
+        outputNode->addInput (std::move (node));
+        firstChannel += 2;
+    }
+
+    return createRackNode (std::move (outputNode), edit.getRackList(), params);
+}
+
 std::function<std::unique_ptr<tracktion_graph::Node> (std::unique_ptr<tracktion_graph::Node>)> EditNodeBuilder::insertOptionalLastStageNode
     = [] (std::unique_ptr<tracktion_graph::Node> input) { return input; };
 
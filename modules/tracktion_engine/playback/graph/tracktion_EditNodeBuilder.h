@@ -31,6 +31,13 @@ struct CreateNodeParams
     bool includeMasterPlugins = true;                   /**< Whether to include master plugins, fades and volume. */
     bool addAntiDenormalisationNoise = false;           /**< Whether to add low level anti-denormalisation noise to the output. */
     bool includeBypassedPlugins = true;                 /**< If false, bypassed plugins will be completely ommited from the graph. */
+
+    /** If set, the clips of tracks that haven't changed reuse the prepared SharedNodes in this
+        index and other tracks' clips are put in SharedNodes for the next graph to reuse.
+        Only set this when the graph will replace one played by the same player, without
+        pooled memory allocations.
+    */
+    const tracktion_graph::NodeIDIndex* nodesToShare = nullptr;
 };
 
 //==============================================================================
@@ -49,5 +56,15 @@ std::unique_ptr<tracktion_graph::Node> createNodeForEdit (EditPlaybackContext&,
 /** Creates a Node to render an Edit. */
 std::unique_ptr<tracktion_graph::Node> createNodeForEdit (Edit&, const CreateNodeParams&);
 
+/** Creates a Node to render groups of tracks, or stems, of an Edit in a single pass.
+    Each stem is given two channels of the output in order, so stem n is in channels
+    2n and 2n + 1. The params' allowedTracks is ignored and master plugins are never
+    included as they can only be processed once per block.
+    If numStemChannels isn't nullptr, the number of channels each stem's tracks
+    produce is added to it so mono stems can be written as mono files.
+*/
+std::unique_ptr<tracktion_graph::Node> createNodeForEditStems (Edit&, const std::vector<juce::Array<Track*>>& stemTracks, const CreateNodeParams&,
+                                                                std::vector<int>* numStemChannels = nullptr);
+
 
 } // namespace tracktion_engine
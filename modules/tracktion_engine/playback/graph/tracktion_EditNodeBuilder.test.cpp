@@ -42,6 +42,9 @@ public:
 
         runSubmix (ts, 3.0, 2, true);
         runSubmix (ts, 3.0, 2, false);
+
+        runStemRendering (ts, 3.0);
+        runSharedClipNodes (ts, 3.0);
     }
 
 private:
@@ -279,6 +282,196 @@ private:
         }
     }
     
+    /** Renders a stereo, a mono and a quieter track as stems in a single pass and
+        checks each stem file is the same as rendering its track on its own.
+    */
+    void runStemRendering (test_utilities::TestSetup ts, double durationInSeconds)
+    {
+        using namespace tracktion_graph;
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        auto stereoFile = test_utilities::getSinFile<juce::WavAudioFormat> (ts.sampleRate, durationInSeconds, 2, 220.0f);
+        auto monoFile = test_utilities::getSinFile<juce::WavAudioFormat> (ts.sampleRate, durationInSeconds, 1, 440.0f);
+
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (3);
+        auto tracks = getAudioTracks (*edit);
+
+        tracks[0]->insertWaveClip ({}, stereoFile->getFile(), ClipPosition { { 0.0, durationInSeconds } }, false);
+        tracks[1]->insertWaveClip ({}, monoFile->getFile(), ClipPosition { { 0.0, durationInSeconds } }, false);
+        tracks[2]->insertWaveClip ({}, stereoFile->getFile(), ClipPosition { { 0.5, durationInSeconds } }, false);
+        tracks[2]->getVolumePlugin()->setVolumeDb (-6.0f);
+
+        beginTest ("Stem Rendering: " + test_utilities::getDescription (ts));
+        {
+            const Edit::ScopedRenderStatus srs (*edit, true);
+
+            juce::OwnedArray<juce::TemporaryFile> trackFiles, stemFiles;
+            std::vector<Renderer::Parameters::Stem> stems;
+            juce::Array<Track*> allTracks;
+
+            for (auto t : tracks)
+            {
+                auto trackFile = trackFiles.add (new juce::TemporaryFile (".wav"));
+                auto stemFile = stemFiles.add (new juce::TemporaryFile (".wav"));
+
+                auto trackParams = createRenderParams (*edit, ts, durationInSeconds);
+                trackParams.tracksToDo = getTracksMask (juce::Array<Track*> { t });
+                trackParams.destFile = trackFile->getFile();
+                render (trackParams);
+
+                stems.push_back ({ trackParams.tracksToDo, stemFile->getFile() });
+                allTracks.add (t);
+            }
+
+            auto stemsParams = createRenderParams (*edit, ts, durationInSeconds);
+            stemsParams.tracksToDo = getTracksMask (allTracks);
+            stemsParams.stems = stems;
+            render (stemsParams);
+
+            for (int i = 0; i < tracks.size(); ++i)
+            {
+                auto trackAudio = readFile (engine, trackFiles[i]->getFile());
+                auto stemAudio = readFile (engine, stemFiles[i]->getFile());
+
+                expectEquals (stemAudio.getNumChannels(), trackAudio.getNumChannels(), "Channel counts differ");
+                expectEquals (stemAudio.getNumSamples(), trackAudio.getNumSamples(), "Lengths differ");
+                expect (trackAudio.getMagnitude (0, trackAudio.getNumSamples()) > 0.1f, "Track render is silent");
+
+                if (stemAudio.getNumChannels() != trackAudio.getNumChannels()
+                    || stemAudio.getNumSamples() != trackAudio.getNumSamples())
+                    continue;
+
+                int numDifferent = 0;
+
+                for (int c = 0; c < trackAudio.getNumChannels(); ++c)
+                    for (int s = 0; s < trackAudio.getNumSamples(); ++s)
+                        if (trackAudio.getSample (c, s) != stemAudio.getSample (c, s))
+                            ++numDifferent;
+
+                expectEquals (numDifferent, 0, "Stem differs from track render " + juce::String (i));
+            }
+
+            expectEquals (readFile (engine, stemFiles[1]->getFile()).getNumChannels(), 1, "Mono track wasn't rendered as a mono stem");
+        }
+    }
+
+    /** Rebuilds the graph for two tracks after moving the clip on one of them and checks
+        only the other track's clip Nodes are shared with the new graph.
+    */
+    void runSharedClipNodes (test_utilities::TestSetup ts, double durationInSeconds)
+    {
+        using namespace tracktion_graph;
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        auto sinFile = test_utilities::getSinFile<juce::WavAudioFormat> (ts.sampleRate, durationInSeconds, 2, 220.0f);
+
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (2);
+        auto tracks = getAudioTracks (*edit);
+
+        for (auto t : tracks)
+            t->insertWaveClip ({}, sinFile->getFile(), ClipPosition { { 0.0, durationInSeconds } }, false);
+
+        tracktion_graph::PlayHead playHead;
+        tracktion_graph::PlayHeadState playHeadState { playHead };
+        ProcessState processState { playHeadState };
+        TracktionNodePlayer player (processState, getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+        player.setNumThreads (0);
+
+        choc::buffer::ChannelArrayBuffer<float> audio (2, (choc::buffer::FrameCount) ts.blockSize);
+        MidiMessageArray midi;
+
+        auto setNodeSharingCurrentNodes = [&]
+        {
+            const auto currentNodes = player.getNode() != nullptr ? NodeIDIndex (*player.getNode()) : NodeIDIndex();
+
+            CreateNodeParams params { processState };
+            params.sampleRate = ts.sampleRate;
+            params.blockSize = ts.blockSize;
+            params.nodesToShare = &currentNodes;
+            player.setNode (createNodeForEdit (*edit, params), ts.sampleRate, ts.blockSize);
+
+            // Process a block to swap the new graph in
+            audio.clear();
+            midi.clear();
+            player.process ({ juce::Range<int64_t>::withStartAndLength (0, ts.blockSize), { audio.getView(), midi } });
+        };
+
+        auto getSharedInputs = [&]
+        {
+            std::map<size_t, Node*> inputs;
+
+            for (auto n : getNodes (*player.getNode(), VertexOrdering::postordering))
+                if (auto sharedNode = dynamic_cast<SharedNode*> (n))
+                    inputs[sharedNode->getNodeProperties().nodeID] = &sharedNode->getInput();
+
+            return inputs;
+        };
+
+        beginTest ("Shared Clip Nodes: " + test_utilities::getDescription (ts));
+        {
+            setNodeSharingCurrentNodes();
+            const auto firstInputs = getSharedInputs();
+            expectEquals ((int) firstInputs.size(), 2);
+
+            auto clip = tracks[0]->getClips().getFirst();
+            clip->setStart (0.5, false, true);
+
+            setNodeSharingCurrentNodes();
+            const auto secondInputs = getSharedInputs();
+            expectEquals ((int) secondInputs.size(), 2);
+
+            int numShared = 0;
+
+            for (auto& idAndInput : secondInputs)
+            {
+                auto iter = firstInputs.find (idAndInput.first);
+                expect (iter != firstInputs.end(), "Track's SharedNode ID has changed");
+
+                if (iter != firstInputs.end() && iter->second == idAndInput.second)
+                    ++numShared;
+            }
+
+            expectEquals (numShared, 1, "Only the unchanged track should be shared");
+        }
+    }
+
+    static Renderer::Parameters createRenderParams (Edit& edit, test_utilities::TestSetup ts, double durationInSeconds)
+    {
+        Renderer::Parameters r (edit);
+        r.audioFormat = edit.engine.getAudioFileFormatManager().getWavFormat();
+        r.bitDepth = 32;
+        r.sampleRateForAudio = ts.sampleRate;
+        r.blockSizeForAudio = ts.blockSize;
+        r.time = { 0.0, durationInSeconds };
+
+        return r;
+    }
+
+    void render (const Renderer::Parameters& r)
+    {
+        Renderer::RenderTask task ("", r, nullptr, nullptr);
+
+        while (task.runJob() == juce::ThreadPoolJob::jobNeedsRunningAgain)
+        {}
+
+        expect (task.errorMessage.isEmpty(), task.errorMessage);
+    }
+
+    static juce::AudioBuffer<float> readFile (Engine& engine, const juce::File& file)
+    {
+        juce::AudioBuffer<float> buffer;
+
+        if (auto reader = std::unique_ptr<juce::AudioFormatReader> (AudioFileUtils::createReaderFor (engine, file)))
+        {
+            buffer.setSize ((int) reader->numChannels, (int) reader->lengthInSamples);
+            reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        }
+
+        return buffer;
+    }
+
     //==============================================================================
     //==============================================================================
     static std::unique_ptr<tracktion_graph::Node> createNode (Edit& edit, ProcessState& processState,
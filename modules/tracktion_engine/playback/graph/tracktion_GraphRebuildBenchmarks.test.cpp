@@ -0,0 +1,136 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+
+#include "tracktion_BenchmarkUtilities.h"
+
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class GraphRebuildBenchmarks : public juce::UnitTest
+{
+public:
+    GraphRebuildBenchmarks()
+        : juce::UnitTest ("Graph Rebuild Benchmarks", "tracktion_graph_performance")
+    {
+    }
+    
+    void runTest() override
+    {
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        for (int numTracks : { 25, 50, 100, 200 })
+            runRebuildTest (engine, numTracks);
+    }
+
+    void runRebuildTest (Engine& engine, int numTracks)
+    {
+        using namespace benchmark_utilities;
+        using namespace tracktion_graph;
+
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 256;
+        constexpr int numRebuilds = 10;
+
+        auto sinFile = test_utilities::getSinFile<juce::WavAudioFormat> (sampleRate, 10.0, 2, 220.0f);
+
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (numTracks);
+
+        for (auto t : getAudioTracks (*edit))
+            t->insertWaveClip ({}, sinFile->getFile(), ClipPosition { { 0.0, 10.0 } }, false);
+
+        PlayHead playHead;
+        PlayHeadState playHeadState { playHead };
+        ProcessState processState { playHeadState };
+        TracktionNodePlayer player (processState, getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+        player.setNumThreads (0);
+
+        choc::buffer::ChannelArrayBuffer<float> audio (2, (choc::buffer::FrameCount) blockSize);
+        MidiMessageArray midi;
+        int64_t referenceSamplePosition = 0;
+
+        // Processing a block makes the player swap in the pending graph so the next
+        // rebuild shares its unchanged Nodes, just like during playback
+        auto processBlock = [&]
+        {
+            audio.clear();
+            midi.clear();
+            const auto range = juce::Range<int64_t>::withStartAndLength (referenceSamplePosition, blockSize);
+            player.process ({ range, { audio.getView(), midi } });
+            referenceSamplePosition += blockSize;
+        };
+
+        // Builds a playback graph that shares the Nodes of tracks that haven't changed
+        auto createNodeSharingCurrentNodes = [&]
+        {
+            const auto currentNodes = player.getNode() != nullptr ? NodeIDIndex (*player.getNode()) : NodeIDIndex();
+
+            CreateNodeParams params { processState };
+            params.sampleRate = sampleRate;
+            params.blockSize = blockSize;
+            params.nodesToShare = &currentNodes;
+
+            return createNodeForEdit (*edit, params);
+        };
+
+        const auto description = String (numTracks) + " tracks";
+
+        beginTest ("Initial build: " + description);
+        {
+            const StopwatchTimer sw;
+            player.setNode (createNodeSharingCurrentNodes(), sampleRate, blockSize);
+            processBlock();
+            std::cout << "Build and prepare: " << sw.getDescription() << "\n";
+            std::cout << "Num nodes: " << getNodes (*player.getNode(), VertexOrdering::postordering).size() << "\n";
+            expect (player.getNode() != nullptr);
+        }
+
+        beginTest ("Rebuild: " + description);
+        {
+            double buildSeconds = 0.0, prepareSeconds = 0.0;
+
+            for (int i = 0; i < numRebuilds; ++i)
+            {
+                // Move a clip to simulate a typical edit
+                auto track = getAudioTracks (*edit)[i % numTracks];
+                auto clip = track->getClips().getFirst();
+                clip->setStart (clip->getPosition().getStart() + 0.1, false, true);
+
+                const StopwatchTimer buildTimer;
+                auto node = createNodeSharingCurrentNodes();
+                buildSeconds += buildTimer.getSeconds();
+
+                const StopwatchTimer prepareTimer;
+                player.setNode (std::move (node), sampleRate, blockSize);
+                prepareSeconds += prepareTimer.getSeconds();
+
+                processBlock();
+            }
+
+            std::cout << "Average build: " << String (buildSeconds * 1000.0 / numRebuilds, 2) << "ms, "
+                      << "average prepare: " << String (prepareSeconds * 1000.0 / numRebuilds, 2) << "ms\n";
+            expect (true);
+        }
+    }
+};
+
+static GraphRebuildBenchmarks graphRebuildBenchmarks;
+
+}
+
+#endif
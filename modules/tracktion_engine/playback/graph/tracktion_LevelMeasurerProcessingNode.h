@@ -55,6 +55,7 @@ public:
         
         tempAudioBuffer.resize ({ (choc::buffer::ChannelCount) getNodeProperties().numberOfChannels,
                                   (choc::buffer::FrameCount) info.blockSize });
+        tempMidiBuffer.setFixedCapacity (MidiMessageArray::getFixedCapacityForNumSamples (info.blockSize));
     }
     
     void process (ProcessContext& pc) override
@@ -44,28 +44,18 @@ std::vector<tracktion_graph::Node*> LiveMidiInjectingNode::getDirectInputNodes()
 
 void LiveMidiInjectingNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo& info)
 {
-    if (info.rootNodeToReplace == nullptr)
+    if (info.nodesToReplace == nullptr)
         return;
     
-    auto nodeIDToLookFor = getNodeProperties().nodeID;
-    
-    if (nodeIDToLookFor == 0)
-        return;
+    auto other = info.nodesToReplace->find<LiveMidiInjectingNode> (getNodeProperties().nodeID,
+                                                                   [this] (LiveMidiInjectingNode& n) { return n.track == track; });
 
-    auto visitor = [this, nodeIDToLookFor] (Node& node)
+    if (other != nullptr)
     {
-        if (auto other = dynamic_cast<LiveMidiInjectingNode*> (&node))
-        {
-            if (other->getNodeProperties().nodeID == nodeIDToLookFor
-                && other->track == track)
-            {
-                const juce::ScopedLock sl2 (other->liveMidiLock);
-                liveMidiMessages.swapWith (other->liveMidiMessages);
-                midiSourceID = other->midiSourceID;
-            }
-        }
-    };
-    visitNodes (*info.rootNodeToReplace, visitor, true);
+        const juce::ScopedLock sl2 (other->liveMidiLock);
+        liveMidiMessages.swapWith (other->liveMidiMessages);
+        midiSourceID = other->midiSourceID;
+    }
 }
 
 bool LiveMidiInjectingNode::isReadyToProcess()
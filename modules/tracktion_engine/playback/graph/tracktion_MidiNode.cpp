@@ -29,15 +29,12 @@ MidiNode::MidiNode (juce::MidiMessageSequence sequence,
       wasMute (liveClipLevel.isMute())
 {
     jassert (channelNumbers.getStart() > 0 && channelNumbers.getEnd() <= 16);
-    ms.emplace_back (sequence);
+    sequences.emplace_back (sequence);
 
-    for (auto& s : ms)
-        s.updateMatchedPairs();
-    
     controllerMessagesScratchBuffer.ensureStorageAllocated (32);
 }
 
-MidiNode::MidiNode (std::vector<juce::MidiMessageSequence> sequences,
+MidiNode::MidiNode (std::vector<juce::MidiMessageSequence> sourceSequences,
                     juce::Range<int> midiChannelNumbers,
                     bool useMPE,
                     EditTimeRange editTimeRange,
@@ -46,7 +43,6 @@ MidiNode::MidiNode (std::vector<juce::MidiMessageSequence> sequences,
                     EditItemID editItemIDToUse,
                     std::function<bool()> shouldBeMuted)
     : TracktionEngineNode (processStateToUse),
-      ms (std::move (sequences)),
       channelNumbers (midiChannelNumbers),
       useMPEChannelMode (useMPE),
       editSection (editTimeRange),
@@ -57,8 +53,8 @@ MidiNode::MidiNode (std::vector<juce::MidiMessageSequence> sequences,
 {
     jassert (channelNumbers.getStart() > 0 && channelNumbers.getEnd() <= 16);
 
-    for (auto& s : ms)
-        s.updateMatchedPairs();
+    for (auto& s : sourceSequences)
+        sequences.emplace_back (s);
 
     controllerMessagesScratchBuffer.ensureStorageAllocated (32);
 }
@@ -76,24 +72,14 @@ void MidiNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo&
     sampleRate = info.sampleRate;
     timeForOneSample = tracktion_graph::sampleToTime (1, info.sampleRate);
     
-    if (info.rootNodeToReplace != nullptr)
+    if (info.nodesToReplace != nullptr)
     {
-        bool foundNodeToReplace = false;
-        const auto nodeIDToLookFor = getNodeProperties().nodeID;
-        
-        visitNodes (info.rootNode, [&] (Node& n)
-                    {
-                        if (auto midiNode = dynamic_cast<MidiNode*> (&n))
-                        {
-                            if (midiNode->getNodeProperties().nodeID == nodeIDToLookFor)
-                            {
-                                midiSourceID = midiNode->midiSourceID;
-                                foundNodeToReplace = true;
-                            }
-                        }
-                    }, true);
-        
-        shouldCreateMessagesForTime = ! foundNodeToReplace;
+        auto nodeToReplace = info.nodesToReplace->find<MidiNode> (getNodeProperties().nodeID);
+
+        if (nodeToReplace != nullptr)
+            midiSourceID = nodeToReplace->midiSourceID;
+
+        shouldCreateMessagesForTime = nodeToReplace == nullptr;
     }
 }
 
@@ -116,10 +102,10 @@ void MidiNode::processSection (ProcessContext& pc, juce::Range<int64_t> timeline
     if (shouldBeMutedDelegate && shouldBeMutedDelegate())
         return;
 
-    if (ms.size() > 0 && timelineRange.getStart() < lastStart )
+    if (sequences.size() > 0 && timelineRange.getStart() < lastStart )
     {
         currentSequence++;
-        if (currentSequence >= ms.size())
+        if (currentSequence >= sequences.size())
             currentSequence = 0;
     }
     lastStart = timelineRange.getStart();
@@ -138,7 +124,7 @@ void MidiNode::processSection (ProcessContext& pc, juce::Range<int64_t> timeline
         if (mute != wasMute)
         {
             wasMute = mute;
-            createNoteOffs (pc.buffers.midi, ms[currentSequence], localTime.getStart(), 0.0, getPlayHead().isPlaying());
+            createNoteOffs (pc.buffers.midi, sequences[currentSequence], localTime.getStart(), 0.0, getPlayHead().isPlaying());
         }
 
         return;
@@ -150,140 +136,88 @@ void MidiNode::processSection (ProcessContext& pc, juce::Range<int64_t> timeline
         shouldCreateMessagesForTime = false;
     }
 
-    auto numEvents = ms[currentSequence].getNumEvents();
-
-    if (numEvents != 0)
-    {
-        currentIndex = juce::jlimit (0, numEvents - 1, currentIndex);
-
-        if (ms[currentSequence].getEventTime (currentIndex) >= localTime.getStart())
-        {
-            while (currentIndex > 0 && ms[currentSequence].getEventTime (currentIndex - 1) >= localTime.getStart())
-                --currentIndex;
-        }
-        else
-        {
-            while (currentIndex < numEvents && ms[currentSequence].getEventTime (currentIndex) < localTime.getStart())
-                ++currentIndex;
-        }
-    }
+    auto& sequence = sequences[currentSequence];
+    const auto numEvents = sequence.size();
+    currentIndex = sequence.getNextIndexAtTime (localTime.getStart(), currentIndex);
 
     auto volScale = clipLevel.getGain();
     const auto lastBlockOfLoop = getPlayHeadState().isLastBlockOfLoop();
 
-    for (;;)
+    for (; currentIndex < numEvents; ++currentIndex)
     {
-        if (auto meh = ms[currentSequence].getEventPointer (currentIndex++))
-        {
-            auto eventTime = meh->message.getTimeStamp();
+        auto& e = sequence[currentIndex];
+        auto eventTime = e.time;
+
+        // This correction here is to avoid rounding errors converting to and from sample position and times
+        const auto timeCorrection = lastBlockOfLoop ? (e.isNoteOff() ? 0.0 : timeForOneSample) : 0.0;
 
-            // This correction here is to avoid rounding errors converting to and from sample position and times
-            const auto timeCorrection = lastBlockOfLoop ? (meh->message.isNoteOff() ? 0.0 : timeForOneSample) : 0.0;
-            
-            if (eventTime >= (localTime.getEnd() - timeCorrection))
-                break;
+        if (eventTime >= (localTime.getEnd() - timeCorrection))
+            break;
 
-            eventTime -= localTime.getStart();
+        eventTime -= localTime.getStart();
 
-            if (eventTime >= 0.0)
-            {
-                juce::MidiMessage m (meh->message);
-                m.multiplyVelocity (volScale);
-                pc.buffers.midi.addMidiMessage (m, eventTime, midiSourceID);
-            }
-        }
-        else
+        if (eventTime >= 0.0)
         {
-            break;
+            auto m = sequence.createMessage (e);
+            m.multiplyVelocity (volScale);
+            pc.buffers.midi.addMidiMessage (m, eventTime, midiSourceID);
         }
     }
 
     // N.B. if the note-off is added on the last time it may not be sent to the plugin which can break the active note-state.
     // To avoid this, make sure any added messages are nudged back by 0.00001s
     if (getPlayHeadState().isLastBlockOfLoop())
-        createNoteOffs (pc.buffers.midi, ms[currentSequence], localTime.getEnd(), localTime.getLength() - 0.00001, getPlayHead().isPlaying());
+        createNoteOffs (pc.buffers.midi, sequences[currentSequence], localTime.getEnd(), localTime.getLength() - 0.00001, getPlayHead().isPlaying());
 }
 
 void MidiNode::createMessagesForTime (double time, MidiMessageArray& buffer)
 {
+    auto& sequence = sequences[currentSequence];
+    controllerMessagesScratchBuffer.clearQuick();
+
     if (useMPEChannelMode)
     {
-        const int indexOfTime = ms[currentSequence].getNextIndexAtTime (time);
-
-        controllerMessagesScratchBuffer.clearQuick();
-
-        for (int i = channelNumbers.getStart(); i <= channelNumbers.getEnd(); ++i)
-            MPEStartTrimmer::reconstructExpression (controllerMessagesScratchBuffer, ms[currentSequence], indexOfTime, i);
+        sequence.reconstructMPEExpression (channelNumbers.getStart(), channelNumbers.getEnd(), time, controllerMessagesScratchBuffer);
 
         for (auto& m : controllerMessagesScratchBuffer)
             buffer.addMidiMessage (m, 0.0001, midiSourceID);
     }
     else
     {
-        {
-            controllerMessagesScratchBuffer.clearQuick();
+        sequence.createControllerUpdatesForTime (channelNumbers.getStart(), channelNumbers.getEnd(), time, controllerMessagesScratchBuffer);
 
-            for (int i = channelNumbers.getStart(); i <= channelNumbers.getEnd(); ++i)
-                ms[currentSequence].createControllerUpdatesForTime (i, time, controllerMessagesScratchBuffer);
-
-            for (auto& m : controllerMessagesScratchBuffer)
-                buffer.addMidiMessage (m, midiSourceID);
-        }
+        for (auto& m : controllerMessagesScratchBuffer)
+            buffer.addMidiMessage (m, midiSourceID);
 
         if (! clipLevel.isMute())
         {
             auto volScale = clipLevel.getGain();
 
-            for (int i = 0; i < ms[currentSequence].getNumEvents(); ++i)
+            sequence.forEachNoteSoundingAt (time, [&] (const PackedMidiSequence::Event& noteOn, const PackedMidiSequence::Event& noteOff)
             {
-                if (auto meh = ms[currentSequence].getEventPointer (i))
+                // don't play very short notes or ones that have already finished
+                if (noteOff.time > time + 0.0001)
                 {
-                    if (meh->noteOffObject != nullptr
-                        && meh->message.isNoteOn())
-                    {
-                        if (meh->message.getTimeStamp() >= time)
-                            break;
-
-                        // don't play very short notes or ones that have already finished
-                        if (meh->noteOffObject->message.getTimeStamp() > time + 0.0001)
-                        {
-                            juce::MidiMessage m (meh->message);
-                            m.multiplyVelocity (volScale);
-
-                            // give these a tiny offset to make sure they're played after the controller updates
-                            buffer.addMidiMessage (m, 0.0001, midiSourceID);
-                        }
-                    }
+                    auto m = sequence.createMessage (noteOn);
+                    m.multiplyVelocity (volScale);
+
+                    // give these a tiny offset to make sure they're played after the controller updates
+                    buffer.addMidiMessage (m, 0.0001, midiSourceID);
                 }
-            }
+            });
         }
     }
 }
 
-void MidiNode::createNoteOffs (MidiMessageArray& destination, const juce::MidiMessageSequence& source,
+void MidiNode::createNoteOffs (MidiMessageArray& destination, const PackedMidiSequence& source,
                                double time, double midiTimeOffset, bool isPlaying)
 {
-    int activeChannels = 0;
+    const int activeChannels = source.getNoteOnChannelMask();
 
-    for (int i = 0; i < source.getNumEvents(); ++i)
+    source.forEachNoteSoundingAt (time, [&] (const PackedMidiSequence::Event&, const PackedMidiSequence::Event& noteOff)
     {
-        if (auto meh = source.getEventPointer (i))
-        {
-            if (meh->message.isNoteOn())
-            {
-                activeChannels |= (1 << meh->message.getChannel());
-
-                if (meh->message.getTimeStamp() < time
-                     && meh->noteOffObject != nullptr
-                     && meh->noteOffObject->message.getTimeStamp() >= time)
-                    destination.addMidiMessage (meh->noteOffObject->message, midiTimeOffset, midiSourceID);
-            }
-        }
-        else
-        {
-            break;
-        }
-    }
+        destination.addMidiMessage (source.createMessage (noteOff), midiTimeOffset, midiSourceID);
+    });
 
     for (int i = 1; i <= 16; ++i)
     {
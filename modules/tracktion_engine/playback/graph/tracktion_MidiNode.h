@@ -43,7 +43,7 @@ public:
 
 private:
     //==============================================================================
-    std::vector<juce::MidiMessageSequence> ms;
+    std::vector<PackedMidiSequence> sequences;
     int64_t lastStart = 0;
     size_t currentSequence = 0;
     juce::Range<int> channelNumbers;
@@ -62,7 +62,7 @@ private:
 
     //==============================================================================
     void createMessagesForTime (double time, MidiMessageArray&);
-    void createNoteOffs (MidiMessageArray& destination, const juce::MidiMessageSequence& source,
+    void createNoteOffs (MidiMessageArray& destination, const PackedMidiSequence& source,
                          double time, double midiTimeOffset, bool isPlaying);
     void processSection (ProcessContext&, juce::Range<int64_t> timelineRange);
 };
@@ -35,6 +35,8 @@ public:
             runMidiTests (setup, true);
             runMidiTests (setup, false);
         }
+
+        runChaseTests();
     }
 
 private:
@@ -113,6 +115,145 @@ private:
             test_utilities::expectMidiBuffer (*this, testContext->midi, sampleRate, expectedSequence);
         }
     }
+    //==============================================================================
+    /** Creates a sequence with notes, controllers, pitch-bend, pressure and program
+        changes spread randomly over all channels.
+    */
+    static juce::MidiMessageSequence createRandomChaseSequence (int numEvents, double duration, juce::Random& r)
+    {
+        juce::MidiMessageSequence sequence;
+
+        for (int i = 0; i < numEvents; ++i)
+        {
+            // Quantise the times so some events coincide
+            const auto time = std::floor (r.nextDouble() * duration * 100.0) / 100.0;
+            const auto channel = r.nextInt ({ 1, 17 });
+
+            switch (r.nextInt (6))
+            {
+                case 0:
+                {
+                    const auto note = r.nextInt (128);
+                    const auto noteOffTime = time + r.nextDouble();
+                    sequence.addEvent (juce::MidiMessage::noteOn (channel, note, (juce::uint8) r.nextInt ({ 1, 128 })), time);
+
+                    // Some note-offs are note-ons with zero velocity
+                    if (r.nextBool())
+                        sequence.addEvent (juce::MidiMessage::noteOff (channel, note), noteOffTime);
+                    else
+                        sequence.addEvent (juce::MidiMessage::noteOn (channel, note, (juce::uint8) 0), noteOffTime);
+
+                    break;
+                }
+                case 1:     sequence.addEvent (juce::MidiMessage::controllerEvent (channel, 74, r.nextInt (128)), time); break;
+                case 2:     sequence.addEvent (juce::MidiMessage::controllerEvent (channel, r.nextInt (128), r.nextInt (128)), time); break;
+                case 3:     sequence.addEvent (juce::MidiMessage::pitchWheel (channel, r.nextInt (16384)), time); break;
+                case 4:     sequence.addEvent (juce::MidiMessage::channelPressureChange (channel, r.nextInt (128)), time); break;
+                case 5:     sequence.addEvent (juce::MidiMessage::programChange (channel, r.nextInt (128)), time); break;
+                default:    break;
+            }
+        }
+
+        sequence.updateMatchedPairs();
+
+        return sequence;
+    }
+
+    void expectSameMessages (const juce::Array<juce::MidiMessage>& actual, const juce::Array<juce::MidiMessage>& expected)
+    {
+        expectEquals (actual.size(), expected.size());
+
+        for (int i = 0; i < std::min (actual.size(), expected.size()); ++i)
+        {
+            auto& a = actual.getReference (i);
+            auto& e = expected.getReference (i);
+
+            expectEquals (a.getRawDataSize(), e.getRawDataSize());
+            expect (std::memcmp (a.getRawData(), e.getRawData(), (size_t) std::min (a.getRawDataSize(), e.getRawDataSize())) == 0,
+                    "Message mismatch: " + a.getDescription() + " != " + e.getDescription());
+            expectEquals (a.getTimeStamp(), e.getTimeStamp());
+        }
+    }
+
+    void runChaseTests()
+    {
+        juce::Random r (getRandom().nextInt64());
+        const double duration = 20.0;
+        const auto sequence = createRandomChaseSequence (20000, duration, r);
+        const PackedMidiSequence packedSequence (sequence);
+
+        expectGreaterThan ((int) packedSequence.getNumCheckpoints(), 1);
+
+        const auto lastEventTime = sequence.getEndTime();
+        std::vector<double> times { 0.0, lastEventTime, lastEventTime + 1.0 };
+
+        for (int i = 0; i < 200; ++i)
+            times.push_back (r.nextDouble() * duration);
+
+        // Times landing exactly on events are the edge cases for the chase
+        for (int i = 0; i < 200; ++i)
+            times.push_back (sequence.getEventTime (r.nextInt (sequence.getNumEvents())));
+
+        beginTest ("Controller chase");
+        {
+            for (auto time : times)
+            {
+                juce::Array<juce::MidiMessage> expected, actual;
+
+                for (int channel = 1; channel <= 16; ++channel)
+                    sequence.createControllerUpdatesForTime (channel, time, expected);
+
+                packedSequence.createControllerUpdatesForTime (1, 16, time, actual);
+                expectSameMessages (actual, expected);
+            }
+        }
+
+        beginTest ("MPE chase");
+        {
+            for (auto time : times)
+            {
+                const int trimIndex = sequence.getNextIndexAtTime (time);
+
+                if (trimIndex >= sequence.getNumEvents())
+                    continue;
+
+                juce::Array<juce::MidiMessage> expected, actual;
+
+                for (int channel = 1; channel <= 16; ++channel)
+                    MPEStartTrimmer::reconstructExpression (expected, sequence, trimIndex, channel);
+
+                packedSequence.reconstructMPEExpression (1, 16, time, actual);
+                expectSameMessages (actual, expected);
+            }
+        }
+
+        beginTest ("Held note chase");
+        {
+            for (auto time : times)
+            {
+                juce::Array<juce::MidiMessage> expected, actual;
+
+                for (int i = 0; i < sequence.getNumEvents(); ++i)
+                {
+                    auto meh = sequence.getEventPointer (i);
+
+                    if (meh->message.getTimeStamp() >= time)
+                        break;
+
+                    if (meh->message.isNoteOn() && meh->noteOffObject != nullptr
+                        && meh->noteOffObject->message.getTimeStamp() >= time)
+                        expected.add (meh->message);
+                }
+
+                packedSequence.forEachNoteSoundingAt (time, [&] (const PackedMidiSequence::Event& noteOn, const PackedMidiSequence::Event&)
+                {
+                    actual.add (packedSequence.createMessage (noteOn));
+                });
+
+                expectSameMessages (actual, expected);
+            }
+        }
+    }
 };
 
 static MidiNodeTests midiNodeTests;
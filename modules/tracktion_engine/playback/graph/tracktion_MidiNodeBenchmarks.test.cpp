@@ -0,0 +1,326 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class MidiNodeBenchmarks : public juce::UnitTest
+{
+public:
+    MidiNodeBenchmarks()
+        : juce::UnitTest ("MidiNode Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        const auto sequence = createDenseSequence (100000, duration);
+
+        for (int blockSize : { 64, 256, 1024 })
+        {
+            runSequenceIterationTest (sequence, blockSize);
+            runMidiNodeTest (sequence, blockSize);
+        }
+
+        const auto automationSequence = createDenseAutomationSequence (100000, duration);
+        runChaseTest (automationSequence);
+
+        for (double loopStart : { 1.0, duration / 2.0, duration - 1.0 })
+            runRapidLoopingTest (automationSequence, 256, loopStart);
+    }
+
+private:
+    static constexpr double sampleRate = 44100.0;
+    static constexpr double duration = 60.0;
+
+    /** Creates a drum-programming style sequence of short notes across all 16 channels. */
+    static juce::MidiMessageSequence createDenseSequence (int numEvents, double durationSeconds)
+    {
+        juce::Random r (42);
+        juce::MidiMessageSequence sequence;
+        const double noteInterval = durationSeconds / (numEvents / 2);
+
+        for (int i = 0; i < numEvents / 2; ++i)
+        {
+            const auto time = i * noteInterval;
+            const auto channel = r.nextInt ({ 1, 17 });
+            const auto note = r.nextInt ({ 36, 52 });
+
+            sequence.addEvent (juce::MidiMessage::noteOn (channel, note, (juce::uint8) r.nextInt ({ 1, 128 })), time);
+            sequence.addEvent (juce::MidiMessage::noteOff (channel, note), time + noteInterval * 0.5);
+        }
+
+        sequence.updateMatchedPairs();
+
+        return sequence;
+    }
+
+    /** Creates a sequence of dense controller and pitch-bend automation with some sustained notes. */
+    static juce::MidiMessageSequence createDenseAutomationSequence (int numEvents, double durationSeconds)
+    {
+        juce::Random r (42);
+        juce::MidiMessageSequence sequence;
+        const double interval = durationSeconds / numEvents;
+
+        for (int i = 0; i < numEvents; ++i)
+        {
+            const auto time = i * interval;
+
+            if (i % 100 == 0)
+            {
+                const auto note = r.nextInt ({ 48, 72 });
+                sequence.addEvent (juce::MidiMessage::noteOn (1, note, (juce::uint8) 100), time);
+                sequence.addEvent (juce::MidiMessage::noteOff (1, note), time + interval * 90.5);
+            }
+            else if (i % 3 == 0)
+            {
+                sequence.addEvent (juce::MidiMessage::pitchWheel (1, r.nextInt (16384)), time);
+            }
+            else
+            {
+                sequence.addEvent (juce::MidiMessage::controllerEvent (1, r.nextInt ({ 1, 32 }), r.nextInt (128)), time);
+            }
+        }
+
+        sequence.updateMatchedPairs();
+
+        return sequence;
+    }
+
+    void runSequenceIterationTest (const juce::MidiMessageSequence& sequence, int blockSize)
+    {
+        const auto description = juce::String (sequence.getNumEvents()) + " events, block size " + juce::String (blockSize);
+        const auto blockLength = tracktion_graph::sampleToTime (blockSize, sampleRate);
+        const auto midiSourceID = MidiMessageArray::createUniqueMPESourceID();
+
+        MidiMessageArray buffer;
+        buffer.reserve (1024);
+
+        beginTest ("MidiMessageSequence iteration: " + description);
+        {
+            const StopwatchTimer sw;
+            int currentIndex = 0;
+            size_t numEmitted = 0;
+
+            for (double blockStart = 0.0; blockStart < duration; blockStart += blockLength)
+            {
+                buffer.clear();
+
+                while (auto meh = sequence.getEventPointer (currentIndex))
+                {
+                    if (meh->message.getTimeStamp() >= blockStart + blockLength)
+                        break;
+
+                    juce::MidiMessage m (meh->message);
+                    m.multiplyVelocity (0.9f);
+                    buffer.addMidiMessage (m, m.getTimeStamp() - blockStart, midiSourceID);
+                    ++currentIndex;
+                }
+
+                numEmitted += (size_t) buffer.size();
+            }
+
+            std::cout << "Emitted " << numEmitted << " events in " << sw.getDescription() << "\n";
+            expectEquals ((int) numEmitted, sequence.getNumEvents());
+        }
+
+        beginTest ("PackedMidiSequence iteration: " + description);
+        {
+            const PackedMidiSequence packedSequence (sequence);
+            const StopwatchTimer sw;
+            int currentIndex = 0;
+            size_t numEmitted = 0;
+
+            for (double blockStart = 0.0; blockStart < duration; blockStart += blockLength)
+            {
+                buffer.clear();
+                currentIndex = packedSequence.getNextIndexAtTime (blockStart, currentIndex);
+
+                for (; currentIndex < packedSequence.size(); ++currentIndex)
+                {
+                    auto& e = packedSequence[currentIndex];
+
+                    if (e.time >= blockStart + blockLength)
+                        break;
+
+                    auto m = packedSequence.createMessage (e);
+                    m.multiplyVelocity (0.9f);
+                    buffer.addMidiMessage (m, e.time - blockStart, midiSourceID);
+                }
+
+                numEmitted += (size_t) buffer.size();
+            }
+
+            std::cout << "Emitted " << numEmitted << " events in " << sw.getDescription() << "\n";
+            expectEquals ((int) numEmitted, packedSequence.size());
+        }
+    }
+
+    void runMidiNodeTest (const juce::MidiMessageSequence& sequence, int blockSize)
+    {
+        using namespace tracktion_graph;
+
+        beginTest ("MidiNode playback: " + juce::String (sequence.getNumEvents()) + " events, block size " + juce::String (blockSize));
+
+        PlayHead playHead;
+        PlayHeadState playHeadState { playHead };
+        ProcessState processState { playHeadState };
+        playHead.playSyncedToRange ({ 0, std::numeric_limits<int64_t>::max() });
+
+        std::unique_ptr<Node> node;
+
+        {
+            const StopwatchTimer sw;
+            node = std::make_unique<MidiNode> (sequence,
+                                               juce::Range<int> (1, 16),
+                                               false,
+                                               EditTimeRange (0.0, duration),
+                                               LiveClipLevel(),
+                                               processState,
+                                               EditItemID());
+            std::cout << "Build: " << sw.getDescription() << "\n";
+        }
+
+        TracktionNodePlayer player (std::move (node), processState, sampleRate, blockSize,
+                                    getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+        player.setNumThreads (0);
+
+        choc::buffer::ChannelArrayBuffer<float> audio (0, (choc::buffer::FrameCount) blockSize);
+        MidiMessageArray midi;
+        midi.reserve (1024);
+
+        const auto totalNumSamples = timeToSample (duration, sampleRate);
+        double worstBlockSeconds = 0.0;
+        size_t numEmitted = 0;
+
+        const StopwatchTimer sw;
+
+        for (int64_t start = 0; start < totalNumSamples; start += blockSize)
+        {
+            midi.clear();
+
+            const StopwatchTimer blockTimer;
+            player.process ({ juce::Range<int64_t>::withStartAndLength (start, blockSize), { audio.getView(), midi } });
+            worstBlockSeconds = std::max (worstBlockSeconds, blockTimer.getSeconds());
+
+            numEmitted += (size_t) midi.size();
+        }
+
+        std::cout << "Emitted " << numEmitted << " events in " << sw.getDescription()
+                  << ", worst block: " << juce::String (worstBlockSeconds * 1000.0, 3) << "ms\n";
+        expectGreaterOrEqual ((int) numEmitted, sequence.getNumEvents());
+    }
+
+    void runChaseTest (const juce::MidiMessageSequence& sequence)
+    {
+        const auto description = juce::String (sequence.getNumEvents()) + " events";
+        constexpr int numChases = 1000;
+
+        juce::Random r (42);
+        std::vector<double> times;
+
+        for (int i = 0; i < numChases; ++i)
+            times.push_back (r.nextDouble() * duration);
+
+        juce::Array<juce::MidiMessage> dest;
+        dest.ensureStorageAllocated (256);
+
+        auto timeChases = [&] (auto&& chase)
+        {
+            double worstSeconds = 0.0;
+            const StopwatchTimer sw;
+
+            for (auto time : times)
+            {
+                dest.clearQuick();
+                const StopwatchTimer chaseTimer;
+                chase (time);
+                worstSeconds = std::max (worstSeconds, chaseTimer.getSeconds());
+            }
+
+            std::cout << numChases << " chases in " << sw.getDescription()
+                      << ", worst: " << juce::String (worstSeconds * 1000.0, 3) << "ms\n";
+        };
+
+        beginTest ("MidiMessageSequence controller chase: " + description);
+        {
+            auto copy = sequence;
+            timeChases ([&] (double time) { copy.createControllerUpdatesForTime (1, time, dest); });
+            expect (true);
+        }
+
+        beginTest ("PackedMidiSequence controller chase: " + description);
+        {
+            const PackedMidiSequence packedSequence (sequence);
+            std::cout << "Num checkpoints: " << packedSequence.getNumCheckpoints() << "\n";
+            timeChases ([&] (double time) { packedSequence.createControllerUpdatesForTime (1, 1, time, dest); });
+            expect (true);
+        }
+    }
+
+    void runRapidLoopingTest (const juce::MidiMessageSequence& sequence, int blockSize, double loopStart)
+    {
+        using namespace tracktion_graph;
+
+        beginTest ("MidiNode rapid looping: " + juce::String (sequence.getNumEvents()) + " events, loop start " + juce::String (loopStart, 1) + "s");
+
+        PlayHead playHead;
+        PlayHeadState playHeadState { playHead };
+        ProcessState processState { playHeadState };
+
+        // Loop every four blocks so nearly every other block has to chase
+        const auto loopStartSample = timeToSample (loopStart, sampleRate);
+        playHead.play ({ loopStartSample, loopStartSample + blockSize * 4 }, true);
+
+        TracktionNodePlayer player (std::make_unique<MidiNode> (sequence,
+                                                                juce::Range<int>::withStartAndLength (1, 1),
+                                                                false,
+                                                                EditTimeRange (0.0, duration),
+                                                                LiveClipLevel(),
+                                                                processState,
+                                                                EditItemID()),
+                                    processState, sampleRate, blockSize,
+                                    getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+        player.setNumThreads (0);
+
+        choc::buffer::ChannelArrayBuffer<float> audio (0, (choc::buffer::FrameCount) blockSize);
+        MidiMessageArray midi;
+        midi.reserve (1024);
+
+        constexpr int numBlocks = 10000;
+        double worstBlockSeconds = 0.0;
+        const StopwatchTimer sw;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            midi.clear();
+
+            const StopwatchTimer blockTimer;
+            player.process ({ juce::Range<int64_t>::withStartAndLength ((int64_t) i * blockSize, blockSize), { audio.getView(), midi } });
+            worstBlockSeconds = std::max (worstBlockSeconds, blockTimer.getSeconds());
+        }
+
+        std::cout << numBlocks << " blocks in " << sw.getDescription()
+                  << ", worst block: " << juce::String (worstBlockSeconds * 1000.0, 3) << "ms\n";
+        expect (true);
+    }
+};
+
+static MidiNodeBenchmarks midiNodeBenchmarks;
+
+}
+
+#endif
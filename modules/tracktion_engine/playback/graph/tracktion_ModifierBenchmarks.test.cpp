@@ -0,0 +1,142 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+
+#include "tracktion_BenchmarkUtilities.h"
+
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class ModifierBenchmarks : public juce::UnitTest
+{
+public:
+    ModifierBenchmarks()
+        : juce::UnitTest ("Modifier Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        runLFOTest (engine, 500, 50);
+    }
+
+    void runLFOTest (Engine& engine, int numModifiers, int numTracks)
+    {
+        using namespace benchmark_utilities;
+        using namespace tracktion_graph;
+
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 256;
+        constexpr int numBlocks = 2000;
+
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->ensureNumberOfAudioTracks (numTracks);
+        auto tracks = getAudioTracks (*edit);
+
+        // Each LFO drives the volume or pan of one of the tracks
+        juce::Array<LFOModifier*> lfos;
+
+        for (int i = 0; i < numModifiers; ++i)
+        {
+            auto track = tracks[i % numTracks];
+            auto modifier = track->getModifierList().insertModifier (juce::ValueTree (IDs::LFO), -1, nullptr);
+            auto lfo = dynamic_cast<LFOModifier*> (modifier.get());
+            lfos.add (lfo);
+
+            auto volumePlugin = track->getVolumePlugin();
+            auto param = (i / numTracks) % 2 == 0 ? volumePlugin->volParam : volumePlugin->panParam;
+            param->addModifier (*lfo, 0.1f);
+        }
+
+        PlayHead playHead;
+        PlayHeadState playHeadState { playHead };
+        ProcessState processState { playHeadState };
+        TracktionNodePlayer player (processState, getPoolCreatorFunction (ThreadPoolStrategy::lightweightSemHybrid));
+        player.setNode (createNode (*edit, processState, sampleRate, blockSize), sampleRate, blockSize);
+        playHead.playSyncedToRange ({ 0, std::numeric_limits<int64_t>::max() });
+
+        choc::buffer::ChannelArrayBuffer<float> audio (2, (choc::buffer::FrameCount) blockSize);
+        MidiMessageArray midi;
+        int64_t referenceSamplePosition = 0;
+
+        auto processBlock = [&]
+        {
+            audio.clear();
+            midi.clear();
+            const auto range = juce::Range<int64_t>::withStartAndLength (referenceSamplePosition, blockSize);
+            player.process ({ range, { audio.getView(), midi } });
+            referenceSamplePosition += blockSize;
+        };
+
+        auto getEditTime = [&] { return tracktion_graph::sampleToTime (referenceSamplePosition, sampleRate); };
+
+        auto updateSerially = [&] { edit->updateModifierTimers (getEditTime(), blockSize); };
+        auto updateInParallel = [&]
+        {
+            edit->updateModifierTimers (getEditTime(), blockSize,
+                                        [&player] (size_t numTasks, auto&& updateTask) { player.runTasks (numTasks, updateTask); });
+        };
+
+        const auto description = String (numModifiers) + " LFOs, " + String (numTracks) + " tracks";
+
+        auto runBlocks = [&] (const juce::String& name, std::function<void()> updateModifiers, bool shouldProcess)
+        {
+            beginTest (name + ": " + description);
+
+            double updateSeconds = 0.0;
+            const StopwatchTimer totalTimer;
+
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                const StopwatchTimer updateTimer;
+                updateModifiers();
+                updateSeconds += updateTimer.getSeconds();
+
+                if (shouldProcess)
+                    processBlock();
+                else
+                    referenceSamplePosition += blockSize;
+            }
+
+            std::cout << name << ": average modifier update " << String (updateSeconds * 1.0e6 / numBlocks, 2) << "us, "
+                      << "total " << totalTimer.getDescription() << "\n";
+
+            // All the LFOs have the same settings so should have been updated to the same value
+            bool allEqual = true;
+
+            for (auto lfo : lfos)
+                allEqual = allEqual && lfo->getCurrentValue() == lfos.getFirst()->getCurrentValue();
+
+            expect (allEqual);
+        };
+
+        runBlocks ("Serial update", updateSerially, false);
+        runBlocks ("Parallel update", updateInParallel, false);
+        runBlocks ("Serial update and process", updateSerially, true);
+        runBlocks ("Parallel update and process", updateInParallel, true);
+
+        player.clearNode();
+    }
+};
+
+static ModifierBenchmarks modifierBenchmarks;
+
+}
+
+#endif
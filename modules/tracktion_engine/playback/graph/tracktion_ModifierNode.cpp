@@ -71,6 +71,8 @@ void ModifierNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationI
 
     if (props.latencyNumSamples > 0)
         automationAdjustmentTime = -tracktion_graph::sampleToTime (props.latencyNumSamples, sampleRate);
+
+    midiMessageArray.setFixedCapacity (getMidiCapacityForInputs (info.blockSize));
 }
 
 void ModifierNode::process (ProcessContext& pc)
@@ -32,6 +32,163 @@ namespace
         plugins.addArray (insideRacks);
         return plugins;
     }
+
+    /** Adds the time it's alive for to a total number of seconds. */
+    struct ScopedTimeAccumulator
+    {
+        ScopedTimeAccumulator (double& totalToAddTo) noexcept  : total (totalToAddTo) {}
+        ~ScopedTimeAccumulator() noexcept   { total += (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0; }
+
+        double& total;
+        const double start { juce::Time::getMillisecondCounterHiRes() };
+    };
+}
+
+
+//==============================================================================
+NodeRenderContext::WritePipeline::WritePipeline (int numChannels, int maxBlockSize,
+                                                 std::vector<choc::buffer::ChannelRange> outputChannelsToUse,
+                                                 WriteFunction writeFunctionToUse)
+    : outputChannels (std::move (outputChannelsToUse)), writeFunction (std::move (writeFunctionToUse))
+{
+    jassert (writeFunction);
+
+    // Enough blocks to ride out a slow write but not an unbounded amount of memory
+    const size_t maxNumBytes = 16 * 1024 * 1024;
+    const auto blockBytes = (size_t) (numChannels * maxBlockSize) * sizeof (float);
+    const auto numBlocks = juce::jlimit ((size_t) 2, (size_t) 32, maxNumBytes / std::max ((size_t) 1, blockBytes));
+
+    for (size_t i = 0; i < numBlocks; ++i)
+        blocks.emplace_back (numChannels, maxBlockSize);
+
+    numFramesInBlock.resize (numBlocks, 0);
+
+    const auto numOutputs = outputChannels.size();
+    numRead.resize (numOutputs, 0);
+    writeSeconds.resize (numOutputs, 0.0);
+    waitSeconds.resize (numOutputs, 0.0);
+
+    for (size_t i = 0; i < numOutputs; ++i)
+        threads.emplace_back ([this, i] { run (i); });
+}
+
+NodeRenderContext::WritePipeline::~WritePipeline()
+{
+    finish();
+}
+
+bool NodeRenderContext::WritePipeline::push (choc::buffer::ChannelArrayView<float> source, double& waitSecondsToUpdate)
+{
+    jassert (source.getNumChannels() <= (choc::buffer::ChannelCount) blocks.front().getNumChannels());
+    jassert (source.getNumFrames() <= (choc::buffer::FrameCount) blocks.front().getNumSamples());
+
+    std::unique_lock<std::mutex> l (mutex);
+
+    {
+        ScopedTimeAccumulator waitTimer (waitSecondsToUpdate);
+        blockFreed.wait (l, [this] { return failed || numWritten - getNumReadByAllOutputs() < blocks.size(); });
+    }
+
+    if (failed)
+        return false;
+
+    // Only this thread touches the next block until numWritten is incremented
+    l.unlock();
+    auto& block = blocks[numWritten % blocks.size()];
+    auto dest = choc::buffer::createChannelArrayView (block.getArrayOfWritePointers(),
+                                                      source.getNumChannels(), source.getNumFrames());
+    choc::buffer::copy (dest, source);
+    numFramesInBlock[numWritten % blocks.size()] = source.getNumFrames();
+    l.lock();
+
+    ++numWritten;
+    blockAdded.notify_all();
+
+    return true;
+}
+
+void NodeRenderContext::WritePipeline::finish()
+{
+    stopThreads (false);
+}
+
+void NodeRenderContext::WritePipeline::cancel()
+{
+    stopThreads (true);
+}
+
+void NodeRenderContext::WritePipeline::addTimings (Renderer::Parameters::StageTimings& timings) const
+{
+    for (auto t : writeSeconds)     timings.writeSeconds += t;
+    for (auto t : waitSeconds)      timings.writerWaitSeconds += t;
+}
+
+size_t NodeRenderContext::WritePipeline::getNumReadByAllOutputs() const
+{
+    return *std::min_element (numRead.begin(), numRead.end());
+}
+
+void NodeRenderContext::WritePipeline::stopThreads (bool shouldCancel)
+{
+    {
+        const std::lock_guard<std::mutex> l (mutex);
+        finishing = true;
+        cancelled = cancelled || shouldCancel;
+    }
+
+    blockAdded.notify_all();
+
+    for (auto& t : threads)
+        if (t.joinable())
+            t.join();
+}
+
+void NodeRenderContext::WritePipeline::run (size_t outputIndex)
+{
+    for (;;)
+    {
+        size_t blockIndex = 0;
+
+        {
+            std::unique_lock<std::mutex> l (mutex);
+
+            {
+                ScopedTimeAccumulator waitTimer (waitSeconds[outputIndex]);
+                blockAdded.wait (l, [this, outputIndex] { return cancelled || failed || finishing
+                                                                    || numRead[outputIndex] < numWritten; });
+            }
+
+            if (cancelled || failed || numRead[outputIndex] == numWritten)
+                return;
+
+            blockIndex = numRead[outputIndex] % blocks.size();
+        }
+
+        bool ok = false;
+
+        {
+            ScopedTimeAccumulator writeTimer (writeSeconds[outputIndex]);
+
+            // Each output only reads and dithers its own channels so they can share the block
+            auto& block = blocks[blockIndex];
+            auto view = choc::buffer::createChannelArrayView (block.getArrayOfWritePointers(),
+                                                              (choc::buffer::ChannelCount) block.getNumChannels(),
+                                                              numFramesInBlock[blockIndex]);
+
+            ok = writeFunction (outputIndex, view.getChannelRange (outputChannels[outputIndex]));
+        }
+
+        {
+            const std::lock_guard<std::mutex> l (mutex);
+            ++numRead[outputIndex];
+            failed = failed || ! ok;
+        }
+
+        blockFreed.notify_all();
+
+        if (! ok)
+            blockAdded.notify_all();
+    }
 }
 
 
@@ -48,7 +205,6 @@ NodeRenderContext::NodeRenderContext (Renderer::RenderTask& owner_, Renderer::Pa
       playHeadState (std::move (playHeadState_)),
       processState (std::move (processState_)),
       status (juce::Result::ok()),
-      ditherers (256, r.bitDepth),
       sourceToUpdate (sourceToUpdate_)
 {
     CRASH_TRACER
@@ -70,21 +226,7 @@ NodeRenderContext::NodeRenderContext (Renderer::RenderTask& owner_, Renderer::Pa
         TRACKTION_LOG_ERROR("Rendering whilst attached to audio device");
     }
 
-    if (r.shouldNormalise || r.trimSilenceAtEnds || r.shouldNormaliseByRMS)
-    {
-        needsToNormaliseAndTrim = true;
-
-        r.audioFormat = r.engine->getAudioFileFormatManager().getFrozenFileFormat();
-
-        intermediateFile = std::make_unique<juce::TemporaryFile> (r.destFile.withFileExtension (r.audioFormat->getFileExtensions()[0]));
-        r.destFile = intermediateFile->getFile();
-
-        r.shouldNormalise = false;
-        r.trimSilenceAtEnds = false;
-        r.shouldNormaliseByRMS = false;
-    }
-
-    numOutputChans = 2;
+    needsToNormaliseAndTrim = r.shouldNormalise || r.trimSilenceAtEnds || r.shouldNormaliseByRMS;
 
     {
         auto props = nodePlayer->getNode()->getNodeProperties();
@@ -95,20 +237,28 @@ NodeRenderContext::NodeRenderContext (Renderer::RenderTask& owner_, Renderer::Pa
             return;
         }
 
-        if (r.mustRenderInMono || (r.canRenderInMono && (props.numberOfChannels < 2)))
-            numOutputChans = 1;
-    }
-
-    AudioFileUtils::addBWAVStartToMetadata (r.metadata, (int64_t) (r.time.getStart() * r.sampleRateForAudio));
-
-    writer = std::make_unique<AudioFileWriter> (AudioFile (*originalParams.engine, r.destFile),
-                                                r.audioFormat, numOutputChans, r.sampleRateForAudio,
-                                                r.bitDepth, r.metadata, r.quality);
+        if (r.stems.empty())
+        {
+            numOutputChans = (r.mustRenderInMono || (r.canRenderInMono && (props.numberOfChannels < 2))) ? 1 : 2;
 
-    if (r.destFile != juce::File() && ! writer->isOpen())
-    {
-        status = juce::Result::fail (TRANS("Couldn't write to target file"));
-        return;
+            if (! addOutput (r.destFile, 0, numOutputChans))
+                return;
+        }
+        else
+        {
+            // Each stem is on its own pair of channels but mono stems are written
+            // as mono files, the same as when the tracks are rendered on their own
+            numOutputChans = (int) r.stems.size() * 2;
+
+            for (size_t i = 0; i < r.stems.size(); ++i)
+            {
+                auto& stem = r.stems[i];
+                const int numStemChans = (r.mustRenderInMono || (r.canRenderInMono && stem.numChannels < 2)) ? 1 : 2;
+
+                if (! addOutput (stem.destFile, (int) i * 2, numStemChans))
+                    return;
+            }
+        }
     }
 
     blockLength = r.blockSizeForAudio / r.sampleRateForAudio;
@@ -123,10 +273,6 @@ NodeRenderContext::NodeRenderContext (Renderer::RenderTask& owner_, Renderer::Pa
 
     currentTempoPosition = std::make_unique<TempoSequencePosition> (r.edit->tempoSequence);
 
-    peak = 0.0001f;
-    rmsTotal = 0.0;
-    rmsNumSamps = 0;
-    numNonZeroSamps = 0;
     streamTime = r.time.getStart();
 
     precount = numPreRenderBlocks;
@@ -139,35 +285,109 @@ NodeRenderContext::NodeRenderContext (Renderer::RenderTask& owner_, Renderer::Pa
     nodePlayer->prepareToPlay (r.sampleRateForAudio, r.blockSizeForAudio);
     Renderer::RenderTask::flushAllPlugins (plugins, r.sampleRateForAudio, r.blockSizeForAudio);
 
-    samplesTrimmed = 0;
-    hasStartedSavingToFile = ! r.trimSilenceAtEnds;
-
     playHead->stop();
     playHead->setPosition (timeToSample (r.time.getStart(), r.sampleRateForAudio));
 
     samplesToWrite = juce::roundToInt ((r.time.getLength() + r.endAllowance) * r.sampleRateForAudio);
 
     if (sourceToUpdate != nullptr)
-        sourceToUpdate->reset (numOutputChans, r.sampleRateForAudio, samplesToWrite);
+        sourceToUpdate->reset (outputs.front()->numChannels, r.sampleRateForAudio, samplesToWrite);
+
+    renderingBuffer.setSize (numOutputChans, r.blockSizeForAudio + 256);
+    std::vector<choc::buffer::ChannelRange> outputChannels;
+
+    for (auto& output : outputs)
+        outputChannels.push_back ({ (choc::buffer::ChannelCount) output->firstChannel,
+                                    (choc::buffer::ChannelCount) (output->firstChannel + output->numChannels) });
+
+    writePipeline = std::make_unique<WritePipeline> (numOutputChans, r.blockSizeForAudio, std::move (outputChannels),
+                                                     [this] (size_t outputIndex, choc::buffer::ChannelArrayView<float> block)
+                                                     {
+                                                         return writeAudioBlock (*outputs[outputIndex], block) == WriteResult::succeeded;
+                                                     });
 }
 
 NodeRenderContext::~NodeRenderContext()
 {
     CRASH_TRACER
-    r.resultMagnitude = owner.params.resultMagnitude = peak;
-    r.resultRMS = owner.params.resultRMS = rmsNumSamps > 0 ? (float) (rmsTotal / rmsNumSamps) : 0.0f;
-    r.resultAudioDuration = owner.params.resultAudioDuration = float (numNonZeroSamps / owner.params.sampleRateForAudio);
+    // Wait for the queued blocks to be written before using the results
+    if (writePipeline != nullptr)
+    {
+        writePipeline->finish();
+        writePipeline->addTimings (timings);
+        writePipeline.reset();
+    }
+
+    owner.params.resultTimings = timings;
+
+    // When rendering stems, the results are the loudest and longest of them
+    owner.params.resultMagnitude = 0.0f;
+    owner.params.resultRMS = 0.0f;
+    owner.params.resultAudioDuration = 0.0f;
+
+    for (auto& output : outputs)
+    {
+        auto& op = output->params;
+        op.resultMagnitude = output->peak;
+        op.resultRMS = output->rmsNumSamps > 0 ? (float) (output->rmsTotal / output->rmsNumSamps) : 0.0f;
+        op.resultAudioDuration = float (output->numNonZeroSamps / owner.params.sampleRateForAudio);
+
+        owner.params.resultMagnitude = std::max (owner.params.resultMagnitude, op.resultMagnitude);
+        owner.params.resultRMS = std::max (owner.params.resultRMS, op.resultRMS);
+        owner.params.resultAudioDuration = std::max (owner.params.resultAudioDuration, op.resultAudioDuration);
+    }
 
     playHead->stop();
     Renderer::RenderTask::setAllPluginsRealtime (plugins, true);
 
-    if (writer != nullptr)
-        writer->closeForWriting();
+    for (auto& output : outputs)
+        output->writer->closeForWriting();
 
     callBlocking ([this] { nodePlayer.reset(); });
 
     if (needsToNormaliseAndTrim)
-        owner.performNormalisingAndTrimming (originalParams, r);
+        for (auto& output : outputs)
+            owner.performNormalisingAndTrimming (output->originalParams, output->params);
+}
+
+bool NodeRenderContext::addOutput (const juce::File& destFile, int firstChannel, int numChannels)
+{
+    auto output = std::make_unique<Output> (originalParams, firstChannel, numChannels);
+    output->originalParams.destFile = destFile;
+
+    auto& op = output->params;
+    op = r;
+    op.destFile = destFile;
+
+    if (needsToNormaliseAndTrim)
+    {
+        op.audioFormat = op.engine->getAudioFileFormatManager().getFrozenFileFormat();
+
+        output->intermediateFile = std::make_unique<juce::TemporaryFile> (destFile.withFileExtension (op.audioFormat->getFileExtensions()[0]));
+        op.destFile = output->intermediateFile->getFile();
+
+        op.shouldNormalise = false;
+        op.trimSilenceAtEnds = false;
+        op.shouldNormaliseByRMS = false;
+    }
+
+    AudioFileUtils::addBWAVStartToMetadata (op.metadata, (int64_t) (op.time.getStart() * op.sampleRateForAudio));
+
+    output->writer = std::make_unique<AudioFileWriter> (AudioFile (*originalParams.engine, op.destFile),
+                                                        op.audioFormat, numChannels, op.sampleRateForAudio,
+                                                        op.bitDepth, op.metadata, op.quality);
+    output->hasStartedSavingToFile = ! op.trimSilenceAtEnds;
+
+    auto& writer = *output->writer;
+    outputs.push_back (std::move (output));
+
+    if (op.destFile != juce::File() && ! writer.isOpen())
+    {
+        status = juce::Result::fail (TRANS("Couldn't write to target file"));
+        return false;
+    }
+
+    return true;
 }
 
 bool NodeRenderContext::renderNextBlock (std::atomic<float>& progressToUpdate)
@@ -183,8 +403,14 @@ bool NodeRenderContext::renderNextBlock (std::atomic<float>& progressToUpdate)
 
     if (owner.shouldExit())
     {
-        writer->closeForWriting();
-        r.destFile.deleteFile();
+        if (writePipeline != nullptr)
+            writePipeline->cancel();
+
+        for (auto& output : outputs)
+        {
+            output->writer->closeForWriting();
+            output->params.destFile.deleteFile();
+        }
 
         playHead->stop();
         Renderer::RenderTask::setAllPluginsRealtime (plugins, true);
@@ -229,7 +455,8 @@ bool NodeRenderContext::renderNextBlock (std::atomic<float>& progressToUpdate)
     const auto referenceSampleRange = juce::Range<int64_t>::withStartAndLength (tracktion_graph::timeToSample (streamTimeRange.start, originalParams.sampleRateForAudio), r.blockSizeForAudio);
 
     // Update modifier timers
-    r.edit->updateModifierTimers (streamTime, r.blockSizeForAudio);
+    r.edit->updateModifierTimers (streamTime, r.blockSizeForAudio,
+                                  [this] (size_t numTasks, auto&& updateTask) { nodePlayer->runTasks (numTasks, updateTask); });
 
     // Wait for any nodes to render their sources or proxies
     auto leafNodesReady = [this, referenceSampleRange]
@@ -249,7 +476,6 @@ bool NodeRenderContext::renderNextBlock (std::atomic<float>& progressToUpdate)
     while (! (leafNodesReady || owner.shouldExit()))
         return false;
 
-    juce::AudioBuffer<float> renderingBuffer (numOutputChans, r.blockSizeForAudio + 256);
     renderingBuffer.clear();
     midiBuffer.clear();
 
@@ -257,7 +483,10 @@ bool NodeRenderContext::renderNextBlock (std::atomic<float>& progressToUpdate)
                                                           (choc::buffer::ChannelCount) renderingBuffer.getNumChannels(),
                                                           (choc::buffer::FrameCount) referenceSampleRange.getLength());
 
-    nodePlayer->process ({ referenceSampleRange, { destView, midiBuffer} });
+    {
+        ScopedTimeAccumulator graphTimer (timings.graphSeconds);
+        nodePlayer->process ({ referenceSampleRange, { destView, midiBuffer} });
+    }
 
     if (precount <= 0)
     {
@@ -283,7 +512,9 @@ bool NodeRenderContext::renderNextBlock (std::atomic<float>& progressToUpdate)
         {
             jassert (blockSize <= destView.getNumFrames());
 
-            if (writeAudioBlock (destView.getFrameRange ({ blockOffset, blockOffset + blockSize })) == WriteResult::failed)
+            // The writer threads take it from here
+            if (! writePipeline->push (destView.getFrameRange ({ blockOffset, blockOffset + blockSize }),
+                                       timings.graphWaitSeconds))
                 return true;
         }
     }
@@ -319,39 +550,38 @@ bool NodeRenderContext::renderNextBlock (std::atomic<float>& progressToUpdate)
 }
 
 //==============================================================================
-NodeRenderContext::WriteResult NodeRenderContext::writeAudioBlock (choc::buffer::ChannelArrayView<float> block)
+NodeRenderContext::WriteResult NodeRenderContext::writeAudioBlock (Output& output, choc::buffer::ChannelArrayView<float> block)
 {
     CRASH_TRACER
     // Prepare buffer to use
     auto blockSizeSamples = (int) block.getNumFrames();
-    
-    juce::AudioBuffer<float> buffer (block.data.channels, numOutputChans, blockSizeSamples);
+    auto buffer = tracktion_graph::toAudioBuffer (block);
 
     // Apply dithering and mag/rms analysis
     if (r.ditheringEnabled && r.bitDepth < 32)
-        ditherers.apply (buffer, blockSizeSamples);
+        output.ditherers.apply (buffer, blockSizeSamples);
 
     auto mag = buffer.getMagnitude (0, blockSizeSamples);
-    peak = juce::jmax (peak, mag);
+    output.peak = juce::jmax (output.peak, mag);
 
-    if (! hasStartedSavingToFile)
-        hasStartedSavingToFile = (mag > 0.0f);
+    if (! output.hasStartedSavingToFile)
+        output.hasStartedSavingToFile = (mag > 0.0f);
 
     for (int i = buffer.getNumChannels(); --i >= 0;)
     {
-        rmsTotal += buffer.getRMSLevel (i, 0, blockSizeSamples);
-        ++rmsNumSamps;
+        output.rmsTotal += buffer.getRMSLevel (i, 0, blockSizeSamples);
+        ++output.rmsNumSamps;
     }
 
     for (int i = blockSizeSamples; --i >= 0;)
         if (buffer.getMagnitude (i, 1) > 0.0001)
-            numNonZeroSamps++;
+            output.numNonZeroSamps++;
 
-    if (! hasStartedSavingToFile)
-        samplesTrimmed += blockSizeSamples;
+    if (! output.hasStartedSavingToFile)
+        output.samplesTrimmed += blockSizeSamples;
 
-    // Update thumbnail source
-    if (sourceToUpdate != nullptr && blockSizeSamples > 0)
+    // Update thumbnail source, this only shows the first output
+    if (sourceToUpdate != nullptr && blockSizeSamples > 0 && &output == outputs.front().get())
     {
         sourceToUpdate->addBlock (numSamplesWrittenToSource, buffer, 0, blockSizeSamples);
         numSamplesWrittenToSource += blockSizeSamples;
@@ -359,9 +589,9 @@ NodeRenderContext::WriteResult NodeRenderContext::writeAudioBlock (choc::buffer:
 
     // And finally write to the file
     // NB buffer gets trashed by this call
-    if (blockSizeSamples > 0 && hasStartedSavingToFile
-         && writer->isOpen()
-         && ! writer->appendBuffer (buffer, blockSizeSamples))
+    if (blockSizeSamples > 0 && output.hasStartedSavingToFile
+         && output.writer->isOpen()
+         && ! output.writer->appendBuffer (buffer, blockSizeSamples))
         return WriteResult::failed;
     
     return WriteResult::succeeded;
@@ -431,7 +661,8 @@ juce::String NodeRenderContext::renderMidi (Renderer::RenderTask& owner,
         const EditTimeRange streamTimeRange (streamTime, blockEnd);
         
         // Update modifier timers
-        r.edit->updateModifierTimers (streamTime, samplesPerBlock);
+        r.edit->updateModifierTimers (streamTime, samplesPerBlock,
+                                      [&nodePlayer] (size_t numTasks, auto&& updateTask) { nodePlayer->runTasks (numTasks, updateTask); });
         
         // Then once eveything is ready, render the block
         currentTempoPosition.setTime (streamTime);
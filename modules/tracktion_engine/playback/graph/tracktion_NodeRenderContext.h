@@ -16,6 +16,11 @@ namespace tracktion_engine
 //==============================================================================
 /**
     Holds the state of an audio render procedure so it can be rendered in blocks.
+
+    The graph is processed on the rendering thread and each block is copied in to a
+    bounded queue. Writer threads, one for each output file, then measure, dither and
+    encode the blocks so the graph doesn't have to wait for the disk. If the writers
+    fall behind, the graph waits for them to free a block.
 */
 class NodeRenderContext
 {
@@ -49,6 +54,66 @@ public:
                                     std::unique_ptr<ProcessState>,
                                     std::atomic<float>& progressToUpdate);
 
+    //==============================================================================
+    /**
+        A ring of preallocated blocks the rendering thread fills and a thread for each
+        output writes out. A block is only reused once every output has written it.
+    */
+    class WritePipeline
+    {
+    public:
+        /** Called on an output's thread with that output's channels of each block.
+            Should return false if the block couldn't be written.
+        */
+        using WriteFunction = std::function<bool (size_t outputIndex, choc::buffer::ChannelArrayView<float>)>;
+
+        /** Starts a thread for each output, which are given by the channels they write. */
+        WritePipeline (int numChannels, int maxBlockSize,
+                       std::vector<choc::buffer::ChannelRange> outputChannels,
+                       WriteFunction);
+
+        /** Waits for any queued blocks to be written. */
+        ~WritePipeline();
+
+        /** Copies a block in to the queue, waiting for a free block if the writers are behind.
+            Returns false if any of the writes have failed.
+        */
+        bool push (choc::buffer::ChannelArrayView<float>, double& waitSecondsToUpdate);
+
+        /** Waits for the queued blocks to be written and stops the threads. */
+        void finish();
+
+        /** Stops the threads, dropping any blocks that haven't been written. */
+        void cancel();
+
+        /** Returns the number of blocks that can be queued before push has to wait. */
+        size_t getNumBlocks() const                             { return blocks.size(); }
+
+        /** Adds the time spent by the writer threads. */
+        void addTimings (Renderer::Parameters::StageTimings&) const;
+
+    private:
+        const std::vector<choc::buffer::ChannelRange> outputChannels;
+        const WriteFunction writeFunction;
+        std::vector<juce::AudioBuffer<float>> blocks;
+        std::vector<choc::buffer::FrameCount> numFramesInBlock;
+        std::vector<std::thread> threads;
+
+        std::mutex mutex;
+        std::condition_variable blockAdded, blockFreed;
+        size_t numWritten = 0;
+        std::vector<size_t> numRead;
+        bool finishing = false, cancelled = false, failed = false;
+
+        std::vector<double> writeSeconds, waitSeconds;
+
+        size_t getNumReadByAllOutputs() const;
+        void stopThreads (bool shouldCancel);
+        void run (size_t outputIndex);
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WritePipeline)
+    };
+
 private:
     //==============================================================================
     struct Ditherers
@@ -73,6 +138,31 @@ private:
         juce::Array<Ditherer> ditherers;
     };
 
+    //==============================================================================
+    /** The state of one of the files being written. */
+    struct Output
+    {
+        Output (const Renderer::Parameters& targetParams, int firstChannelToUse, int numChannelsToUse)
+            : originalParams (targetParams), params (targetParams),
+              firstChannel (firstChannelToUse), numChannels (numChannelsToUse),
+              ditherers (numChannelsToUse, targetParams.bitDepth)
+        {
+        }
+
+        Renderer::Parameters originalParams, params;
+        int firstChannel = 0, numChannels = 0;
+        std::unique_ptr<AudioFileWriter> writer;
+        std::unique_ptr<juce::TemporaryFile> intermediateFile;
+        Ditherers ditherers;
+
+        float peak = 0.0001f;
+        double rmsTotal = 0;
+        int64_t rmsNumSamps = 0;
+        int64_t numNonZeroSamps = 0;
+        int64_t samplesTrimmed = 0;
+        bool hasStartedSavingToFile = false;
+    };
+
     //==============================================================================
     Renderer::RenderTask& owner;
     Renderer::Parameters r, originalParams;
@@ -84,12 +174,15 @@ private:
     std::unique_ptr<TracktionNodePlayer> nodePlayer;
     
     int numOutputChans = 0;
-    std::unique_ptr<AudioFileWriter> writer;
+    std::vector<std::unique_ptr<Output>> outputs;
+
+    std::unique_ptr<WritePipeline> writePipeline;
+    Renderer::Parameters::StageTimings timings;
     Plugin::Array plugins;
     juce::Result status;
 
     //==============================================================================
-    Ditherers ditherers;
+    juce::AudioBuffer<float> renderingBuffer;
     MidiMessageArray midiBuffer;
 
     const float thresholdForStopping { dbToGain (-70.0f) };
@@ -103,18 +196,11 @@ private:
     int sleepCounter = 0;
 
     std::unique_ptr<TempoSequencePosition> currentTempoPosition;
-    float peak = 0;
-    double rmsTotal = 0;
-    int64_t rmsNumSamps = 0;
-    int64_t numNonZeroSamps = 0;
     int precount = 0;
     double streamTime = 0;
 
-    int64_t samplesTrimmed = 0;
-    bool hasStartedSavingToFile = 0;
     int64_t samplesToWrite = 0, numSamplesWrittenToSource = 0;
 
-    std::unique_ptr<juce::TemporaryFile> intermediateFile;
     juce::AudioFormatWriter::ThreadedWriter::IncomingDataReceiver* sourceToUpdate;
 
     //==============================================================================
@@ -124,7 +210,8 @@ private:
         failed
     };
     
-    WriteResult writeAudioBlock (choc::buffer::ChannelArrayView<float>);
+    bool addOutput (const juce::File& destFile, int firstChannel, int numChannels);
+    WriteResult writeAudioBlock (Output&, choc::buffer::ChannelArrayView<float>);
 };
 
 } // namespace tracktion_engine
@@ -0,0 +1,265 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if GRAPH_UNIT_TESTS_NODERENDERCONTEXT
+
+//==============================================================================
+//==============================================================================
+class WritePipelineTests : public juce::UnitTest
+{
+public:
+    WritePipelineTests()
+        : juce::UnitTest ("WritePipeline", "tracktion_graph")
+    {
+    }
+
+    void runTest() override
+    {
+        runWriteTest();
+        runBackpressureTest();
+        runWriteFailureTest();
+        runCancelTest();
+    }
+
+private:
+    //==============================================================================
+    static constexpr int numChannels = 4, blockSize = 64;
+
+    /** Lets a test hold the writer threads up until it's ready. */
+    struct Gate
+    {
+        void open()
+        {
+            {
+                const std::lock_guard<std::mutex> l (mutex);
+                isOpen = true;
+            }
+
+            condition.notify_all();
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> l (mutex);
+            condition.wait (l, [this] { return isOpen; });
+        }
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool isOpen = false;
+    };
+
+    /** Records the first sample of each channel of the blocks each output is given. */
+    struct WrittenBlocks
+    {
+        void add (size_t outputIndex, choc::buffer::ChannelArrayView<float> block)
+        {
+            const std::lock_guard<std::mutex> l (mutex);
+
+            for (choc::buffer::ChannelCount c = 0; c < block.getNumChannels(); ++c)
+                values[outputIndex].push_back (block.getSample (c, 0));
+        }
+
+        size_t getNumWritten (size_t outputIndex, size_t numChannelsPerOutput)
+        {
+            const std::lock_guard<std::mutex> l (mutex);
+            return values[outputIndex].size() / numChannelsPerOutput;
+        }
+
+        std::mutex mutex;
+        std::map<size_t, std::vector<float>> values;
+    };
+
+    static std::vector<choc::buffer::ChannelRange> getStereoOutputs()
+    {
+        return { { 0, 2 }, { 2, 4 } };
+    }
+
+    /** Fills each channel with its index and the block number so the writes can be checked. */
+    static juce::AudioBuffer<float> createBlock (int blockNumber)
+    {
+        juce::AudioBuffer<float> block (numChannels, blockSize);
+
+        for (int c = 0; c < numChannels; ++c)
+            juce::FloatVectorOperations::fill (block.getWritePointer (c), getValue (blockNumber, c), blockSize);
+
+        return block;
+    }
+
+    static float getValue (int blockNumber, int channel)
+    {
+        return (float) (blockNumber * numChannels + channel);
+    }
+
+    static bool push (NodeRenderContext::WritePipeline& pipeline, int blockNumber, double& waitSeconds)
+    {
+        auto block = createBlock (blockNumber);
+        return pipeline.push (tracktion_graph::toBufferView (block), waitSeconds);
+    }
+
+    //==============================================================================
+    void runWriteTest()
+    {
+        beginTest ("Each output writes its channels of every block in order");
+        {
+            WrittenBlocks written;
+            NodeRenderContext::WritePipeline pipeline (numChannels, blockSize, getStereoOutputs(),
+                                                       [&] (size_t outputIndex, choc::buffer::ChannelArrayView<float> block)
+                                                       {
+                                                           written.add (outputIndex, block);
+                                                           return true;
+                                                       });
+
+            const int numBlocks = (int) pipeline.getNumBlocks() * 3;
+            double waitSeconds = 0;
+
+            for (int i = 0; i < numBlocks; ++i)
+                expect (push (pipeline, i, waitSeconds));
+
+            pipeline.finish();
+
+            for (size_t output = 0; output < 2; ++output)
+            {
+                auto& values = written.values[output];
+                expectEquals ((int) values.size(), numBlocks * 2);
+
+                for (int i = 0; i < numBlocks && (size_t) (i * 2 + 1) < values.size(); ++i)
+                {
+                    expectEquals (values[(size_t) i * 2],     getValue (i, (int) output * 2));
+                    expectEquals (values[(size_t) i * 2 + 1], getValue (i, (int) output * 2 + 1));
+                }
+            }
+        }
+    }
+
+    void runBackpressureTest()
+    {
+        beginTest ("Pushing waits for the writers when the queue is full");
+        {
+            Gate gate;
+            WrittenBlocks written;
+            NodeRenderContext::WritePipeline pipeline (numChannels, blockSize, getStereoOutputs(),
+                                                       [&] (size_t outputIndex, choc::buffer::ChannelArrayView<float> block)
+                                                       {
+                                                           gate.wait();
+                                                           written.add (outputIndex, block);
+                                                           return true;
+                                                       });
+
+            // The queue can be filled without the writers doing anything
+            const int numBlocks = (int) pipeline.getNumBlocks();
+            double waitSeconds = 0;
+
+            for (int i = 0; i < numBlocks; ++i)
+                expect (push (pipeline, i, waitSeconds));
+
+            // But the next block has to wait for one to be written
+            std::atomic<bool> hasPushed { false };
+            double blockedWaitSeconds = 0;
+            bool pushResult = false;
+
+            std::thread pushThread ([&]
+                                    {
+                                        pushResult = push (pipeline, numBlocks, blockedWaitSeconds);
+                                        hasPushed = true;
+                                    });
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (100));
+            expect (! hasPushed, "Push didn't wait for a free block");
+
+            gate.open();
+            pushThread.join();
+
+            expect (hasPushed.load());
+            expect (pushResult);
+            expectGreaterThan (blockedWaitSeconds, 0.0);
+
+            pipeline.finish();
+            expectEquals ((int) written.getNumWritten (0, 2), numBlocks + 1);
+            expectEquals ((int) written.getNumWritten (1, 2), numBlocks + 1);
+        }
+    }
+
+    void runWriteFailureTest()
+    {
+        beginTest ("A failed write stops the pipeline");
+        {
+            WrittenBlocks written;
+            NodeRenderContext::WritePipeline pipeline (numChannels, blockSize, getStereoOutputs(),
+                                                       [&] (size_t outputIndex, choc::buffer::ChannelArrayView<float> block)
+                                                       {
+                                                           written.add (outputIndex, block);
+
+                                                           // The first output fails on its second block
+                                                           return ! (outputIndex == 0 && written.getNumWritten (0, 2) == 2);
+                                                       });
+
+            // Once the first output has stopped the queue fills up and push has to report the failure
+            const int maxNumPushes = (int) pipeline.getNumBlocks() + 3;
+            double waitSeconds = 0;
+            int numPushed = 0;
+
+            while (numPushed < maxNumPushes && push (pipeline, numPushed, waitSeconds))
+                ++numPushed;
+
+            expect (numPushed < maxNumPushes, "The failure wasn't reported by push");
+            expect (! push (pipeline, numPushed, waitSeconds), "Pushing after a failure succeeded");
+
+            pipeline.finish();
+            expectEquals ((int) written.getNumWritten (0, 2), 2, "Writing continued after a failure");
+        }
+    }
+
+    void runCancelTest()
+    {
+        beginTest ("Cancelling drops the blocks that haven't been written");
+        {
+            Gate gate;
+            std::atomic<int> numWritesStarted { 0 };
+            NodeRenderContext::WritePipeline pipeline (numChannels, blockSize, { { 0, (choc::buffer::ChannelCount) numChannels } },
+                                                       [&] (size_t, choc::buffer::ChannelArrayView<float>)
+                                                       {
+                                                           ++numWritesStarted;
+                                                           gate.wait();
+                                                           return true;
+                                                       });
+
+            const int numBlocks = (int) pipeline.getNumBlocks();
+            double waitSeconds = 0;
+
+            for (int i = 0; i < numBlocks; ++i)
+                expect (push (pipeline, i, waitSeconds));
+
+            while (numWritesStarted == 0)
+                std::this_thread::yield();
+
+            // Let the write in progress finish once the pipeline has been cancelled
+            std::thread gateThread ([&]
+                                    {
+                                        std::this_thread::sleep_for (std::chrono::milliseconds (100));
+                                        gate.open();
+                                    });
+
+            pipeline.cancel();
+            gateThread.join();
+
+            expectEquals (numWritesStarted.load(), 1, "Queued blocks were written after cancelling");
+        }
+    }
+};
+
+static WritePipelineTests writePipelineTests;
+
+#endif
+
+} // namespace tracktion_engine
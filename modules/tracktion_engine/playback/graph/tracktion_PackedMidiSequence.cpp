@@ -0,0 +1,308 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+PackedMidiSequence::PackedMidiSequence (const juce::MidiMessageSequence& source)
+{
+    // Work on a copy so the source's matched pairs can be left alone
+    juce::MidiMessageSequence sequence (source);
+    sequence.sort();
+    sequence.updateMatchedPairs();
+
+    const int numEvents = sequence.getNumEvents();
+    events.resize ((size_t) numEvents);
+
+    std::unordered_map<const juce::MidiMessageSequence::MidiEventHolder*, int> holderIndexes;
+    holderIndexes.reserve ((size_t) numEvents);
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        auto meh = sequence.getEventPointer (i);
+        holderIndexes[meh] = i;
+
+        auto& m = meh->message;
+        auto& e = events[(size_t) i];
+        e.time = m.getTimeStamp();
+
+        auto data = m.getRawData();
+        const auto numBytes = m.getRawDataSize();
+
+        if (numBytes <= 3 && data[0] != 0xf0 && data[0] != 0xff)
+        {
+            e.shortMessage = choc::midi::ShortMessage (data, (size_t) numBytes);
+
+            if (e.isNoteOn())
+                noteOnChannelMask |= (1 << e.shortMessage.getChannel1to16());
+        }
+        else
+        {
+            e.longMessageOffset = (uint32_t) longMessageData.size();
+            e.longMessageSize = (uint32_t) numBytes;
+            longMessageData.insert (longMessageData.end(), data, data + numBytes);
+        }
+    }
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        auto meh = sequence.getEventPointer (i);
+
+        if (meh->noteOffObject != nullptr && events[(size_t) i].isNoteOn())
+        {
+            auto found = holderIndexes.find (meh->noteOffObject);
+
+            if (found != holderIndexes.end())
+                events[(size_t) i].noteOffIndex = found->second;
+        }
+    }
+
+    buildCheckpoints();
+}
+
+const PackedMidiSequence::Event* PackedMidiSequence::getNoteOff (const Event& noteOn) const noexcept
+{
+    if (noteOn.noteOffIndex < 0)
+        return nullptr;
+
+    return &events[(size_t) noteOn.noteOffIndex];
+}
+
+int PackedMidiSequence::getNextIndexAtTime (double time, int hintIndex) const noexcept
+{
+    const int numEvents = size();
+
+    if (hintIndex >= 0 && hintIndex <= numEvents
+        && (hintIndex == numEvents || getEventTime (hintIndex) >= time)
+        && (hintIndex == 0 || getEventTime (hintIndex - 1) < time))
+        return hintIndex;
+
+    auto found = std::lower_bound (events.begin(), events.end(), time,
+                                   [] (const Event& e, double t) { return e.time < t; });
+
+    return (int) std::distance (events.begin(), found);
+}
+
+juce::MidiMessage PackedMidiSequence::createMessage (const Event& e) const
+{
+    if (e.isLongMessage())
+        return juce::MidiMessage (longMessageData.data() + e.longMessageOffset, (int) e.longMessageSize, e.time);
+
+    return juce::MidiMessage (e.shortMessage.data, (int) e.shortMessage.size(), e.time);
+}
+
+//==============================================================================
+void PackedMidiSequence::createControllerUpdatesForTime (int firstChannel, int lastChannel, double time,
+                                                         juce::Array<juce::MidiMessage>& dest) const
+{
+    jassert (firstChannel > 0 && lastChannel <= 16);
+
+    // Events at the time itself count as already having happened
+    const auto endIndex = (int) std::distance (events.begin(),
+                                               std::upper_bound (events.begin(), events.end(), time,
+                                                                 [] (double t, const Event& e) { return t < e.time; }));
+
+    ChannelState states[16];
+    getChannelStatesBefore (endIndex, firstChannel, lastChannel, states);
+
+    for (int channel = firstChannel; channel <= lastChannel; ++channel)
+    {
+        auto& state = states[channel - 1];
+
+        int32_t indexes[130];
+        int numIndexes = 0;
+
+        auto addIndex = [&] (int32_t index)
+        {
+            if (index >= 0)
+                indexes[numIndexes++] = index;
+        };
+
+        addIndex (state.lastProgramChange);
+        addIndex (state.lastPitchWheel);
+
+        for (auto index : state.lastController)
+            addIndex (index);
+
+        // Most recent first to match MidiMessageSequence
+        std::sort (indexes, indexes + numIndexes, std::greater<int32_t>());
+
+        for (int i = 0; i < numIndexes; ++i)
+        {
+            auto m = createMessage (events[(size_t) indexes[i]]);
+            m.setTimeStamp (0.0);
+            dest.add (m);
+        }
+    }
+}
+
+void PackedMidiSequence::reconstructMPEExpression (int firstChannel, int lastChannel, double time,
+                                                   juce::Array<juce::MidiMessage>& dest) const
+{
+    jassert (firstChannel > 0 && lastChannel <= 16);
+
+    ChannelState states[16];
+    getChannelStatesBefore (getNextIndexAtTime (time), firstChannel, lastChannel, states);
+
+    auto valueOr = [] (int value, int defaultValue) { return value >= 0 ? value : defaultValue; };
+
+    for (int channel = firstChannel; channel <= lastChannel; ++channel)
+    {
+        auto& state = states[channel - 1];
+
+        if (state.lastNoteEvent < 0)
+            continue;
+
+        auto& noteOn = events[(size_t) state.lastNoteEvent].shortMessage;
+
+        if ((noteOn.data[0] & 0xf0) != 0x90)
+            continue;
+
+        auto& initial = state.atLastNoteOn;
+        auto& mostRecent = state.sinceNoteOn;
+        const int centrePitchbend = juce::MidiMessage::pitchbendToPitchwheelPos (0.0f, 12.f);
+
+        dest.add (juce::MidiMessage::controllerEvent       (channel, 74, valueOr (initial.timbre, 64)));
+        dest.add (juce::MidiMessage::channelPressureChange (channel,     valueOr (initial.pressure, 0)));
+        dest.add (juce::MidiMessage::pitchWheel            (channel,     valueOr (initial.pitchBend, centrePitchbend)));
+        dest.add (juce::MidiMessage::noteOn (channel, noteOn.data[1], noteOn.data[2]));
+
+        if (mostRecent.timbre >= 0)
+            dest.add (juce::MidiMessage::controllerEvent (channel, 74, mostRecent.timbre));
+
+        if (mostRecent.pressure >= 0)
+            dest.add (juce::MidiMessage::channelPressureChange (channel, mostRecent.pressure));
+
+        if (mostRecent.pitchBend >= 0)
+            dest.add (juce::MidiMessage::pitchWheel (channel, mostRecent.pitchBend));
+    }
+}
+
+//==============================================================================
+PackedMidiSequence::ChannelState::ChannelState() noexcept
+{
+    std::fill (std::begin (lastController), std::end (lastController), -1);
+}
+
+void PackedMidiSequence::ChannelState::apply (const Event& e, int eventIndex) noexcept
+{
+    auto data = e.shortMessage.data;
+
+    switch (data[0] & 0xf0)
+    {
+        case 0x80:
+            lastNoteEvent = eventIndex;
+            sinceNoteOff = {};
+            break;
+
+        case 0x90:
+            // This mirrors MPEStartTrimmer where any 0x9n message counts as a note-on
+            // but one with zero velocity also counts as a note-off
+            lastNoteEvent = eventIndex;
+            atLastNoteOn = sinceNoteOff;
+            sinceNoteOn = {};
+
+            if (data[2] == 0)
+                sinceNoteOff = {};
+
+            break;
+
+        case 0xb0:
+            lastController[data[1] & 0x7f] = eventIndex;
+
+            if (data[1] == 74)
+                sinceNoteOn.timbre = sinceNoteOff.timbre = data[2];
+
+            break;
+
+        case 0xc0:
+            lastProgramChange = eventIndex;
+            break;
+
+        case 0xd0:
+            sinceNoteOn.pressure = sinceNoteOff.pressure = data[1];
+            break;
+
+        case 0xe0:
+            lastPitchWheel = eventIndex;
+            sinceNoteOn.pitchBend = sinceNoteOff.pitchBend = data[1] | (data[2] << 7);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void PackedMidiSequence::buildCheckpoints()
+{
+    const int numEvents = size();
+    checkpoints.resize ((size_t) (numEvents / checkpointInterval + 1));
+
+    ChannelState states[16];
+    std::set<int32_t> heldNotes;
+    std::vector<int32_t> noteOnIndexForNoteOff ((size_t) numEvents, -1);
+
+    for (int i = 0; i < numEvents; ++i)
+        if (events[(size_t) i].noteOffIndex >= 0)
+            noteOnIndexForNoteOff[(size_t) events[(size_t) i].noteOffIndex] = i;
+
+    for (int i = 0; i <= numEvents; ++i)
+    {
+        if (i % checkpointInterval == 0)
+        {
+            auto& checkpoint = checkpoints[(size_t) (i / checkpointInterval)];
+            std::copy (std::begin (states), std::end (states), std::begin (checkpoint.channels));
+
+            checkpoint.heldNotesStart = (uint32_t) heldNoteOnIndexes.size();
+            heldNoteOnIndexes.insert (heldNoteOnIndexes.end(), heldNotes.begin(), heldNotes.end());
+            checkpoint.heldNotesEnd = (uint32_t) heldNoteOnIndexes.size();
+        }
+
+        if (i == numEvents)
+            break;
+
+        auto& e = events[(size_t) i];
+
+        if (e.noteOffIndex >= 0)
+            heldNotes.insert (i);
+        else if (noteOnIndexForNoteOff[(size_t) i] >= 0)
+            heldNotes.erase (noteOnIndexForNoteOff[(size_t) i]);
+
+        if (! e.isLongMessage())
+            states[e.shortMessage.getChannel0to15()].apply (e, i);
+    }
+}
+
+void PackedMidiSequence::getChannelStatesBefore (int index, int firstChannel, int lastChannel, ChannelState* dest) const noexcept
+{
+    if (checkpoints.empty())
+        return;
+
+    const auto checkpointIndex = index / checkpointInterval;
+    auto& checkpoint = checkpoints[(size_t) checkpointIndex];
+
+    for (int channel = firstChannel; channel <= lastChannel; ++channel)
+        dest[channel - 1] = checkpoint.channels[channel - 1];
+
+    for (int i = checkpointIndex * checkpointInterval; i < index; ++i)
+    {
+        auto& e = events[(size_t) i];
+
+        if (e.isLongMessage())
+            continue;
+
+        const int channel = e.shortMessage.getChannel1to16();
+
+        if (channel >= firstChannel && channel <= lastChannel)
+            dest[channel - 1].apply (e, i);
+    }
+}
+
+} // namespace tracktion_engine
@@ -0,0 +1,184 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    A compact, contiguous, time-sorted copy of a MidiMessageSequence for playback.
+
+    Short messages are stored inline in each event, longer ones (e.g. sysex) live in
+    a single side arena and note-ons hold the index of their matching note-off.
+    This means events can be iterated and converted to juce::MidiMessages on the
+    audio thread without chasing pointers or allocating.
+*/
+class PackedMidiSequence
+{
+public:
+    /** Creates an empty sequence. */
+    PackedMidiSequence() = default;
+
+    /** Creates a packed copy of a MidiMessageSequence.
+        This doesn't require the source to have had its note pairs matched.
+    */
+    explicit PackedMidiSequence (const juce::MidiMessageSequence&);
+
+    //==============================================================================
+    /** A single event in the sequence. */
+    struct Event
+    {
+        double time = 0.0;                      /**< The time of the event in seconds. */
+        int32_t noteOffIndex = -1;              /**< For note-ons, the index of the matching note-off or -1. */
+        uint32_t longMessageOffset = 0;         /**< For long messages, the start of the data in the arena. */
+        uint32_t longMessageSize = 0;           /**< For long messages, the number of bytes in the arena. */
+        choc::midi::ShortMessage shortMessage;  /**< The message itself if it's a short one. */
+
+        /** Returns true if the message data lives in the sequence's arena. */
+        bool isLongMessage() const              { return longMessageSize > 0; }
+
+        /** Returns true if this is a short note-on with a non-zero velocity. */
+        bool isNoteOn() const                   { return ! isLongMessage() && shortMessage.isNoteOn(); }
+
+        /** Returns true if this is a short note-off or note-on with zero velocity. */
+        bool isNoteOff() const                  { return ! isLongMessage() && shortMessage.isNoteOff(); }
+    };
+
+    //==============================================================================
+    /** Returns the number of events in the sequence. */
+    int size() const noexcept                               { return (int) events.size(); }
+
+    /** Returns true if there are no events in the sequence. */
+    bool isEmpty() const noexcept                           { return events.empty(); }
+
+    /** Returns an event. The index must be in range. */
+    const Event& operator[] (int index) const noexcept      { return events[(size_t) index]; }
+
+    /** Returns the time of an event. The index must be in range. */
+    double getEventTime (int index) const noexcept          { return events[(size_t) index].time; }
+
+    /** Returns the note-off matching a note-on event or nullptr if there isn't one. */
+    const Event* getNoteOff (const Event&) const noexcept;
+
+    /** Returns the index of the first event at or after the given time.
+        If the hint index is already in the right place this is constant time,
+        otherwise it's a binary search.
+    */
+    int getNextIndexAtTime (double time, int hintIndex = -1) const noexcept;
+
+    /** Returns a bitmask with bit N set for each MIDI channel N (1-16) that has a note-on on it. */
+    int getNoteOnChannelMask() const noexcept               { return noteOnChannelMask; }
+
+    /** Creates a juce::MidiMessage for an event.
+        For short messages this won't allocate.
+    */
+    juce::MidiMessage createMessage (const Event&) const;
+
+    /** Returns the total number of bytes used by long messages. */
+    size_t getLongMessageDataSize() const noexcept          { return longMessageData.size(); }
+
+    //==============================================================================
+    /** Adds the most recent program change, pitch-wheel and controller messages at
+        or before the given time for each channel in [firstChannel, lastChannel].
+        This gives the same messages in the same order as
+        juce::MidiMessageSequence::createControllerUpdatesForTime but only replays
+        events from the nearest checkpoint rather than the whole sequence.
+    */
+    void createControllerUpdatesForTime (int firstChannel, int lastChannel, double time,
+                                         juce::Array<juce::MidiMessage>& dest) const;
+
+    /** Adds the messages needed to restore the MPE state of each channel in
+        [firstChannel, lastChannel] at the given time.
+        This gives the same messages as MPEStartTrimmer::reconstructExpression but
+        only replays events from the nearest checkpoint rather than the whole sequence.
+    */
+    void reconstructMPEExpression (int firstChannel, int lastChannel, double time,
+                                   juce::Array<juce::MidiMessage>& dest) const;
+
+    /** Calls a function for each note-on before the given time whose note-off is at
+        or after it, in sequence order. The callback is passed the note-on and note-off Events.
+    */
+    template<typename Callback>
+    void forEachNoteSoundingAt (double time, Callback&& callback) const;
+
+    /** Returns the number of checkpoints the chase state is stored at. */
+    size_t getNumCheckpoints() const noexcept               { return checkpoints.size(); }
+
+private:
+    //==============================================================================
+    /** The number of events between each chase checkpoint. */
+    static constexpr int checkpointInterval = 1024;
+
+    struct ExpressionState
+    {
+        int timbre = -1, pressure = -1, pitchBend = -1;
+    };
+
+    /** The chase state of a single channel, built from all the events before an index. */
+    struct ChannelState
+    {
+        ChannelState() noexcept;
+
+        void apply (const Event&, int eventIndex) noexcept;
+
+        int32_t lastProgramChange = -1, lastPitchWheel = -1;
+        int32_t lastController[128];
+        int32_t lastNoteEvent = -1;
+        ExpressionState sinceNoteOn, sinceNoteOff, atLastNoteOn;
+    };
+
+    struct Checkpoint
+    {
+        ChannelState channels[16];
+        uint32_t heldNotesStart = 0, heldNotesEnd = 0;
+    };
+
+    std::vector<Event> events;
+    std::vector<uint8_t> longMessageData;
+    std::vector<Checkpoint> checkpoints;
+    std::vector<int32_t> heldNoteOnIndexes;
+    int noteOnChannelMask = 0;
+
+    void buildCheckpoints();
+    void getChannelStatesBefore (int index, int firstChannel, int lastChannel, ChannelState* dest) const noexcept;
+};
+
+//==============================================================================
+template<typename Callback>
+void PackedMidiSequence::forEachNoteSoundingAt (double time, Callback&& callback) const
+{
+    const int endIndex = getNextIndexAtTime (time);
+
+    if (endIndex == 0)
+        return;
+
+    // Any note still sounding must either have been held at the checkpoint or started after it
+    const auto checkpointIndex = (size_t) (endIndex / checkpointInterval);
+    auto& checkpoint = checkpoints[checkpointIndex];
+
+    for (auto i = checkpoint.heldNotesStart; i < checkpoint.heldNotesEnd; ++i)
+    {
+        auto& noteOn = events[(size_t) heldNoteOnIndexes[i]];
+        auto& noteOff = events[(size_t) noteOn.noteOffIndex];
+
+        if (noteOff.time >= time)
+            callback (noteOn, noteOff);
+    }
+
+    for (int i = (int) checkpointIndex * checkpointInterval; i < endIndex; ++i)
+    {
+        auto& noteOn = events[(size_t) i];
+
+        if (auto noteOff = getNoteOff (noteOn))
+            if (noteOff->time >= time)
+                callback (noteOn, *noteOff);
+    }
+}
+
+} // namespace tracktion_engine
@@ -47,7 +47,7 @@ public:
         
         // Member variables have to be updated from the previous Node or if the graph gets
         // rebuilt during the countdown period, the playhead time will jump back
-        updateFromPreviousNode (info.rootNodeToReplace);
+        updateFromPreviousNode (info.nodesToReplace);
     }
     
     void process (ProcessContext& pc) override
@@ -109,28 +109,16 @@ private:
         updateReferencePositionOnJump = false;
     }
 
-    void updateFromPreviousNode (Node* rootNodeToReplace)
+    void updateFromPreviousNode (const tracktion_graph::NodeIDIndex* nodesToReplace)
     {
-        if (rootNodeToReplace == nullptr)
+        if (nodesToReplace == nullptr)
             return;
         
-        auto nodeIDToLookFor = getNodeProperties().nodeID;
-        
-        if (nodeIDToLookFor == 0)
-            return;
-
-        auto visitor = [this, nodeIDToLookFor] (Node& node)
+        if (auto other = nodesToReplace->find<PlayHeadPositionNode> (getNodeProperties().nodeID))
         {
-            if (auto other = dynamic_cast<PlayHeadPositionNode*> (&node))
-            {
-                if (other->getNodeProperties().nodeID == nodeIDToLookFor)
-                {
-                    state = other->state;
-                    updateReferencePositionOnJump = false;
-                }
-            }
-        };
-        visitNodes (*rootNodeToReplace, visitor, true);
+            state = other->state;
+            updateReferencePositionOnJump = false;
+        }
     }
 };
 
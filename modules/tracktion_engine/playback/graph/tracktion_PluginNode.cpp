@@ -96,7 +96,14 @@ void PluginNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationInf
     if (props.latencyNumSamples > 0)
         automationAdjustmentTime = -tracktion_graph::sampleToTime (props.latencyNumSamples, sampleRate);
     
-    if (shouldUseFineGrainAutomation (*plugin))
+    midiMessageArray.setFixedCapacity (getMidiCapacityForInputs (info.blockSize));
+
+    // Plugins that follow their automation with ramps don't need the block splitting up.
+    // This uses the interval the plugin took when it was initialised, which is the same
+    // one it uses to decide whether to read ramps, so one of them always follows the automation
+    const bool canUseAutomationRamps = plugin->getAutomationRampInterval() > 0;
+
+    if (shouldUseFineGrainAutomation (*plugin) && ! canUseAutomationRamps)
         subBlockSizeToUse = std::max (128, 128 * juce::roundToInt (info.sampleRate / 44100.0));
     
     canProcessBypassed = balanceLatency
@@ -105,7 +112,7 @@ void PluginNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationInf
     
     if (canProcessBypassed)
     {
-        replaceLatencyProcessorIfPossible (info.rootNodeToReplace);
+        replaceLatencyProcessorIfPossible (info.nodesToReplace);
         
         if (! latencyProcessor)
         {
@@ -283,40 +290,27 @@ PluginRenderContext PluginNode::getPluginRenderContext (int64_t referenceSampleP
              playHead.isPlaying(), playHead.isUserDragging(), isRendering, canProcessBypassed };
 }
 
-void PluginNode::replaceLatencyProcessorIfPossible (Node* rootNodeToReplace)
+void PluginNode::replaceLatencyProcessorIfPossible (const tracktion_graph::NodeIDIndex* nodesToReplace)
 {
-    if (rootNodeToReplace == nullptr)
+    if (nodesToReplace == nullptr)
         return;
     
     auto props = getNodeProperties();
-    auto nodeIDToLookFor = props.nodeID;
-    
-    if (nodeIDToLookFor == 0)
+    auto other = nodesToReplace->find<PluginNode> (props.nodeID);
+
+    if (other == nullptr || ! other->latencyProcessor)
         return;
 
-    auto visitor = [this, nodeIDToLookFor, props] (Node& node)
+    if (! latencyProcessor)
     {
-        if (auto other = dynamic_cast<PluginNode*> (&node))
-        {
-            if (other->getNodeProperties().nodeID == nodeIDToLookFor)
-            {
-                if (! other->latencyProcessor)
-                    return;
-                
-                if (! latencyProcessor)
-                {
-                    if (other->latencyProcessor->hasConfiguration (latencyNumSamples, sampleRate, props.numberOfChannels))
-                        latencyProcessor = other->latencyProcessor;
-
-                    return;
-                }
-
-                if (latencyProcessor->hasSameConfigurationAs (*other->latencyProcessor))
-                    latencyProcessor = other->latencyProcessor;
-            }
-        }
-    };
-    visitNodes (*rootNodeToReplace, visitor, true);
+        if (other->latencyProcessor->hasConfiguration (latencyNumSamples, sampleRate, props.numberOfChannels))
+            latencyProcessor = other->latencyProcessor;
+
+        return;
+    }
+
+    if (latencyProcessor->hasSameConfigurationAs (*other->latencyProcessor))
+        latencyProcessor = other->latencyProcessor;
 }
 
 }
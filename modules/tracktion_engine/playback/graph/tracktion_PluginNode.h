@@ -87,7 +87,7 @@ private:
     //==============================================================================
     void initialisePlugin (double sampleRateToUse, int blockSizeToUse);
     PluginRenderContext getPluginRenderContext (int64_t, juce::AudioBuffer<float>&);
-    void replaceLatencyProcessorIfPossible (Node*);
+    void replaceLatencyProcessorIfPossible (const tracktion_graph::NodeIDIndex*);
 };
 
 }
@@ -16,9 +16,6 @@ namespace tracktion_engine
 //==============================================================================
 struct SpeedRampWaveNode::PerChannelState
 {
-    PerChannelState()    { resampler.reset(); }
-    
-    juce::LagrangeInterpolator resampler;
     float lastSample = 0;
 };
 
@@ -77,6 +74,9 @@ void SpeedRampWaveNode::prepareToPlay (const tracktion_graph::PlaybackInitialisa
     if (reader != nullptr)
         for (int i = std::max (channelsToUse.size(), reader->getNumChannels()); --i >= 0;)
             channelState.add (new PerChannelState());
+
+    resampler.setQuality (audioFile.engine->getEngineBehaviour().getResamplingQuality (isOfflineRender));
+    resampler.prepare (channelState.size());
 }
 
 bool SpeedRampWaveNode::isReadyToProcess()
@@ -200,14 +200,15 @@ void SpeedRampWaveNode::processSection (ProcessContext& pc, juce::Range<int64_t>
     auto numChannels = (choc::buffer::ChannelCount) destBufferChannels.size();
     assert (pc.buffers.audio.getNumChannels() == numChannels);
 
-    AudioScratchBuffer fileData ((int) numChannels, numFileSamples + 2);
+    const int numFileSamplesToRead = numFileSamples + resampler.getNumLookAheadSamples();
+    AudioScratchBuffer fileData ((int) numChannels, numFileSamplesToRead);
 
     uint32_t lastSampleFadeLength = 0;
 
     {
         SCOPED_REALTIME_CHECK
 
-        if (reader->readSamples (numFileSamples + 2, fileData.buffer, destBufferChannels, 0,
+        if (reader->readSamples (numFileSamplesToRead, fileData.buffer, destBufferChannels, 0,
                                  channelsToUse,
                                  isOfflineRender ? 5000 : 3))
         {
@@ -242,15 +243,17 @@ void SpeedRampWaveNode::processSection (ProcessContext& pc, juce::Range<int64_t>
     
     jassert ((int) numChannels <= channelState.size()); // this should always have been made big enough
 
+    // All the channels are resampled together, then de-clicked individually
+    const auto numChannelsToResample = std::min (numChannels, (choc::buffer::ChannelCount) channelState.size());
+    resampler.processAdding (ratio, fileData.buffer.getArrayOfReadPointers(), numFileSamplesToRead,
+                             destBuffer.getFirstChannels (numChannelsToResample), gains, 2);
+
     for (choc::buffer::ChannelCount channel = 0; channel < numChannels; ++channel)
     {
-        if (channel < (choc::buffer::ChannelCount) channelState.size())
+        if (channel < numChannelsToResample)
         {
-            const auto src = fileData.buffer.getReadPointer ((int) channel);
             const auto dest = destBuffer.getChannel (channel).data.data;
-
             auto& state = *channelState.getUnchecked ((int) channel);
-            state.resampler.processAdding (ratio, src, dest, (int) numSamples, gains[channel & 1]);
 
             if (lastSampleFadeLength > 0)
             {
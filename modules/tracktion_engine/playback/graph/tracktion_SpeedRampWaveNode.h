@@ -70,6 +70,7 @@ private:
     const juce::AudioChannelSet channelsToUse, destChannels;
     AudioFileCache::Reader::Ptr reader;
 
+    Resampler resampler;
     struct PerChannelState;
     juce::OwnedArray<PerChannelState> channelState;
     bool playedLastBlock = false;
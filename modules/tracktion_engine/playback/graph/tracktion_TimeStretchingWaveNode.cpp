@@ -13,212 +13,558 @@ namespace tracktion_engine
 
 //==============================================================================
 //==============================================================================
-TimeStretchingWaveNode::TimeStretchingWaveNode (AudioClipBase& clip, tracktion_graph::PlayHeadState& playHeadStateToUse)
-    : c (clip), playHeadState (playHeadStateToUse), clipPtr (clip),
-      file (c.getAudioFile()),
-      fileInfo (file.getInfo()),
-      sampleRate (fileInfo.sampleRate),
-      fifo ((choc::buffer::ChannelCount) std::max (1, fileInfo.numChannels), 8192)
+/**
+    A FIFO of audio that a background thread renders ahead of the audio thread.
+
+    The background thread calls getWritePosition to find where to render from and
+    pushes the rendered frames with write. The audio thread reads blocks with
+    readAdding and never waits for the background thread:
+     - If a block isn't all ready, whatever is ready is used and the rest is left
+       silent. The same number of frames are discarded when they do arrive so
+       the output stays in time.
+     - If a block doesn't follow on from the last one, or has fallen too far behind
+       to catch up, everything in the FIFO is discarded and the background thread
+       is asked to render from the start of the next block. Anything it was
+       rendering for the old position is dropped when it's written.
+
+    The lock is only held whilst frames are pushed and whilst the audio thread
+    discards them for a seek, never whilst rendering.
+*/
+class RenderAheadFifo
 {
-    CRASH_TRACER
+public:
+    RenderAheadFifo (int numChannels, int capacity)
+        : fifo ((choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) capacity),
+          maxFramesBehind (capacity)
+    {
+    }
 
-    reader = c.edit.engine.getAudioFileManager().cache.createReader (file);
+    //==============================================================================
+    /** Returns the position the next frames written should be rendered from.
+        This should only be called by the background thread.
+    */
+    int64_t getWritePosition()
+    {
+        const auto generation = seekGeneration.load (std::memory_order_acquire);
 
-    auto wi = clip.getWaveInfo();
-    auto& li = c.getLoopInfo();
+        if (generation != writeGeneration)
+        {
+            writeGeneration = generation;
+            writePosition = seekPosition.load (std::memory_order_acquire);
+        }
 
-    if (li.getNumBeats() > 0)
-    {
-        if (c.getAutoTempo() && wi.hashCode != 0)
-            speedRatio = (float) (li.getBpm (wi) / clip.edit.tempoSequence.getTempo (0)->getBpm());
-        else
-            speedRatio = (float) c.getSpeedRatio();
+        return writePosition;
     }
 
-    const int rootNote = li.getRootNote();
+    /** Returns the number of frames that can be written. */
+    int getFreeSpace() const noexcept               { return fifo.getFreeSpace(); }
+
+    /** Returns the number of frames that have been written and not read yet. */
+    int getNumReady() const noexcept                { return fifo.getNumReady(); }
 
-    if (rootNote != -1)
+    /** Pushes frames rendered from the last position returned by getWritePosition.
+        Returns false if they were dropped because the audio thread has seeked since.
+        This should only be called by the background thread.
+    */
+    bool write (choc::buffer::ChannelArrayView<float> frames)
     {
-        if (c.getAutoPitch() && rootNote != -1)
-            pitchSemitones = (float) c.getTransposeSemiTones (true);
-        else
-            pitchSemitones = c.getPitchChange();
+        const juce::SpinLock::ScopedLockType sl (pushLock);
+
+        if (seekGeneration.load (std::memory_order_acquire) != writeGeneration)
+            return false;
+
+        const bool res = fifo.write (frames);
+        jassert (res); juce::ignoreUnused (res);
+        writePosition += (int64_t) frames.getNumFrames();
+        return true;
     }
 
-    jassert (speedRatio >= 0.1f);
-    speedRatio = std::max (speedRatio, 0.1f);
-}
+    //==============================================================================
+    /** Adds the frames for a block starting at a position to a buffer, returning
+        the number that were ready. This should only be called by the audio thread.
+    */
+    int readAdding (choc::buffer::ChannelArrayView<float> dest, int64_t position)
+    {
+        const auto numFrames = (int) dest.getNumFrames();
 
-//==============================================================================
-tracktion_graph::NodeProperties TimeStretchingWaveNode::getNodeProperties()
-{
-    tracktion_graph::NodeProperties props;
-    props.hasAudio = true;
-    props.numberOfChannels = fileInfo.numChannels;
-    return props;
-}
+        if (position != readPosition || numFramesToDiscard > maxFramesBehind)
+        {
+            const juce::SpinLock::ScopedTryLockType sl (pushLock);
+
+            // The background thread is pushing frames so try again next block
+            if (! sl.isLocked())
+            {
+                readPosition = -1;
+                return 0;
+            }
+
+            fifo.removeSamples (fifo.getNumReady());
+            numFramesToDiscard = 0;
+            readPosition = position + numFrames;
+            seekPosition.store (readPosition, std::memory_order_release);
+            seekGeneration.fetch_add (1, std::memory_order_release);
+            return 0;
+        }
 
-std::vector<tracktion_graph::Node*> TimeStretchingWaveNode::getDirectInputNodes()
-{
-    return {};
-}
+        // Drop the frames that were left silent when they weren't ready in time
+        if (numFramesToDiscard > 0)
+        {
+            const auto numToDiscard = std::min (numFramesToDiscard, fifo.getNumReady());
+            fifo.removeSamples (numToDiscard);
+            numFramesToDiscard -= numToDiscard;
+        }
 
-void TimeStretchingWaveNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo& info)
-{
-    CRASH_TRACER
+        const auto numReady = numFramesToDiscard > 0 ? 0 : std::min (numFrames, fifo.getNumReady());
 
-    // Elastique can't handle blocks larger than 1024
-    stretchBlockSize = std::min (std::max (info.blockSize, 512), 1024);
-    sampleRate = info.sampleRate;
+        if (numReady > 0)
+            fifo.readAdding (dest.getStart ((choc::buffer::FrameCount) numReady));
 
-    const TimeStretcher::Mode m = c.getTimeStretchMode();
+        numFramesToDiscard += numFrames - numReady;
+        readPosition += numFrames;
 
-    if (TimeStretcher::canProcessFor (m))
-    {
-        fileSpeedRatio = float (fileInfo.sampleRate / sampleRate);
-        const float resamplingPitchRatio = fileSpeedRatio > 0.0f ? (float) std::log2 (fileSpeedRatio) : 1.0f;
-        timestretcher.initialise (info.sampleRate, stretchBlockSize, fileInfo.numChannels, m, c.elastiqueProOptions.get(), false);
-        timestetchSpeedRatio = std::max (0.1f, float (speedRatio / fileSpeedRatio));
-        timestetchSemitonesUp = float ((pitchSemitones + (resamplingPitchRatio * 12.0f)));
-        timestretcher.setSpeedAndPitch (timestetchSpeedRatio, timestetchSemitonesUp);
+        return numReady;
     }
 
-    fifo.setSize ((choc::buffer::ChannelCount) fileInfo.numChannels,
-                  (choc::buffer::FrameCount) timestretcher.getMaxFramesNeeded());
-}
+private:
+    //==============================================================================
+    tracktion_graph::AudioFifo fifo;
+    const int maxFramesBehind;
+    juce::SpinLock pushLock;
 
-bool TimeStretchingWaveNode::isReadyToProcess()
-{
-    if (file.getHash() == 0)
-        return true;
+    std::atomic<int64_t> seekPosition { 0 };
+    std::atomic<uint32_t> seekGeneration { 0 };
 
-    if (reader == nullptr)
-        reader = c.edit.engine.getAudioFileManager().cache.createReader (file);
+    int64_t readPosition = 0;       // Only used by the audio thread
+    int numFramesToDiscard = 0;     // Only used by the audio thread
+    int64_t writePosition = 0;      // Only used by the background thread
+    uint32_t writeGeneration = 0;   // Only used by the background thread
 
-    return reader != nullptr && reader->getSampleRate() > 0.0;
-}
+    JUCE_DECLARE_NON_COPYABLE (RenderAheadFifo)
+};
 
-void TimeStretchingWaveNode::process (ProcessContext& pc)
+//==============================================================================
+/** The thread that renders all the real time stretched streams ahead of playback. */
+struct TimeStretchingThread  : public juce::TimeSliceThread
 {
-    CRASH_TRACER
-    const auto timelineRange = referenceSampleRangeToSplitTimelineRange (playHeadState.playHead, pc.referenceSampleRange).timelineRange1;
-    const auto editRange = tracktion_graph::sampleToTime (timelineRange, sampleRate);
+    TimeStretchingThread()
+        : juce::TimeSliceThread ("Time Stretching")
+    {
+        startThread (7);
+    }
 
-    if (timelineRange.isEmpty())
-        return;
+    ~TimeStretchingThread() override
+    {
+        stopThread (1000);
+    }
+};
 
-    auto destAudioView = pc.buffers.audio;
+//==============================================================================
+//==============================================================================
+/**
+    Renders a clip's AudioSegmentList at the output sample rate.
 
-    if (! playHeadState.isContiguousWithPreviousBlock() || editRange.getStart() != nextEditTime)
-        reset (editRange.getStart());
+    Positions are in output samples from the start of the clip. Each segment that
+    overlaps the rendered range is played by one of a small pool of voices, each
+    with its own reader and TimeStretcher, so crossfading segments can overlap.
 
-    auto numSamples = destAudioView.getNumFrames();
-    choc::buffer::FrameCount start = 0;
+    The stream renders ahead into a RenderAheadFifo on a TimeStretchingThread shared
+    by all the streams. The audio thread only ever reads from the FIFO so it plays
+    silence after a seek until the stretched audio for the new position arrives.
 
-    while (numSamples > 0)
+    For offline renders nothing is rendered ahead. Each block is rendered when it's
+    read, waiting for the file to be read if it needs to, so the output doesn't
+    depend on the timing of the background thread.
+*/
+class TimeStretchingWaveNode::StretchedStream  : private juce::TimeSliceClient
+{
+public:
+    StretchedStream (Engine& engine, const AudioFile& file, const AudioClipBase::ProxyRenderingInfo& info,
+                     double sampleRateToUse, int maxBlockSize, int numChannelsToUse, int64_t lengthInSamplesToUse,
+                     bool isOfflineRenderToUse)
+        : outputSampleRate (sampleRateToUse),
+          numChannels (numChannelsToUse),
+          lengthInSamples (lengthInSamplesToUse),
+          // Elastique can't handle blocks larger than 1024
+          stretchBlockSize (std::min (std::max (maxBlockSize, 512), 1024)),
+          crossfadeSamples ((int64_t) (info.audioSegmentList->getCrossfadeLength() * sampleRateToUse)),
+          channelSet (juce::AudioChannelSet::canonicalChannelSet (numChannelsToUse)),
+          isOfflineRender (isOfflineRenderToUse)
     {
-        auto numReady = std::min (numSamples, (choc::buffer::FrameCount) fifo.getNumReady());
+        CRASH_TRACER
+        const auto fileSampleRate = file.getSampleRate();
 
-        if (numReady > 0)
+        // Feeding the file at the output rate shifts its pitch so this is corrected for by the stretcher
+        const auto resamplingSemitones = (float) (12.0 * std::log2 (fileSampleRate / outputSampleRate));
+
+        for (auto& s : info.audioSegmentList->getSegments())
         {
-            const bool res = fifo.readAdding (destAudioView.getFrameRange ({ start, start + numReady }));
-            jassert (res); juce::ignoreUnused (res);
+            const auto range = s.getRange();
+            const juce::Range<int64_t> outputRange ((int64_t) std::llround (range.getStart() * outputSampleRate),
+                                                    (int64_t) std::llround (range.getEnd() * outputSampleRate));
+
+            if (outputRange.isEmpty() || s.getSampleRange().isEmpty())
+                continue;
 
-            start += numReady;
-            numSamples -= numReady;
+            const auto inputSamplesPerOutputSample = s.getSampleRange().getLength() / (double) outputRange.getLength();
+            segments.push_back ({ &s, outputRange, inputSamplesPerOutputSample,
+                                  (float) inputSamplesPerOutputSample, s.getTranspose() + resamplingSemitones });
         }
-        else
+
+        for (int i = 0; i < numVoices; ++i)
         {
-            if (! fillNextBlock())
-                break;
+            auto v = std::make_unique<Voice>();
+            v->reader = engine.getAudioFileManager().cache.createReader (file);
+            v->stretcher.initialise (outputSampleRate, stretchBlockSize, numChannels, info.mode, info.options, false);
+            jassert (v->stretcher.isInitialised()); // Have you enabled a TimeStretcher mode?
+            v->output.setSize (numChannels, stretchBlockSize);
+            voices.push_back (std::move (v));
+        }
+
+        const int maxFramesNeeded = voices.front()->stretcher.getMaxFramesNeeded();
+        inputScratch.resize ({ (choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) std::max (maxFramesNeeded, stretchBlockSize) });
+        renderScratch.resize ({ (choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) stretchBlockSize });
+
+        if (! isOfflineRender)
+        {
+            const int lookAheadSamples = std::max ({ 4 * stretchBlockSize, 2 * maxBlockSize, (int) (outputSampleRate * lookAheadSeconds) });
+            fifo = std::make_unique<RenderAheadFifo> (numChannels, lookAheadSamples);
+            backgroundThread.emplace();
+            (*backgroundThread)->addTimeSliceClient (this);
         }
     }
 
-    nextEditTime = editRange.getEnd();
-}
+    ~StretchedStream() override
+    {
+        if (backgroundThread)
+            (*backgroundThread)->removeTimeSliceClient (this);
+    }
 
-//==============================================================================
-int64_t TimeStretchingWaveNode::timeToFileSample (double time) const noexcept
-{
-    const double fileStartTime = time / speedRatio;
-    return juce::roundToInt (fileStartTime * fileInfo.sampleRate);
-}
+    /** Adds the stretched audio for a block starting at a position to a buffer.
+        This is called from the audio thread.
+    */
+    void readAdding (choc::buffer::ChannelArrayView<float> dest, int64_t position)
+    {
+        if (isOfflineRender)
+            renderAdding (dest, position, backgroundReadTimeoutMs);
+        else
+            fifo->readAdding (dest, position);
+    }
 
-void TimeStretchingWaveNode::reset (double newStartTime)
-{
-    const int64_t readPos = timeToFileSample (newStartTime);
+private:
+    //==============================================================================
+    static constexpr int numVoices = 4;
+    static constexpr double lookAheadSeconds = 0.25;
+    static constexpr int backgroundReadTimeoutMs = 100;
 
-    if (reader != nullptr)
+    struct SegmentInfo
     {
-        if (readPos == reader->getReadPosition())
-            return;
+        const AudioSegmentList::Segment* segment;
+        juce::Range<int64_t> outputRange;
+        double inputSamplesPerOutputSample;
+        float speedRatio, semitones;
+    };
+
+    struct Voice
+    {
+        TimeStretcher stretcher;
+        AudioFileCache::Reader::Ptr reader;
+        juce::AudioBuffer<float> output;
+        int readyStart = 0, readyEnd = 0;
+        int64_t nextPosition = 0;
+        int segmentIndex = -1;
+        bool flushed = false;
+    };
 
-        reader->setReadPosition (readPos);
+    const double outputSampleRate;
+    const int numChannels;
+    const int64_t lengthInSamples;
+    const int stretchBlockSize;
+    const int64_t crossfadeSamples;
+    const juce::AudioChannelSet channelSet;
+    const bool isOfflineRender;
+
+    std::vector<SegmentInfo> segments;
+    std::vector<std::unique_ptr<Voice>> voices;
+    choc::buffer::ChannelArrayBuffer<float> inputScratch, renderScratch;
+
+    // Only used for real time playback
+    std::unique_ptr<RenderAheadFifo> fifo;
+    std::optional<juce::SharedResourcePointer<TimeStretchingThread>> backgroundThread;
+
+    //==============================================================================
+    int useTimeSlice() override
+    {
+        // The voices are only used by this thread so nothing is locked whilst rendering
+        const auto position = fifo->getWritePosition();
+
+        // Check back soon in case the audio thread seeks
+        if (position >= lengthInSamples || fifo->getFreeSpace() < stretchBlockSize)
+            return 5;
+
+        auto view = renderScratch.getView();
+        view.clear();
+        renderAdding (view, position, backgroundReadTimeoutMs);
+        fifo->write (view);
+
+        return 0;
     }
 
-    fifo.reset();
+    void renderAdding (choc::buffer::ChannelArrayView<float> dest, int64_t position, int readTimeoutMs)
+    {
+        CRASH_TRACER
+        const auto range = juce::Range<int64_t>::withStartAndLength (position, (int64_t) dest.getNumFrames());
 
-    timestretcher.reset();
-    timestretcher.setSpeedAndPitch (timestetchSpeedRatio, timestetchSemitonesUp);
-}
+        // Free up any voices whose segments aren't needed for this range
+        for (auto& v : voices)
+            if (v->segmentIndex >= 0 && ! segments[(size_t) v->segmentIndex].outputRange.intersects (range))
+                v->segmentIndex = -1;
 
-bool TimeStretchingWaveNode::fillNextBlock()
-{
-    CRASH_TRACER
-    const int needed = timestretcher.getFramesNeeded();
-    jassert (needed < fifo.getFreeSpace());
-    jassert (reader != nullptr);
+        auto firstSegment = std::upper_bound (segments.begin(), segments.end(), position,
+                                              [] (int64_t pos, const SegmentInfo& s) { return pos < s.outputRange.getEnd(); });
 
-    if (reader == nullptr)
-        return false;
+        for (auto s = firstSegment; s != segments.end() && s->outputRange.getStart() < range.getEnd(); ++s)
+        {
+            const auto segmentIndex = (int) std::distance (segments.begin(), s);
+            const auto segmentRange = s->outputRange.getIntersectionWith (range);
 
-    AudioScratchBuffer fifoScratch (fileInfo.numChannels, stretchBlockSize);
+            if (auto v = getVoiceFor (segmentIndex))
+                renderSegmentAdding (*v, *s, dest.getFrameRange (tracktion_graph::frameRangeWithStartAndLength ((choc::buffer::FrameCount) (segmentRange.getStart() - position),
+                                                                                                                  (choc::buffer::FrameCount) segmentRange.getLength())),
+                                     segmentRange.getStart(), readTimeoutMs);
+        }
+    }
 
-    float* outs[] =
+    Voice* getVoiceFor (int segmentIndex)
     {
-        fifoScratch.buffer.getWritePointer (0),
-        fileInfo.numChannels > 1 ? fifoScratch.buffer.getWritePointer (1) : nullptr,
-        nullptr
-    };
+        for (auto& v : voices)
+            if (v->segmentIndex == segmentIndex)
+                return v.get();
+
+        for (auto& v : voices)
+        {
+            if (v->segmentIndex < 0)
+            {
+                v->segmentIndex = segmentIndex;
+                v->nextPosition = -1;
+                return v.get();
+            }
+        }
+
+        jassertfalse; // More segments are overlapping than there are voices
+        return nullptr;
+    }
 
-    if (needed >= 0)
+    void seek (Voice& v, const SegmentInfo& s, int64_t position)
     {
-        AudioScratchBuffer scratch (fileInfo.numChannels, needed);
-        const juce::AudioChannelSet bufChannels = fileInfo.numChannels == 1 ? juce::AudioChannelSet::mono() : juce::AudioChannelSet::stereo();
-        const juce::AudioChannelSet channelsToUse = juce::AudioChannelSet::stereo();
+        v.nextPosition = position;
+        v.readyStart = v.readyEnd = 0;
+        v.flushed = false;
+
+        if (v.reader == nullptr)
+            return;
+
+        const auto sampleRange = s.segment->getSampleRange();
+        const auto inputOffset = (int64_t) ((position - s.outputRange.getStart()) * s.inputSamplesPerOutputSample);
 
-        if (needed > 0)
+        if (s.segment->isFollowedBySilence())
         {
-            bool b = reader->readSamples (needed, scratch.buffer, bufChannels, 0, channelsToUse, 3);
-            juce::ignoreUnused (b);
-            // don't worry about failed reads -- they are cache misses. It'll catch up
+            v.reader->setLoopRange ({});
+            v.reader->setReadPosition (sampleRange.getStart() + inputOffset);
+        }
+        else
+        {
+            v.reader->setLoopRange (sampleRange);
+            v.reader->setReadPosition (inputOffset);
         }
 
-        const float* ins[] =
+        v.stretcher.reset();
+        v.stretcher.setSpeedAndPitch (s.speedRatio, s.semitones);
+    }
+
+    void renderSegmentAdding (Voice& v, const SegmentInfo& s, choc::buffer::ChannelArrayView<float> dest,
+                              int64_t position, int readTimeoutMs)
+    {
+        if (v.nextPosition != position)
+            seek (v, s, position);
+
+        if (v.reader == nullptr)
+            return;
+
+        const auto numFrames = (int) dest.getNumFrames();
+        int numDone = 0, numEmptyBlocks = 0;
+
+        while (numDone < numFrames)
         {
-            scratch.buffer.getReadPointer (0),
-            fileInfo.numChannels > 1 ? scratch.buffer.getReadPointer (1) : nullptr,
-            nullptr
-        };
+            const int numReady = std::min (numFrames - numDone, v.readyEnd - v.readyStart);
+
+            if (numReady > 0)
+            {
+                addWithFades (v, s, dest.getFrameRange (tracktion_graph::frameRangeWithStartAndLength ((choc::buffer::FrameCount) numDone,
+                                                                                                       (choc::buffer::FrameCount) numReady)));
+                v.readyStart += numReady;
+                v.nextPosition += numReady;
+                numDone += numReady;
+                numEmptyBlocks = 0;
+            }
+            else if (! fillNextBlock (v, readTimeoutMs) || ++numEmptyBlocks > 32)
+            {
+                // Nothing more is coming out of the stretcher so leave the rest silent
+                v.nextPosition = position + numFrames;
+                break;
+            }
+        }
+    }
+
+    bool fillNextBlock (Voice& v, int readTimeoutMs)
+    {
+        if (v.flushed)
+            return false;
+
+        float* outs[maxNumChannels] = {};
+
+        for (int i = 0; i < numChannels; ++i)
+            outs[i] = v.output.getWritePointer (i);
+
+        const int needed = v.stretcher.getFramesNeeded();
+        int numRead = 0;
+
+        if (needed >= 0)
+        {
+            auto input = inputScratch.getView().getStart ((choc::buffer::FrameCount) needed);
+            input.clear();
+
+            // Don't worry about failed reads, they're cache misses and will catch up
+            if (needed > 0)
+                v.reader->readSamples (input, channelSet, channelSet, readTimeoutMs);
+
+            const float* ins[maxNumChannels] = {};
 
-        if (TimeStretcher::canProcessFor (c.getTimeStretchMode()))
-            timestretcher.processData (ins, needed, outs);
+            for (int i = 0; i < numChannels; ++i)
+                ins[i] = input.getChannel ((choc::buffer::ChannelCount) i).data.data;
+
+            numRead = v.stretcher.processData (ins, needed, outs);
+        }
         else
-            for (int channel = fileInfo.numChannels; --channel >= 0;)
-                juce::FloatVectorOperations::copy (outs[channel], ins[channel], needed);
+        {
+            jassert (needed == -1);
+            numRead = v.stretcher.flush (outs);
+            v.flushed = true;
+        }
+
+        v.readyStart = 0;
+        v.readyEnd = numRead;
+
+        return true;
     }
-    else
+
+    void addWithFades (Voice& v, const SegmentInfo& s, choc::buffer::ChannelArrayView<float> dest)
     {
-        jassert (needed == -1);
-        timestretcher.flush (outs);
+        const auto numFrames = (int) dest.getNumFrames();
+        const auto range = juce::Range<int64_t>::withStartAndLength (v.nextPosition, numFrames);
+        const auto fadeIn = juce::Range<int64_t>::withStartAndLength (s.outputRange.getStart(), crossfadeSamples);
+        const auto fadeOut = juce::Range<int64_t> (s.outputRange.getEnd() - crossfadeSamples, s.outputRange.getEnd());
+        const bool needsFadeIn = s.segment->hasFadeIn() && fadeIn.intersects (range);
+        const bool needsFadeOut = s.segment->hasFadeOut() && fadeOut.intersects (range);
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            auto src = v.output.getReadPointer (chan, v.readyStart);
+            auto dst = dest.getChannel ((choc::buffer::ChannelCount) chan).data.data;
+
+            if (! (needsFadeIn || needsFadeOut))
+            {
+                juce::FloatVectorOperations::add (dst, src, numFrames);
+                continue;
+            }
+
+            for (int i = 0; i < numFrames; ++i)
+            {
+                const auto pos = range.getStart() + i;
+                float gain = 1.0f;
+
+                if (needsFadeIn && pos < fadeIn.getEnd())
+                    gain *= AudioFadeCurve::alphaToGainForType (AudioFadeCurve::convex, (pos - fadeIn.getStart()) / (float) crossfadeSamples);
+
+                if (needsFadeOut && pos >= fadeOut.getStart())
+                    gain *= AudioFadeCurve::alphaToGainForType (AudioFadeCurve::convex, (fadeOut.getEnd() - pos) / (float) crossfadeSamples);
+
+                dst[i] += src[i] * gain;
+            }
+        }
     }
 
-    const bool res = fifo.write (choc::buffer::createChannelArrayView (fifoScratch.buffer.getArrayOfWritePointers(),
-                                                                       (choc::buffer::ChannelCount) fifoScratch.buffer.getNumChannels(),
-                                                                       (choc::buffer::FrameCount) stretchBlockSize));
-    jassert (res); juce::ignoreUnused (res);
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StretchedStream)
+};
+
+//==============================================================================
+//==============================================================================
+TimeStretchingWaveNode::TimeStretchingWaveNode (AudioClipBase& clip, ProcessState& processStateToUse, bool isOfflineRenderToUse)
+    : TracktionEngineNode (processStateToUse),
+      c (clip), clipPtr (clip),
+      file (c.getAudioFile()),
+      fileInfo (file.getInfo()),
+      renderingInfo (c.createProxyRenderingInfo()),
+      editPosition (c.getEditTimeRange()),
+      clipLevel (c.getLiveClipLevel()),
+      editItemID (c.itemID),
+      numChannels (juce::jlimit (1, maxNumChannels, fileInfo.numChannels)),
+      isOfflineRender (isOfflineRenderToUse)
+{
+}
+
+TimeStretchingWaveNode::~TimeStretchingWaveNode()
+{
+}
+
+//==============================================================================
+tracktion_graph::NodeProperties TimeStretchingWaveNode::getNodeProperties()
+{
+    tracktion_graph::NodeProperties props;
+    props.hasAudio = true;
+    props.numberOfChannels = numChannels;
+    props.nodeID = (size_t) editItemID.getRawID();
+    return props;
+}
+
+void TimeStretchingWaveNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo& info)
+{
+    CRASH_TRACER
+    sampleRate = info.sampleRate;
+    editPositionInSamples = tracktion_graph::timeToSample ({ editPosition.start, editPosition.end }, sampleRate);
 
+    if (file.getHash() != 0 && renderingInfo != nullptr)
+        stream = std::make_unique<StretchedStream> (c.edit.engine, file, *renderingInfo, sampleRate, info.blockSize,
+                                                    numChannels, editPositionInSamples.getLength(), isOfflineRender);
+}
+
+bool TimeStretchingWaveNode::isReadyToProcess()
+{
     return true;
 }
 
+void TimeStretchingWaveNode::process (ProcessContext& pc)
+{
+    CRASH_TRACER
+    const auto timelineRange = getTimelineSampleRange();
+    const auto clipRange = timelineRange.getIntersectionWith (editPositionInSamples);
+
+    if (stream == nullptr || clipRange.isEmpty())
+        return;
+
+    auto dest = pc.buffers.audio.getFrameRange (tracktion_graph::frameRangeWithStartAndLength ((choc::buffer::FrameCount) (clipRange.getStart() - timelineRange.getStart()),
+                                                                                               (choc::buffer::FrameCount) clipRange.getLength()));
+    stream->readAdding (dest, clipRange.getStart() - editPositionInSamples.getStart());
+
+    float gains[2];
+
+    // For stereo, use the pan, otherwise ignore it
+    if (numChannels == 2)
+        clipLevel.getLeftAndRightGains (gains[0], gains[1]);
+    else
+        gains[0] = gains[1] = clipLevel.getGainIncludingMute();
+
+    for (choc::buffer::ChannelCount chan = 0; chan < dest.getNumChannels(); ++chan)
+        juce::FloatVectorOperations::multiply (dest.getChannel (chan).data.data, gains[std::min (chan, 1u)], (int) dest.getNumFrames());
+}
+
 } // namespace tracktion_engine
@@ -13,46 +13,56 @@ namespace tracktion_engine
 
 //==============================================================================
 //==============================================================================
-/** Node that reads from a file node and timestretches its output.
+/** Node that reads from an audio clip's source file and timestretches its output
+    in real time.
 
-    Annoyingly, this has to replicate a lot of the functionality in WaveNode.
-    Note that this isn't designed to be a fully fledged Node, it doesn't deal
-    with clip offsets, loops etc. It's only designed for previewing files.
+    This plays back the same AudioSegmentList that's used to render a clip's
+    time-stretched proxy file so honours the clip's offset, loop range, speed ratio,
+    warp markers, auto-tempo and pitch changes. The stretched audio is rendered
+    ahead on a background thread shared by all the nodes so the audio thread only
+    has to read it from a FIFO. After a seek or loop there is a short silence
+    whilst the audio for the new position is rendered.
+
+    Offline renders should still use the clip's proxy file. If isOfflineRender is
+    true, each block is stretched when it's processed instead of ahead of time,
+    which is mostly useful for comparing the output with the proxy.
 */
-class TimeStretchingWaveNode final : public tracktion_graph::Node
+class TimeStretchingWaveNode final : public tracktion_graph::Node,
+                                     public TracktionEngineNode
 {
 public:
-    TimeStretchingWaveNode (AudioClipBase&, tracktion_graph::PlayHeadState&);
+    TimeStretchingWaveNode (AudioClipBase&, ProcessState&, bool isOfflineRender);
+    ~TimeStretchingWaveNode() override;
 
     //==============================================================================
     tracktion_graph::NodeProperties getNodeProperties() override;
-    std::vector<Node*> getDirectInputNodes() override;
     void prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo&) override;
     bool isReadyToProcess() override;
     void process (ProcessContext&) override;
 
 private:
     //==============================================================================
+    static constexpr int maxNumChannels = 8;
+
     AudioClipBase& c;
-    tracktion_graph::PlayHeadState& playHeadState;
     Clip::Ptr clipPtr;
 
     AudioFile file;
     AudioFileInfo fileInfo;
-    AudioFileCache::Reader::Ptr reader;
+    std::unique_ptr<AudioClipBase::ProxyRenderingInfo> renderingInfo;
+    const EditTimeRange editPosition;
+    LiveClipLevel clipLevel;
+    const EditItemID editItemID;
+    const int numChannels;
+    const bool isOfflineRender;
 
-    double sampleRate = 44100.0, fileSpeedRatio = 1.0, nextEditTime = -1.0;
-    TimeStretcher timestretcher;
-    float speedRatio = 1.0f, pitchSemitones = 0;
-    float timestetchSpeedRatio = 1.0f, timestetchSemitonesUp = 1.0f;
+    double sampleRate = 44100.0;
+    juce::Range<int64_t> editPositionInSamples;
 
-    tracktion_graph::AudioFifo fifo;
-    int stretchBlockSize = 512;
+    class StretchedStream;
+    std::unique_ptr<StretchedStream> stream;
 
-    //==============================================================================
-    int64_t timeToFileSample (double) const noexcept;
-    void reset (double newStartTime);
-    bool fillNextBlock();
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeStretchingWaveNode)
 };
 
 } // namespace tracktion_engine
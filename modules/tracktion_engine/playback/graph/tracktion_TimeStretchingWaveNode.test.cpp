@@ -0,0 +1,363 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if GRAPH_UNIT_TESTS_TIMESTRETCHINGWAVENODE
+
+//==============================================================================
+//==============================================================================
+class TimeStretchingWaveNodeTests : public juce::UnitTest
+{
+public:
+    TimeStretchingWaveNodeTests()
+        : juce::UnitTest ("TimeStretchingWaveNode", "tracktion_graph")
+    {
+    }
+
+    void runTest() override
+    {
+        runRenderAheadFifoTests();
+
+        if (! TimeStretcher::canProcessFor (TimeStretcher::defaultMode))
+        {
+            logMessage ("No TimeStretcher mode is enabled so skipping TimeStretchingWaveNode tests");
+            return;
+        }
+
+        // The proxy is rendered in blocks of 1024 at the file's sample rate so
+        // use the same here to give the stretchers the same input
+        tracktion_graph::test_utilities::TestSetup ts;
+        ts.sampleRate = 44100.0;
+        ts.blockSize = 1024;
+
+        runProxyComparisonTest (ts, "Stretched and pitched", 1.5, 3.0f, {}, 0.0);
+        runProxyComparisonTest (ts, "Stretched, pitched and offset", 0.75, -5.0f, {}, 0.5);
+        runProxyComparisonTest (ts, "Stretched, pitched, offset and looped", 1.5, 3.0f, { 0.4, 1.4 }, 0.2);
+
+        runProxyComparisonTest (ts, "Warped", 1.0, 2.0f, {}, 0.0,
+                                [] (Edit&, AudioClipBase& clip)
+                                {
+                                    clip.setWarpTime (true);
+                                    auto& warpTimeManager = clip.getWarpTimeManager();
+                                    warpTimeManager.insertMarker ({ 1.0, 0.7 });
+                                    warpTimeManager.insertMarker ({ 2.0, 2.3 });
+                                });
+
+        runProxyComparisonTest (ts, "Auto-tempo with a tempo change", 1.0, 0.0f, {}, 0.0,
+                                [] (Edit& edit, AudioClipBase& clip)
+                                {
+                                    clip.getLoopInfo().setBpm (120.0, clip.getAudioFile().getInfo());
+                                    clip.setAutoTempo (true);
+                                    edit.tempoSequence.insertTempo (4.0, 90.0, 0.0f);
+                                });
+    }
+
+private:
+    //==============================================================================
+    static constexpr double fileLengthSeconds = 4.0;
+    static constexpr int windowSize = 2048;
+
+    /** Creates a sin file that gets louder over its length so the RMS of a window
+        shows which part of the file it came from.
+    */
+    static std::unique_ptr<juce::TemporaryFile> getRampedSinFile (double sampleRate)
+    {
+        const auto numFrames = (int) (sampleRate * fileLengthSeconds);
+        const auto phaseIncrement = tracktion_graph::test_utilities::getPhaseIncrement (440.0f, sampleRate);
+        auto buffer = choc::buffer::createChannelArrayBuffer (1, numFrames,
+                                                              [=] (auto, auto frame)
+                                                              {
+                                                                  const auto gain = 0.1f + 0.9f * (float) frame / (float) numFrames;
+                                                                  return gain * std::sin ((float) (frame * phaseIncrement));
+                                                              });
+
+        auto f = std::make_unique<juce::TemporaryFile> (".wav");
+        tracktion_graph::test_utilities::writeToFile (f->getFile(), buffer, sampleRate);
+        return f;
+    }
+
+    static juce::AudioBuffer<float> renderProxy (AudioClipBase& clip, double sampleRate)
+    {
+        auto& engine = clip.edit.engine;
+        juce::TemporaryFile proxyFile (".wav");
+        juce::AudioBuffer<float> result;
+
+        {
+            AudioFileWriter writer (AudioFile (engine, proxyFile.getFile()), engine.getAudioFileFormatManager().getWavFormat(),
+                                    1, sampleRate, 32, {}, 0);
+            juce::ThreadPoolJob* const noJob = nullptr;
+            std::atomic<float> progress { 0.0f };
+
+            if (! writer.isOpen() || ! clip.createProxyRenderingInfo()->render (engine, clip.getAudioFile(), writer, noJob, progress))
+                return result;
+        }
+
+        if (auto reader = std::unique_ptr<juce::AudioFormatReader> (AudioFileUtils::createReaderFor (engine, proxyFile.getFile())))
+        {
+            result.setSize (1, (int) reader->lengthInSamples);
+            reader->read (&result, 0, result.getNumSamples(), 0, true, false);
+        }
+
+        return result;
+    }
+
+    static float getRMS (const juce::AudioBuffer<float>& buffer, int start, int numSamples)
+    {
+        return buffer.getRMSLevel (0, start, std::min (numSamples, buffer.getNumSamples() - start));
+    }
+
+    static int getNumZeroCrossings (const juce::AudioBuffer<float>& buffer, int start, int numSamples)
+    {
+        auto data = buffer.getReadPointer (0, start);
+        numSamples = std::min (numSamples, buffer.getNumSamples() - start);
+        int num = 0;
+
+        for (int i = 1; i < numSamples; ++i)
+            if ((data[i - 1] < 0.0f) != (data[i] < 0.0f))
+                ++num;
+
+        return num;
+    }
+
+    //==============================================================================
+    void runRenderAheadFifoTests()
+    {
+        constexpr int capacity = 1024, blockSize = 128;
+        choc::buffer::ChannelArrayBuffer<float> rendered (1, (choc::buffer::FrameCount) blockSize);
+        choc::buffer::ChannelArrayBuffer<float> block (1, (choc::buffer::FrameCount) blockSize);
+
+        // Renders a block whose samples are their positions, as the background thread would
+        auto render = [&] (RenderAheadFifo& fifo)
+        {
+            const auto position = fifo.getWritePosition();
+
+            if (fifo.getFreeSpace() < blockSize)
+                return false;
+
+            for (int i = 0; i < blockSize; ++i)
+                rendered.getView().getChannel (0).data.data[i] = (float) (position + i);
+
+            return fifo.write (rendered.getView());
+        };
+
+        auto read = [&] (RenderAheadFifo& fifo, int64_t position)
+        {
+            block.clear();
+            return fifo.readAdding (block.getView(), position);
+        };
+
+        // Checks the block read starts at a position and is silent after the frames that were ready
+        auto expectBlock = [&] (int64_t position, int numReady)
+        {
+            int numWrong = 0;
+
+            for (int i = 0; i < blockSize; ++i)
+                if (block.getSample (0, (choc::buffer::FrameCount) i) != (i < numReady ? (float) (position + i) : 0.0f))
+                    ++numWrong;
+
+            expectEquals (numWrong, 0, "Wrong frames for block at " + juce::String (position));
+        };
+
+        beginTest ("RenderAheadFifo fills and reads in order");
+        {
+            RenderAheadFifo fifo (1, capacity);
+            int numRendered = 0;
+
+            while (render (fifo))
+                ++numRendered;
+
+            expectEquals (numRendered, (capacity - 1) / blockSize);
+            expectEquals (fifo.getNumReady(), numRendered * blockSize);
+
+            for (int64_t position = 0; position < numRendered * blockSize; position += blockSize)
+            {
+                expectEquals (read (fifo, position), blockSize);
+                expectBlock (position, blockSize);
+            }
+
+            expectEquals (fifo.getNumReady(), 0);
+        }
+
+        beginTest ("RenderAheadFifo underruns stay in time");
+        {
+            RenderAheadFifo fifo (1, capacity);
+            expect (render (fifo));
+
+            expectEquals (read (fifo, 0), blockSize);
+            expectBlock (0, blockSize);
+
+            // Nothing's ready for the next two blocks so they're silent
+            expectEquals (read (fifo, blockSize), 0);
+            expectBlock (blockSize, 0);
+            expectEquals (read (fifo, 2 * blockSize), 0);
+
+            // When they arrive, the frames for the silent blocks are dropped
+            for (int i = 0; i < 3; ++i)
+                expect (render (fifo));
+
+            expectEquals (read (fifo, 3 * blockSize), blockSize);
+            expectBlock (3 * blockSize, blockSize);
+
+            // A partially ready block is padded with silence and the rest dropped later
+            expect (render (fifo));
+            expectEquals (fifo.getWritePosition(), (int64_t) 5 * blockSize);
+
+            block.clear();
+            expectEquals (fifo.readAdding (block.getView().getStart ((choc::buffer::FrameCount) blockSize / 2), 4 * blockSize), blockSize / 2);
+            expectEquals (read (fifo, 4 * blockSize + blockSize / 2), blockSize / 2);
+            expectBlock (4 * blockSize + blockSize / 2, blockSize / 2);
+
+            expect (render (fifo));
+            expectEquals (read (fifo, 5 * blockSize + blockSize / 2), blockSize / 2);
+            expectBlock (5 * blockSize + blockSize / 2, blockSize / 2);
+        }
+
+        beginTest ("RenderAheadFifo seeking");
+        {
+            RenderAheadFifo fifo (1, capacity);
+            expect (render (fifo));
+            expect (render (fifo));
+
+            expectEquals (read (fifo, 0), blockSize);
+
+            // Seeking discards what's ready and plays silence whilst the new position is rendered
+            const int64_t seekPosition = 10000;
+            expectEquals (read (fifo, seekPosition), 0);
+            expectBlock (seekPosition, 0);
+            expectEquals (fifo.getNumReady(), 0);
+            expectEquals (fifo.getWritePosition(), seekPosition + blockSize);
+
+            expect (render (fifo));
+            expectEquals (read (fifo, seekPosition + blockSize), blockSize);
+            expectBlock (seekPosition + blockSize, blockSize);
+
+            // Frames being rendered when the audio thread seeks are dropped
+            const auto stalePosition = fifo.getWritePosition();
+            expectEquals (read (fifo, 20000), 0);
+
+            for (int i = 0; i < blockSize; ++i)
+                rendered.getView().getChannel (0).data.data[i] = (float) (stalePosition + i);
+
+            expect (! fifo.write (rendered.getView()));
+            expectEquals (fifo.getNumReady(), 0);
+
+            expect (render (fifo));
+            expectEquals (read (fifo, 20000 + blockSize), blockSize);
+            expectBlock (20000 + blockSize, blockSize);
+        }
+
+        beginTest ("RenderAheadFifo restarts after falling too far behind");
+        {
+            RenderAheadFifo fifo (1, capacity);
+            int64_t position = 0;
+
+            // Read without rendering until the missed frames are more than the FIFO can hold
+            while (position <= capacity)
+            {
+                expectEquals (read (fifo, position), 0);
+                position += blockSize;
+            }
+
+            expectEquals (fifo.getWritePosition(), (int64_t) 0);
+
+            // The next block asks for the stream to start again after it
+            expectEquals (read (fifo, position), 0);
+            expectEquals (fifo.getWritePosition(), position + blockSize);
+
+            expect (render (fifo));
+            expectEquals (read (fifo, position + blockSize), blockSize);
+            expectBlock (position + blockSize, blockSize);
+        }
+    }
+
+    //==============================================================================
+    void runProxyComparisonTest (tracktion_graph::test_utilities::TestSetup ts, juce::String name,
+                                 double speedRatio, float semitones, EditTimeRange loopRange, double offset,
+                                 std::function<void (Edit&, AudioClipBase&)> setUpClip = {})
+    {
+        using namespace tracktion_graph;
+        auto& engine = *tracktion_engine::Engine::getEngines()[0];
+
+        beginTest ("Real time stretching matches proxy: " + name);
+        {
+            auto sinFile = getRampedSinFile (ts.sampleRate);
+
+            auto edit = Edit::createSingleTrackEdit (engine);
+            auto track = getAudioTracks (*edit)[0];
+            const EditTimeRange clipTime (1.0, 4.0);
+            auto clip = track->insertWaveClip ("sin", sinFile->getFile(), { clipTime, 0.0 }, false);
+            expect (clip != nullptr);
+
+            clip->setTimeStretchMode (TimeStretcher::defaultMode);
+            clip->setSpeedRatio (speedRatio);
+            clip->setPitchChange (semitones);
+            clip->setOffset (offset);
+
+            if (! loopRange.isEmpty())
+                clip->setLoopRange (loopRange);
+
+            if (setUpClip)
+                setUpClip (*edit, *clip);
+
+            expect (clip->usesTimeStretchedProxy());
+
+            const auto proxy = renderProxy (*clip, ts.sampleRate);
+            expect (proxy.getNumSamples() >= timeToSample (clipTime.getLength(), ts.sampleRate));
+
+            tracktion_graph::PlayHead playHead;
+            tracktion_graph::PlayHeadState playHeadState (playHead);
+            ProcessState processState (playHeadState);
+            playHead.play ({ 0, std::numeric_limits<int64_t>::max() }, false);
+
+            auto node = makeNode<TimeStretchingWaveNode> (*clip, processState, true);
+            test_utilities::TestProcess<TracktionNodePlayer> testProcess (std::make_unique<TracktionNodePlayer> (std::move (node), processState, ts.sampleRate, ts.blockSize,
+                                                                                                                 getPoolCreatorFunction (ThreadPoolStrategy::realTime)),
+                                                                          ts, 1, clipTime.getEnd() + 1.0, true);
+            auto testContext = testProcess.processAll();
+            auto& realtime = testContext->buffer;
+
+            // Nothing outside the clip
+            test_utilities::expectAudioBuffer (*this, realtime, 0, timeToSample ({ 0.0, clipTime.getStart() }, ts.sampleRate), 0.0f, 0.0f);
+            test_utilities::expectAudioBuffer (*this, realtime, 0, timeToSample ({ clipTime.getEnd(), clipTime.getEnd() + 1.0 }, ts.sampleRate), 0.0f, 0.0f);
+
+            // The two paths fade segments slightly differently so compare the level
+            // and pitch of each window rather than individual samples
+            const auto clipStart = (int) timeToSample (clipTime.getStart(), ts.sampleRate);
+            const auto clipLength = (int) timeToSample (clipTime.getLength(), ts.sampleRate);
+            int numLevelMismatches = 0, numPitchMismatches = 0;
+
+            for (int start = 0; start + windowSize <= clipLength; start += windowSize)
+            {
+                const auto proxyRMS = getRMS (proxy, start, windowSize);
+                const auto realtimeRMS = getRMS (realtime, clipStart + start, windowSize);
+
+                if (std::abs (proxyRMS - realtimeRMS) > 0.05f)
+                    ++numLevelMismatches;
+
+                const auto proxyCrossings = getNumZeroCrossings (proxy, start, windowSize);
+                const auto realtimeCrossings = getNumZeroCrossings (realtime, clipStart + start, windowSize);
+
+                if (std::abs (proxyCrossings - realtimeCrossings) > std::max (2, proxyCrossings / 20))
+                    ++numPitchMismatches;
+            }
+
+            expectEquals (numLevelMismatches, 0, "Level differs from the proxy");
+            expectEquals (numPitchMismatches, 0, "Pitch differs from the proxy");
+        }
+    }
+};
+
+static TimeStretchingWaveNodeTests timeStretchingWaveNodeTests;
+
+#endif
+
+} // namespace tracktion_engine
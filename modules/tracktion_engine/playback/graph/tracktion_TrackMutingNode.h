@@ -77,6 +77,9 @@ public:
     TrackMutingNode (std::unique_ptr<TrackMuteState>, std::unique_ptr<tracktion_graph::Node> input,
                      bool dontMuteIfTrackContentsShouldBeProcessed);
 
+    /** Returns the ID of the Track or Edit this mutes. */
+    size_t getItemID() const                        { return trackMuteState->getItemID(); }
+
     //==============================================================================
     tracktion_graph::NodeProperties getNodeProperties() override;
     std::vector<Node*> getDirectInputNodes() override;
@@ -0,0 +1,33 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+size_t TracktionNodePlayer::getOwnerItemID (tracktion_graph::Node& node)
+{
+    if (auto trackMutingNode = dynamic_cast<TrackMutingNode*> (&node))
+        return trackMutingNode->getItemID();
+
+    if (auto pluginNode = dynamic_cast<PluginNode*> (&node))
+        return (size_t) pluginNode->getPlugin().itemID.getRawID();
+
+    // These all use the EditItemID of their clip, track or modifier as their nodeID
+    if (dynamic_cast<WaveNode*> (&node) != nullptr
+        || dynamic_cast<SpeedRampWaveNode*> (&node) != nullptr
+        || dynamic_cast<TimeStretchingWaveNode*> (&node) != nullptr
+        || dynamic_cast<MidiNode*> (&node) != nullptr
+        || dynamic_cast<ModifierNode*> (&node) != nullptr)
+        return node.getNodeProperties().nodeID;
+
+    return 0;
+}
+
+}
@@ -29,6 +29,7 @@ public:
           processState (processStateToUse),
           nodePlayer (std::move (poolCreator))
     {
+        nodePlayer.setNodeOwnerFunction (getOwnerItemID);
     }
 
     /** Creates an NodePlayer to process a Node. */
@@ -120,6 +121,15 @@ public:
         return numMisses;
     }
     
+    /** Runs a number of independent tasks on the player's threads and the calling thread.
+        @see tracktion_graph::LockFreeMultiThreadedNodePlayer::runTasks
+    */
+    template<typename TaskFunction>
+    void runTasks (size_t numTasks, TaskFunction&& taskFunction)
+    {
+        nodePlayer.runTasks (numTasks, std::forward<TaskFunction> (taskFunction));
+    }
+
     /** Clears the Node currently playing. */
     void clearNode()
     {
@@ -137,6 +147,47 @@ public:
     {
         nodePlayer.enablePooledMemoryAllocations (enablePooledMemory);
     }
+
+    //==============================================================================
+    /** Returns the profiler that records the time each Node takes to process.
+        The events are tagged with the raw EditItemID of the track, clip, plugin or
+        modifier each Node belongs to.
+    */
+    tracktion_graph::NodeProfiler& getProfiler()
+    {
+        return nodePlayer.getProfiler();
+    }
+
+    /** The recorded timings of a Node and the item it belongs to. */
+    struct NodeStatistics
+    {
+        EditItemID itemID;  /**< The track, clip, plugin or modifier, or invalid if the Node is shared. */
+        tracktion_graph::NodeProfiler::NodeStatistics statistics;
+    };
+
+    /** Returns the statistics for each Node the profiler has recorded, slowest total first. */
+    std::vector<NodeStatistics> getProfileStatistics()
+    {
+        std::vector<NodeStatistics> allStats;
+
+        for (auto& stats : nodePlayer.getProfiler().getStatistics())
+            allStats.push_back ({ EditItemID::fromRawID ((juce::uint64) stats.node.ownerID), stats });
+
+        return allStats;
+    }
+
+    /** Returns the number of MIDI messages the Nodes have dropped because their buffers were full.
+        @see tracktion_graph::LockFreeMultiThreadedNodePlayer::getNumMidiOverflows
+    */
+    int getNumMidiOverflows() const
+    {
+        return nodePlayer.getNumMidiOverflows();
+    }
+
+    /** Returns the raw EditItemID of the item a Node belongs to or 0 if it isn't known.
+        This is used to tag the profiled Nodes.
+    */
+    static size_t getOwnerItemID (tracktion_graph::Node&);
     
 private:
     tracktion_graph::PlayHeadState& playHeadState;
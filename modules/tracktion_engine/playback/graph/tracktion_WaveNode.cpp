@@ -16,9 +16,6 @@ namespace tracktion_engine
 //==============================================================================
 struct WaveNode::PerChannelState
 {
-    PerChannelState()    { resampler.reset(); }
-
-    juce::LagrangeInterpolator resampler;
     float lastSample = 0;
 };
 
@@ -72,6 +69,9 @@ void WaveNode::prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo&
     if (reader != nullptr)
         for (int i = std::max (channelsToUse.size(), reader->getNumChannels()); --i >= 0;)
             channelState.add (new PerChannelState());
+
+    resampler.setQuality (audioFile.engine->getEngineBehaviour().getResamplingQuality (isOfflineRender));
+    resampler.prepare (channelState.size());
 }
 
 bool WaveNode::isReadyToProcess()
@@ -166,14 +166,15 @@ void WaveNode::processSection (ProcessContext& pc, juce::Range<int64_t> timeline
     auto numChannels = (choc::buffer::ChannelCount) destBufferChannels.size();
     assert (pc.buffers.audio.getNumChannels() == numChannels);
 
-    AudioScratchBuffer fileData ((int) numChannels, numFileSamples + 2);
+    const int numFileSamplesToRead = numFileSamples + resampler.getNumLookAheadSamples();
+    AudioScratchBuffer fileData ((int) numChannels, numFileSamplesToRead);
 
     uint32_t lastSampleFadeLength = 0;
 
     {
         SCOPED_REALTIME_CHECK
 
-        if (reader->readSamples (numFileSamples + 2, fileData.buffer, destBufferChannels, 0,
+        if (reader->readSamples (numFileSamplesToRead, fileData.buffer, destBufferChannels, 0,
                                  channelsToUse,
                                  isOfflineRender ? 5000 : 3))
         {
@@ -208,15 +209,17 @@ void WaveNode::processSection (ProcessContext& pc, juce::Range<int64_t> timeline
 
     jassert (numChannels <= (choc::buffer::ChannelCount) channelState.size()); // this should always have been made big enough
 
+    // All the channels are resampled together, then de-clicked individually
+    const auto numChannelsToResample = std::min (numChannels, (choc::buffer::ChannelCount) channelState.size());
+    resampler.processAdding (ratio, fileData.buffer.getArrayOfReadPointers(), numFileSamplesToRead,
+                             destBuffer.getFirstChannels (numChannelsToResample), gains, 2);
+
     for (choc::buffer::ChannelCount channel = 0; channel < numChannels; ++channel)
     {
-        if (channel < (choc::buffer::ChannelCount) channelState.size())
+        if (channel < numChannelsToResample)
         {
-            const auto src = fileData.buffer.getReadPointer ((int) channel);
             const auto dest = destBuffer.getIterator (channel).sample;
-
             auto& state = *channelState.getUnchecked ((int) channel);
-            state.resampler.processAdding (ratio, src, dest, (int) numFrames, gains[channel & 1]);
 
             if (lastSampleFadeLength > 0)
             {
@@ -58,6 +58,7 @@ private:
     const juce::AudioChannelSet channelsToUse, destChannels;
     AudioFileCache::Reader::Ptr reader;
 
+    Resampler resampler;
     struct PerChannelState;
     juce::OwnedArray<PerChannelState> channelState;
 
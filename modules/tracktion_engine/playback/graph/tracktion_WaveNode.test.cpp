@@ -31,6 +31,8 @@ public:
             runBasicTests (ts, false);
             runLoopedTimelineTests (ts);
         }
+
+        runResamplerTests();
     }
 
 private:
@@ -216,6 +218,78 @@ private:
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, timeToSample ({ 0.0, 5.0 }, ts.sampleRate), 1.0f, 0.707f);
         }
     }
+
+    void runResamplerTests()
+    {
+        beginTest ("Resampler unity ratio");
+        {
+            juce::Random r (42);
+            choc::buffer::ChannelArrayBuffer<float> source (2, 1024);
+            choc::buffer::setAllSamples (source, [&] { return r.nextFloat() * 2.0f - 1.0f; });
+
+            Resampler resampler;
+            resampler.prepare (2);
+
+            choc::buffer::ChannelArrayBuffer<float> dest (2, 1024);
+            dest.clear();
+            const float gains[] = { 1.0f };
+
+            for (choc::buffer::FrameCount start = 0; start < 1024; start += 256)
+            {
+                const float* channels[] = { source.getView().getChannel (0).data.data + start,
+                                            source.getView().getChannel (1).data.data + start };
+                expectEquals (resampler.processAdding (1.0, channels, 256, dest.getFrameRange ({ start, start + 256 }), gains, 1), 256);
+            }
+
+            expect (choc::buffer::contentMatches (dest, source));
+        }
+
+        for (auto quality : { ResamplingQuality::lagrange, ResamplingQuality::sinc })
+        {
+            for (double sourceRate : { 44100.0, 96000.0 })
+            {
+                beginTest (juce::String ("Resampler ") + (quality == ResamplingQuality::sinc ? "sinc " : "lagrange ")
+                            + juce::String (sourceRate) + " to 48000");
+
+                // Stream a 1kHz sine in blocks and compare it to an ideal one at the output rate
+                const double outputRate = 48000.0, frequency = 1000.0, ratio = sourceRate / outputRate;
+                const int blockSize = 256;
+
+                Resampler resampler (quality);
+                resampler.prepare (1);
+
+                int64_t sourcePosition = 0;
+                float maxError = 0.0f;
+                std::vector<float> source;
+                choc::buffer::ChannelArrayBuffer<float> dest (1, (choc::buffer::FrameCount) blockSize);
+
+                for (int block = 0; block < 100; ++block)
+                {
+                    source.resize ((size_t) (std::ceil (blockSize * ratio) + resampler.getNumLookAheadSamples() + 1));
+
+                    for (size_t i = 0; i < source.size(); ++i)
+                        source[i] = (float) std::sin (juce::MathConstants<double>::twoPi * frequency * (double) (sourcePosition + (int64_t) i) / sourceRate);
+
+                    const float* channels[] = { source.data() };
+                    const float gain = 1.0f;
+                    dest.clear();
+                    sourcePosition += resampler.processAdding (ratio, channels, (int) source.size(), dest.getView(), &gain, 1);
+
+                    // Ignore the first blocks where the history is still silent
+                    if (block < 2)
+                        continue;
+
+                    for (int i = 0; i < blockSize; ++i)
+                    {
+                        const auto expected = std::sin (juce::MathConstants<double>::twoPi * frequency * (block * blockSize + i) / outputRate);
+                        maxError = std::max (maxError, std::abs (dest.getSample (0, (choc::buffer::FrameCount) i) - (float) expected));
+                    }
+                }
+
+                expectLessThan (maxError, 0.001f);
+            }
+        }
+    }
 };
 
 static WaveNodeTests waveNodeTests;
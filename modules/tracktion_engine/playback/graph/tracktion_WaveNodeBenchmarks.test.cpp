@@ -0,0 +1,192 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+class WaveNodeBenchmarks : public juce::UnitTest
+{
+public:
+    WaveNodeBenchmarks()
+        : juce::UnitTest ("WaveNode Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        for (auto quality : { ResamplingQuality::lagrange, ResamplingQuality::sinc })
+        {
+            runResamplerTest (quality, { 48000.0 });
+            runResamplerTest (quality, { 44100.0, 48000.0, 96000.0 });
+        }
+
+        auto& engine = *Engine::getEngines()[0];
+        runWaveNodeTest (engine, { 48000.0 });
+        runWaveNodeTest (engine, { 44100.0, 48000.0, 96000.0 });
+    }
+
+private:
+    static constexpr int numTracks = 100;
+    static constexpr int numChannels = 2;
+    static constexpr int blockSize = 256;
+    static constexpr double outputSampleRate = 48000.0;
+    static constexpr double duration = 10.0;
+
+    static juce::String getDescription (const std::vector<double>& fileSampleRates)
+    {
+        juce::StringArray rates;
+
+        for (auto rate : fileSampleRates)
+            rates.add (juce::String (rate / 1000.0, 1) + "kHz");
+
+        return juce::String (numTracks) + " tracks, " + rates.joinIntoString ("/");
+    }
+
+    void printThroughput (const StopwatchTimer& sw)
+    {
+        const auto seconds = sw.getSeconds();
+        std::cout << "Streamed " << duration << "s in " << sw.getDescription()
+                  << " (" << juce::String (duration / std::max (seconds, 0.000001), 1) << "x real-time)\n";
+    }
+
+    /** Streams the tracks straight through Resamplers to isolate their cost from file reading. */
+    void runResamplerTest (ResamplingQuality quality, const std::vector<double>& fileSampleRates)
+    {
+        beginTest (juce::String ("Resampler ") + (quality == ResamplingQuality::sinc ? "sinc: " : "lagrange: ")
+                    + getDescription (fileSampleRates));
+
+        struct Track
+        {
+            Resampler resampler;
+            double ratio = 1.0;
+            int64_t position = 0;
+        };
+
+        std::vector<std::unique_ptr<Track>> tracks;
+
+        for (int i = 0; i < numTracks; ++i)
+        {
+            auto t = std::make_unique<Track>();
+            t->resampler.setQuality (quality);
+            t->resampler.prepare (numChannels);
+            t->ratio = fileSampleRates[(size_t) i % fileSampleRates.size()] / outputSampleRate;
+            tracks.push_back (std::move (t));
+        }
+
+        // A second of noise is enough to be larger than the caches but is read circularly
+        const int sourceLength = 96000;
+        const int maxNumSourceFrames = (int) std::ceil (blockSize * 96000.0 / outputSampleRate) + 64;
+        choc::buffer::ChannelArrayBuffer<float> source ((choc::buffer::ChannelCount) numChannels,
+                                                        (choc::buffer::FrameCount) (sourceLength + maxNumSourceFrames));
+        juce::Random r (42);
+        choc::buffer::setAllSamples (source, [&] { return r.nextFloat() * 2.0f - 1.0f; });
+
+        choc::buffer::ChannelArrayBuffer<float> dest ((choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) blockSize);
+        const float gains[] = { 0.5f, 0.5f };
+        const auto numBlocks = (int) (duration * outputSampleRate / blockSize);
+
+        const StopwatchTimer sw;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            dest.clear();
+
+            for (auto& t : tracks)
+            {
+                const auto start = (choc::buffer::FrameCount) (t->position % sourceLength);
+                const float* channels[] = { source.getView().getChannel (0).data.data + start,
+                                            source.getView().getChannel (1).data.data + start };
+
+                t->position += t->resampler.processAdding (t->ratio, channels, maxNumSourceFrames,
+                                                           dest.getView(), gains, numChannels);
+            }
+        }
+
+        printThroughput (sw);
+        expect (true);
+    }
+
+    /** Plays a mix of WaveNodes reading sine files at different sample rates. */
+    void runWaveNodeTest (Engine& engine, const std::vector<double>& fileSampleRates)
+    {
+        using namespace tracktion_graph;
+
+        beginTest ("WaveNode playback: " + getDescription (fileSampleRates));
+
+        std::vector<std::unique_ptr<juce::TemporaryFile>> files;
+
+        for (auto rate : fileSampleRates)
+            files.push_back (test_utilities::getSinFile<juce::WavAudioFormat> (rate, duration, numChannels));
+
+        PlayHead playHead;
+        PlayHeadState playHeadState { playHead };
+        ProcessState processState { playHeadState };
+        playHead.playSyncedToRange ({ 0, std::numeric_limits<int64_t>::max() });
+
+        std::vector<std::unique_ptr<Node>> nodes;
+
+        for (int i = 0; i < numTracks; ++i)
+        {
+            AudioFile audioFile (engine, files[(size_t) i % files.size()]->getFile());
+            nodes.push_back (makeNode<WaveNode> (audioFile,
+                                                 EditTimeRange (0.0, duration),
+                                                 0.0,
+                                                 EditTimeRange(),
+                                                 LiveClipLevel(),
+                                                 1.0,
+                                                 juce::AudioChannelSet::stereo(),
+                                                 juce::AudioChannelSet::stereo(),
+                                                 processState,
+                                                 EditItemID::fromRawID ((juce::uint64) i + 1),
+                                                 true));
+        }
+
+        TracktionNodePlayer player (std::make_unique<SummingNode> (std::move (nodes)), processState,
+                                    outputSampleRate, blockSize,
+                                    getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+        player.setNumThreads (0);
+
+        choc::buffer::ChannelArrayBuffer<float> audio ((choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) blockSize);
+        MidiMessageArray midi;
+        const auto totalNumSamples = timeToSample (duration, outputSampleRate);
+
+        // Process once to get the files mapped so the timing is of the streaming
+        player.process ({ juce::Range<int64_t>::withStartAndLength ((int64_t) 0, (int64_t) blockSize), { audio.getView(), midi } });
+
+        double worstBlockSeconds = 0.0;
+        const StopwatchTimer sw;
+
+        for (int64_t start = 0; start < totalNumSamples; start += blockSize)
+        {
+            audio.clear();
+            midi.clear();
+
+            const StopwatchTimer blockTimer;
+            player.process ({ juce::Range<int64_t>::withStartAndLength (start, (int64_t) blockSize), { audio.getView(), midi } });
+            worstBlockSeconds = std::max (worstBlockSeconds, blockTimer.getSeconds());
+        }
+
+        printThroughput (sw);
+        std::cout << "Worst block: " << juce::String (worstBlockSeconds * 1000.0, 3) << "ms\n";
+        expect (true);
+    }
+};
+
+static WaveNodeBenchmarks waveNodeBenchmarks;
+
+}
+
+#endif
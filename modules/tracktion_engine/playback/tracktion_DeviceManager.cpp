@@ -1051,6 +1051,22 @@ double DeviceManager::getOutputLatencySeconds() const
     return outputLatencyTime;
 }
 
+void DeviceManager::setUsesSharedThreadPool (bool shouldUseSharedPool)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    // The pool is kept once created as contexts may still be using its threads
+    if (shouldUseSharedPool && sharedThreadPool == nullptr)
+        sharedThreadPool = std::make_unique<tracktion_graph::SharedNodePlayerThreadPool> ((size_t) jmax (0, engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() - 1));
+
+    useSharedThreadPool.store (shouldUseSharedPool, std::memory_order_release);
+}
+
+tracktion_graph::SharedNodePlayerThreadPool* DeviceManager::getSharedThreadPool() const
+{
+    return usesSharedThreadPool() ? sharedThreadPool.get() : nullptr;
+}
+
 void DeviceManager::audioDeviceIOCallback (const float** inputChannelData, int numInputChannels,
                                            float** outputChannelData, int totalNumOutputChannels,
                                            int numSamples)
@@ -1093,8 +1109,26 @@ void DeviceManager::audioDeviceIOCallback (const float** inputChannelData, int n
 
                 blockStreamTime = { streamTime, streamTime + blockLength };
 
-                for (auto c : activeContexts)
-                    c->fillNextNodeBlock (outputChannelData, totalNumOutputChannels, numSamples);
+                if (useSharedThreadPool.load (std::memory_order_acquire) && activeContexts.size() > 1)
+                {
+                    // Process the contexts at the same time, each in to its own buffer, then sum them.
+                    // Any that couldn't be processed concurrently, such as those synced to another
+                    // context, are processed here once the others have finished, in the same order
+                    // they'd be summed in if they were all processed sequentially.
+                    sharedThreadPool->runTasks ((size_t) activeContexts.size(), [&] (size_t contextIndex)
+                    {
+                        activeContexts.getUnchecked ((int) contextIndex)->fillNextNodeBlockConcurrently (totalNumOutputChannels, numSamples);
+                    });
+
+                    for (auto c : activeContexts)
+                        if (! c->addConcurrentNodeBlock (outputChannelData, totalNumOutputChannels, numSamples))
+                            c->fillNextNodeBlock (outputChannelData, totalNumOutputChannels, numSamples);
+                }
+                else
+                {
+                    for (auto c : activeContexts)
+                        c->fillNextNodeBlock (outputChannelData, totalNumOutputChannels, numSamples);
+                }
             }
 
             for (int i = totalNumOutputChannels; --i >= 0;)
@@ -173,6 +173,24 @@ public:
         DeviceManager& dm;
     };
 
+    //==============================================================================
+    /** Sets whether the EditPlaybackContexts should share one pool of worker threads and
+        be processed concurrently in the audio callback.
+        By default each context has its own threads and the contexts are processed one
+        after the other. This only changes the threads used by contexts created afterwards
+        so should be set before any Edits are played.
+    */
+    void setUsesSharedThreadPool (bool);
+
+    /** Returns true if the contexts are sharing a pool of threads.
+        @see setUsesSharedThreadPool
+    */
+    bool usesSharedThreadPool() const                   { return useSharedThreadPool.load (std::memory_order_acquire); }
+
+    /** Returns the pool new contexts should use, or nullptr if they should create their own threads. */
+    tracktion_graph::SharedNodePlayerThreadPool* getSharedThreadPool() const;
+
+    //==============================================================================
     void setGlobalOutputAudioProcessor (juce::AudioProcessor*);
     juce::AudioProcessor* getGlobalOutputAudioProcessor() const { return globalOutputAudioProcessor.get(); }
 
@@ -203,6 +221,8 @@ private:
 
     juce::CriticalSection contextLock;
     juce::Array<EditPlaybackContext*> activeContexts;
+    std::unique_ptr<tracktion_graph::SharedNodePlayerThreadPool> sharedThreadPool;
+    std::atomic<bool> useSharedThreadPool { false };
     std::unique_ptr<juce::AudioProcessor> globalOutputAudioProcessor;
 
    #if JUCE_ANDROID
@@ -0,0 +1,164 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+#if TRACKTION_UNIT_TESTS
+
+class ConcurrentContextTests    : public juce::UnitTest
+{
+public:
+    ConcurrentContextTests()
+        : juce::UnitTest ("ConcurrentContextTests", "Tracktion:Longer") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto& deviceManager = engine.getDeviceManager();
+        auto& audioIO = deviceManager.getHostedAudioDeviceInterface();
+
+        HostedAudioDeviceInterface::Parameters params;
+        params.sampleRate = 44100.0;
+        params.blockSize = 256;
+        params.fixedBlockSize = true;
+
+        audioIO.initialise (params);
+        audioIO.prepareToPlay (params.sampleRate, params.blockSize);
+
+        // Each Edit plays a different constant level so the output is the same
+        // whenever the contexts start as long as they're all playing
+        std::vector<std::unique_ptr<juce::TemporaryFile>> files;
+        std::vector<std::unique_ptr<Edit>> edits;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            files.push_back (createConstantFile (params.sampleRate, 0.0625f * (i + 1)));
+
+            auto edit = Edit::createSingleTrackEdit (engine);
+            getAudioTracks (*edit)[0]->insertWaveClip ("constant", files.back()->getFile(), { { 0.0, fileLengthSeconds }, 0.0 }, false);
+            edits.push_back (std::move (edit));
+        }
+
+        const bool wasUsingSharedPool = deviceManager.usesSharedThreadPool();
+
+        beginTest ("Concurrent contexts sum to the same output as sequential ones");
+        {
+            deviceManager.setUsesSharedThreadPool (false);
+            auto sequential = playEdits (audioIO, params, edits);
+
+            deviceManager.setUsesSharedThreadPool (true);
+            auto concurrent = playEdits (audioIO, params, edits);
+
+            expectEquals (sequential.getNumSamples(), concurrent.getNumSamples());
+            expectGreaterThan (sequential.getMagnitude (0, 0, sequential.getNumSamples()), 0.0f);
+
+            int numDifferent = 0;
+
+            for (int c = 0; c < sequential.getNumChannels(); ++c)
+                for (int i = 0; i < sequential.getNumSamples(); ++i)
+                    if (sequential.getSample (c, i) != concurrent.getSample (c, i))
+                        ++numDifferent;
+
+            expectEquals (numDifferent, 0, "Concurrent output differs from sequential output");
+        }
+
+        deviceManager.setUsesSharedThreadPool (wasUsingSharedPool);
+        edits.clear();
+
+        deviceManager.closeDevices();
+        deviceManager.removeHostedAudioDeviceInterface();
+        deviceManager.deviceManager.closeAudioDevice();
+    }
+
+private:
+    static constexpr double fileLengthSeconds = 20.0;
+
+    static std::unique_ptr<juce::TemporaryFile> createConstantFile (double sampleRate, float level)
+    {
+        auto buffer = choc::buffer::createChannelArrayBuffer (1, (choc::buffer::FrameCount) (sampleRate * fileLengthSeconds),
+                                                              [=] (auto, auto) { return level; });
+        auto f = std::make_unique<juce::TemporaryFile> (".wav");
+        tracktion_graph::test_utilities::writeToFile (f->getFile(), buffer, sampleRate);
+        return f;
+    }
+
+    /** Plays the Edits, with the last one synced to the first, and returns a second
+        of output from after they've all started.
+    */
+    juce::AudioBuffer<float> playEdits (HostedAudioDeviceInterface& audioIO, const HostedAudioDeviceInterface::Parameters& params,
+                                        std::vector<std::unique_ptr<Edit>>& edits)
+    {
+        for (auto& edit : edits)
+        {
+            auto& transport = edit->getTransport();
+            transport.setCurrentPosition (0.0);
+            transport.play (false);
+        }
+
+        edits.back()->getTransport().syncToEdit (edits.front().get(), false);
+
+        juce::AudioBuffer<float> block (std::max (params.inputChannels, params.outputChannels), params.blockSize);
+        juce::MidiBuffer midi;
+        const auto blockDuration = std::chrono::microseconds ((int64_t) (1.0e6 * params.blockSize / params.sampleRate));
+
+        auto processBlock = [&]
+        {
+            // Keep roughly to real time so the file cache can keep up
+            const auto endTime = std::chrono::steady_clock::now() + blockDuration;
+            block.clear();
+            midi.clear();
+            audioIO.processBlock (block, midi);
+
+            while (std::chrono::steady_clock::now() < endTime)
+                std::this_thread::yield();
+        };
+
+        auto allPlayingFrom = [&] (double time)
+        {
+            for (auto& edit : edits)
+                if (auto context = edit->getTransport().getCurrentPlaybackContext())
+                    if (! context->isPlaying() || context->getPosition() < time)
+                        return false;
+
+            return true;
+        };
+
+        const int maxNumBlocks = (int) (params.sampleRate * (fileLengthSeconds / 2.0) / params.blockSize);
+
+        for (int i = 0; i < maxNumBlocks && ! allPlayingFrom (0.5); ++i)
+            processBlock();
+
+        expect (allPlayingFrom (0.5), "Edits didn't start playing");
+
+        const int numBlocks = (int) (params.sampleRate / params.blockSize);
+        juce::AudioBuffer<float> output (params.outputChannels, numBlocks * params.blockSize);
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            processBlock();
+
+            for (int c = 0; c < params.outputChannels; ++c)
+                output.copyFrom (c, i * params.blockSize, block, c, 0, params.blockSize);
+        }
+
+        for (auto& edit : edits)
+            edit->getTransport().stop (false, false);
+
+        return output;
+    }
+};
+
+static ConcurrentContextTests concurrentContextTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -138,12 +138,14 @@ private:
 //==============================================================================
  struct EditPlaybackContext::NodePlaybackContext
  {
-     NodePlaybackContext (size_t numThreads, size_t maxNumThreadsToUse)
-        : player (processState, getPoolCreatorFunction (static_cast<tracktion_graph::ThreadPoolStrategy> (getThreadPoolStrategy()))),
-          maxNumThreads (maxNumThreadsToUse)
+     NodePlaybackContext (size_t numThreads, size_t maxNumThreadsToUse,
+                          tracktion_graph::LockFreeMultiThreadedNodePlayer::ThreadPoolCreator poolCreator)
+        : player (processState, std::move (poolCreator)),
+          maxNumThreads (maxNumThreadsToUse),
+          usesPooledMemory (EditPlaybackContextInternal::getPooledMemoryFlag())
      {
          setNumThreads (numThreads);
-         player.enablePooledMemoryAllocations (EditPlaybackContextInternal::getPooledMemoryFlag());
+         player.enablePooledMemoryAllocations (usesPooledMemory);
      }
      
      void setNumThreads (size_t numThreads)
@@ -160,18 +162,44 @@ private:
          player.setNode (std::move (node), sampleRate, blockSize);
          
          if (auto currentNode = player.getNode())
+         {
              latencySamples = currentNode->getNodeProperties().latencyNumSamples;
+             maxNumChannels = 1;
+
+             for (auto n : tracktion_graph::getNodes (*currentNode, tracktion_graph::VertexOrdering::postordering))
+                 maxNumChannels = std::max (maxNumChannels, n->getNodeProperties().numberOfChannels);
+         }
      }
      
      void clearNode()
      {
          player.clearNode();
      }
+
+     /** Returns an index of the current graph's Nodes for a new graph to share, or
+         nothing if the player pools its buffers as its Nodes can't be shared then.
+     */
+     std::optional<tracktion_graph::NodeIDIndex> getNodesToShare()
+     {
+         if (usesPooledMemory)
+             return {};
+
+         if (auto currentNode = player.getNode())
+             return tracktion_graph::NodeIDIndex (*currentNode);
+
+         return tracktion_graph::NodeIDIndex();
+     }
      
      int getLatencySamples() const
      {
          return latencySamples;
      }
+
+     /** Returns the most channels any Node in the current graph has. */
+     int getMaxNumChannels() const
+     {
+         return maxNumChannels;
+     }
      
      void postPosition (double newPosition)
      {
@@ -263,6 +291,26 @@ private:
      {
          return player.getSampleRate();
      }
+
+     void updateModifierTimers (Edit& edit, double editTime, int numSamples)
+     {
+         // Spread the modifiers over the threads that are about to process the graph
+         edit.updateModifierTimers (editTime, numSamples,
+                                    [this] (size_t numTasks, auto&& updateTask)
+                                    {
+                                        player.runTasks (numTasks, updateTask);
+                                    });
+     }
+
+     tracktion_graph::NodeProfiler& getProfiler()
+     {
+         return player.getProfiler();
+     }
+
+     int getNumMidiOverflows() const
+     {
+         return player.getNumMidiOverflows();
+     }
      
      tracktion_graph::PlayHead playHead;
      tracktion_graph::PlayHeadState playHeadState { playHead };
@@ -273,8 +321,9 @@ private:
      MidiMessageArray scratchMidiBuffer;
      TracktionNodePlayer player;
      const size_t maxNumThreads;
+     const bool usesPooledMemory;
      
-     int latencySamples = 0;
+     int latencySamples = 0, maxNumChannels = 2;
      juce::Range<int64_t> referenceSampleRange;
      std::atomic<double> pendingPosition { 0.0 };
      std::atomic<bool> positionUpdatePending { false }, pendingRollInToLoop { false };
@@ -318,8 +367,13 @@ EditPlaybackContext::EditPlaybackContext (TransportControl& tc)
 
     if (edit.shouldPlay())
     {
+        auto sharedThreadPool = edit.engine.getDeviceManager().getSharedThreadPool();
+        auto poolCreator = sharedThreadPool != nullptr ? sharedThreadPool->getPoolCreatorFunction()
+                                                       : getPoolCreatorFunction (static_cast<tracktion_graph::ThreadPoolStrategy> (getThreadPoolStrategy()));
+
         nodePlaybackContext = std::make_unique<NodePlaybackContext> (edit.engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio(),
-                                                                     size_t (edit.getIsPreviewEdit() ? 0 : juce::SystemStats::getNumCpus() - 1));
+                                                                     size_t (edit.getIsPreviewEdit() ? 0 : juce::SystemStats::getNumCpus() - 1),
+                                                                     std::move (poolCreator));
         contextSyncroniser = std::make_unique<ContextSyncroniser>();
 
         // This ensures the referenceSampleRange of the new context has been synced
@@ -473,6 +527,13 @@ void EditPlaybackContext::createNode()
     }
     
     cnp.includeBypassedPlugins = ! edit.engine.getEngineBehaviour().shouldBypassedPluginsBeRemovedFromPlaybackGraph();
+
+    // Let tracks that haven't changed reuse their prepared clip Nodes from the current graph
+    const auto nodesToShare = nodePlaybackContext->getNodesToShare();
+
+    if (nodesToShare)
+        cnp.nodesToShare = &*nodesToShare;
+
     auto editNode = createNodeForEdit (*this, audiblePlaybackTime, cnp);
 
     const auto& tempoSections = edit.tempoSequence.getTempoSections();
@@ -481,6 +542,14 @@ void EditPlaybackContext::createNode()
     nodePlaybackContext->setNode (std::move (editNode), cnp.sampleRate, cnp.blockSize);
     updateNumCPUs();
 
+    // Size the buffer used when this is processed alongside other contexts so the callback doesn't have to
+    if (auto device = dm.deviceManager.getCurrentAudioDevice())
+        prepareConcurrentOutputBuffer (device->getActiveOutputChannels().countNumberOfSetBits(), cnp.blockSize);
+
+    // Make sure each audio thread has some scratch buffers so they don't have to allocate mid-callback
+    AudioScratchBuffer::preallocate (edit.engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() * 4,
+                                     nodePlaybackContext->getMaxNumChannels(), juce::roundToInt (cnp.blockSize * 1.1));
+
     if (hasTempoChanged && lastTempoSections.size() > 0)
     {
         const auto sampleRate = cnp.sampleRate;
@@ -733,7 +802,7 @@ void EditPlaybackContext::fillNextNodeBlock (float** allChannels, int numChannel
     }
 
     const double editTime = tracktion_graph::sampleToTime (nodePlaybackContext->playHead.getPosition(), nodePlaybackContext->getSampleRate());
-    edit.updateModifierTimers (editTime, numSamples);
+    nodePlaybackContext->updateModifierTimers (edit, editTime, numSamples);
     
     nodePlaybackContext->process (allChannels, numChannels, numSamples);
     
@@ -741,6 +810,52 @@ void EditPlaybackContext::fillNextNodeBlock (float** allChannels, int numChannel
     midiDispatcher.dispatchPendingMessagesForDevices (editTime);
 }
 
+void EditPlaybackContext::prepareConcurrentOutputBuffer (int numChannels, int numSamples)
+{
+    if (numChannels <= concurrentOutputBuffer.getNumChannels()
+         && numSamples <= concurrentOutputBuffer.getNumSamples())
+        return;
+
+    // Allocate the new buffer before swapping it in so the audio thread is only blocked briefly
+    juce::AudioBuffer<float> newBuffer (std::max (numChannels, concurrentOutputBuffer.getNumChannels()),
+                                        std::max (numSamples, concurrentOutputBuffer.getNumSamples()));
+
+    const ScopedLock sl (edit.engine.getDeviceManager().deviceManager.getAudioCallbackLock());
+    std::swap (concurrentOutputBuffer, newBuffer);
+}
+
+void EditPlaybackContext::fillNextNodeBlockConcurrently (int numChannels, int numSamples)
+{
+    hasFilledConcurrentBlock = false;
+
+    // Synced contexts read their master's playhead so have to wait until it's been processed
+    if (nodeContextToSyncTo != nullptr
+         || numChannels > concurrentOutputBuffer.getNumChannels()
+         || numSamples > concurrentOutputBuffer.getNumSamples())
+        return;
+
+    auto channels = concurrentOutputBuffer.getArrayOfWritePointers();
+
+    for (int i = 0; i < numChannels; ++i)
+        FloatVectorOperations::clear (channels[i], numSamples);
+
+    fillNextNodeBlock (channels, numChannels, numSamples);
+    hasFilledConcurrentBlock = true;
+}
+
+bool EditPlaybackContext::addConcurrentNodeBlock (float** allChannels, int numChannels, int numSamples)
+{
+    if (! hasFilledConcurrentBlock)
+        return false;
+
+    for (int i = 0; i < numChannels; ++i)
+        if (auto dest = allChannels[i])
+            FloatVectorOperations::add (dest, concurrentOutputBuffer.getReadPointer (i), numSamples);
+
+    hasFilledConcurrentBlock = false;
+    return true;
+}
+
 InputDeviceInstance* EditPlaybackContext::getInputFor (InputDevice* d) const
 {
     TRACKTION_ASSERT_MESSAGE_THREAD
@@ -815,6 +930,18 @@ tracktion_graph::PlayHead* EditPlaybackContext::getNodePlayHead() const
                                : nullptr;
 }
 
+tracktion_graph::NodeProfiler* EditPlaybackContext::getNodeProfiler() const
+{
+    return nodePlaybackContext ? &nodePlaybackContext->getProfiler()
+                               : nullptr;
+}
+
+int EditPlaybackContext::getNumMidiOverflows() const
+{
+    return nodePlaybackContext ? nodePlaybackContext->getNumMidiOverflows()
+                               : 0;
+}
+
 bool EditPlaybackContext::isPlaying() const
 {
     return nodePlaybackContext ? nodePlaybackContext->playHead.isPlaying()
@@ -934,7 +1061,7 @@ void EditPlaybackContext::resyncToGlobalStreamTime (juce::Range<double> globalSt
 void EditPlaybackContext::setThreadPoolStrategy (int type)
 {
     type = jlimit (static_cast<int> (tracktion_graph::ThreadPoolStrategy::conditionVariable),
-                   static_cast<int> (tracktion_graph::ThreadPoolStrategy::lightweightSemHybrid),
+                   static_cast<int> (tracktion_graph::ThreadPoolStrategy::workStealing),
                    type);
     EditPlaybackContextInternal::getThreadPoolStrategyType() = type;
 }
@@ -942,7 +1069,7 @@ void EditPlaybackContext::setThreadPoolStrategy (int type)
 int EditPlaybackContext::getThreadPoolStrategy()
 {
     const int type = jlimit (static_cast<int> (tracktion_graph::ThreadPoolStrategy::conditionVariable),
-                             static_cast<int> (tracktion_graph::ThreadPoolStrategy::lightweightSemHybrid),
+                             static_cast<int> (tracktion_graph::ThreadPoolStrategy::workStealing),
                              EditPlaybackContextInternal::getThreadPoolStrategyType());
     
     return type;
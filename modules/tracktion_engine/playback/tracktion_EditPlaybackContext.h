@@ -104,6 +104,18 @@ public:
     /** @internal. Will be removed in a future release. */
     tracktion_graph::PlayHead* getNodePlayHead() const;
 
+    /** Returns the profiler that can record the time each Node of the playback graph
+        takes to process, or nullptr if the Edit isn't playable.
+        @see TracktionNodePlayer::getProfileStatistics
+    */
+    tracktion_graph::NodeProfiler* getNodeProfiler() const;
+
+    /** Returns the number of MIDI messages the playback graph has dropped because
+        they didn't fit in the buffers the Nodes reserved.
+        @see tracktion_graph::LockFreeMultiThreadedNodePlayer::getNumMidiOverflows
+    */
+    int getNumMidiOverflows() const;
+
     /** @see tracktion_graph::ThreadPoolStrategy */
     static void setThreadPoolStrategy (int);
     /** @see tracktion_graph::ThreadPoolStrategy */
@@ -157,9 +169,24 @@ private:
     juce::WeakReference<EditPlaybackContext> nodeContextToSyncTo;
     std::atomic<double> audiblePlaybackTime { 0.0 };
 
+    juce::AudioBuffer<float> concurrentOutputBuffer;
+    bool hasFilledConcurrentBlock = false; // Only used by the audio thread
+
     void createNode();
+    void prepareConcurrentOutputBuffer (int numChannels, int numSamples);
     void fillNextNodeBlock (float** allChannels, int numChannels, int numSamples);
 
+    /** Renders the next block in to this context's own buffer so it can be processed
+        at the same time as other contexts. This does nothing if the context is synced
+        to another, as it reads that context's playhead, or if the buffer isn't big enough.
+    */
+    void fillNextNodeBlockConcurrently (int numChannels, int numSamples);
+
+    /** Adds the block rendered by fillNextNodeBlockConcurrently to the output.
+        Returns false if no block was rendered, in which case fillNextNodeBlock should be used.
+    */
+    bool addConcurrentNodeBlock (float** allChannels, int numChannels, int numSamples);
+
     JUCE_DECLARE_WEAK_REFERENCEABLE (EditPlaybackContext)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EditPlaybackContext)
 };
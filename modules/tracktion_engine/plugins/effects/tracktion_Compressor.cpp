@@ -85,6 +85,7 @@ void CompressorPlugin::getChannelNames (StringArray* ins, StringArray* outs)
 
 void CompressorPlugin::initialise (const PluginInitialisationInfo&)
 {
+    prepareAutomationRamps ({ &thresholdRamp, &ratioRamp, &attackRamp, &releaseRamp, &outputRamp, &sidechainRamp });
     currentLevel = 0.0;
     lastSamp = 0.0f;
 }
@@ -102,23 +103,50 @@ void CompressorPlugin::applyToBuffer (const PluginRenderContext& fc)
 
     SCOPED_REALTIME_CHECK
 
+    fillAutomationRamp (thresholdRamp, *thresholdGain, fc);
+    fillAutomationRamp (ratioRamp, *ratio, fc);
+    fillAutomationRamp (attackRamp, *attackMs, fc);
+    fillAutomationRamp (releaseRamp, *releaseMs, fc);
+    fillAutomationRamp (outputRamp, *outputDb, fc);
+    fillAutomationRamp (sidechainRamp, *sidechainDb, fc);
+
+    // Without automation ramps this is a single section using the current values
+    for (int pos = 0; pos < fc.bufferNumSamples;)
+    {
+        int end = fc.bufferNumSamples;
+
+        for (auto ramp : { &thresholdRamp, &ratioRamp, &attackRamp, &releaseRamp, &outputRamp, &sidechainRamp })
+            end = std::min (end, ramp->getSegmentEnd (pos));
+
+        processSection (*fc.destBuffer, fc.bufferStartSample + pos, pos, end - pos);
+        pos = end;
+    }
+
+    clearChannels (*fc.destBuffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
+}
+
+void CompressorPlugin::processSection (juce::AudioBuffer<float>& buffer, int startSample, int rampPos, int numSamples)
+{
     const double logThreshold = std::log10 (0.01);
-    const double attackFactor = std::pow (10.0, logThreshold / (attackMs->getCurrentValue() * sampleRate / 1000.0));
-    const double releaseFactor = std::pow (10.0, logThreshold / (releaseMs->getCurrentValue() * sampleRate / 1000.0));
-    const float outputGain = dbToGain (outputDb->getCurrentValue());
-    const float thresh = thresholdGain->getCurrentValue();
-    const float rat = ratio->getCurrentValue();
+    const double attackFactor = std::pow (10.0, logThreshold / (attackRamp.getValueAt (rampPos) * sampleRate / 1000.0));
+    const double releaseFactor = std::pow (10.0, logThreshold / (releaseRamp.getValueAt (rampPos) * sampleRate / 1000.0));
+    const float thresh = thresholdRamp.getValueAt (rampPos);
+    const float rat = ratioRamp.getValueAt (rampPos);
     const bool useSidechain = useSidechainTrigger.get();
-    const float sidechainGain = dbToGain (sidechainDb->getCurrentValue());
+    const float sidechainGain = dbToGain (sidechainRamp.getValueAt (rampPos));
 
-    float* b1 = fc.destBuffer->getWritePointer (0, fc.bufferStartSample);
+    // The output gain is ramped across the section to avoid steps
+    float outputGain = dbToGain (outputRamp.getValueAt (rampPos));
+    const float outputGainDelta = (dbToGain (outputRamp.getValueAt (rampPos + numSamples)) - outputGain) / (float) numSamples;
 
-    if (fc.destBuffer->getNumChannels() >= 2)
+    float* b1 = buffer.getWritePointer (0, startSample);
+
+    if (buffer.getNumChannels() >= 2)
     {
-        float* b2 = fc.destBuffer->getWritePointer (1, fc.bufferStartSample);
-        float* b3 = fc.destBuffer->getNumChannels() > 2 ? fc.destBuffer->getWritePointer (2, fc.bufferStartSample) : nullptr;
+        float* b2 = buffer.getWritePointer (1, startSample);
+        float* b3 = buffer.getNumChannels() > 2 ? buffer.getWritePointer (2, startSample) : nullptr;
 
-        for (int i = fc.bufferNumSamples; --i >= 0;)
+        for (int i = numSamples; --i >= 0;)
         {
             float samp1 = *b1 + 1.0f;
             samp1 -= 1.0f;
@@ -148,6 +176,7 @@ void CompressorPlugin::applyToBuffer (const PluginRenderContext& fc)
                 currentLevel = (currentLevel - sampAvg) * releaseFactor + sampAvg;
 
             float r = outputGain;
+            outputGain += outputGainDelta;
 
             if (currentLevel > thresh)
             {
@@ -161,7 +190,7 @@ void CompressorPlugin::applyToBuffer (const PluginRenderContext& fc)
     }
     else
     {
-        for (int i = fc.bufferNumSamples; --i >= 0;)
+        for (int i = numSamples; --i >= 0;)
         {
             const float samp = *b1;
             const float sampAvg = lastSamp * preFilterAmount
@@ -176,6 +205,7 @@ void CompressorPlugin::applyToBuffer (const PluginRenderContext& fc)
                 currentLevel = (currentLevel - sampAvg) * releaseFactor + sampAvg;
 
             float r = outputGain;
+            outputGain += outputGainDelta;
 
             if (currentLevel > thresh)
                 r *= (float)((thresh + (currentLevel - thresh) * rat) / currentLevel);
@@ -183,8 +213,6 @@ void CompressorPlugin::applyToBuffer (const PluginRenderContext& fc)
             *b1++ = samp * r;
         }
     }
-
-    clearChannels (*fc.destBuffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
 }
 
 float CompressorPlugin::getThreshold() const
@@ -37,6 +37,7 @@ public:
     void initialise (const PluginInitialisationInfo&) override;
     void deinitialise() override;
     void applyToBuffer (const PluginRenderContext&) override;
+    bool supportsAutomationRamps() override                             { return true; }
 
     juce::String getSelectableDescription() override                    { return TRANS("Compressor/Limiter Plugin"); }
 
@@ -54,6 +55,9 @@ public:
 private:
     double currentLevel = 0.0;
     float lastSamp = 0.0f;
+    AutomationRamp thresholdRamp, ratioRamp, attackRamp, releaseRamp, outputRamp, sidechainRamp;
+
+    void processSection (juce::AudioBuffer<float>&, int startSample, int rampPos, int numSamples);
 
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
 
@@ -260,6 +260,9 @@ void EqualiserPlugin::initialise (const PluginInitialisationInfo&)
     for (int i = 4; --i >= 0;)
         needToUpdateFilters[i] = true;
 
+    for (auto& ramps : bandRamps)
+        prepareAutomationRamps ({ &ramps[0], &ramps[1], &ramps[2] });
+
     updateIIRFilters();
 }
 
@@ -283,14 +286,16 @@ void EqualiserPlugin::applyToBuffer (const PluginRenderContext& fc)
 
         addAntiDenormalisationNoise (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples);
 
-        for (int i = jmin ((int) EQ_CHANS, fc.destBuffer->getNumChannels()); --i >= 0;)
+        if (isReadingAutomationRamps())
+        {
+            processWithAutomationRamps (fc);
+        }
+        else
         {
-            float* const data = fc.destBuffer->getWritePointer (i, fc.bufferStartSample);
+            const bool bandsActive[] = { loGain->getCurrentValue() != 0, midGain1->getCurrentValue() != 0,
+                                         midGain2->getCurrentValue() != 0, hiGain->getCurrentValue() != 0 };
 
-            if (loGain->getCurrentValue() != 0)       low[i] .processSamples (data, fc.bufferNumSamples);
-            if (midGain1->getCurrentValue() != 0)     mid1[i].processSamples (data, fc.bufferNumSamples);
-            if (midGain2->getCurrentValue() != 0)     mid2[i].processSamples (data, fc.bufferNumSamples);
-            if (hiGain->getCurrentValue() != 0)       high[i].processSamples (data, fc.bufferNumSamples);
+            processBands (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples, bandsActive);
         }
 
         if (phaseInvert)
@@ -298,6 +303,94 @@ void EqualiserPlugin::applyToBuffer (const PluginRenderContext& fc)
     }
 }
 
+void EqualiserPlugin::processWithAutomationRamps (const PluginRenderContext& fc)
+{
+    AutomatableParameter* const bandParams[4][3] = { { loFreq.get(),    loQ.get(),    loGain.get() },
+                                                     { midFreq1.get(),  midQ1.get(),  midGain1.get() },
+                                                     { midFreq2.get(),  midQ2.get(),  midGain2.get() },
+                                                     { hiFreq.get(),    hiQ.get(),    hiGain.get() } };
+    bool bandsRamping[4] = {};
+
+    for (int band = 0; band < 4; ++band)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            fillAutomationRamp (bandRamps[band][i], *bandParams[band][i], fc);
+            bandsRamping[band] = bandsRamping[band] || ! bandRamps[band][i].isConstant();
+        }
+    }
+
+    // Update the coefficients of any bands that are changing at the start of each segment
+    for (int pos = 0; pos < fc.bufferNumSamples;)
+    {
+        int end = fc.bufferNumSamples;
+        bool bandsActive[4];
+
+        for (int band = 0; band < 4; ++band)
+        {
+            auto& ramps = bandRamps[band];
+            bandsActive[band] = ramps[2].getValueAt (pos) != 0;
+
+            if (! bandsRamping[band])
+                continue;
+
+            for (auto& ramp : ramps)
+                end = std::min (end, ramp.getSegmentEnd (pos));
+
+            const auto c = makeBandCoefficients (band, ramps[0].getValueAt (pos), ramps[1].getValueAt (pos), ramps[2].getValueAt (pos));
+
+            auto filters = getBandFilters (band);
+
+            for (int i = EQ_CHANS; --i >= 0;)
+                filters[i].setCoefficients (c);
+        }
+
+        processBands (*fc.destBuffer, fc.bufferStartSample + pos, end - pos, bandsActive);
+        pos = end;
+    }
+
+    // Put the filters back to the current values for the next block
+    for (int band = 0; band < 4; ++band)
+        if (bandsRamping[band])
+            needToUpdateFilters[band] = true;
+}
+
+void EqualiserPlugin::processBands (juce::AudioBuffer<float>& buffer, int startSample, int numSamples, const bool (&bandsActive)[4])
+{
+    for (int i = jmin ((int) EQ_CHANS, buffer.getNumChannels()); --i >= 0;)
+    {
+        float* const data = buffer.getWritePointer (i, startSample);
+
+        for (int band = 0; band < 4; ++band)
+            if (bandsActive[band])
+                getBandFilters (band)[i].processSamples (data, numSamples);
+    }
+}
+
+juce::IIRCoefficients EqualiserPlugin::makeBandCoefficients (int band, float freq, float q, float gainDb) const
+{
+    const auto gain = convertEQLevelToGain (gainDb);
+
+    if (band == 0)
+        return IIRCoefficients::makeLowShelf (lastSampleRate, freq, q, gain);
+
+    if (band == 3)
+        return IIRCoefficients::makeHighShelf (lastSampleRate, freq, q, gain);
+
+    return IIRCoefficients::makePeakFilter (lastSampleRate, freq, q, gain);
+}
+
+juce::IIRFilter* EqualiserPlugin::getBandFilters (int band)
+{
+    switch (band)
+    {
+        case 0:     return low;
+        case 1:     return mid1;
+        case 2:     return mid2;
+        default:    return high;
+    }
+}
+
 float EqualiserPlugin::getDBGainAtFrequency (float f)
 {
     if (curveNeedsUpdating)
@@ -38,6 +38,7 @@ public:
     void initialise (const PluginInitialisationInfo&) override;
     void deinitialise() override;
     void applyToBuffer (const PluginRenderContext&) override;
+    bool supportsAutomationRamps() override         { return true; }
 
     void resetToDefault();
     void restorePluginStateFromValueTree (const juce::ValueTree&) override;
@@ -91,6 +92,14 @@ private:
     std::atomic<bool> needToUpdateFilters[4];
     juce::CriticalSection filterLock;
 
+    // The frequency, Q and gain of each band
+    std::array<AutomationRamp, 3> bandRamps[4];
+
+    void processWithAutomationRamps (const PluginRenderContext&);
+    void processBands (juce::AudioBuffer<float>&, int startSample, int numSamples, const bool (&bandsActive)[4]);
+    juce::IIRCoefficients makeBandCoefficients (int band, float freq, float q, float gainDb) const;
+    juce::IIRFilter* getBandFilters (int band);
+
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EqualiserPlugin)
@@ -1467,6 +1467,10 @@ void FourOscPlugin::applyToBuffer (const PluginRenderContext& fc)
         {
             int thisBlock = jmin (32, todo);
 
+            // The values for the start of the block have already been set so just follow the automation from there
+            if (isReadingAutomationRamps() && pos > fc.bufferStartSample)
+                updateParameterStreams (fc.editTime + (pos - fc.bufferStartSample) / sampleRate);
+
             AudioScratchBuffer workBuffer (2, thisBlock);
             workBuffer.buffer.clear();
 
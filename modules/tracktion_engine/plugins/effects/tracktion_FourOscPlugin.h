@@ -188,6 +188,7 @@ public:
     void reset() override;
 
     void applyToBuffer (const PluginRenderContext&) override;
+    bool supportsAutomationRamps() override             { return true; }
 
     //==============================================================================
     bool takesMidiInput() override                      { return true; }
@@ -19,31 +19,26 @@ static constexpr int maximumSimultaneousNotes = 32;
 struct SamplerPlugin::SampledNote   : public ReferenceCountedObject
 {
 public:
-    SampledNote (int midiNote, int keyNote,
-                 float velocity,
-                 const AudioFile& file,
+    SampledNote (int midiNote, float velocity,
                  double sampleRate,
                  int sampleDelayFromBufferStart,
-                 const juce::AudioBuffer<float>& data,
-                 int lengthInSamples,
-                 float gainDb,
-                 float pan,
-                 bool openEnded_)
+                 SamplerSound& s)
        : note (midiNote),
          offset (-sampleDelayFromBufferStart),
-         audioData (data),
-         openEnded (openEnded_)
+         sound (s),
+         audioData (s.audioData),
+         openEnded (s.openEnded)
     {
         resampler[0].reset();
         resampler[1].reset();
 
-        const float volumeSliderPos = decibelsToVolumeFaderPosition (gainDb - (20.0f * (1.0f - velocity)));
-        getGainsFromVolumeFaderPositionAndPan (volumeSliderPos, pan, getDefaultPanLaw(), gains[0], gains[1]);
+        const float volumeSliderPos = decibelsToVolumeFaderPosition (sound.gainDb - (20.0f * (1.0f - velocity)));
+        getGainsFromVolumeFaderPositionAndPan (volumeSliderPos, sound.pan, getDefaultPanLaw(), gains[0], gains[1]);
 
         const double hz = MidiMessage::getMidiNoteInHertz (midiNote);
-        playbackRatio = hz / MidiMessage::getMidiNoteInHertz (keyNote);
-        playbackRatio *= file.getSampleRate() / sampleRate;
-        samplesLeftToPlay = playbackRatio > 0 ? (1 + (int) (lengthInSamples / playbackRatio)) : 0;
+        playbackRatio = hz / MidiMessage::getMidiNoteInHertz (sound.keyNote);
+        playbackRatio *= sound.audioFile.getSampleRate() / sampleRate;
+        samplesLeftToPlay = playbackRatio > 0 ? (1 + (int) (sound.fileLengthSamples / playbackRatio)) : 0;
     }
 
     void addNextBlock (juce::AudioBuffer<float>& outBuffer, int startSamp, int numSamples)
@@ -62,22 +57,24 @@ public:
 
         if (numSamps > 0)
         {
+            const int numSampsNeeded = 2 + roundToInt ((numSamps + 2) * playbackRatio);
             int numUsed = 0;
 
-            for (int i = jmin (2, outBuffer.getNumChannels()); --i >= 0;)
+            if (offset + numSampsNeeded <= sound.preloadedSamples)
             {
-                numUsed = resampler[i]
-                            .processAdding (playbackRatio,
-                                            audioData.getReadPointer (jmin (i, audioData.getNumChannels() - 1), offset),
-                                            outBuffer.getWritePointer (i, startSamp),
-                                            numSamps,
-                                            gains[i]);
+                numUsed = resampleAdding (audioData, offset, outBuffer, startSamp, numSamps);
+            }
+            else
+            {
+                AudioScratchBuffer scratch (audioData.getNumChannels(), numSampsNeeded);
+                readSourceSamples (scratch.buffer, numSampsNeeded);
+                numUsed = resampleAdding (scratch.buffer, 0, outBuffer, startSamp, numSamps);
             }
 
             offset += numUsed;
             samplesLeftToPlay -= numSamps;
 
-            jassert (offset <= audioData.getNumSamples());
+            jassert (offset <= sound.fileLengthSamples + 32);
         }
 
         if (numSamples > numSamps && startFade > 0.0f)
@@ -99,15 +96,10 @@ public:
             const int numSampsNeeded = 2 + roundToInt ((numSamps + 2) * playbackRatio);
             AudioScratchBuffer scratch (audioData.getNumChannels(), numSampsNeeded + 8);
 
-            if (offset + numSampsNeeded < audioData.getNumSamples())
-            {
-                for (int i = scratch.buffer.getNumChannels(); --i >= 0;)
-                    scratch.buffer.copyFrom (i, 0, audioData, i, offset, numSampsNeeded);
-            }
+            if (offset + numSampsNeeded < sound.fileLengthSamples + 32)
+                readSourceSamples (scratch.buffer, numSampsNeeded);
             else
-            {
                 scratch.buffer.clear();
-            }
 
             if (numSampsNeeded > 2)
                 AudioFadeCurve::applyCrossfadeSection (scratch.buffer, 0, numSampsNeeded - 2,
@@ -115,15 +107,7 @@ public:
 
             startFade = endFade;
 
-            int numUsed = 0;
-
-            for (int i = jmin (2, outBuffer.getNumChannels()); --i >= 0;)
-                numUsed = resampler[i].processAdding (playbackRatio,
-                                                      scratch.buffer.getReadPointer (jmin (i, scratch.buffer.getNumChannels() - 1)),
-                                                      outBuffer.getWritePointer (i, startSamp),
-                                                      numSamps, gains[i]);
-
-            offset += numUsed;
+            offset += resampleAdding (scratch.buffer, 0, outBuffer, startSamp, numSamps);
 
             if (startFade <= 0.0f)
                 isFinished = true;
@@ -135,18 +119,103 @@ public:
     int offset, samplesLeftToPlay = 0;
     float gains[2];
     double playbackRatio = 1.0;
+    SamplerSound& sound;
     const juce::AudioBuffer<float>& audioData;
     float lastVals[4] = { 0, 0, 0, 0 };
     float startFade = 1.0f;
     bool openEnded, isFinished = false;
+    int numCacheMisses = 0;
 
 private:
+    int resampleAdding (const juce::AudioBuffer<float>& source, int sourceOffset,
+                        juce::AudioBuffer<float>& outBuffer, int startSamp, int numSamps)
+    {
+        int numUsed = 0;
+
+        for (int i = jmin (2, outBuffer.getNumChannels()); --i >= 0;)
+            numUsed = resampler[i].processAdding (playbackRatio,
+                                                  source.getReadPointer (jmin (i, source.getNumChannels() - 1), sourceOffset),
+                                                  outBuffer.getWritePointer (i, startSamp),
+                                                  numSamps, gains[i]);
+
+        return numUsed;
+    }
+
+    /** Fills the start of dest with numSamples of source data from the current offset,
+        taking what it can from the preloaded head and streaming the rest.
+    */
+    void readSourceSamples (juce::AudioBuffer<float>& dest, int numSamples)
+    {
+        const int numFromMemory = jlimit (0, numSamples, audioData.getNumSamples() - offset);
+
+        for (int i = dest.getNumChannels(); --i >= 0;)
+            dest.copyFrom (i, 0, audioData, jmin (i, audioData.getNumChannels() - 1), offset, numFromMemory);
+
+        int pos = numFromMemory;
+
+        if (sound.preloadedSamples < sound.fileLengthSamples)
+        {
+            // The in-memory data has 32 samples of padding past the head, so only
+            // stream from the end of the real preloaded samples onwards
+            pos = jmin (pos, jmax (0, sound.preloadedSamples - offset));
+            const int numToStream = jmin (numSamples - pos, sound.fileLengthSamples - (offset + pos));
+
+            if (numToStream > 0)
+            {
+                if (! streamSamples (dest, pos, numToStream))
+                {
+                    ++numCacheMisses;
+                    ++sound.owner.totalCacheMisses;
+                }
+
+                pos += numToStream;
+            }
+        }
+
+        if (pos < numSamples)
+            dest.clear (pos, numSamples - pos);
+    }
+
+    /** Reads from the sound's mapped file without waiting, so anything the cache
+        doesn't have yet is left as silence and false is returned.
+    */
+    bool streamSamples (juce::AudioBuffer<float>& dest, int destStart, int numSamples)
+    {
+        auto reader = sound.streamReader.get();
+
+        if (reader == nullptr)
+        {
+            dest.clear (destStart, numSamples);
+            return false;
+        }
+
+        auto channels = AudioChannelSet::canonicalChannelSet (dest.getNumChannels());
+        reader->setReadPosition (sound.fileStartSample + offset + destStart);
+        bool allRead = true;
+
+        for (int done = 0; done < numSamples;)
+        {
+            const int numThisTime = jmin (8192, numSamples - done);
+
+            if (! reader->readSamples (numThisTime, dest, channels, destStart + done, AudioChannelSet::stereo(), 0))
+                allRead = false;
+
+            done += numThisTime;
+        }
+
+        return allRead;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampledNote)
 };
 
 //==============================================================================
 SamplerPlugin::SamplerPlugin (PluginCreationInfo info)  : Plugin (info)
 {
+    auto um = getUndoManager();
+    streaming.referTo (state, IDs::streaming, um, false);
+    preloadLength.referTo (state, IDs::preloadLength, um, 1.0);
+
     triggerAsyncUpdate();
 }
 
@@ -198,7 +267,8 @@ void SamplerPlugin::handleAsyncUpdate()
         {
             if (s->source == newSound->source
                 && s->startTime == newSound->startTime
-                && s->length == newSound->length)
+                && s->length == newSound->length
+                && s->preloadedSamples == newSound->preloadedSamples)
             {
                 newSound->audioFile = s->audioFile;
                 newSound->fileStartSample = s->fileStartSample;
@@ -256,17 +326,7 @@ void SamplerPlugin::playNotes (const BigInteger& keysDown)
                          && (! ss->audioFile.isNull())
                          && playingNotes.size() < maximumSimultaneousNotes)
                     {
-                        playingNotes.add (new SampledNote (note,
-                                                           ss->keyNote,
-                                                           0.75f,
-                                                           ss->audioFile,
-                                                           sampleRate,
-                                                           0,
-                                                           ss->audioData,
-                                                           ss->fileLengthSamples,
-                                                           ss->gainDb,
-                                                           ss->pan,
-                                                           ss->openEnded));
+                        playingNotes.add (new SampledNote (note, 0.75f, sampleRate, 0, *ss));
                     }
                 }
             }
@@ -283,6 +343,39 @@ void SamplerPlugin::allNotesOff()
     highlightedNotes.clear();
 }
 
+//==============================================================================
+void SamplerPlugin::setStreamingMode (bool shouldStream, double preloadSeconds)
+{
+    streaming = shouldStream;
+    preloadLength = jmax (0.0, preloadSeconds);
+}
+
+SamplerPlugin::StreamingStatistics SamplerPlugin::getStreamingStatistics() const
+{
+    StreamingStatistics stats;
+    stats.totalCacheMisses = totalCacheMisses.load();
+
+    const ScopedLock sl (lock);
+
+    for (auto n : playingNotes)
+        stats.voiceCacheMisses.add (n->numCacheMisses);
+
+    for (auto s : soundList)
+        stats.preloadedBytes += (juce::int64) s->audioData.getNumChannels() * s->audioData.getNumSamples() * (juce::int64) sizeof (float);
+
+    return stats;
+}
+
+void SamplerPlugin::resetStreamingStatistics()
+{
+    totalCacheMisses = 0;
+
+    const ScopedLock sl (lock);
+
+    for (auto n : playingNotes)
+        n->numCacheMisses = 0;
+}
+
 void SamplerPlugin::applyToBuffer (const PluginRenderContext& fc)
 {
     if (fc.destBuffer != nullptr)
@@ -327,17 +420,8 @@ void SamplerPlugin::applyToBuffer (const PluginRenderContext& fc)
                         {
                             highlightedNotes.setBit (note);
 
-                            playingNotes.add (new SampledNote (note,
-                                                               ss->keyNote,
-                                                               m.getVelocity() / 127.0f,
-                                                               ss->audioFile,
-                                                               sampleRate,
-                                                               noteTimeSample,
-                                                               ss->audioData,
-                                                               ss->fileLengthSamples,
-                                                               ss->gainDb,
-                                                               ss->pan,
-                                                               ss->openEnded));
+                            playingNotes.add (new SampledNote (note, m.getVelocity() / 127.0f,
+                                                               sampleRate, noteTimeSample, *ss));
                         }
                     }
                 }
@@ -650,16 +734,38 @@ void SamplerPlugin::SamplerSound::setExcerpt (double startTime_, double length_)
 
         fileStartSample = roundToInt (startTime * audioFile.getSampleRate());
         fileLengthSamples = roundToInt (length * audioFile.getSampleRate());
+        preloadedSamples = fileLengthSamples;
+        streamReader = nullptr;
+
+        if (owner.streaming)
+        {
+            // Only mapped files can be read on the audio thread without touching the disk,
+            // anything else is loaded in full
+            auto reader = owner.engine.getAudioFileManager().cache.createReader (audioFile);
+
+            if (reader != nullptr && reader->isMapped())
+            {
+                preloadedSamples = jlimit (0, fileLengthSamples, roundToInt (owner.preloadLength * audioFile.getSampleRate()));
+
+                if (preloadedSamples < fileLengthSamples)
+                {
+                    // Parking the reader at the end of the head keeps the cache's
+                    // read-ahead primed so that new notes can start streaming straight away
+                    reader->setReadPosition (fileStartSample + preloadedSamples);
+                    streamReader = reader;
+                }
+            }
+        }
 
         if (auto reader = owner.engine.getAudioFileManager().cache.createReader (audioFile))
         {
-            audioData.setSize (audioFile.getNumChannels(), fileLengthSamples + 32);
+            audioData.setSize (audioFile.getNumChannels(), preloadedSamples + 32);
             audioData.clear();
 
             auto audioDataChannelSet = AudioChannelSet::canonicalChannelSet (audioFile.getNumChannels());
             auto channelsToUse = AudioChannelSet::stereo();
 
-            int total = fileLengthSamples;
+            int total = preloadedSamples;
             int offset = 0;
 
             while (total > 0)
@@ -698,6 +804,7 @@ void SamplerPlugin::SamplerSound::setExcerpt (double startTime_, double length_)
     else
     {
         audioFile = AudioFile (owner.edit.engine);
+        streamReader = nullptr;
     }
 }
 
@@ -707,4 +814,154 @@ void SamplerPlugin::SamplerSound::refreshFile()
     setExcerpt (startTime, length);
 }
 
+
+//==============================================================================
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class SamplerPluginTests  : public juce::UnitTest
+{
+public:
+    SamplerPluginTests()
+        : juce::UnitTest ("SamplerPlugin", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto edit = Edit::createSingleTrackEdit (engine);
+        edit->filePathResolver = [] (const juce::String& path) { return juce::File (path); };
+
+        auto sinFile = createSinFile (2.0);
+        const int numSamplesToRender = (int) (sampleRate * 1.5);
+
+        beginTest ("Streamed output matches in-memory output");
+        {
+            auto inMemory = createSampler (*edit, sinFile->getFile(), false);
+            auto streamed = createSampler (*edit, sinFile->getFile(), true);
+            auto& streamedSound = *streamed->soundList.getFirst();
+
+            expect (inMemory->soundList.getFirst()->streamReader == nullptr);
+            expect (streamedSound.streamReader != nullptr);
+            expectEquals (streamedSound.preloadedSamples, (int) (sampleRate * preloadSeconds));
+            expectGreaterThan (streamedSound.fileLengthSamples, streamedSound.preloadedSamples);
+
+            // Blocking until the file is mapped means the voices' zero-timeout reads can't miss
+            {
+                auto reader = engine.getAudioFileManager().cache.createReader (streamedSound.audioFile);
+                juce::AudioBuffer<float> scratch (1, 256);
+                reader->setReadPosition (0);
+                expect (reader->readSamples (scratch.getNumSamples(), scratch, juce::AudioChannelSet::mono(), 0,
+                                             juce::AudioChannelSet::mono(), -1));
+            }
+
+            auto expected = renderNote (*inMemory, numSamplesToRender);
+            auto actual = renderNote (*streamed, numSamplesToRender);
+
+            for (int chan = 0; chan < expected.getNumChannels(); ++chan)
+                for (int i = 0; i < numSamplesToRender; ++i)
+                    if (! juce::isWithin (actual.getSample (chan, i), expected.getSample (chan, i), 1.0e-6f))
+                        expectEquals (actual.getSample (chan, i), expected.getSample (chan, i), "Sample " + juce::String (i));
+
+            expectGreaterThan (expected.getMagnitude (0, numSamplesToRender), 0.1f);
+
+            auto stats = streamed->getStreamingStatistics();
+            expectEquals (stats.totalCacheMisses, (juce::int64) 0);
+            expectEquals (stats.voiceCacheMisses.size(), 1);
+            expectEquals (stats.voiceCacheMisses.getFirst(), 0);
+            expectGreaterThan (inMemory->getStreamingStatistics().preloadedBytes, stats.preloadedBytes);
+        }
+
+        beginTest ("Cache misses play silence and are counted");
+        {
+            auto streamed = createSampler (*edit, sinFile->getFile(), true);
+            auto& sound = *streamed->soundList.getFirst();
+            const int headLength = sound.preloadedSamples;
+
+            // Without a reader none of the streamed data ever arrives
+            sound.streamReader = nullptr;
+
+            auto output = renderNote (*streamed, numSamplesToRender);
+
+            // Allow for the interpolator reading a few samples past the head
+            const int firstStreamedSample = headLength + 8;
+            expectGreaterThan (output.getMagnitude (0, headLength), 0.1f);
+            expectEquals (output.getMagnitude (firstStreamedSample, numSamplesToRender - firstStreamedSample), 0.0f);
+
+            auto stats = streamed->getStreamingStatistics();
+            expectEquals (stats.voiceCacheMisses.size(), 1);
+            expectGreaterThan (stats.voiceCacheMisses.getFirst(), 0);
+            expectEquals (stats.totalCacheMisses, (juce::int64) stats.voiceCacheMisses.getFirst());
+
+            streamed->resetStreamingStatistics();
+            stats = streamed->getStreamingStatistics();
+            expectEquals (stats.totalCacheMisses, (juce::int64) 0);
+            expectEquals (stats.voiceCacheMisses.getFirst(), 0);
+        }
+
+        engine.getAudioFileManager().releaseAllFiles();
+    }
+
+private:
+    static constexpr double sampleRate = 44100.0;
+    static constexpr double preloadSeconds = 0.5;
+    static constexpr int blockSize = 512;
+
+    static std::unique_ptr<juce::TemporaryFile> createSinFile (double lengthSeconds)
+    {
+        juce::AudioBuffer<float> buffer (1, (int) (sampleRate * lengthSeconds));
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (0, i, 0.8f * std::sin (juce::MathConstants<float>::twoPi * 220.0f * (float) (i / sampleRate)));
+
+        juce::WavAudioFormat format;
+        auto f = std::make_unique<juce::TemporaryFile> (".wav");
+        std::unique_ptr<juce::AudioFormatWriter> writer (AudioFileUtils::createWriterFor (&format, f->getFile(), sampleRate, 1, 16, {}, 0));
+
+        if (writer != nullptr)
+            writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+
+        return f;
+    }
+
+    static juce::ReferenceCountedObjectPtr<SamplerPlugin> createSampler (Edit& edit, const juce::File& file, bool stream)
+    {
+        auto plugin = edit.getPluginCache().createNewPlugin (SamplerPlugin::xmlTypeName, {});
+        juce::ReferenceCountedObjectPtr<SamplerPlugin> sampler (dynamic_cast<SamplerPlugin*> (plugin.get()));
+
+        sampler->setStreamingMode (stream, preloadSeconds);
+        sampler->addSound (file.getFullPathName(), "sin", 0.0, 0.0, 0.0f);
+        sampler->handleUpdateNowIfNeeded();
+
+        return sampler;
+    }
+
+    /** Plays the sound at its root note, so the samples come out as they are in the file. */
+    static juce::AudioBuffer<float> renderNote (SamplerPlugin& sampler, int numSamples)
+    {
+        sampler.baseClassInitialise ({ 0.0, sampleRate, blockSize });
+
+        juce::AudioBuffer<float> output (2, numSamples);
+        output.clear();
+
+        MidiMessageArray midi;
+        midi.addMidiMessage (juce::MidiMessage::noteOn (1, sampler.getKeyNote (0), (juce::uint8) 127), 0.0, MidiMessageArray::notMPE);
+
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            sampler.applyToBuffer (PluginRenderContext (&output, juce::AudioChannelSet::stereo(),
+                                                        start, std::min (blockSize, numSamples - start),
+                                                        &midi, 0.0, start / sampleRate, true, false, true, false));
+            midi.clear();
+        }
+
+        return output;
+    }
+};
+
+static SamplerPluginTests samplerPluginTests;
+
+#endif // TRACKTION_UNIT_TESTS
+
 }
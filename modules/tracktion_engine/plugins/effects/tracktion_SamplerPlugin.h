@@ -46,6 +46,31 @@ public:
     void playNotes (const juce::BigInteger& keysDown);
     void allNotesOff();
 
+    //==============================================================================
+    /** Enables disk-streaming playback.
+        When streaming, only the first preloadSeconds of each sound are held in memory
+        and the rest is read on demand through the AudioFileCache. This keeps load times
+        and memory use down for large multi-sampled instruments.
+
+        Voices never wait for the disk: if the cache hasn't got the data yet they play
+        silence and count a miss. Files the cache can't memory-map are always held
+        entirely in memory.
+    */
+    void setStreamingMode (bool shouldStream, double preloadSeconds);
+    bool isStreaming() const                            { return streaming; }
+    double getPreloadLength() const                     { return preloadLength; }
+
+    /** Describes how well the streaming voices are keeping up with the disk. */
+    struct StreamingStatistics
+    {
+        juce::Array<int> voiceCacheMisses;  /**< Cache misses for each currently playing voice. */
+        juce::int64 totalCacheMisses = 0;   /**< All misses since the last reset, including finished voices. */
+        juce::int64 preloadedBytes = 0;     /**< Memory held by the in-memory sample data. */
+    };
+
+    StreamingStatistics getStreamingStatistics() const;
+    void resetStreamingStatistics();
+
     //==============================================================================
     static const char* getPluginName()                  { return NEEDS_TRANS("Sampler"); }
     static const char* xmlTypeName;
@@ -88,12 +113,18 @@ public:
         juce::String name;
         int keyNote = -1, minNote = 0, maxNote = 0;
         int fileStartSample = 0, fileLengthSamples = 0;
+        int preloadedSamples = 0;
         bool openEnded = false;
         float gainDb = 0, pan = 0;
         double startTime = 0, length = 0;
         AudioFile audioFile;
         juce::AudioBuffer<float> audioData { 2, 64 };
 
+        /** Reads the samples past the preloaded head, or nullptr if the sound isn't streamed.
+            This is shared by all the sound's voices, which each set its position before reading.
+        */
+        AudioFileCache::Reader::Ptr streamReader;
+
     private:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerSound)
     };
@@ -107,12 +138,17 @@ private:
     juce::ReferenceCountedArray<SampledNote> playingNotes;
     juce::OwnedArray<SamplerSound> soundList;
     juce::BigInteger highlightedNotes;
+    juce::CachedValue<bool> streaming;
+    juce::CachedValue<double> preloadLength;
+    std::atomic<juce::int64> totalCacheMisses { 0 };
 
     juce::ValueTree getSound (int index) const;
 
     void valueTreeChanged() override;
     void handleAsyncUpdate() override;
 
+    friend class SamplerPluginTests;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerPlugin)
 };
 
@@ -22,6 +22,26 @@ juce::String createIdentifierString (const juce::PluginDescription& d)
     return d.pluginFormatName + "-" + d.name + getDeprecatedPluginDescSuffix (d);
 }
 
+static String getPluginStateString (const juce::ValueTree& v)
+{
+    if (v.hasProperty (IDs::state))
+        return v.getProperty (IDs::state).toString();
+
+    auto vstDataTree = v.getChildWithName (IDs::VSTDATA);
+
+    if (vstDataTree.isValid())
+    {
+        auto s = vstDataTree.getProperty (IDs::DATA).toString();
+
+        if (s.isEmpty())
+            s = vstDataTree.getProperty (IDs::__TEXT).toString();
+
+        return s;
+    }
+
+    return {};
+}
+
 struct ExternalPlugin::ProcessorChangedManager  : public juce::AudioProcessorListener,
                                                   private juce::AsyncUpdater
 {
@@ -542,7 +562,9 @@ ExternalPlugin::ExternalPlugin (PluginCreationInfo info)  : Plugin (info)
     desc.manufacturerName = state[IDs::manufacturer];
     identiferString = createIdentifierString (desc);
 
-    initialiseFully();
+    // Edits loading concurrently initialise all their plugins together once they've been created
+    if (! edit.shouldDeferPluginInitialisation())
+        initialiseFully();
 }
 
 ValueTree ExternalPlugin::create (Engine& e, const PluginDescription& desc)
@@ -577,6 +599,93 @@ void ExternalPlugin::initialiseFully()
     }
 }
 
+void ExternalPlugin::initialiseFully (InstanceLoader& loader)
+{
+    if (! fullyInitialised)
+    {
+        CRASH_TRACER_PLUGIN (getDebugName());
+        fullyInitialised = true;
+
+        // The loader will have already restored the instance's state
+        if (loader.instance != nullptr)
+        {
+            jassert (pluginInstance == nullptr);
+            pluginInstance = std::move (loader.instance);
+            processorChangedManager = std::make_unique<ProcessorChangedManager> (*this);
+            initialisePluginInstance();
+        }
+        else if (loader.error.isNotEmpty())
+        {
+            TRACKTION_LOG_ERROR (loader.error);
+        }
+
+        buildParameterList();
+        restoreChannelLayout (*this);
+    }
+}
+
+std::unique_ptr<ExternalPlugin::InstanceLoader> ExternalPlugin::createInstanceLoader()
+{
+    CRASH_TRACER
+
+    if (fullyInitialised || pluginInstance != nullptr || ! processing || ! edit.shouldLoadPlugins())
+        return {};
+
+    auto foundDesc = findMatchingPlugin();
+
+    if (foundDesc == nullptr || isDisabled())
+        return {};
+
+    desc = *foundDesc;
+    identiferString = createIdentifierString (desc);
+    updateDebugName();
+
+    std::unique_ptr<InstanceLoader> loader (new InstanceLoader (engine, desc));
+    loader->requiresMessageThread = ! engine.getPluginManager().canCreatePluginInstanceOnBackgroundThread (desc);
+
+    // As in restorePluginStateFromValueTree, the program is only set along with the state
+    auto stateString = getPluginStateString (state);
+
+    if (stateString.isNotEmpty())
+    {
+        loader->programNum = state[IDs::programNum];
+        loader->stateChunk.fromBase64Encoding (stateString);
+    }
+
+    return loader;
+}
+
+//==============================================================================
+ExternalPlugin::InstanceLoader::InstanceLoader (Engine& e, const juce::PluginDescription& d)
+    : engine (e), description (d),
+      sampleRate (e.getDeviceManager().getSampleRate()),
+      blockSize (e.getDeviceManager().getBlockSize())
+{
+}
+
+void ExternalPlugin::InstanceLoader::load()
+{
+    CRASH_TRACER
+    jassert (instance == nullptr);
+
+    if (requiresMessageThread)
+        TRACKTION_ASSERT_MESSAGE_THREAD
+
+    instance = engine.getPluginManager().createPluginInstance (description, sampleRate, blockSize, error);
+
+    if (instance == nullptr)
+        return;
+
+    instance->enableAllBuses();
+
+    if (programNum >= 0 && instance->getNumPrograms() > 1)
+        setInstanceProgram (*instance, programNum);
+
+    if (stateChunk.getSize() > 0)
+        instance->setStateInformation (stateChunk.getData(), (int) stateChunk.getSize());
+}
+
+//==============================================================================
 void ExternalPlugin::forceFullReinitialise()
 {
     TransportControl::ScopedPlaybackRestarter restarter (edit.getTransport());
@@ -831,27 +940,30 @@ void ExternalPlugin::doFullInitialisation()
             });
 
             if (pluginInstance != nullptr)
-            {
-               #if JUCE_PLUGINHOST_VST
-                if (auto xml = juce::VSTPluginFormat::getVSTXML (pluginInstance.get()))
-                    vstXML.reset (VSTXML::createFor (*xml));
-
-                juce::VSTPluginFormat::setExtraFunctions (pluginInstance.get(), new ExtraVSTCallbacks (edit));
-               #endif
-
-                pluginInstance->setPlayHead (playhead.get());
-                supportsMPE = pluginInstance->supportsMPE();
-
-                engine.getEngineBehaviour().doAdditionalInitialisation (*this);
-            }
+                initialisePluginInstance();
             else
-            {
                 TRACKTION_LOG_ERROR (error);
-            }
         }
     }
 }
 
+void ExternalPlugin::initialisePluginInstance()
+{
+    jassert (pluginInstance != nullptr);
+
+   #if JUCE_PLUGINHOST_VST
+    if (auto xml = juce::VSTPluginFormat::getVSTXML (pluginInstance.get()))
+        vstXML.reset (VSTXML::createFor (*xml));
+
+    juce::VSTPluginFormat::setExtraFunctions (pluginInstance.get(), new ExtraVSTCallbacks (edit));
+   #endif
+
+    pluginInstance->setPlayHead (playhead.get());
+    supportsMPE = pluginInstance->supportsMPE();
+
+    engine.getEngineBehaviour().doAdditionalInitialisation (*this);
+}
+
 //==============================================================================
 ExternalPlugin::~ExternalPlugin()
 {
@@ -937,24 +1049,7 @@ void ExternalPlugin::flushBusesLayoutToValueTree()
 
 void ExternalPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
 {
-    String s;
-
-    if (v.hasProperty (IDs::state))
-    {
-        s = v.getProperty (IDs::state).toString();
-    }
-    else
-    {
-        auto vstDataTree = v.getChildWithName (IDs::VSTDATA);
-
-        if (vstDataTree.isValid())
-        {
-            s = vstDataTree.getProperty (IDs::DATA).toString();
-
-            if (s.isEmpty())
-                s = vstDataTree.getProperty (IDs::__TEXT).toString();
-        }
-    }
+    auto s = getPluginStateString (v);
 
     if (pluginInstance != nullptr && s.isNotEmpty())
     {
@@ -1575,12 +1670,9 @@ void ExternalPlugin::setCurrentProgram (int index, bool sendChangeMessage)
     {
         CRASH_TRACER_PLUGIN (getDebugName());
 
-        index = jlimit (0, getNumPrograms() - 1, index);
-
-        if (index != getCurrentProgram())
+        if (setInstanceProgram (*pluginInstance, index))
         {
-            pluginInstance->setCurrentProgram (index);
-            state.setProperty (IDs::programNum, index, nullptr);
+            state.setProperty (IDs::programNum, jlimit (0, getNumPrograms() - 1, index), nullptr);
 
             if (sendChangeMessage)
             {
@@ -1591,6 +1683,17 @@ void ExternalPlugin::setCurrentProgram (int index, bool sendChangeMessage)
     }
 }
 
+bool ExternalPlugin::setInstanceProgram (juce::AudioPluginInstance& instance, int index)
+{
+    index = jlimit (0, instance.getNumPrograms() - 1, index);
+
+    if (index == instance.getCurrentProgram())
+        return false;
+
+    instance.setCurrentProgram (index);
+    return true;
+}
+
 bool ExternalPlugin::takesMidiInput()
 {
     return pluginInstance && pluginInstance->acceptsMidi();
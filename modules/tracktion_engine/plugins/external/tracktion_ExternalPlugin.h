@@ -36,6 +36,50 @@ public:
     void initialiseFully() override;
     void forceFullReinitialise();
 
+    //==============================================================================
+    /** Creates a plugin's instance and restores its state without touching the
+        plugin or its Edit, so that a number of plugins can be loaded at once.
+        @see createInstanceLoader, Edit::Options::loadConcurrently
+    */
+    class InstanceLoader
+    {
+    public:
+        /** Creates the instance and restores its state.
+            If mustLoadOnMessageThread() returns true this must be called on the message thread,
+            otherwise it can be called from any thread.
+        */
+        void load();
+
+        /** Returns true if the plugin's format requires it to be created on the message thread. */
+        bool mustLoadOnMessageThread() const noexcept   { return requiresMessageThread; }
+
+    private:
+        friend class ExternalPlugin;
+        InstanceLoader (Engine&, const juce::PluginDescription&);
+
+        Engine& engine;
+        const juce::PluginDescription description;
+        const double sampleRate;
+        const int blockSize;
+        bool requiresMessageThread = true;
+        int programNum = -1;
+        juce::MemoryBlock stateChunk;
+
+        std::unique_ptr<juce::AudioPluginInstance> instance;
+        juce::String error;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InstanceLoader)
+    };
+
+    /** Returns a loader for this plugin's instance, or nullptr if the plugin doesn't
+        need to create one. This must be called on the thread loading the Edit and
+        the loader passed back to initialiseFully() once it's loaded.
+    */
+    std::unique_ptr<InstanceLoader> createInstanceLoader();
+
+    /** Fully initialises the plugin using an instance that's already been loaded. */
+    void initialiseFully (InstanceLoader&);
+
     static const char* xmlTypeName;
 
     void flushPluginStateToValueTree() override;
@@ -165,7 +209,13 @@ private:
 
     //==============================================================================
     void doFullInitialisation();
+    void initialisePluginInstance();
     void buildParameterList();
+
+    /** Sets an instance's program, limiting it to the available ones. Returns true if it changed.
+        This is used by setCurrentProgram and by InstanceLoader before the instance belongs to a plugin.
+    */
+    static bool setInstanceProgram (juce::AudioPluginInstance&, int index);
     void refreshParameterValues();
     void updateDebugName();
     void processPluginBlock (const PluginRenderContext&, bool processedBypass);
@@ -47,6 +47,7 @@ struct RackType::RackPluginList  : public ValueTreeObjectList<RackType::PluginIn
     {
         CRASH_TRACER
         callBlocking ([this] { this->rebuildObjects(); });
+        type.edit.getEditItemIndex().invalidatePlugins();
     }
 
     ~RackPluginList() override
@@ -74,11 +75,17 @@ struct RackType::RackPluginList  : public ValueTreeObjectList<RackType::PluginIn
         delete p;
     }
 
-    void newObjectAdded (PluginInfo*) override                                    { sendChange(); }
-    void objectRemoved (PluginInfo*) override                                     { sendChange(); }
-    void objectOrderChanged() override                                            { sendChange(); }
+    void newObjectAdded (PluginInfo*) override                                    { pluginsChanged(); }
+    void objectRemoved (PluginInfo*) override                                     { pluginsChanged(); }
+    void objectOrderChanged() override                                            { pluginsChanged(); }
     void valueTreePropertyChanged (ValueTree&, const juce::Identifier&) override  { sendChange(); }
 
+    void pluginsChanged()
+    {
+        type.edit.getEditItemIndex().invalidatePlugins();
+        sendChange();
+    }
+
     void sendChange()
     {
         // XXX
@@ -1189,6 +1196,7 @@ struct RackTypeList::ValueTreeList  : public ValueTreeObjectList<RackType>
     ~ValueTreeList() override
     {
         freeObjects();
+        list.edit.getEditItemIndex().invalidatePlugins();
     }
 
     bool isSuitableType (const juce::ValueTree& v) const override
@@ -1209,11 +1217,17 @@ struct RackTypeList::ValueTreeList  : public ValueTreeObjectList<RackType>
         t->decReferenceCount();
     }
 
-    void newObjectAdded (RackType*) override                                      { sendChange(); }
-    void objectRemoved (RackType*) override                                       { sendChange(); }
-    void objectOrderChanged() override                                            { sendChange(); }
+    void newObjectAdded (RackType*) override                                      { typesChanged(); }
+    void objectRemoved (RackType*) override                                       { typesChanged(); }
+    void objectOrderChanged() override                                            { typesChanged(); }
     void valueTreePropertyChanged (ValueTree&, const juce::Identifier&) override  { sendChange(); }
 
+    void typesChanged()
+    {
+        list.edit.getEditItemIndex().invalidatePlugins();
+        sendChange();
+    }
+
     void sendChange()
     {
         // XXX
@@ -1238,6 +1252,7 @@ void RackTypeList::initialise (const juce::ValueTree& v)
 
     list.reset (new ValueTreeList (*this, v));
     list->rebuildObjects();
+    edit.getEditItemIndex().invalidatePlugins();
 }
 
 RackTypeList::~RackTypeList()
@@ -147,6 +147,7 @@ const char* VolumeAndPanPlugin::xmlTypeName = "volume";
 //==============================================================================
 void VolumeAndPanPlugin::initialise (const PluginInitialisationInfo&)
 {
+    prepareAutomationRamps ({ &volRamp, &panRamp });
     refreshVCATrack();
     auto sliderPos = getSliderPos();
     getGainsFromVolumeFaderPositionAndPan (sliderPos, getPan(), getPanLaw(), lastGainL, lastGainR);
@@ -190,34 +191,21 @@ void VolumeAndPanPlugin::applyToBuffer (const PluginRenderContext& fc)
 
         if (fc.destBuffer != nullptr)
         {
-            const int numChansIn = fc.destBuffer->getNumChannels();
             const float vcaPosDelta = vcaTrack != nullptr
                                     ? decibelsToVolumeFaderPosition (getParentVcaDb (*vcaTrack, fc.editTime))
                                         - decibelsToVolumeFaderPosition (0.0f)
                                     : 0.0f;
 
-            float lgain, rgain;
-            getGainsFromVolumeFaderPositionAndPan (getSliderPos() + vcaPosDelta, getPan(), getPanLaw(), lgain, rgain);
-            lgain *= (polarity ? -1 : 1);
-            rgain *= (polarity ? -1 : 1);
+            fillAutomationRamp (volRamp, *volParam, fc);
+            fillAutomationRamp (panRamp, *panParam, fc);
 
-            fc.destBuffer->applyGainRamp (0, fc.bufferStartSample, fc.bufferNumSamples, lastGainL, lgain);
-
-            if (numChansIn > 1)
-                fc.destBuffer->applyGainRamp (1, fc.bufferStartSample, fc.bufferNumSamples, lastGainR, rgain);
-
-            lastGainL = lgain;
-            lastGainR = rgain;
-
-            // If the number of channels is greater than two, just apply volume
-            if (numChansIn > 2)
+            // Without automation ramps this is a single ramp to the current values
+            for (int pos = 0; pos < fc.bufferNumSamples;)
             {
-                const float gain = volumeFaderPositionToGain (getSliderPos() + vcaPosDelta) * (polarity ? -1 : 1);
-
-                for (int i = 2; i < numChansIn; ++i)
-                    fc.destBuffer->applyGainRamp (i, fc.bufferStartSample, fc.bufferNumSamples, lastGainS, gain);
-
-                lastGainS = gain;
+                const auto end = std::min (volRamp.getSegmentEnd (pos), panRamp.getSegmentEnd (pos));
+                applyGainRamps (*fc.destBuffer, fc.bufferStartSample + pos, end - pos,
+                                volRamp.getValueAt (end) + vcaPosDelta, panRamp.getValueAt (end));
+                pos = end;
             }
         }
 
@@ -226,6 +214,36 @@ void VolumeAndPanPlugin::applyToBuffer (const PluginRenderContext& fc)
     }
 }
 
+void VolumeAndPanPlugin::applyGainRamps (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                                         float sliderPos, float panPos)
+{
+    const int numChansIn = buffer.getNumChannels();
+
+    float lgain, rgain;
+    getGainsFromVolumeFaderPositionAndPan (sliderPos, panPos, getPanLaw(), lgain, rgain);
+    lgain *= (polarity ? -1 : 1);
+    rgain *= (polarity ? -1 : 1);
+
+    buffer.applyGainRamp (0, startSample, numSamples, lastGainL, lgain);
+
+    if (numChansIn > 1)
+        buffer.applyGainRamp (1, startSample, numSamples, lastGainR, rgain);
+
+    lastGainL = lgain;
+    lastGainR = rgain;
+
+    // If the number of channels is greater than two, just apply volume
+    if (numChansIn > 2)
+    {
+        const float gain = volumeFaderPositionToGain (sliderPos) * (polarity ? -1 : 1);
+
+        for (int i = 2; i < numChansIn; ++i)
+            buffer.applyGainRamp (i, startSample, numSamples, lastGainS, gain);
+
+        lastGainS = gain;
+    }
+}
+
 void VolumeAndPanPlugin::refreshVCATrack()
 {
     vcaTrack = ignoreVca ? nullptr : dynamic_cast<AudioTrack*> (getOwnerTrack());
@@ -56,6 +56,7 @@ public:
     void initialiseWithoutStopping (const PluginInitialisationInfo&) override;
     void deinitialise() override;
     void applyToBuffer (const PluginRenderContext&) override;
+    bool supportsAutomationRamps() override                 { return true; }
     int getNumOutputChannelsGivenInputs (int numInputs) override    { return juce::jmax (2, numInputs); }
     bool canBeMoved() override                              { return ! isMasterVolume; }
 
@@ -71,11 +72,13 @@ public:
 
 private:
     float lastGainL = 0.0f, lastGainR = 0.0f, lastGainS = 0.0f, lastVolumeBeforeMute = 0.0f;
+    AutomationRamp volRamp, panRamp;
 
     juce::ReferenceCountedObjectPtr<AudioTrack> vcaTrack;
     const bool isMasterVolume = false;
 
     void refreshVCATrack();
+    void applyGainRamps (juce::AudioBuffer<float>&, int startSample, int numSamples, float sliderPos, float pan);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VolumeAndPanPlugin)
 };
@@ -467,6 +467,8 @@ void Plugin::baseClassInitialise (const PluginInitialisationInfo& info)
         if (initialiseCount++ == 0 || sampleRateOrBlockSizeChanged)
         {
             CRASH_TRACER
+            automationRampInterval = supportsAutomationRamps() ? std::max (0, engine.getPluginManager().automationRampIntervalSamples)
+                                                               : 0;
             initialise (info);
         }
         else
@@ -661,6 +663,7 @@ void Plugin::applyToBufferWithAutomation (const PluginRenderContext& pc)
     jassert (initialiseCount > 0);
 
     updateLastPlaybackTime();
+    readingAutomationRamps = false;
 
     if (isAutomationNeeded()
         && (arm.isReadingAutomation() || isClipEffect.load()))
@@ -678,7 +681,9 @@ void Plugin::applyToBufferWithAutomation (const PluginRenderContext& pc)
         {
             SCOPED_REALTIME_CHECK
             updateParameterStreams (pc.editTime);
+            readingAutomationRamps = automationRampInterval > 0;
             applyToBuffer (pc);
+            readingAutomationRamps = false;
         }
     }
     else
@@ -688,6 +693,22 @@ void Plugin::applyToBufferWithAutomation (const PluginRenderContext& pc)
     }
 }
 
+void Plugin::fillAutomationRamp (AutomationRamp& ramp, AutomatableParameter& param, const PluginRenderContext& pc)
+{
+    if (readingAutomationRamps)
+        param.fillAutomationRamp (ramp, pc.editTime, sampleRate, pc.bufferNumSamples, automationRampInterval);
+    else
+        ramp.setConstant (param.getCurrentValue(), pc.bufferNumSamples);
+}
+
+void Plugin::prepareAutomationRamps (std::initializer_list<AutomationRamp*> ramps)
+{
+    const auto maxNumSegments = AutomationRamp::getMaxNumSegments (blockSizeSamples, automationRampInterval);
+
+    for (auto ramp : ramps)
+        ramp->prepare (maxNumSegments);
+}
+
 //==============================================================================
 bool Plugin::hasNameForMidiNoteNumber (int, int midiChannel, String&)
 {
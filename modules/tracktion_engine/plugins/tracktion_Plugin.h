@@ -204,6 +204,18 @@ public:
     // wrapper on applyTobuffer, called by the node
     void applyToBufferWithAutomation (const PluginRenderContext&);
 
+    /** Should return true if the plugin reads its automation with fillAutomationRamp
+        so that it doesn't need to be processed in smaller blocks to follow it closely.
+        @see PluginManager::automationRampIntervalSamples
+    */
+    virtual bool supportsAutomationRamps()              { return false; }
+
+    /** Returns the interval this plugin follows its automation with ramps at, or 0 if it
+        doesn't use ramps. This is taken from PluginManager::automationRampIntervalSamples
+        when the plugin is initialised so it doesn't change while it's being played.
+    */
+    int getAutomationRampInterval() const noexcept      { return automationRampInterval; }
+
     double getCpuUsage() const noexcept     { return juce::jlimit (0.0, 1.0, timeToCpuScale * cpuUsageMs.load()); }
 
     //==============================================================================
@@ -399,12 +411,31 @@ protected:
                                     std::function<juce::String(float)> valueToStringFunction,
                                     std::function<float(const juce::String&)> stringToValueFunction);
 
+    //==============================================================================
+    /** Returns true if automation is being read with ramps in the current block.
+        Call this from applyToBuffer.
+    */
+    bool isReadingAutomationRamps() const noexcept      { return readingAutomationRamps; }
+
+    /** Fills a ramp with the values a parameter takes over the block being processed.
+        Call this from applyToBuffer. If automation isn't being read with ramps or the
+        parameter isn't automated, this will be a single segment at its current value.
+    */
+    void fillAutomationRamp (AutomationRamp&, AutomatableParameter&, const PluginRenderContext&);
+
+    /** Reserves enough space in some ramps to follow a block's automation.
+        Call this from initialise with the ramps you'll pass to fillAutomationRamp.
+    */
+    void prepareAutomationRamps (std::initializer_list<AutomationRamp*>);
+
     //==============================================================================
     static void getLeftRightChannelNames (juce::StringArray* ins, juce::StringArray* outs);
     static void getLeftRightChannelNames (juce::StringArray* chans);
 
 private:
     mutable AutomatableParameter::Ptr quickControlParameter;
+    bool readingAutomationRamps = false;
+    int automationRampInterval = 0;
 
     int initialiseCount = 0;
     double timeToCpuScale = 0;
@@ -32,6 +32,7 @@ struct PluginList::ObjectList  : public ValueTreeObjectList<Plugin>
     ~ObjectList() override
     {
         freeObjects();
+        list.edit.getEditItemIndex().invalidatePlugins();
     }
 
     bool isSuitableType (const juce::ValueTree& v) const override
@@ -60,9 +61,9 @@ struct PluginList::ObjectList  : public ValueTreeObjectList<Plugin>
         p->decReferenceCount();
     }
 
-    void newObjectAdded (Plugin*) override {}
-    void objectRemoved (Plugin*) override {}
-    void objectOrderChanged() override {}
+    void newObjectAdded (Plugin*) override      { list.edit.getEditItemIndex().invalidatePlugins(); }
+    void objectRemoved (Plugin*) override       { list.edit.getEditItemIndex().invalidatePlugins(); }
+    void objectOrderChanged() override          { list.edit.getEditItemIndex().invalidatePlugins(); }
     void valueTreePropertyChanged (ValueTree&, const juce::Identifier&) override  {}
 
     PluginList& list;
@@ -93,6 +94,7 @@ void PluginList::initialise (const juce::ValueTree& v)
     state = v;
     list.reset (new ObjectList (*this, state));
     callBlocking ([this] { list->rebuildObjects(); });
+    edit.getEditItemIndex().invalidatePlugins();
 }
 
 void PluginList::releaseObjects()
@@ -61,6 +61,13 @@ struct PluginScanMasterProcess  : private ChildProcessMaster
 
     bool waitForReply (int requestID, const String& fileOrIdentifier,
                        OwnedArray<PluginDescription>& result, KnownPluginList::CustomScanner& scanner)
+    {
+        return waitForReply (requestID, fileOrIdentifier, result, [&scanner] { return scanner.shouldExit(); }, -1);
+    }
+
+    bool waitForReply (int requestID, const String& fileOrIdentifier,
+                       OwnedArray<PluginDescription>& result,
+                       const std::function<bool()>& shouldExit, int timeoutMs)
     {
       #if ! TRACKTION_LOG_ENABLED
         juce::ignoreUnused (fileOrIdentifier);
@@ -82,12 +89,19 @@ struct PluginScanMasterProcess  : private ChildProcessMaster
                     return false;
                 }
 
-                if (scanner.shouldExit() || ! launched)
+                if (shouldExit() || ! launched)
                 {
                     TRACKTION_LOG ("Plugin scan cancelled");
                     return false;
                 }
 
+                if (timeoutMs >= 0 && elapsed.inMilliseconds() > timeoutMs)
+                {
+                    TRACKTION_LOG_ERROR ("Plugin timed out:  " + fileOrIdentifier);
+                    timedOut = true;
+                    return false;
+                }
+
                 Thread::sleep (10);
                 continue;
             }
@@ -132,6 +146,7 @@ struct PluginScanMasterProcess  : private ChildProcessMaster
     }
 
     volatile bool launched = false, crashed = false;
+    bool timedOut = false;
 
 private:
     Engine& engine;
@@ -171,6 +186,51 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginScanMasterProcess)
 };
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+/** A format that the child scanning process knows about so that the tests can
+    make it really crash or hang. Files starting with "crash" abort the process,
+    ones starting with "hang" never return and anything else finds one plugin.
+    The name makes CustomScanner scan it in a separate process.
+*/
+struct ChildProcessScanTestFormat  : public AudioPluginFormat
+{
+    String getName() const override                                         { return "ChildProcessScanTestVST"; }
+
+    void findAllTypesForFile (OwnedArray<PluginDescription>& results, const String& fileOrIdentifier) override
+    {
+        if (fileOrIdentifier.startsWith ("crash"))
+            std::abort();
+
+        if (fileOrIdentifier.startsWith ("hang"))
+            for (;;)
+                Thread::sleep (1000);
+
+        auto desc = new PluginDescription();
+        desc->name = fileOrIdentifier;
+        desc->pluginFormatName = getName();
+        desc->fileOrIdentifier = fileOrIdentifier;
+        desc->uniqueId = fileOrIdentifier.hashCode();
+        results.add (desc);
+    }
+
+    bool fileMightContainThisPluginType (const String&) override            { return true; }
+    String getNameOfPluginFromIdentifier (const String& id) override        { return id; }
+    bool pluginNeedsRescanning (const PluginDescription&) override          { return false; }
+    bool doesPluginStillExist (const PluginDescription&) override           { return true; }
+    bool canScanForPlugins() const override                                 { return true; }
+    bool isTrivialToScan() const override                                   { return false; }
+    StringArray searchPathsForPlugins (const FileSearchPath&, bool, bool) override  { return {}; }
+    FileSearchPath getDefaultLocationsToSearch() override                   { return {}; }
+    bool requiresUnblockedMessageThreadDuringCreation (const PluginDescription&) const override { return false; }
+
+    void createPluginInstance (const PluginDescription&, double, int, PluginCreationCallback callback) override
+    {
+        callback (nullptr, "Test plugins can't be created");
+    }
+};
+#endif
+
 //==============================================================================
 struct PluginScanSlaveProcess  : public ChildProcessSlave,
                                  private AsyncUpdater
@@ -178,6 +238,10 @@ struct PluginScanSlaveProcess  : public ChildProcessSlave,
     PluginScanSlaveProcess()
     {
         pluginFormatManager.addDefaultFormats();
+
+       #if TRACKTION_UNIT_TESTS
+        pluginFormatManager.addFormat (new ChildProcessScanTestFormat());
+       #endif
     }
 
     void handleConnectionMade() override {}
@@ -376,6 +440,369 @@ struct CustomScanner  : public KnownPluginList::CustomScanner
     std::unique_ptr<PluginScanMasterProcess> masterProcess;
 };
 
+//==============================================================================
+struct ChildProcessScanWorker  : public PluginScanner::Worker
+{
+    ChildProcessScanWorker (Engine& e) : engine (e) {}
+
+    Result scan (AudioPluginFormat& format, const String& fileOrIdentifier,
+                 OwnedArray<PluginDescription>& results,
+                 int timeoutMs, const std::function<bool()>& shouldCancel) override
+    {
+        CRASH_TRACER
+
+        // This is called on a background thread so leave anything that has to be
+        // scanned in this process for the scanner to do on its own thread
+        if (! CustomScanner::shouldUseSeparateProcessToScan (format))
+            return Result::needsInProcessScan;
+
+        if (masterProcess == nullptr)
+            masterProcess = std::make_unique<PluginScanMasterProcess> (engine);
+
+        if (! masterProcess->ensureSlaveIsLaunched())
+        {
+            TRACKTION_LOG_ERROR ("Couldn't launch the plugin scanning process, scanning in main process..");
+            masterProcess.reset();
+            return Result::needsInProcessScan;
+        }
+
+        auto requestID = Random().nextInt();
+
+        if (masterProcess->sendScanRequest (format, fileOrIdentifier, requestID)
+             && masterProcess->waitForReply (requestID, fileOrIdentifier, results, shouldCancel, timeoutMs))
+            return Result::ok;
+
+        auto result = masterProcess->timedOut ? Result::timedOut
+                                              : (shouldCancel() ? Result::cancelled : Result::crashed);
+
+        // Deleting the master kills any child that is still stuck in the plugin
+        masterProcess.reset();
+        return result;
+    }
+
+    bool canScanConcurrently() const override   { return true; }
+
+    Engine& engine;
+    std::unique_ptr<PluginScanMasterProcess> masterProcess;
+};
+
+struct InProcessScanWorker  : public PluginScanner::Worker
+{
+    Result scan (AudioPluginFormat& format, const String& fileOrIdentifier,
+                 OwnedArray<PluginDescription>& results,
+                 int timeoutMs, const std::function<bool()>&) override
+    {
+        const auto start = Time::getMillisecondCounterHiRes();
+
+        try
+        {
+            format.findAllTypesForFile (results, fileOrIdentifier);
+        }
+        catch (...)
+        {
+            results.clear();
+            return Result::crashed;
+        }
+
+        // A scan here can't be stopped, so one that over-runs but finishes still counts
+        if (timeoutMs >= 0 && Time::getMillisecondCounterHiRes() - start > timeoutMs)
+            TRACKTION_LOG ("Plugin scan took longer than the timeout: " + fileOrIdentifier);
+
+        return Result::ok;
+    }
+
+    bool canScanConcurrently() const override   { return false; }
+};
+
+std::unique_ptr<PluginScanner::Worker> PluginScanner::createChildProcessWorker (Engine& e)
+{
+    return std::make_unique<ChildProcessScanWorker> (e);
+}
+
+std::unique_ptr<PluginScanner::Worker> PluginScanner::createInProcessWorker()
+{
+    return std::make_unique<InProcessScanWorker>();
+}
+
+//==============================================================================
+namespace PluginScanCache
+{
+    /** Combines the name, size and modification time of a file, or of every file in
+        a bundle. The contents aren't read as hashing every binary in a large plugin
+        folder would take almost as long as scanning it.
+    */
+    static String getFileHash (const File& f)
+    {
+        uint64 hash = 0;
+
+        auto addFile = [&hash] (const File& file)
+        {
+            hash = hash * 31 + (uint64) file.getFileName().hashCode64();
+            hash = hash * 31 + (uint64) file.getSize();
+            hash = hash * 31 + (uint64) file.getLastModificationTime().toMilliseconds();
+        };
+
+        if (f.isDirectory())
+        {
+            Array<File> files;
+            f.findChildFiles (files, File::findFiles, true);
+            files.sort();
+
+            for (auto& file : files)
+                addFile (file);
+        }
+        else
+        {
+            addFile (f);
+        }
+
+        return String::toHexString ((int64) hash);
+    }
+
+    static bool canCache (const String& fileOrIdentifier)
+    {
+        return File::isAbsolutePath (fileOrIdentifier) && File (fileOrIdentifier).exists();
+    }
+
+    static XmlElement* findEntry (XmlElement& cache, AudioPluginFormat& format, const String& fileOrIdentifier)
+    {
+        for (auto e : cache.getChildWithTagNameIterator ("FILE"))
+            if (e->getStringAttribute ("file") == fileOrIdentifier
+                 && e->getStringAttribute ("format") == format.getName())
+                return e;
+
+        return nullptr;
+    }
+}
+
+//==============================================================================
+PluginScanner::PluginScanner (Engine& e, Options o)
+    : engine (e), options (std::move (o))
+{
+}
+
+PluginScanner::~PluginScanner()
+{
+    cancel();
+}
+
+std::unique_ptr<PluginScanner::Worker> PluginScanner::createWorker (AudioPluginFormat& format)
+{
+    if (options.createWorker)
+        return options.createWorker();
+
+    if (CustomScanner::shouldUseSeparateProcessToScan (format))
+        return createChildProcessWorker (engine);
+
+    return createInProcessWorker();
+}
+
+float PluginScanner::getProgress() const
+{
+    auto total = numFilesToScan.load();
+    return total > 0 ? numFilesDone.load() / (float) total : 1.0f;
+}
+
+PluginScanner::Results PluginScanner::scan (KnownPluginList& list, AudioPluginFormat& format,
+                                            const StringArray& filesOrIdentifiers)
+{
+    CRASH_TRACER
+    Results results;
+    shouldCancel = false;
+
+    std::unique_ptr<XmlElement> cache;
+
+    if (options.cacheFile.existsAsFile())
+        cache = parseXML (options.cacheFile);
+
+    if (cache == nullptr || ! cache->hasTagName ("PLUGINSCANCACHE"))
+        cache = std::make_unique<XmlElement> ("PLUGINSCANCACHE");
+
+    struct Job
+    {
+        String fileOrIdentifier, modificationTime, hash;
+        OwnedArray<PluginDescription> found;
+        Worker::Result result = Worker::Result::cancelled;
+    };
+
+    std::vector<std::unique_ptr<Job>> jobs;
+
+    for (auto& fileOrIdentifier : filesOrIdentifiers)
+    {
+        if (list.getBlacklistedFiles().contains (fileOrIdentifier))
+            continue;
+
+        auto job = std::make_unique<Job>();
+        job->fileOrIdentifier = fileOrIdentifier;
+
+        if (PluginScanCache::canCache (fileOrIdentifier))
+        {
+            File f (fileOrIdentifier);
+            job->modificationTime = String (f.getLastModificationTime().toMilliseconds());
+            job->hash = PluginScanCache::getFileHash (f);
+
+            if (auto entry = PluginScanCache::findEntry (*cache, format, fileOrIdentifier))
+            {
+                if (entry->getStringAttribute ("modified") == job->modificationTime
+                     && entry->getStringAttribute ("hash") == job->hash)
+                {
+                    for (auto e : entry->getChildIterator())
+                    {
+                        PluginDescription desc;
+
+                        if (desc.loadFromXml (*e))
+                            list.addType (desc);
+                    }
+
+                    ++results.numCached;
+                    continue;
+                }
+            }
+        }
+
+        jobs.push_back (std::move (job));
+    }
+
+    numFilesDone = 0;
+    numFilesToScan = (int) jobs.size();
+
+    // Each thread owns a worker and pulls files off the list until it's empty
+    std::atomic<int> nextJob { 0 };
+    auto isCancelled = [this] { return shouldCancel.load(); };
+
+    auto runWorker = [&] (std::unique_ptr<Worker> worker)
+    {
+        for (;;)
+        {
+            auto index = (size_t) nextJob++;
+
+            if (index >= jobs.size() || shouldCancel)
+                break;
+
+            auto& job = *jobs[index];
+            job.result = worker->scan (format, job.fileOrIdentifier, job.found, options.timeoutMs, isCancelled);
+
+            // if there's a crash, give it a second chance with a fresh worker,
+            // in case the real culprit was whatever plugin preceded this one.
+            if (job.result == Worker::Result::crashed && ! shouldCancel)
+            {
+                worker = createWorker (format);
+                job.found.clear();
+                job.result = worker->scan (format, job.fileOrIdentifier, job.found, options.timeoutMs, isCancelled);
+            }
+
+            if (job.result == Worker::Result::needsInProcessScan)
+                continue;
+
+            if (job.result != Worker::Result::ok)
+                worker = createWorker (format);
+
+            ++numFilesDone;
+        }
+    };
+
+    auto firstWorker = createWorker (format);
+
+    if (! firstWorker->canScanConcurrently())
+    {
+        // In-process scans have to happen one at a time on this thread
+        runWorker (std::move (firstWorker));
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        auto numThreads = jlimit (1, jmax (1, (int) jobs.size()), options.numWorkers);
+
+        threads.emplace_back (runWorker, std::move (firstWorker));
+
+        for (int i = 1; i < numThreads; ++i)
+            threads.emplace_back (runWorker, createWorker (format));
+
+        for (auto& t : threads)
+            t.join();
+    }
+
+    // Anything the workers couldn't scan in a child process is scanned here
+    {
+        std::unique_ptr<Worker> inProcessWorker;
+
+        for (auto& job : jobs)
+        {
+            if (job->result != Worker::Result::needsInProcessScan)
+                continue;
+
+            if (shouldCancel)
+            {
+                job->result = Worker::Result::cancelled;
+                continue;
+            }
+
+            if (inProcessWorker == nullptr)
+                inProcessWorker = createInProcessWorker();
+
+            job->found.clear();
+            job->result = inProcessWorker->scan (format, job->fileOrIdentifier, job->found, options.timeoutMs, isCancelled);
+
+            if (job->result != Worker::Result::ok)
+                inProcessWorker.reset();
+
+            ++numFilesDone;
+        }
+    }
+
+    // Results are merged on this thread, in the original order
+    for (auto& job : jobs)
+    {
+        switch (job->result)
+        {
+            case Worker::Result::ok:
+            {
+                ++results.numScanned;
+
+                for (auto desc : job->found)
+                    list.addType (*desc);
+
+                if (job->hash.isNotEmpty())
+                {
+                    if (auto old = PluginScanCache::findEntry (*cache, format, job->fileOrIdentifier))
+                        cache->removeChildElement (old, true);
+
+                    auto entry = cache->createNewChildElement ("FILE");
+                    entry->setAttribute ("file", job->fileOrIdentifier);
+                    entry->setAttribute ("format", format.getName());
+                    entry->setAttribute ("modified", job->modificationTime);
+                    entry->setAttribute ("hash", job->hash);
+
+                    for (auto desc : job->found)
+                        entry->addChildElement (desc->createXml().release());
+                }
+
+                break;
+            }
+
+            case Worker::Result::crashed:
+            case Worker::Result::timedOut:
+                if (job->result == Worker::Result::crashed)
+                    ++results.numCrashed;
+                else
+                    ++results.numTimedOut;
+
+                results.failedFiles.add (job->fileOrIdentifier);
+                list.addToBlacklist (job->fileOrIdentifier);
+                break;
+
+            case Worker::Result::cancelled:
+            case Worker::Result::needsInProcessScan:
+                break;
+        }
+    }
+
+    if (options.cacheFile != File())
+        cache->writeTo (options.cacheFile);
+
+    return results;
+}
+
 //==============================================================================
 SettingID getPluginListPropertyName()
 {
@@ -398,6 +825,18 @@ PluginManager::PluginManager (Engine& e)
                            {
                                return std::unique_ptr<AudioPluginInstance> (pluginFormatManager.createPluginInstance (description, rate, blockSize, errorMessage));
                            };
+
+    canCreatePluginInstanceOnBackgroundThread = [this] (const PluginDescription& description)
+                                                {
+                                                    for (auto format : pluginFormatManager.getFormats())
+                                                        if (format->getName() == description.pluginFormatName
+                                                             && format->requiresUnblockedMessageThreadDuringCreation (description))
+                                                            return false;
+
+                                                    return description.pluginFormatName != "VST"
+                                                        && description.pluginFormatName != "VST3"
+                                                        && description.pluginFormatName != "AudioUnit";
+                                                };
 }
 
 void PluginManager::initialise()
@@ -744,6 +1183,25 @@ void PluginManager::setDoubleClickToOpenWindows (bool b)
     engine.getPropertyStorage().setProperty (SettingID::windowsDoubleClick, b);
 }
 
+void PluginManager::scanForPlugins (AudioPluginFormat& format, const StringArray& filesOrIdentifiers)
+{
+    PluginScanner::Options options;
+    options.cacheFile = engine.getPropertyStorage().getAppCacheFolder().getChildFile ("PluginScanCache.xml");
+
+    if (! usesSeparateProcessForScanning())
+        options.createWorker = [] { return PluginScanner::createInProcessWorker(); };
+
+    PluginScanner scanner (engine, options);
+    auto results = scanner.scan (knownPluginList, format, filesOrIdentifiers);
+
+    TRACKTION_LOG ("----- Ended Plugin Scan: " + String (results.numScanned) + " scanned, "
+                   + String (results.numCached) + " cached, "
+                   + String (results.failedFiles.size()) + " failed");
+
+    if (scanCompletedCallback)
+        scanCompletedCallback();
+}
+
 int PluginManager::getNumberOfThreadsForScanning()
 {
     return jlimit (1, SystemStats::getNumCpus(),
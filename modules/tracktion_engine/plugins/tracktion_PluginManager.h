@@ -38,6 +38,13 @@ public:
     bool usesSeparateProcessForScanning();
     void setUsesSeparateProcessForScanning (bool);
 
+    /** Scans the given files with a PluginScanner, adding the results to the knownPluginList.
+        When scanning in separate processes this uses one child process per core,
+        otherwise the files are scanned one at a time on the calling thread, which
+        should be the message thread. Results are cached in the app's cache folder.
+    */
+    void scanForPlugins (juce::AudioPluginFormat&, const juce::StringArray& filesOrIdentifiers);
+
     //==============================================================================
     Plugin::Ptr createExistingPlugin (Edit&, const juce::ValueTree&);
     Plugin::Ptr createNewPlugin (Edit&, const juce::ValueTree&);
@@ -81,9 +88,26 @@ public:
                                                               double rate, int blockSize,
                                                               juce::String& errorMessage)> createPluginInstance;
 
+    /** Callback that is used to determine if an instance of a plugin can be created and have
+        its state restored on a background thread, when loading an Edit concurrently.
+        By default this returns false for plugin formats that expect to be created on the
+        message thread, i.e. VSTs, VST3s and AudioUnits, so these get loaded one at a time.
+        @see Edit::Options::loadConcurrently
+    */
+    std::function<bool (const juce::PluginDescription&)> canCreatePluginInstanceOnBackgroundThread;
+
     /** Callback that is used to determine if a plugin should use fine-grain automation or not. */
     std::function<bool (Plugin&)> canUseFineGrainAutomation;
 
+    /** If this is greater than 0, plugins that support automation ramps follow their
+        automation every this many samples (and at each automation point) across the whole
+        block, rather than the block being split up for fine-grain automation.
+        Plugins that don't support ramps, i.e. external plugins, are still processed in sub-blocks.
+        Changes are picked up when plugins are next initialised.
+        @see Plugin::supportsAutomationRamps, Plugin::getAutomationRampInterval
+    */
+    int automationRampIntervalSamples = 0;
+
     // this can be set to provide a function that gets called when a scan finishes
     std::function<void()> scanCompletedCallback;
 
@@ -101,6 +125,118 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginManager)
 };
 
+//==============================================================================
+/**
+    Scans plugin files using a pool of workers, each of which runs its scans in its
+    own child process so that slow or crashing plugins are isolated from the host
+    and from each other.
+
+    Most plugin formats can only be scanned safely on the message thread, so
+    workers that scan in this process aren't run concurrently. In that case a
+    single worker scans the files on the thread that calls scan().
+
+    Results are cached by the size and modification time of each file, or of every
+    file in a bundle, so that rescans can skip any binaries that haven't changed.
+    File contents aren't hashed, so a binary that's replaced by one of the same size
+    and modification time won't be rescanned.
+*/
+class PluginScanner
+{
+public:
+    //==============================================================================
+    /** Scans single files on behalf of the scanner. A worker is only ever used by
+        one thread at a time and is thrown away after a crash or timeout.
+    */
+    struct Worker
+    {
+        enum class Result
+        {
+            ok,
+            crashed,
+            timedOut,
+            cancelled,
+            needsInProcessScan  /**< The worker couldn't scan the file itself, e.g. because its
+                                     child process couldn't be launched. The scanner scans these
+                                     files in-process on the calling thread once the others are done. */
+        };
+
+        virtual ~Worker() = default;
+
+        virtual Result scan (juce::AudioPluginFormat&, const juce::String& fileOrIdentifier,
+                             juce::OwnedArray<juce::PluginDescription>& results,
+                             int timeoutMs, const std::function<bool()>& shouldCancel) = 0;
+
+        /** Should return true if several of these workers can scan at the same time
+            on background threads, i.e. if they do their scanning in another process.
+        */
+        virtual bool canScanConcurrently() const = 0;
+    };
+
+    /** Creates a worker that scans in a child process. */
+    static std::unique_ptr<Worker> createChildProcessWorker (Engine&);
+
+    /** Creates a worker that scans on the calling thread.
+        This can't survive a real crash or stop a scan that hangs. It treats
+        exceptions as crashes and keeps the results of scans that over-run, so it
+        never reports a timeout.
+    */
+    static std::unique_ptr<Worker> createInProcessWorker();
+
+    //==============================================================================
+    struct Options
+    {
+        int numWorkers = juce::SystemStats::getNumCpus();
+        int timeoutMs = 60000;
+
+        /** If set, results are read from and written back to this file. */
+        juce::File cacheFile;
+
+        /** Creates the workers. If this isn't set, child process workers are used
+            for formats that CustomScanner would scan in a separate process and
+            in-process workers for the others.
+        */
+        std::function<std::unique_ptr<Worker>()> createWorker;
+    };
+
+    PluginScanner (Engine&, Options);
+    ~PluginScanner();
+
+    //==============================================================================
+    struct Results
+    {
+        int numScanned = 0;     /**< Files that were scanned by a worker. */
+        int numCached = 0;      /**< Files whose results came from the cache. */
+        int numCrashed = 0;
+        int numTimedOut = 0;
+        juce::StringArray failedFiles;
+    };
+
+    /** Scans the given files of a format, adding any types found to the list.
+        Files that crash or time out are added to the list's blacklist. This blocks
+        until all the files have been scanned or the scan is cancelled.
+
+        Any in-process scanning happens on the calling thread so unless all the
+        workers scan in child processes this should be called on the message thread.
+    */
+    Results scan (juce::KnownPluginList&, juce::AudioPluginFormat&, const juce::StringArray& filesOrIdentifiers);
+
+    /** Cancels a scan that is running on another thread. */
+    void cancel()                                   { shouldCancel = true; }
+
+    /** Returns the proportion of the current scan that has completed. */
+    float getProgress() const;
+
+private:
+    Engine& engine;
+    Options options;
+    std::atomic<bool> shouldCancel { false };
+    std::atomic<int> numFilesDone { 0 }, numFilesToScan { 0 };
+
+    std::unique_ptr<Worker> createWorker (juce::AudioPluginFormat&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginScanner)
+};
+
 //==============================================================================
 class PluginCache  : private juce::Timer
 {
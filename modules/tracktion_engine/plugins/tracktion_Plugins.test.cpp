@@ -167,6 +167,571 @@ public:
 
 static PDCTests pdcTests;
 
+
+//==============================================================================
+//==============================================================================
+class PluginScannerTests  : public UnitTest
+{
+public:
+    PluginScannerTests()
+        : UnitTest ("PluginScanner", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+
+        beginTest ("Parallel scanning");
+        {
+            DummyFormat format;
+            KnownPluginList list;
+            StringArray files;
+
+            for (int i = 0; i < 16; ++i)
+                files.add ("sleep:" + String (i));
+
+            auto options = createOptions (1);
+            auto singleThreadTime = timeScan (engine, options, list, format, files);
+            expectEquals (list.getNumTypes(), 16);
+
+            list.clear();
+            options.numWorkers = 8;
+            auto multiThreadTime = timeScan (engine, options, list, format, files);
+            expectEquals (list.getNumTypes(), 16);
+
+            logMessage ("1 worker: " + String (singleThreadTime) + "ms, 8 workers: " + String (multiThreadTime) + "ms");
+            expect (multiThreadTime < singleThreadTime / 2.0);
+        }
+
+        beginTest ("In-process scans use the calling thread");
+        {
+            DummyFormat format;
+            KnownPluginList list;
+            StringArray files;
+
+            for (int i = 0; i < 8; ++i)
+                files.add ("ok:" + String (i));
+
+            // Formats that don't use a separate process default to in-process workers
+            expect (! CustomScanner::shouldUseSeparateProcessToScan (format));
+
+            auto options = createOptions (8);
+            options.createWorker = nullptr;
+            auto results = PluginScanner (engine, options).scan (list, format, files);
+
+            expectEquals (results.numScanned, 8);
+            expectEquals (format.getNumScanThreads(), 1);
+            expect (format.scannedOnThread (Thread::getCurrentThreadId()));
+        }
+
+        beginTest ("Files the workers can't scan are scanned in-process");
+        {
+            DummyFormat format;
+            KnownPluginList list;
+            StringArray files { "ok:1", "local:1", "ok:2", "local:2" };
+
+            auto results = PluginScanner (engine, createOptions (4)).scan (list, format, files);
+
+            expectEquals (results.numScanned, 4);
+            expectEquals (list.getNumTypes(), 4);
+            expect (format.scannedOnThread (Thread::getCurrentThreadId()));
+        }
+
+        beginTest ("In-process crashes and over-runs");
+        {
+            DummyFormat format;
+            KnownPluginList list;
+            StringArray files { "ok:1", "crash:1", "ok:2", "hang:1", "ok:3" };
+
+            PluginScanner scanner (engine, createOptions (4));
+            auto results = scanner.scan (list, format, files);
+
+            // A scan that finishes after the timeout keeps its results
+            expectEquals (results.numScanned, 4);
+            expectEquals (results.numCrashed, 1);
+            expectEquals (results.numTimedOut, 0);
+            expectEquals (list.getNumTypes(), 4);
+            expect (list.getBlacklistedFiles().contains ("crash:1"));
+            expect (! list.getBlacklistedFiles().contains ("hang:1"));
+
+            // Crashed files get a second chance with a fresh worker
+            expectEquals (format.numScans.load(), 6);
+        }
+
+        beginTest ("Cached results");
+        {
+            TemporaryFile cacheFile (".xml");
+            TemporaryFile f1 (".dummy"), f2 (".dummy");
+            f1.getFile().replaceWithText ("plugin 1");
+            f2.getFile().replaceWithText ("plugin 2");
+            StringArray files { f1.getFile().getFullPathName(), f2.getFile().getFullPathName() };
+
+            DummyFormat format;
+            auto options = createOptions (2);
+            options.cacheFile = cacheFile.getFile();
+
+            {
+                KnownPluginList list;
+                auto results = PluginScanner (engine, options).scan (list, format, files);
+                expectEquals (results.numScanned, 2);
+                expectEquals (results.numCached, 0);
+                expectEquals (list.getNumTypes(), 2);
+            }
+
+            {
+                KnownPluginList list;
+                auto results = PluginScanner (engine, options).scan (list, format, files);
+                expectEquals (results.numScanned, 0);
+                expectEquals (results.numCached, 2);
+                expectEquals (list.getNumTypes(), 2);
+                expectEquals (format.numScans.load(), 2);
+            }
+
+            // Changing a binary means it gets rescanned
+            f2.getFile().replaceWithText ("plugin 2 updated");
+            f2.getFile().setLastModificationTime (Time::getCurrentTime() + RelativeTime::seconds (10.0));
+
+            {
+                KnownPluginList list;
+                auto results = PluginScanner (engine, options).scan (list, format, files);
+                expectEquals (results.numScanned, 1);
+                expectEquals (results.numCached, 1);
+                expectEquals (format.numScans.load(), 3);
+            }
+        }
+    }
+
+private:
+    /** A format whose "plugins" sleep, hang or crash depending on their name.
+        It also records which threads scanned it.
+    */
+    struct DummyFormat  : public AudioPluginFormat
+    {
+        String getName() const override                                         { return "Dummy"; }
+
+        void findAllTypesForFile (OwnedArray<PluginDescription>& results, const String& fileOrIdentifier) override
+        {
+            ++numScans;
+
+            {
+                const std::lock_guard<std::mutex> lock (threadsMutex);
+                scanThreads.insert (Thread::getCurrentThreadId());
+            }
+
+            if (fileOrIdentifier.startsWith ("crash"))
+                throw std::runtime_error ("crashed");
+
+            if (fileOrIdentifier.startsWith ("sleep"))
+                Thread::sleep (50);
+            else if (fileOrIdentifier.startsWith ("hang"))
+                Thread::sleep (500);
+
+            auto desc = new PluginDescription();
+            desc->name = fileOrIdentifier;
+            desc->pluginFormatName = getName();
+            desc->fileOrIdentifier = fileOrIdentifier;
+            desc->uniqueId = fileOrIdentifier.hashCode();
+            results.add (desc);
+        }
+
+        bool fileMightContainThisPluginType (const String&) override            { return true; }
+        String getNameOfPluginFromIdentifier (const String& id) override        { return id; }
+        bool pluginNeedsRescanning (const PluginDescription&) override          { return false; }
+        bool doesPluginStillExist (const PluginDescription&) override           { return true; }
+        bool canScanForPlugins() const override                                 { return true; }
+        bool isTrivialToScan() const override                                   { return false; }
+        StringArray searchPathsForPlugins (const FileSearchPath&, bool, bool) override  { return {}; }
+        FileSearchPath getDefaultLocationsToSearch() override                   { return {}; }
+        bool requiresUnblockedMessageThreadDuringCreation (const PluginDescription&) const override { return false; }
+
+        void createPluginInstance (const PluginDescription&, double, int, PluginCreationCallback callback) override
+        {
+            callback (nullptr, "Dummy plugins can't be created");
+        }
+
+        int getNumScanThreads()
+        {
+            const std::lock_guard<std::mutex> lock (threadsMutex);
+            return (int) scanThreads.size();
+        }
+
+        bool scannedOnThread (Thread::ThreadID threadID)
+        {
+            const std::lock_guard<std::mutex> lock (threadsMutex);
+            return scanThreads.count (threadID) > 0;
+        }
+
+        std::atomic<int> numScans { 0 };
+        std::mutex threadsMutex;
+        std::set<Thread::ThreadID> scanThreads;
+    };
+
+    /** Stands in for a child process worker by scanning in-process but claiming
+        it can run concurrently. Files starting with "local" are handed back to
+        the scanner as if the child process couldn't be launched.
+    */
+    struct ConcurrentTestWorker  : public PluginScanner::Worker
+    {
+        Result scan (AudioPluginFormat& format, const String& fileOrIdentifier,
+                     OwnedArray<PluginDescription>& results,
+                     int timeoutMs, const std::function<bool()>& shouldCancel) override
+        {
+            if (fileOrIdentifier.startsWith ("local"))
+                return Result::needsInProcessScan;
+
+            return inProcessWorker->scan (format, fileOrIdentifier, results, timeoutMs, shouldCancel);
+        }
+
+        bool canScanConcurrently() const override   { return true; }
+
+        std::unique_ptr<PluginScanner::Worker> inProcessWorker { PluginScanner::createInProcessWorker() };
+    };
+
+    static PluginScanner::Options createOptions (int numWorkers)
+    {
+        PluginScanner::Options options;
+        options.numWorkers = numWorkers;
+        options.timeoutMs = 200;
+        options.createWorker = [] { return std::make_unique<ConcurrentTestWorker>(); };
+        return options;
+    }
+
+    static double timeScan (Engine& engine, const PluginScanner::Options& options, KnownPluginList& list,
+                            AudioPluginFormat& format, const StringArray& files)
+    {
+        const auto start = Time::getMillisecondCounterHiRes();
+        PluginScanner (engine, options).scan (list, format, files);
+        return Time::getMillisecondCounterHiRes() - start;
+    }
+};
+
+static PluginScannerTests pluginScannerTests;
+
+//==============================================================================
+//==============================================================================
+class ChildProcessPluginScannerTests  : public UnitTest
+{
+public:
+    ChildProcessPluginScannerTests()
+        : UnitTest ("PluginScanner child processes", "Tracktion:Longer")
+    {
+    }
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+
+        // The scanning processes are launched from this executable so it has to handle
+        // PluginManager::startChildProcessPluginScan for these to work
+        if (! engine.getEngineBehaviour().canScanPluginsOutOfProcess())
+            return;
+
+        ChildProcessScanTestFormat format;
+        expect (CustomScanner::shouldUseSeparateProcessToScan (format));
+
+        beginTest ("Child processes find plugins");
+        {
+            KnownPluginList list;
+            StringArray files { "ok:1", "ok:2", "ok:3" };
+
+            auto results = PluginScanner (engine, createOptions()).scan (list, format, files);
+
+            expectEquals (results.numScanned, 3);
+            expectEquals (list.getNumTypes(), 3);
+        }
+
+        beginTest ("Child processes that crash or hang");
+        {
+            KnownPluginList list;
+            StringArray files { "ok:1", "crash:1", "ok:2", "hang:1", "ok:3" };
+
+            const auto start = Time::getMillisecondCounterHiRes();
+            auto results = PluginScanner (engine, createOptions()).scan (list, format, files);
+            const auto duration = Time::getMillisecondCounterHiRes() - start;
+
+            expectEquals (results.numScanned, 3);
+            expectEquals (results.numCrashed, 1);
+            expectEquals (results.numTimedOut, 1);
+            expectEquals (list.getNumTypes(), 3);
+            expect (list.getBlacklistedFiles().contains ("crash:1"));
+            expect (list.getBlacklistedFiles().contains ("hang:1"));
+
+            // The hung process is killed rather than waited for
+            expectLessThan (duration, 4.0 * timeoutMs);
+        }
+    }
+
+private:
+    static constexpr int timeoutMs = 5000;
+
+    static PluginScanner::Options createOptions()
+    {
+        PluginScanner::Options options;
+        options.numWorkers = 2;
+        options.timeoutMs = timeoutMs;
+        return options;
+    }
+};
+
+static ChildProcessPluginScannerTests childProcessPluginScannerTests;
+
+//==============================================================================
+//==============================================================================
+class AutomationRampTests  : public UnitTest
+{
+public:
+    AutomationRampTests()
+        : UnitTest ("AutomationRamp", "Tracktion")
+    {
+    }
+
+    void runTest() override
+    {
+        runSegmentTests();
+        runParameterTests();
+        runPluginTests();
+    }
+
+private:
+    void runSegmentTests()
+    {
+        beginTest ("Segments");
+        {
+            AutomationRamp ramp;
+            ramp.setConstant (0.5f, 256);
+            expect (ramp.isConstant());
+            expectEquals (ramp.getNumSegments(), 1);
+            expectEquals (ramp.getNumSamples(), 256);
+            expectEquals (ramp.getSegmentEnd (0), 256);
+            expectEquals (ramp.getValueAt (100), 0.5f);
+
+            ramp.clear();
+            ramp.addSegment (100, 0.0f, 1.0f);
+            ramp.addSegment (100, 1.0f, 1.0f);
+            expect (! ramp.isConstant());
+            expectEquals (ramp.getNumSamples(), 200);
+            expectEquals (ramp.getSegmentEnd (0), 100);
+            expectEquals (ramp.getSegmentEnd (99), 100);
+            expectEquals (ramp.getSegmentEnd (100), 200);
+            expectWithinAbsoluteError (ramp.getValueAt (50), 0.5f, 0.0001f);
+            expectEquals (ramp.getValueAt (150), 1.0f);
+            expectEquals (ramp.getValueAt (200), 1.0f);
+        }
+
+        beginTest ("Sizing");
+        {
+            expectEquals (AutomationRamp::getMaxNumSegments (512, 0), 2);
+            expectEquals (AutomationRamp::getMaxNumSegments (512, 32), 32);
+            expectEquals (AutomationRamp::getMaxNumSegments (500, 32), 32);
+            expectEquals (AutomationRamp::getMaxNumSegments (16, 32), 2);
+
+            AutomationRamp ramp;
+            expectEquals (ramp.getMaxNumSegments(), 1);
+
+            ramp.prepare (AutomationRamp::getMaxNumSegments (512, 32));
+            expectEquals (ramp.getMaxNumSegments(), 32);
+
+            for (int i = 0; i < ramp.getMaxNumSegments(); ++i)
+                ramp.addSegment (16, (float) i, (float) i + 1.0f);
+
+            expectEquals (ramp.getNumSegments(), 32);
+            expectEquals (ramp.getNumSamples(), 512);
+            expectEquals (ramp.getValueAt (512), 32.0f);
+        }
+    }
+
+    void runParameterTests()
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto edit = Edit::createSingleTrackEdit (engine);
+        auto volParam = edit->getMasterVolumePlugin()->volParam;
+
+        beginTest ("Unautomated parameter");
+        {
+            AutomationRamp ramp;
+            ramp.prepare (AutomationRamp::getMaxNumSegments (1000, 100));
+            volParam->fillAutomationRamp (ramp, 0.0, 1000.0, 1000, 100);
+            expect (ramp.isConstant());
+            expectEquals (ramp.getValueAt (0), volParam->getCurrentValue());
+        }
+
+        beginTest ("Automated parameter");
+        {
+            auto& curve = volParam->getCurve();
+            curve.addPoint (0.0, 0.0f, 0.0f);
+            curve.addPoint (1.0, 1.0f, 0.0f);
+            curve.addPoint (2.0, 0.0f, 0.0f);
+            volParam->updateStream();
+            expect (volParam->isAutomationActive());
+
+            // A second either side of the peak at 1s, split every 128 samples
+            const double sampleRate = 1000.0;
+            volParam->updateFromAutomationSources (0.5);
+
+            AutomationRamp ramp;
+            ramp.prepare (AutomationRamp::getMaxNumSegments (1000, 128));
+            volParam->fillAutomationRamp (ramp, 0.5, sampleRate, 1000, 128);
+            expectEquals (ramp.getNumSamples(), 1000);
+
+            bool hasSegmentEndingOnPoint = false;
+
+            for (auto& segment : ramp)
+            {
+                expect (segment.numSamples <= 128);
+                hasSegmentEndingOnPoint = hasSegmentEndingOnPoint || segment.getEndSample() == 500;
+            }
+
+            expect (hasSegmentEndingOnPoint);
+            expectWithinAbsoluteError (ramp.getValueAt (0), 0.5f, 0.001f);
+            expectWithinAbsoluteError (ramp.getValueAt (250), 0.75f, 0.001f);
+            expectWithinAbsoluteError (ramp.getValueAt (500), 1.0f, 0.001f);
+            expectWithinAbsoluteError (ramp.getValueAt (750), 0.75f, 0.001f);
+            expectWithinAbsoluteError (ramp.getValueAt (1000), 0.5f, 0.001f);
+        }
+
+        beginTest ("Dense automation fits the ramp");
+        {
+            // Lots of points in each interval
+            auto& curve = volParam->getCurve();
+            curve.clear();
+
+            for (int i = 0; i <= 1000; ++i)
+                curve.addPoint (i * 0.002, (i % 2) == 0 ? 0.2f : 0.8f, 0.0f);
+
+            volParam->updateStream();
+
+            const double sampleRate = 1000.0;
+            const int interval = 32, blockSize = 512;
+            volParam->updateFromAutomationSources (0.0);
+
+            AutomationRamp ramp;
+            ramp.prepare (AutomationRamp::getMaxNumSegments (blockSize, interval));
+            volParam->fillAutomationRamp (ramp, 0.0, sampleRate, blockSize, interval);
+
+            expectEquals (ramp.getNumSamples(), blockSize);
+            expectLessOrEqual (ramp.getNumSegments(), ramp.getMaxNumSegments());
+
+            // No segment spans more than an interval and each interval boundary is on the curve
+            for (auto& segment : ramp)
+                expect (segment.getEndSample() <= (segment.startSample / interval + 1) * interval);
+
+            for (int pos = interval; pos <= blockSize; pos += interval)
+                expectWithinAbsoluteError (ramp.getValueAt (pos), curve.getValueAt (pos / sampleRate), 0.001f);
+
+            // Blocks longer than the ramp was prepared for widen the interval rather than overflowing
+            volParam->updateFromAutomationSources (0.0);
+            volParam->fillAutomationRamp (ramp, 0.0, sampleRate, blockSize * 4, interval);
+            expectEquals (ramp.getNumSamples(), blockSize * 4);
+            expectLessOrEqual (ramp.getNumSegments(), ramp.getMaxNumSegments());
+
+            for (auto& segment : ramp)
+                expectLessOrEqual (segment.numSamples, interval * 4);
+
+            curve.clear();
+            volParam->updateStream();
+        }
+    }
+
+    //==============================================================================
+    void runPluginTests()
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto edit = Edit::createSingleTrackEdit (engine);
+        auto& pluginCache = edit->getPluginCache();
+
+        auto volumePlugin = pluginCache.createNewPlugin (VolumeAndPanPlugin::xmlTypeName, {});
+        auto compressorPlugin = pluginCache.createNewPlugin (CompressorPlugin::xmlTypeName, {});
+        auto eqPlugin = pluginCache.createNewPlugin (EqualiserPlugin::xmlTypeName, {});
+
+        beginTest ("VolumeAndPan ramps match sub-blocks");
+        {
+            auto& vol = dynamic_cast<VolumeAndPanPlugin&> (*volumePlugin);
+            expectRampsMatchSubBlocks (vol, *vol.volParam);
+        }
+
+        beginTest ("Compressor ramps match sub-blocks");
+        {
+            auto& comp = dynamic_cast<CompressorPlugin&> (*compressorPlugin);
+            expectRampsMatchSubBlocks (comp, *comp.outputDb);
+        }
+
+        beginTest ("Equaliser ramps match sub-blocks");
+        {
+            auto& eq = dynamic_cast<EqualiserPlugin&> (*eqPlugin);
+            expectRampsMatchSubBlocks (eq, *eq.midGain1);
+        }
+    }
+
+    /** Automates a parameter across its range and checks the plugin's output is the same
+        whether it follows the automation with ramps or is processed in sub-blocks.
+    */
+    void expectRampsMatchSubBlocks (Plugin& plugin, AutomatableParameter& param)
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 512, interval = 32, numBlocks = 64;
+
+        auto& curve = param.getCurve();
+        curve.clear();
+        curve.addPoint (0.0, param.valueRange.convertFrom0to1 (0.25f), 0.0f);
+        curve.addPoint (numBlocks * blockSize / sampleRate / 2.0, param.valueRange.convertFrom0to1 (0.75f), 0.0f);
+        curve.addPoint (numBlocks * blockSize / sampleRate, param.valueRange.convertFrom0to1 (0.4f), 0.0f);
+        param.updateStream();
+        expect (plugin.isAutomationNeeded());
+
+        auto& rampInterval = plugin.engine.getPluginManager().automationRampIntervalSamples;
+        const auto oldRampInterval = rampInterval;
+
+        auto process = [&] (int intervalToUse, int subBlockSize)
+        {
+            rampInterval = intervalToUse;
+            plugin.baseClassInitialise ({ 0.0, sampleRate, blockSize });
+            expectEquals (plugin.getAutomationRampInterval(), intervalToUse);
+
+            // A sine that's loud enough to be compressed
+            juce::AudioBuffer<float> buffer (2, numBlocks * blockSize);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                for (int c = 0; c < buffer.getNumChannels(); ++c)
+                    buffer.setSample (c, i, 0.8f * std::sin (i * 440.0f * juce::MathConstants<float>::twoPi / (float) sampleRate));
+
+            for (int start = 0; start < buffer.getNumSamples(); start += subBlockSize)
+            {
+                juce::AudioBuffer<float> block (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, subBlockSize);
+                PluginRenderContext rc (&block, juce::AudioChannelSet::stereo(), 0, subBlockSize,
+                                        nullptr, 0.0, start / sampleRate, true, false, false, false);
+                plugin.applyToBufferWithAutomation (rc);
+            }
+
+            plugin.baseClassDeinitialise();
+            return buffer;
+        };
+
+        const auto ramped = process (interval, blockSize);
+        const auto subBlocked = process (0, interval);
+        rampInterval = oldRampInterval;
+
+        // The automation should make a difference to the output
+        const auto startLevel = ramped.getRMSLevel (0, 0, blockSize);
+        const auto midLevel = ramped.getRMSLevel (0, ramped.getNumSamples() / 2 - blockSize, blockSize);
+        expectGreaterThan (std::abs (midLevel - startLevel), 0.01f);
+
+        // Sub-blocks take the value at their start, so allow for the automation moving over one of them
+        float maxDifference = 0.0f;
+
+        for (int c = 0; c < ramped.getNumChannels(); ++c)
+            for (int i = 0; i < ramped.getNumSamples(); ++i)
+                maxDifference = std::max (maxDifference, std::abs (ramped.getSample (c, i) - subBlocked.getSample (c, i)));
+
+        expectLessThan (maxDifference, 0.02f * ramped.getMagnitude (0, ramped.getNumSamples()));
+
+        curve.clear();
+        param.updateStream();
+    }
+};
+
+static AutomationRampTests automationRampTests;
+
 #endif
 
 } // namespace tracktion_engine
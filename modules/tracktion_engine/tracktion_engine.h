@@ -49,6 +49,8 @@
 #include <atomic>
 #include <random>
 #include <optional>
+#include <mutex>
+#include <condition_variable>
 
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_utils/juce_audio_utils.h>
@@ -221,6 +223,7 @@
 namespace tracktion_graph
 {
     class PlayHead;
+    class NodeProfiler;
 }
 
 //==============================================================================
@@ -265,6 +268,7 @@ namespace tracktion_engine
     class RenderOptions;
     class AutomatableParameter;
     class AutomatableParameterTree;
+    class AutomationRamp;
     class MacroParameterList;
     class MelodyneFileReader;
     struct ARADocumentHolder;
@@ -284,6 +288,7 @@ namespace tracktion_engine
     class RenderManager;
     class EditPlaybackContext;
     class EditInputDevices;
+    class EditItemIndex;
     class InputDeviceInstance;
     class GrooveTemplate;
     class MidiOutputDevice;
@@ -356,6 +361,7 @@ namespace tracktion_engine
 #include "utilities/tracktion_AudioFadeCurve.h"
 #include "utilities/tracktion_Spline.h"
 #include "utilities/tracktion_Ditherer.h"
+#include "utilities/tracktion_Resampler.h"
 #include "utilities/tracktion_ExternalPlayheadSynchroniser.h"
 #include "selection/tracktion_Selectable.h"
 #include "selection/tracktion_SelectableClass.h"
@@ -462,8 +468,10 @@ namespace tracktion_engine
 #include "model/edit/tracktion_SourceFileReference.h"
 #include "model/clips/tracktion_Clip.h"
 #include "model/edit/tracktion_EditUtilities.h"
+#include "model/edit/tracktion_EditItemIndex.h"
 
 #include "audio_files/tracktion_AudioFileCache.h"
+#include "audio_files/tracktion_PeakFile.h"
 #include "audio_files/tracktion_Thumbnail.h"
 #include "audio_files/tracktion_SmartThumbnail.h"
 #include "audio_files/tracktion_AudioProxyGenerator.h"
@@ -24,6 +24,14 @@ extern "C"
    #endif
 }
 
+#if TRACKTION_UNIT_TESTS
+ #include <tracktion_graph/tracktion_graph_TestConfig.h>
+#endif
+
+#include <tracktion_graph/tracktion_graph.h>
+
+#include <tracktion_graph/tracktion_graph/tracktion_graph_TestUtilities.h>
+
 #include "tracktion_engine.h"
 
 #include <string>
@@ -32,6 +40,9 @@ extern "C"
 #include "audio_files/formats/tracktion_RexFileFormat.cpp"
 #include "audio_files/formats/tracktion_LAMEManager.cpp"
 
+#include "audio_files/tracktion_PeakFile.cpp"
+#include "audio_files/tracktion_PeakFile.test.cpp"
+#include "audio_files/tracktion_PeakFileBenchmarks.test.cpp"
 #include "audio_files/tracktion_Thumbnail.cpp"
 #include "audio_files/tracktion_AudioFileCache.cpp"
 #include "audio_files/tracktion_AudioFile.cpp"
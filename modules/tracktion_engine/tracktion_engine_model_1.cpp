@@ -20,9 +20,13 @@ using namespace juce;
 #include "model/automation/modifiers/tracktion_ModifierInternal.h"
 
 #include "model/edit/tracktion_OldEditConversion.h"
+#include "model/edit/tracktion_ConcurrentEditLoader.h"
 #include "model/edit/tracktion_EditItem.cpp"
 #include "model/edit/tracktion_Edit.cpp"
 #include "model/edit/tracktion_EditUtilities.cpp"
+#include "model/edit/tracktion_EditItemIndex.cpp"
+#include "model/edit/tracktion_EditUtilities.test.cpp"
+#include "model/edit/tracktion_ConcurrentEditLoader.test.cpp"
 #include "model/edit/tracktion_SourceFileReference.cpp"
 #include "model/clips/tracktion_Clip.cpp"
 
@@ -30,6 +34,7 @@ using namespace juce;
 #include "model/automation/tracktion_AutomatableParameter.cpp"
 #include "model/automation/tracktion_MacroParameter.cpp"
 #include "model/automation/tracktion_AutomationCurve.cpp"
+#include "model/automation/tracktion_AutomationCurve.test.cpp"
 #include "model/automation/tracktion_AutomationRecordManager.cpp"
 #include "model/automation/tracktion_MidiLearn.cpp"
 #include "model/automation/tracktion_ParameterChangeHandler.cpp"
@@ -100,6 +100,9 @@ extern "C"
 #include "playback/graph/tracktion_MelodyneNode.h"
 #include "playback/graph/tracktion_MelodyneNode.cpp"
 
+#include "playback/graph/tracktion_PackedMidiSequence.h"
+#include "playback/graph/tracktion_PackedMidiSequence.cpp"
+
 #include "playback/graph/tracktion_MidiNode.h"
 #include "playback/graph/tracktion_MidiNode.cpp"
 
@@ -154,18 +157,30 @@ extern "C"
 #include "playback/graph/tracktion_EditNodeBuilder.cpp"
 #include "playback/graph/tracktion_EditNodeBuilder.test.cpp"
 
+#include "playback/graph/tracktion_TracktionNodePlayer.cpp"
+
 #include "playback/graph/tracktion_NodeRenderContext.h"
 #include "playback/graph/tracktion_NodeRenderContext.cpp"
+#include "playback/graph/tracktion_NodeRenderContext.test.cpp"
 
 #include "playback/graph/tracktion_NodeRendering.test.cpp"
 
 #include "playback/graph/tracktion_WaveNode.test.cpp"
+#include "playback/graph/tracktion_TimeStretchingWaveNode.test.cpp"
+#include "playback/graph/tracktion_WaveNodeBenchmarks.test.cpp"
 #include "playback/graph/tracktion_MidiNode.test.cpp"
+#include "playback/graph/tracktion_MidiNodeBenchmarks.test.cpp"
 #include "playback/graph/tracktion_RackBenchmarks.test.cpp"
+#include "playback/graph/tracktion_GraphRebuildBenchmarks.test.cpp"
+#include "playback/graph/tracktion_ModifierBenchmarks.test.cpp"
+#include "playback/graph/tracktion_ConcurrentContextBenchmarks.test.cpp"
+#include "playback/graph/tracktion_EditLoadBenchmarks.test.cpp"
+#include "playback/graph/tracktion_EditItemIndexBenchmarks.test.cpp"
 
 using namespace juce;
 
 #include "playback/tracktion_DeviceManager.cpp"
+#include "playback/tracktion_DeviceManager.test.cpp"
 #include "playback/tracktion_EditPlaybackContext.cpp"
 #include "playback/tracktion_EditInputDevices.cpp"
 #include "playback/tracktion_LevelMeasurer.cpp"
@@ -195,6 +210,7 @@ using namespace juce;
 #include "playback/devices/tracktion_OutputDevice.cpp"
 #include "playback/devices/tracktion_WaveDeviceDescription.cpp"
 #include "playback/devices/tracktion_WaveInputDevice.cpp"
+#include "playback/devices/tracktion_WaveInputDevice.test.cpp"
 #include "playback/devices/tracktion_WaveOutputDevice.cpp"
 
 #include "playback/tracktion_HostedAudioDevice.cpp"
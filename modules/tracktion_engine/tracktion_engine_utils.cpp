@@ -69,6 +69,7 @@ using namespace juce;
 #include "utilities/tracktion_FileUtilities.cpp"
 #include "utilities/tracktion_Oscillators.cpp"
 #include "utilities/tracktion_PropertyStorage.cpp"
+#include "utilities/tracktion_Resampler.cpp"
 #include "utilities/tracktion_UIBehaviour.cpp"
 #include "utilities/tracktion_TemporaryFileManager.cpp"
 #include "utilities/tracktion_Engine.cpp"
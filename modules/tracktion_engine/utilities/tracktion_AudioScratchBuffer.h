@@ -20,6 +20,7 @@ class AudioScratchBuffer
     struct BufferList;
     struct Buffer;
     Buffer* allocatedBuffer; // NB: keep this member first, as it needs to be initialised before buffer.
+    friend class AudioScratchBufferTests;
 
 public:
     /** Creates a buffer for a given number of channels and samples. */
@@ -37,6 +38,31 @@ public:
     /** Initialises the internal buffer list. */
     static void initialise();
 
+    /** Adds free buffers to the pool until at least this many have been preallocated
+        at the given size. Buffers already in the pool are never claimed or resized so
+        this is safe to call while the audio threads are using it.
+        Call this when the block size or number of audio threads is known (not from
+        the audio thread) so that creating scratch buffers doesn't allocate mid-callback.
+    */
+    static void preallocate (int numBuffers, int numChannels, int numSamples);
+
+    //==============================================================================
+    /** Describes how the pool has been used. */
+    struct Statistics
+    {
+        int numBuffers = 0;     /**< The total number of buffers in the pool. */
+        int numInUse = 0;       /**< The number of buffers currently in use. */
+        int highWaterMark = 0;  /**< The most buffers in use at once since the statistics were reset. */
+        int numMisses = 0;      /**< The number of times there wasn't a free buffer so one had to be allocated. */
+        int numResizes = 0;     /**< The number of times a free buffer was too small and had to reallocate. */
+    };
+
+    /** Returns the current pool statistics. */
+    static Statistics getStatistics();
+
+    /** Resets the high water mark and miss counts. */
+    static void resetStatistics();
+
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioScratchBuffer)
 };
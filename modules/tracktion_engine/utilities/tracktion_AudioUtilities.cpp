@@ -464,50 +464,200 @@ void AudioFadeCurve::drawFadeCurve (Graphics& g, const AudioFadeCurve::Type fade
 //==============================================================================
 struct AudioScratchBuffer::Buffer
 {
-    juce::AudioBuffer<float> buffer { 2, 41000 };
+    Buffer (int numChans, int numSamples, bool pooled)
+        : buffer (numChans, numSamples), isPooled (pooled)
+    {
+        updateCapacity (numChans, numSamples);
+    }
+
+    /** Returns true if the buffer would need to reallocate to hold this size.
+        The capacity only ever grows so if this returns false for a free buffer, it
+        will still be big enough once it's been claimed.
+    */
+    bool needsToGrow (int numChans, int numSamples) const noexcept
+    {
+        return numChans > capacityChannels.load (std::memory_order_relaxed)
+                || numChans * numSamples > capacitySamples.load (std::memory_order_relaxed);
+    }
+
+    /** Must only be called by the thread that has claimed the buffer. */
+    void updateCapacity (int numChans, int numSamples) noexcept
+    {
+        capacityChannels.store (std::max (capacityChannels.load (std::memory_order_relaxed), numChans), std::memory_order_relaxed);
+        capacitySamples.store (std::max (capacitySamples.load (std::memory_order_relaxed), numChans * numSamples), std::memory_order_relaxed);
+    }
+
+    juce::AudioBuffer<float> buffer;
+    std::atomic<int> capacityChannels { 0 }, capacitySamples { 0 };
+    const bool isPooled;
     std::atomic<bool> isFree { true };
 };
 
+/**
+    A fixed array of buffer slots which can be claimed without locking.
+    Each thread starts searching at a different slot so the audio threads don't all
+    contend on the same few buffers. The lock is only taken when there are no free
+    buffers and a new one has to be allocated, which is counted as a miss.
+*/
 struct AudioScratchBuffer::BufferList   : private DeletedAtShutdown
 {
+    static constexpr int maxNumBuffers = 256;
+
     BufferList()
     {
         for (int i = 8; --i >= 0;)
-            buffers.add (new Buffer());
+            addBuffer (2, 41000)->isFree = true;
     }
 
     ~BufferList()
     {
+        for (int i = numBuffers.load(); --i >= 0;)
+            delete buffers[(size_t) i].load();
+
         clearSingletonInstance();
     }
 
     JUCE_DECLARE_SINGLETON (BufferList, false)
 
-    Buffer* get()
+    Buffer* get (int numChans, int numSamples)
     {
+        auto b = findFreeBuffer (numChans, numSamples);
+
+        if (b == nullptr)
+        {
+            // No free buffers so we'll have to allocate one
+            ++numMisses;
+            b = addBuffer (numChans, numSamples);
+        }
+        else if (b->needsToGrow (numChans, numSamples))
         {
-            const ScopedLock sl (lock);
+            ++numResizes;
+        }
 
-            for (auto b : buffers)
+        b->updateCapacity (numChans, numSamples);
+
+        const auto inUse = ++numInUse;
+        auto highWater = highWaterMark.load (std::memory_order_relaxed);
+
+        while (inUse > highWater && ! highWaterMark.compare_exchange_weak (highWater, inUse))
+        {}
+
+        return b;
+    }
+
+    void release (Buffer* b) noexcept
+    {
+        --numInUse;
+
+        if (b->isPooled)
+            b->isFree.store (true, std::memory_order_release);
+        else
+            delete b;
+    }
+
+    /** Adds new free buffers until at least numRequired have been preallocated at this size.
+        Existing buffers are never claimed or resized as the audio threads may be using them,
+        so if the size grows, a new set of buffers is added.
+    */
+    void preallocate (int numRequired, int numChans, int numSamples)
+    {
+        const ScopedLock sl (addLock);
+
+        if (numChans > preallocatedChannels || numSamples > preallocatedSamples)
+        {
+            preallocatedChannels = std::max (preallocatedChannels, numChans);
+            preallocatedSamples = std::max (preallocatedSamples, numSamples);
+            numPreallocated = 0;
+        }
+
+        for (; numPreallocated < numRequired && numBuffers.load() < maxNumBuffers; ++numPreallocated)
+            addBuffer (preallocatedChannels, preallocatedSamples)->isFree.store (true, std::memory_order_release);
+    }
+
+    Statistics getStatistics() const noexcept
+    {
+        Statistics stats;
+        stats.numBuffers    = numBuffers.load();
+        stats.numInUse      = numInUse.load();
+        stats.highWaterMark = highWaterMark.load();
+        stats.numMisses     = numMisses.load();
+        stats.numResizes    = numResizes.load();
+
+        return stats;
+    }
+
+    void resetStatistics() noexcept
+    {
+        highWaterMark = numInUse.load();
+        numMisses = 0;
+        numResizes = 0;
+    }
+
+private:
+    std::array<std::atomic<Buffer*>, (size_t) maxNumBuffers> buffers {};
+    std::atomic<int> numBuffers { 0 }, numInUse { 0 }, highWaterMark { 0 }, numMisses { 0 }, numResizes { 0 };
+    CriticalSection addLock;
+    int preallocatedChannels = 0, preallocatedSamples = 0, numPreallocated = 0; // Guarded by addLock
+
+    /** Claims a free buffer, starting at a slot based on the current thread.
+        Buffers that are already big enough are preferred, a smaller one is only
+        claimed (and resized) if none of them are free.
+    */
+    Buffer* findFreeBuffer (int numChans, int numSamples) noexcept
+    {
+        const int num = numBuffers.load (std::memory_order_acquire);
+
+        if (num == 0)
+            return nullptr;
+
+        static thread_local const size_t threadHash = std::hash<std::thread::id>() (std::this_thread::get_id());
+        const auto start = (int) (threadHash % (size_t) num);
+
+        for (bool mustBeBigEnough : { true, false })
+        {
+            for (int i = 0; i < num; ++i)
             {
-                if (b->isFree)
-                {
-                    b->isFree = false;
+                auto b = buffers[(size_t) ((start + i) % num)].load (std::memory_order_acquire);
+
+                if (! b->isFree.load (std::memory_order_relaxed))
+                    continue;
+
+                if (mustBeBigEnough && b->needsToGrow (numChans, numSamples))
+                    continue;
+
+                bool expected = true;
+
+                if (b->isFree.compare_exchange_strong (expected, false, std::memory_order_acquire))
                     return b;
-                }
             }
         }
 
-        auto newBuffer = new Buffer();
-        newBuffer->isFree = false;
-
-        const ScopedLock sl (lock);
-        buffers.add (newBuffer);
-        return newBuffer;
+        return nullptr;
     }
 
-    CriticalSection lock;
-    OwnedArray<Buffer> buffers;
+    /** Adds a new, already claimed, buffer. */
+    Buffer* addBuffer (int numChans, int numSamples)
+    {
+        const ScopedLock sl (addLock);
+        const int index = numBuffers.load();
+
+        if (index >= maxNumBuffers)
+        {
+            // This many buffers in use at once probably means they're not being released.
+            // We'll still return a buffer but it will be deleted when it's released.
+            jassertfalse;
+            auto b = new Buffer (numChans, numSamples, false);
+            b->isFree = false;
+            return b;
+        }
+
+        auto b = new Buffer (numChans, numSamples, true);
+        b->isFree = false;
+        buffers[(size_t) index].store (b, std::memory_order_release);
+        numBuffers.store (index + 1, std::memory_order_release);
+
+        return b;
+    }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BufferList)
 };
@@ -515,14 +665,14 @@ struct AudioScratchBuffer::BufferList   : private DeletedAtShutdown
 JUCE_IMPLEMENT_SINGLETON (AudioScratchBuffer::BufferList)
 
 AudioScratchBuffer::AudioScratchBuffer (int numChans, int numSamples)
-    : allocatedBuffer (BufferList::getInstance()->get()),
+    : allocatedBuffer (BufferList::getInstance()->get (numChans, numSamples)),
       buffer (allocatedBuffer->buffer)
 {
     buffer.setSize (numChans, numSamples, false, false, true);
 }
 
 AudioScratchBuffer::AudioScratchBuffer (const juce::AudioBuffer<float>& srcBuffer)
-  : allocatedBuffer (BufferList::getInstance()->get()),
+  : allocatedBuffer (BufferList::getInstance()->get (srcBuffer.getNumChannels(), srcBuffer.getNumSamples())),
     buffer (allocatedBuffer->buffer)
 {
     const int chans = srcBuffer.getNumChannels();
@@ -536,7 +686,7 @@ AudioScratchBuffer::AudioScratchBuffer (const juce::AudioBuffer<float>& srcBuffe
 
 AudioScratchBuffer::~AudioScratchBuffer() noexcept
 {
-    allocatedBuffer->isFree = true;
+    BufferList::getInstance()->release (allocatedBuffer);
 }
 
 void AudioScratchBuffer::initialise()
@@ -544,6 +694,21 @@ void AudioScratchBuffer::initialise()
     BufferList::getInstance();
 }
 
+void AudioScratchBuffer::preallocate (int numBuffers, int numChannels, int numSamples)
+{
+    BufferList::getInstance()->preallocate (numBuffers, numChannels, numSamples);
+}
+
+AudioScratchBuffer::Statistics AudioScratchBuffer::getStatistics()
+{
+    return BufferList::getInstance()->getStatistics();
+}
+
+void AudioScratchBuffer::resetStatistics()
+{
+    BufferList::getInstance()->resetStatistics();
+}
+
 
 //==============================================================================
 //==============================================================================
@@ -631,6 +796,140 @@ private:
 
 static PanLawTests panLawTests;
 
+//==============================================================================
+class AudioScratchBufferTests : public UnitTest
+{
+public:
+    AudioScratchBufferTests() : UnitTest ("AudioScratchBuffer", "Tracktion") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        // These use their own BufferList so they don't depend on what else has used the shared one
+        beginTest ("Preallocated buffers");
+        {
+            AudioScratchBuffer::BufferList list;
+            list.preallocate (16, 4, 4096);
+
+            // The list's default buffers are too small so these should all come from the preallocated ones
+            std::vector<AudioScratchBuffer::Buffer*> buffers;
+
+            for (int i = 0; i < 16; ++i)
+                buffers.push_back (list.get (4, 4096));
+
+            auto stats = list.getStatistics();
+            expectEquals (stats.numMisses, 0);
+            expectEquals (stats.numResizes, 0);
+            expectEquals (stats.numInUse, 16);
+            expectEquals (stats.highWaterMark, 16);
+
+            for (auto b : buffers)
+                list.release (b);
+
+            expectEquals (list.getStatistics().numInUse, 0);
+        }
+
+        beginTest ("Buffers that are big enough are used before resizing");
+        {
+            AudioScratchBuffer::BufferList list;
+            list.preallocate (1, 8, 1024);
+
+            auto big = list.get (8, 1024);
+            expectEquals (list.getStatistics().numResizes, 0);
+
+            // With the only big buffer in use a smaller one has to grow rather than allocating a new one
+            auto resized = list.get (8, 1024);
+            expectEquals (list.getStatistics().numResizes, 1);
+            expectEquals (list.getStatistics().numMisses, 0);
+
+            list.release (big);
+            list.release (resized);
+        }
+
+        beginTest ("Preallocating doesn't claim buffers in use");
+        {
+            AudioScratchBuffer::BufferList list;
+            list.preallocate (16, 4, 4096);
+
+            auto inUse = list.get (4, 4096);
+            const auto numBuffersBefore = list.getStatistics().numBuffers;
+
+            // The same size again is already covered so nothing is added or claimed
+            list.preallocate (16, 4, 4096);
+            expectEquals (list.getStatistics().numBuffers, numBuffersBefore);
+            expectEquals (list.getStatistics().numInUse, 1);
+
+            // A larger size adds a new set of buffers rather than growing existing ones
+            list.preallocate (4, 8, 4096);
+            expectEquals (list.getStatistics().numBuffers, numBuffersBefore + 4);
+            expectEquals (list.getStatistics().numInUse, 1);
+            expectGreaterOrEqual (inUse->buffer.getNumChannels(), 4);
+
+            list.release (inUse);
+        }
+
+        beginTest ("Multi-threaded use");
+        {
+            // Each round, every thread claims two buffers and waits for the others to
+            // do the same before releasing them. As no buffers are released while they're
+            // being claimed, 16 free buffers are always enough so there can't be a miss.
+            constexpr int numThreads = 8, numRounds = 1000;
+            AudioScratchBuffer::preallocate (numThreads * 2, 2, 512);
+            AudioScratchBuffer::resetStatistics();
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            int numWaiting = 0, generation = 0;
+
+            auto waitForOtherThreads = [&]
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                const auto thisGeneration = generation;
+
+                if (++numWaiting == numThreads)
+                {
+                    numWaiting = 0;
+                    ++generation;
+                    condition.notify_all();
+                    return;
+                }
+
+                condition.wait (lock, [&] { return generation != thisGeneration; });
+            };
+
+            std::vector<std::thread> threads;
+
+            for (int t = 0; t < numThreads; ++t)
+            {
+                threads.emplace_back ([&]
+                                      {
+                                          for (int i = 0; i < numRounds; ++i)
+                                          {
+                                              {
+                                                  AudioScratchBuffer a (2, 512), b (2, 512);
+                                                  a.buffer.clear();
+                                                  b.buffer.clear();
+                                                  waitForOtherThreads();
+                                              }
+
+                                              waitForOtherThreads();
+                                          }
+                                      });
+            }
+
+            for (auto& t : threads)
+                t.join();
+
+            auto stats = AudioScratchBuffer::getStatistics();
+            expectEquals (stats.numMisses, 0);
+            expectEquals (stats.numInUse, 0);
+            expectLessOrEqual (stats.highWaterMark, 16);
+        }
+    }
+};
+
+static AudioScratchBufferTests audioScratchBufferTests;
+
 #endif // TRACKTION_UNIT_TESTS
 
 }
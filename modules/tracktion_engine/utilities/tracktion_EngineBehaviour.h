@@ -120,6 +120,19 @@ public:
     virtual bool arePluginsRemappedWhenTempoChanges()                               { return true; }
     virtual void setPluginsRemappedWhenTempoChanges (bool)                          {}
 
+    /** Should time-stretched audio clips be stretched in real time during playback.
+        If false, they'll play back from a rendered proxy file which uses less CPU
+        but has to be re-rendered whenever the clip or tempo changes.
+        Real time stretching needs more CPU and can drop out if the stretcher can't
+        keep up so it's off by default.
+    */
+    virtual bool shouldUseRealtimeTimeStretching()                                  { return false; }
+
+    /** Should return the resampling quality to use when audio files are played at a
+        different rate or speed to the output.
+    */
+    virtual ResamplingQuality getResamplingQuality (bool /*isOfflineRender*/)      { return ResamplingQuality::lagrange; }
+
     /** Should return the maximum number of plugins that can be added to the master bus. */
     virtual int getMaxNumMasterPlugins()                                            { return 4; }
 
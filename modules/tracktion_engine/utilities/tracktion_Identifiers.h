@@ -213,6 +213,8 @@ namespace IDs
     DECLARE_ID (minNote)
     DECLARE_ID (maxNote)
     DECLARE_ID (openEnded)
+    DECLARE_ID (streaming)
+    DECLARE_ID (preloadLength)
     DECLARE_ID (SOUND)
     DECLARE_ID (threshold)
     DECLARE_ID (inputDb)
@@ -0,0 +1,286 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+Resampler::Resampler (ResamplingQuality q)
+    : quality (q)
+{
+}
+
+void Resampler::setQuality (ResamplingQuality newQuality) noexcept
+{
+    quality = newQuality;
+    reset();
+}
+
+void Resampler::prepare (int numChannelsToUse)
+{
+    numChannels = numChannelsToUse;
+    history.assign ((size_t) (numChannels * historySize), 0.0f);
+    position = 0.0;
+}
+
+void Resampler::reset() noexcept
+{
+    std::fill (history.begin(), history.end(), 0.0f);
+    position = 0.0;
+}
+
+int Resampler::getNumLookAheadSamples() const noexcept
+{
+    return quality == ResamplingQuality::sinc ? maxHalfTaps : 2;
+}
+
+int Resampler::processAdding (double ratio,
+                              const float* const* source, int numSourceFrames,
+                              choc::buffer::ChannelArrayView<float> dest,
+                              const float* channelGains, int numGains) noexcept
+{
+    jassert (ratio > 0.0);
+    jassert ((int) dest.getNumChannels() <= numChannels);
+    jassert (numGains > 0);
+
+    const auto numFrames = (int) dest.getNumFrames();
+
+    if (numFrames == 0 || numSourceFrames <= 0)
+        return 0;
+
+    if (ratio == 1.0 && position == 0.0 && numSourceFrames >= numFrames)
+        processUnityAdding (source, dest, channelGains, numGains);
+    else if (quality == ResamplingQuality::sinc)
+        processSincAdding (ratio, source, numSourceFrames, dest, channelGains, numGains);
+    else
+        processLagrangeAdding (ratio, source, numSourceFrames, dest, channelGains, numGains);
+
+    const auto endPosition = position + numFrames * ratio;
+    const auto numConsumed = (int) endPosition;
+    position = endPosition - numConsumed;
+
+    updateHistory (source, numSourceFrames, numConsumed, (int) dest.getNumChannels());
+
+    return numConsumed;
+}
+
+//==============================================================================
+float Resampler::getWindowedSinc (float distance) noexcept
+{
+    // A Hann-windowed sinc from 0 to numZeroCrossings, with a spare point for interpolating
+    static const std::vector<float> table = []
+    {
+        std::vector<float> values ((size_t) (numZeroCrossings * sincTableResolution + 2), 0.0f);
+        values[0] = 1.0f;
+
+        for (size_t i = 1; i < values.size(); ++i)
+        {
+            const auto x = juce::MathConstants<double>::pi * (double) i / sincTableResolution;
+
+            if (x < juce::MathConstants<double>::pi * numZeroCrossings)
+                values[i] = (float) (std::sin (x) / x * (0.5 + 0.5 * std::cos (x / numZeroCrossings)));
+        }
+
+        return values;
+    }();
+
+    const auto scaled = std::abs (distance) * sincTableResolution;
+    const auto index = (size_t) scaled;
+
+    if (index >= table.size() - 1)
+        return 0.0f;
+
+    const auto alpha = scaled - (float) index;
+    return table[index] + alpha * (table[index + 1] - table[index]);
+}
+
+void Resampler::processUnityAdding (const float* const* source, choc::buffer::ChannelArrayView<float> dest,
+                                    const float* channelGains, int numGains) noexcept
+{
+    const auto numFrames = (int) dest.getNumFrames();
+
+    for (choc::buffer::ChannelCount chan = 0; chan < dest.getNumChannels(); ++chan)
+        juce::FloatVectorOperations::addWithMultiply (dest.getChannel (chan).data.data, source[chan],
+                                                      channelGains[std::min ((int) chan, numGains - 1)], numFrames);
+}
+
+void Resampler::processLagrangeAdding (double ratio, const float* const* source, int numSourceFrames,
+                                       choc::buffer::ChannelArrayView<float> dest,
+                                       const float* channelGains, int numGains) noexcept
+{
+    const auto numFrames = (int) dest.getNumFrames();
+    const auto numDestChannels = (int) dest.getNumChannels();
+
+    int indexes[maxChunkSize];
+    float coefficients[maxChunkSize][4];
+
+    for (int chunkStart = 0; chunkStart < numFrames; chunkStart += maxChunkSize)
+    {
+        const int chunkSize = std::min (maxChunkSize, numFrames - chunkStart);
+
+        // The positions and coefficients are the same for every channel
+        for (int i = 0; i < chunkSize; ++i)
+        {
+            const auto t = position + (chunkStart + i) * ratio;
+            const auto index = (int) t;
+            const auto f = (float) (t - index);
+            const auto fp1 = f + 1.0f, fm1 = f - 1.0f, fm2 = f - 2.0f;
+
+            indexes[i] = index;
+            coefficients[i][0] = -f * fm1 * fm2 / 6.0f;
+            coefficients[i][1] = fp1 * fm1 * fm2 / 2.0f;
+            coefficients[i][2] = -fp1 * f * fm2 / 2.0f;
+            coefficients[i][3] = fp1 * f * fm1 / 6.0f;
+        }
+
+        const bool allInSource = indexes[0] >= 1 && indexes[chunkSize - 1] + 2 < numSourceFrames;
+
+        for (int chan = 0; chan < numDestChannels; ++chan)
+        {
+            const auto src = source[chan];
+            const auto hist = getHistory (chan);
+            const auto gain = channelGains[std::min (chan, numGains - 1)];
+            const auto d = dest.getChannel ((choc::buffer::ChannelCount) chan).data.data + chunkStart;
+
+            if (allInSource)
+            {
+                for (int i = 0; i < chunkSize; ++i)
+                {
+                    const auto s = src + indexes[i] - 1;
+                    const auto c = coefficients[i];
+                    d[i] += gain * (c[0] * s[0] + c[1] * s[1] + c[2] * s[2] + c[3] * s[3]);
+                }
+            }
+            else
+            {
+                auto getSample = [&] (int index)
+                {
+                    if (index < 0)
+                        return hist[historySize + index];
+
+                    return src[std::min (index, numSourceFrames - 1)];
+                };
+
+                for (int i = 0; i < chunkSize; ++i)
+                {
+                    const auto c = coefficients[i];
+                    const auto index = indexes[i];
+                    d[i] += gain * (c[0] * getSample (index - 1) + c[1] * getSample (index)
+                                     + c[2] * getSample (index + 1) + c[3] * getSample (index + 2));
+                }
+            }
+        }
+    }
+}
+
+void Resampler::processSincAdding (double ratio, const float* const* source, int numSourceFrames,
+                                   choc::buffer::ChannelArrayView<float> dest,
+                                   const float* channelGains, int numGains) noexcept
+{
+    const auto numFrames = (int) dest.getNumFrames();
+    const auto numDestChannels = (int) dest.getNumChannels();
+
+    // When downsampling, the kernel is widened to filter out anything above the new Nyquist
+    const auto cutoff = (float) juce::jlimit (1.0 / maxDownsamplingRatio, 1.0, 1.0 / ratio);
+    const auto halfTaps = std::min (maxHalfTaps, (int) std::ceil (numZeroCrossings / cutoff));
+    const auto numTaps = halfTaps * 2;
+
+    int firstIndexes[maxChunkSize];
+    float coefficients[maxChunkSize][maxHalfTaps * 2];
+
+    for (int chunkStart = 0; chunkStart < numFrames; chunkStart += maxChunkSize)
+    {
+        const int chunkSize = std::min (maxChunkSize, numFrames - chunkStart);
+
+        for (int i = 0; i < chunkSize; ++i)
+        {
+            const auto t = position + (chunkStart + i) * ratio;
+            const auto index = (int) t;
+            const auto f = (float) (t - index);
+            auto c = coefficients[i];
+            float sum = 0.0f;
+
+            firstIndexes[i] = index - halfTaps + 1;
+
+            for (int j = 0; j < numTaps; ++j)
+            {
+                c[j] = getWindowedSinc ((float) (j - halfTaps + 1 - f) * cutoff);
+                sum += c[j];
+            }
+
+            // Normalising keeps the DC gain at exactly 1
+            const auto scale = sum != 0.0f ? 1.0f / sum : 0.0f;
+
+            for (int j = 0; j < numTaps; ++j)
+                c[j] *= scale;
+        }
+
+        const bool allInSource = firstIndexes[0] >= 0 && firstIndexes[chunkSize - 1] + numTaps <= numSourceFrames;
+
+        for (int chan = 0; chan < numDestChannels; ++chan)
+        {
+            const auto src = source[chan];
+            const auto hist = getHistory (chan);
+            const auto gain = channelGains[std::min (chan, numGains - 1)];
+            const auto d = dest.getChannel ((choc::buffer::ChannelCount) chan).data.data + chunkStart;
+
+            for (int i = 0; i < chunkSize; ++i)
+            {
+                const auto c = coefficients[i];
+                const auto firstIndex = firstIndexes[i];
+                float total = 0.0f;
+
+                if (allInSource)
+                {
+                    const auto s = src + firstIndex;
+
+                    for (int j = 0; j < numTaps; ++j)
+                        total += c[j] * s[j];
+                }
+                else
+                {
+                    for (int j = 0; j < numTaps; ++j)
+                    {
+                        const auto index = firstIndex + j;
+                        const auto sample = index < 0 ? hist[historySize + index]
+                                                      : src[std::min (index, numSourceFrames - 1)];
+                        total += c[j] * sample;
+                    }
+                }
+
+                d[i] += gain * total;
+            }
+        }
+    }
+}
+
+void Resampler::updateHistory (const float* const* source, int numSourceFrames, int numConsumed, int numChannelsToUpdate) noexcept
+{
+    for (int chan = 0; chan < numChannelsToUpdate; ++chan)
+    {
+        const auto src = source[chan];
+        const auto hist = getHistory (chan);
+        auto getSample = [&] (int index) { return src[std::min (index, numSourceFrames - 1)]; };
+
+        if (numConsumed >= historySize)
+        {
+            for (int i = 0; i < historySize; ++i)
+                hist[i] = getSample (numConsumed - historySize + i);
+        }
+        else
+        {
+            std::memmove (hist, hist + numConsumed, (size_t) (historySize - numConsumed) * sizeof (float));
+
+            for (int i = 0; i < numConsumed; ++i)
+                hist[historySize - numConsumed + i] = getSample (i);
+        }
+    }
+}
+
+} // namespace tracktion_engine
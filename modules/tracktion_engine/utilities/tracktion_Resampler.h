@@ -0,0 +1,109 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/** The interpolation algorithms a Resampler can use. */
+enum class ResamplingQuality
+{
+    lagrange,   /**< 4-point Lagrange interpolation, cheap and fine for small ratio changes. */
+    sinc        /**< Windowed-sinc interpolation, band-limited when downsampling. */
+};
+
+//==============================================================================
+/**
+    Streams multi-channel audio from one sample rate to another.
+
+    All the channels are processed in one pass so the read positions and
+    interpolation coefficients are only calculated once per output sample.
+    If the ratio is 1 and the stream is on a whole sample, the input is just
+    added to the output with the gain applied.
+
+    Like juce::LagrangeInterpolator, the fractional position and some input
+    history are kept between calls so a continuous stream can be processed in
+    blocks. Unlike it though, there's no added latency: with a ratio of 1 the
+    output is the input.
+*/
+class Resampler
+{
+public:
+    /** Creates a Resampler using a given quality. */
+    Resampler (ResamplingQuality = ResamplingQuality::lagrange);
+
+    /** Changes the quality. This also resets the stream. */
+    void setQuality (ResamplingQuality) noexcept;
+
+    /** Returns the quality being used. */
+    ResamplingQuality getQuality() const noexcept           { return quality; }
+
+    /** Prepares the history for a number of channels and resets the stream.
+        This allocates so shouldn't be called on the audio thread.
+    */
+    void prepare (int numChannels);
+
+    /** Returns the number of channels this has been prepared for. */
+    int getNumChannels() const noexcept                     { return numChannels; }
+
+    /** Resets the position and history ready for a new stream. */
+    void reset() noexcept;
+
+    /** Returns the number of input samples needed after ratio * numOutputSamples
+        so the last output samples can be interpolated.
+    */
+    int getNumLookAheadSamples() const noexcept;
+
+    /** Resamples some input and adds it to a destination buffer.
+        @param ratio            The number of input samples per output sample
+        @param source           The input channels, starting at the next sample to consume
+        @param numSourceFrames  The number of frames in source. This should be at least
+                                ratio * dest.getNumFrames() + getNumLookAheadSamples()
+        @param dest             The buffer to add to. All its frames will be filled and
+                                it shouldn't have more channels than this was prepared for
+        @param channelGains     The gain to apply to each channel. Channels past numGains
+                                use the last gain
+        @returns                The number of input samples consumed
+    */
+    int processAdding (double ratio,
+                       const float* const* source, int numSourceFrames,
+                       choc::buffer::ChannelArrayView<float> dest,
+                       const float* channelGains, int numGains) noexcept;
+
+private:
+    //==============================================================================
+    static constexpr int numZeroCrossings = 8;
+    static constexpr int maxDownsamplingRatio = 4;
+    static constexpr int maxHalfTaps = numZeroCrossings * maxDownsamplingRatio;
+    static constexpr int historySize = maxHalfTaps;
+    static constexpr int maxChunkSize = 32;
+    static constexpr int sincTableResolution = 512;
+
+    ResamplingQuality quality;
+    int numChannels = 0;
+    double position = 0.0;
+    std::vector<float> history;
+
+    float* getHistory (int channel) noexcept               { return history.data() + channel * historySize; }
+    static float getWindowedSinc (float distance) noexcept;
+
+    void processUnityAdding (const float* const* source, choc::buffer::ChannelArrayView<float> dest,
+                             const float* channelGains, int numGains) noexcept;
+    void processLagrangeAdding (double ratio, const float* const* source, int numSourceFrames,
+                                choc::buffer::ChannelArrayView<float> dest,
+                                const float* channelGains, int numGains) noexcept;
+    void processSincAdding (double ratio, const float* const* source, int numSourceFrames,
+                            choc::buffer::ChannelArrayView<float> dest,
+                            const float* channelGains, int numGains) noexcept;
+    void updateHistory (const float* const* source, int numSourceFrames, int numConsumed, int numChannelsToUpdate) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Resampler)
+};
+
+} // namespace tracktion_engine
@@ -40,10 +40,14 @@
 #include "tracktion_graph/tracktion_graph_MultiThreadedNodePlayer.cpp"
 #include "tracktion_graph/tracktion_graph_LockFreeMultiThreadedNodePlayer.cpp"
 #include "tracktion_graph/tracktion_graph_NodePlayerThreadPools.cpp"
+#include "tracktion_graph/tracktion_graph_NodePlayerBenchmarks.test.cpp"
 
 #include "tracktion_graph/nodes/tracktion_graph_ConnectedNode.test.cpp"
+#include "tracktion_graph/nodes/tracktion_graph_SharedNode.test.cpp"
 
 #include "utilities/tracktion_AudioBufferPool.tests.cpp"
+#include "utilities/tracktion_NodeProfiler.cpp"
+#include "utilities/tracktion_NodeProfiler.test.cpp"
 #include "utilities/tracktion_Semaphore.cpp"
 #include "utilities/tracktion_Semaphore.tests.cpp"
 #include "utilities/tracktion_Threads.cpp"
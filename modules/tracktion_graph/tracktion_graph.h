@@ -58,10 +58,22 @@
  #define GRAPH_UNIT_TESTS_QUICK_VALIDATE 0
 #endif
 
+/** Config: GRAPH_UNIT_TESTS_COUNT_ALLOCATIONS
+
+    If this is enabled, the global operator new is replaced with one that can
+    count allocations so the tests can check the audio thread doesn't allocate.
+    Only enable this in test builds.
+*/
+#ifndef GRAPH_UNIT_TESTS_COUNT_ALLOCATIONS
+ #define GRAPH_UNIT_TESTS_COUNT_ALLOCATIONS 0
+#endif
+
 //==============================================================================
 //==============================================================================
 #include <cassert>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 //==============================================================================
 #if __has_include(<choc/audio/choc_SampleBuffers.h>)
@@ -85,6 +97,8 @@
 #include "utilities/tracktion_GlueCode.h"
 #include "utilities/tracktion_AudioFifo.h"
 #include "utilities/tracktion_MidiMessageArray.h"
+#include "utilities/tracktion_NodeProfiler.h"
+#include "utilities/tracktion_ParallelTasks.h"
 #include "utilities/tracktion_PerformanceMeasurement.h"
 #include "utilities/tracktion_RealTimeSpinLock.h"
 #include "utilities/tracktion_Semaphore.h"
@@ -95,6 +109,7 @@
 
 #include "tracktion_graph/tracktion_graph_Node.h"
 #include "tracktion_graph/tracktion_graph_PlayHeadState.h"
+#include "tracktion_graph/nodes/tracktion_graph_SharedNode.h"
 
 #include "tracktion_graph/players/tracktion_graph_NodePlayerUtilities.h"
 
@@ -71,7 +71,7 @@ public:
     void prepareToPlay (const PlaybackInitialisationInfo& info) override
     {
         latencyProcessor->prepareToPlay (info.sampleRate, info.blockSize, getNodeProperties().numberOfChannels);
-        replaceLatencyProcessorIfPossible (info.rootNodeToReplace);
+        replaceLatencyProcessorIfPossible (info.nodesToReplace);
     }
     
     void process (ProcessContext& pc) override
@@ -95,28 +95,19 @@ private:
     Node* input = nullptr;
     std::shared_ptr<LatencyProcessor> latencyProcessor { std::make_shared<LatencyProcessor>() };
     
-    void replaceLatencyProcessorIfPossible (Node* rootNodeToReplace)
+    void replaceLatencyProcessorIfPossible (const NodeIDIndex* nodesToReplace)
     {
-        if (rootNodeToReplace == nullptr)
-            return;
-        
-        auto nodeIDToLookFor = getNodeProperties().nodeID;
-        
-        if (nodeIDToLookFor == 0)
+        if (nodesToReplace == nullptr)
             return;
 
-        auto visitor = [this, nodeIDToLookFor] (Node& node)
-        {
-            if (auto other = dynamic_cast<LatencyNode*> (&node))
-            {
-                if (other->getNodeProperties().nodeID == nodeIDToLookFor
-                    && latencyProcessor->hasSameConfigurationAs (*other->latencyProcessor))
-                {
-                    latencyProcessor = other->latencyProcessor;
-                }
-            }
-        };
-        visitNodes (*rootNodeToReplace, visitor, true);
+        auto other = nodesToReplace->find<LatencyNode> (getNodeProperties().nodeID,
+                                                         [this] (LatencyNode& n)
+                                                         {
+                                                             return latencyProcessor->hasSameConfigurationAs (*n.latencyProcessor);
+                                                         });
+
+        if (other != nullptr)
+            latencyProcessor = other->latencyProcessor;
     }
 };
 
@@ -0,0 +1,118 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    Wraps a subtree so that it can be passed, along with its prepared state, to the
+    graphs that replace the one it was built for.
+
+    Give each SharedNode a nodeID that identifies what it plays and a hash of everything
+    its subtree was built from. When the graph is rebuilt, use createFrom to look up the
+    SharedNode in the graph being replaced and, if nothing has changed, share its input
+    rather than building and preparing a new one.
+
+    The input is only transformed and initialised the first time it is prepared with a
+    given sample rate and block size so it mustn't be connected to any other part of the
+    graph (e.g. with sends and returns) and mustn't be prepared with pooled buffers as
+    these belong to the player's previous graph.
+*/
+class SharedNode final : public Node
+{
+public:
+    /** Creates a SharedNode for a newly built subtree. */
+    SharedNode (std::unique_ptr<Node> inputNode, size_t nodeIDToUse, size_t contentHashToUse)
+        : nodeID (nodeIDToUse), contentHash (contentHashToUse),
+          shared (std::make_shared<SharedState>())
+    {
+        jassert (inputNode != nullptr);
+        shared->input = std::move (inputNode);
+    }
+
+    /** Returns a SharedNode that shares the input of the SharedNode with the same nodeID
+        and content hash in the index, or nullptr if there isn't one.
+    */
+    static std::unique_ptr<SharedNode> createFrom (const NodeIDIndex& nodesToShare, size_t nodeID, size_t contentHash)
+    {
+        if (auto other = nodesToShare.find<SharedNode> (nodeID, [contentHash] (SharedNode& n) { return n.contentHash == contentHash; }))
+            return std::unique_ptr<SharedNode> (new SharedNode (*other));
+
+        return {};
+    }
+
+    /** Returns the Node being shared. */
+    Node& getInput() const                          { return *shared->input; }
+
+    /** Returns the hash this was created with. */
+    size_t getContentHash() const                   { return contentHash; }
+
+    /** Returns true if the input has already been initialised with this sample rate and block size. */
+    bool isInputPreparedFor (double sampleRate, int blockSize) const
+    {
+        return shared->preparedSampleRate == sampleRate && shared->preparedBlockSize == blockSize;
+    }
+
+    //==============================================================================
+    NodeProperties getNodeProperties() override
+    {
+        auto props = shared->input->getNodeProperties();
+        props.nodeID = nodeID;
+
+        return props;
+    }
+
+    std::vector<Node*> getDirectInputNodes() override
+    {
+        return { shared->input.get() };
+    }
+
+    bool isReadyToProcess() override
+    {
+        return shared->input->hasProcessed();
+    }
+
+    void prepareToPlay (const PlaybackInitialisationInfo& info) override
+    {
+        // The input will have been initialised by now so it can be shared with the next graph
+        jassert (info.allocateAudioBuffer == nullptr);
+        shared->preparedSampleRate = info.sampleRate;
+        shared->preparedBlockSize = info.blockSize;
+    }
+
+    void process (ProcessContext& pc) override
+    {
+        auto inputBuffers = shared->input->getProcessedOutput();
+        copy (pc.buffers.audio, inputBuffers.audio);
+        pc.buffers.midi.copyFrom (inputBuffers.midi);
+    }
+
+private:
+    struct SharedState
+    {
+        std::unique_ptr<Node> input;
+        double preparedSampleRate = 0.0;
+        int preparedBlockSize = 0;
+    };
+
+    const size_t nodeID, contentHash;
+    std::shared_ptr<SharedState> shared;
+
+    SharedNode (const SharedNode& other)
+        : nodeID (other.nodeID), contentHash (other.contentHash), shared (other.shared)
+    {
+    }
+};
+
+}
@@ -0,0 +1,179 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if GRAPH_UNIT_TESTS_SHAREDNODE
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+class SharedNodeTests : public juce::UnitTest
+{
+public:
+    SharedNodeTests()
+        : juce::UnitTest ("SharedNode", "tracktion_graph")
+    {
+    }
+
+    void runTest() override
+    {
+        for (size_t numThreads : { 0, 2 })
+            runSharingTests (numThreads);
+    }
+
+private:
+    //==============================================================================
+    /** Outputs the number of samples it has processed and counts the times it's been prepared. */
+    class CountingNode final : public Node
+    {
+    public:
+        CountingNode (size_t nodeIDToUse)
+            : nodeID (nodeIDToUse)
+        {
+        }
+
+        NodeProperties getNodeProperties() override
+        {
+            NodeProperties props;
+            props.hasAudio = true;
+            props.numberOfChannels = 1;
+            props.nodeID = nodeID;
+
+            return props;
+        }
+
+        bool isReadyToProcess() override
+        {
+            return true;
+        }
+
+        void prepareToPlay (const PlaybackInitialisationInfo&) override
+        {
+            ++numTimesPrepared;
+        }
+
+        void process (ProcessContext& pc) override
+        {
+            setAllFrames (pc.buffers.audio, [&] { return (float) numSamplesProcessed++; });
+        }
+
+        const size_t nodeID;
+        int numTimesPrepared = 0;
+        int numSamplesProcessed = 0;
+    };
+
+    //==============================================================================
+    void runSharingTests (size_t numThreads)
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 256;
+        constexpr size_t sharedNodeID = 1, rebuiltNodeID = 2;
+        constexpr size_t contentHash = 42;
+
+        LockFreeMultiThreadedNodePlayer player;
+        player.setNumThreads (numThreads);
+
+        choc::buffer::ChannelArrayBuffer<float> audio (1, (choc::buffer::FrameCount) blockSize);
+        tracktion_engine::MidiMessageArray midi;
+        int64_t referenceSamplePosition = 0;
+
+        auto processBlocks = [&] (int numBlocks)
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                audio.clear();
+                midi.clear();
+                player.process ({ juce::Range<int64_t>::withStartAndLength (referenceSamplePosition, blockSize),
+                                  { audio.getView(), midi } });
+                referenceSamplePosition += blockSize;
+            }
+        };
+
+        auto createGraph = [] (std::unique_ptr<SharedNode> sharedNode, std::unique_ptr<Node> rebuiltNode)
+        {
+            std::vector<std::unique_ptr<Node>> inputs;
+            inputs.push_back (std::move (sharedNode));
+            inputs.push_back (std::move (rebuiltNode));
+
+            return makeNode<SummingNode> (std::move (inputs));
+        };
+
+        beginTest ("Unchanged subtrees keep their prepared state: " + juce::String (numThreads) + " threads");
+        {
+            auto sharedInput = std::make_unique<CountingNode> (0);
+            auto rebuiltInput = std::make_unique<CountingNode> (rebuiltNodeID);
+            auto sharedInputPtr = sharedInput.get();
+            auto rebuiltInputPtr = rebuiltInput.get();
+
+            player.setNode (createGraph (std::make_unique<SharedNode> (std::move (sharedInput), sharedNodeID, contentHash),
+                                         std::move (rebuiltInput)),
+                            sampleRate, blockSize);
+            processBlocks (4);
+
+            expectEquals (sharedInputPtr->numTimesPrepared, 1);
+            expectEquals (rebuiltInputPtr->numTimesPrepared, 1);
+            expectEquals (sharedInputPtr->numSamplesProcessed, 4 * blockSize);
+
+            // Rebuild the graph, only sharing the subtree if its content hasn't changed
+            const NodeIDIndex currentNodes (*player.getNode());
+            expect (SharedNode::createFrom (currentNodes, sharedNodeID, contentHash + 1) == nullptr);
+            expect (SharedNode::createFrom (currentNodes, rebuiltNodeID, contentHash) == nullptr);
+
+            auto sharedNode = SharedNode::createFrom (currentNodes, sharedNodeID, contentHash);
+            expect (sharedNode != nullptr);
+            expect (&sharedNode->getInput() == sharedInputPtr);
+
+            rebuiltInput = std::make_unique<CountingNode> (rebuiltNodeID);
+            rebuiltInputPtr = rebuiltInput.get();
+            player.setNode (createGraph (std::move (sharedNode), std::move (rebuiltInput)), sampleRate, blockSize);
+
+            // The shared Node isn't prepared again and carries on from where it was
+            expectEquals (sharedInputPtr->numTimesPrepared, 1);
+            expectEquals (rebuiltInputPtr->numTimesPrepared, 1);
+
+            processBlocks (1);
+            expectEquals (sharedInputPtr->numSamplesProcessed, 5 * blockSize);
+            expectEquals (rebuiltInputPtr->numSamplesProcessed, blockSize);
+            expectEquals (audio.getSample (0, 0), (float) (4 * blockSize));
+            expectEquals (audio.getSample (0, blockSize - 1), (float) (5 * blockSize - 1) + (float) (blockSize - 1));
+
+            // It can be passed on to later graphs too
+            sharedNode = SharedNode::createFrom (NodeIDIndex (*player.getNode()), sharedNodeID, contentHash);
+            expect (sharedNode != nullptr);
+            player.setNode (createGraph (std::move (sharedNode), std::make_unique<CountingNode> (rebuiltNodeID)), sampleRate, blockSize);
+            processBlocks (1);
+            expectEquals (sharedInputPtr->numTimesPrepared, 1);
+            expectEquals (sharedInputPtr->numSamplesProcessed, 6 * blockSize);
+        }
+
+        beginTest ("Shared subtrees are prepared again for a new sample rate: " + juce::String (numThreads) + " threads");
+        {
+            auto& sharedNode = *NodeIDIndex (*player.getNode()).find<SharedNode> (sharedNodeID);
+            auto& sharedInput = static_cast<CountingNode&> (sharedNode.getInput());
+            expect (sharedNode.isInputPreparedFor (sampleRate, blockSize));
+
+            player.prepareToPlay (sampleRate * 2.0, blockSize);
+            expectEquals (sharedInput.numTimesPrepared, 2);
+            expect (sharedNode.isInputPreparedFor (sampleRate * 2.0, blockSize));
+            expect (! sharedNode.isInputPreparedFor (sampleRate, blockSize));
+        }
+
+        player.clearNode();
+    }
+};
+
+static SharedNodeTests sharedNodeTests;
+
+}
+
+#endif
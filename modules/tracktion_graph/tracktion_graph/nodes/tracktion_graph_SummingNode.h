@@ -138,22 +138,6 @@ private:
     bool useDoublePrecision = false;
     choc::buffer::ChannelArrayBuffer<double> tempDoubleBuffer;
     
-    static void sortByTimestampUnstable (tracktion_engine::MidiMessageArray& messages) noexcept
-    {
-        std::sort (messages.begin(), messages.end(), [] (const juce::MidiMessage& a, const juce::MidiMessage& b)
-        {
-            auto t1 = a.getTimeStamp();
-            auto t2 = b.getTimeStamp();
-
-            if (t1 == t2)
-            {
-                if (a.isNoteOff() && b.isNoteOn()) return true;
-                if (a.isNoteOn() && b.isNoteOff()) return false;
-            }
-            return t1 < t2;
-        });
-    }
-
     //==============================================================================
     void processSinglePrecision (const ProcessContext& pc)
     {
@@ -176,8 +160,9 @@ private:
             pc.buffers.midi.mergeFrom (inputFromNode.midi);
         }
 
+        // Each input is already sorted so this is a stable merge of them
         if (nodesWithMidi > 1)
-            sortByTimestampUnstable (pc.buffers.midi);
+            pc.buffers.midi.sortByTimestamp();
     }
 
     void processDoublePrecision (const ProcessContext& pc)
@@ -208,8 +193,9 @@ private:
         if (numChannels != 0)
             add (pc.buffers.audio.getFirstChannels (numChannels), doubleView);
 
+        // Each input is already sorted so this is a stable merge of them
         if (nodesWithMidi > 1)
-            sortByTimestampUnstable (pc.buffers.midi);
+            pc.buffers.midi.sortByTimestamp();
     }
 
     //==============================================================================
@@ -32,7 +32,29 @@ namespace node_player_utils
         return uniqueEnd == nodeIDs.end();
     }
 
-    /** Prepares a specific Node to be played and returns all the Nodes. */
+    /** Returns the Nodes inside any SharedNodes in the graph that have already been
+        prepared with this sample rate and block size.
+        These are also used by another graph so mustn't be transformed or initialised again.
+    */
+    static inline std::unordered_set<Node*> getPreparedSharedNodes (Node& rootNode, double sampleRate, int blockSize)
+    {
+        std::unordered_set<Node*> sharedNodes;
+
+        visitNodes (rootNode,
+                    [&] (Node& n)
+                    {
+                        if (auto sharedNode = dynamic_cast<SharedNode*> (&n))
+                            if (sharedNode->isInputPreparedFor (sampleRate, blockSize))
+                                for (auto input : getNodes (sharedNode->getInput(), VertexOrdering::postordering))
+                                    sharedNodes.insert (input);
+                    }, false);
+
+        return sharedNodes;
+    }
+
+    /** Prepares a specific Node to be played and returns all the Nodes.
+        Nodes inside SharedNodes that have already been prepared are left as they are.
+    */
     static std::vector<Node*> prepareToPlay (Node* node, Node* oldNode, double sampleRate, int blockSize,
                                              std::function<NodeBuffer (choc::buffer::Size)> allocateAudioBuffer = nullptr,
                                              std::function<void (NodeBuffer&&)> deallocateAudioBuffer = nullptr)
@@ -40,14 +62,27 @@ namespace node_player_utils
         if (node == nullptr)
             return {};
         
+        // Subtrees shared with a previous graph are already prepared and may still be playing
+        const auto sharedNodes = getPreparedSharedNodes (*node, sampleRate, blockSize);
+
         // First give the Nodes a chance to transform
-        transformNodes (*node);
+        transformNodes (*node, sharedNodes);
         
+        // Index the old graph once so each new Node can find its counterpart by nodeID
+        // and take over its state without searching the whole old graph
+        const NodeIDIndex nodesToReplace = oldNode != nullptr ? NodeIDIndex (*oldNode) : NodeIDIndex();
+
         // Next, initialise all the nodes, this will call prepareToPlay on them and also
         // give them a chance to do things like balance latency
         const PlaybackInitialisationInfo info { sampleRate, blockSize, *node, oldNode,
-                                                allocateAudioBuffer, deallocateAudioBuffer };
-        visitNodes (*node, [&] (Node& n) { n.initialise (info); }, false);
+                                                allocateAudioBuffer, deallocateAudioBuffer,
+                                                &nodesToReplace };
+        visitNodes (*node,
+                    [&] (Node& n)
+                    {
+                        if (sharedNodes.count (&n) == 0)
+                            n.initialise (info);
+                    }, false);
         
         // Then find all the nodes as it might have changed after initialisation
         return tracktion_graph::getNodes (*node, tracktion_graph::VertexOrdering::postordering);
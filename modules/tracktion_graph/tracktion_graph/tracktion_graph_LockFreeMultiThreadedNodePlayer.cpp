@@ -19,11 +19,13 @@ namespace tracktion_graph
 LockFreeMultiThreadedNodePlayer::LockFreeMultiThreadedNodePlayer()
 {
     threadPool = getPoolCreatorFunction (ThreadPoolStrategy::realTime) (*this);
+    useWorkStealing = threadPool->usesWorkStealing();
 }
 
 LockFreeMultiThreadedNodePlayer::LockFreeMultiThreadedNodePlayer (ThreadPoolCreator poolCreator)
 {
     threadPool = poolCreator (*this);
+    useWorkStealing = threadPool->usesWorkStealing();
 }
 
 LockFreeMultiThreadedNodePlayer::~LockFreeMultiThreadedNodePlayer()
@@ -79,20 +81,45 @@ int LockFreeMultiThreadedNodePlayer::process (const Node::ProcessContext& pc)
     if (! preparedNode.rootNode)
         return -1;
 
+    const bool isProfiling = profiler.isEnabled();
+    const auto blockStartTime = isProfiling ? NodeProfiler::Clock::now() : NodeProfiler::Clock::time_point();
+
     // Reset the stream range
     referenceSampleRange = pc.referenceSampleRange;
 
-    // Prepare all the nodes to be played back
+    // Prepare all the nodes to be played back, collecting any MIDI they dropped last block
+    int numOverflows = 0;
+
     for (auto node : preparedNode.allNodes)
+    {
+        numOverflows += node->takeNumMidiOverflows();
         node->prepareForNextBlock (referenceSampleRange);
+    }
+
+    if (numOverflows > 0)
+        numMidiOverflows.fetch_add (numOverflows, std::memory_order_relaxed);
+
+    deadlineSeconds.store ((double) referenceSampleRange.getLength() / getSampleRate(), std::memory_order_relaxed);
+
+    // Time the Nodes every few blocks and occasionally re-rank them with the smoothed costs
+    const bool measureCosts = isMeasuringCosts.load (std::memory_order_relaxed);
+    isMeasuringBlock.store (isProfiling || (measureCosts && numBlocksProcessed % blocksPerCostMeasurement == 0),
+                            std::memory_order_relaxed);
+
+    if (measureCosts && numBlocksProcessed % blocksPerPriorityUpdate == 0)
+        updateCostStatistics (updateNodePriorities (preparedNode));
+
+    ++numBlocksProcessed;
 
     // We need to retain the root so we can get the output from it
     preparedNode.rootNode->retain();
 
     if (numThreadsToUse.load (std::memory_order_acquire) == 0 || preparedNode.allNodes.size() == 1)
     {
+        const bool shouldMeasure = isMeasuringBlock.load (std::memory_order_relaxed);
+
         for (auto node : preparedNode.allNodes)
-            node->process (referenceSampleRange);
+            processAndMeasure (*node, referenceSampleRange, profiler, shouldMeasure);
     }
     else
     {
@@ -106,7 +133,7 @@ int LockFreeMultiThreadedNodePlayer::process (const Node::ProcessContext& pc)
             if (preparedNode.rootNode->hasProcessed())
                 break;
 
-            if (! processNextFreeNode())
+            if (! processNextFreeNode (0))
                 threadPool->waitForFinalNode();
         }
     }
@@ -126,6 +153,9 @@ int LockFreeMultiThreadedNodePlayer::process (const Node::ProcessContext& pc)
     // We need to retain the root so we can get the output from it
     preparedNode.rootNode->release();
 
+    if (isProfiling)
+        profiler.addEvent ({ "LockFreeMultiThreadedNodePlayer::process" }, blockStartTime, NodeProfiler::Clock::now());
+
     return -1;
 }
 
@@ -151,6 +181,41 @@ void LockFreeMultiThreadedNodePlayer::clearNode()
     assert (rootNode == nullptr);
 }
 
+LockFreeMultiThreadedNodePlayer::CostStatistics LockFreeMultiThreadedNodePlayer::getCostStatistics() const
+{
+    CostStatistics stats;
+    stats.criticalPathSeconds = criticalPathSeconds.load (std::memory_order_relaxed);
+    stats.totalWorkSeconds = totalWorkSeconds.load (std::memory_order_relaxed);
+    stats.deadlineSeconds = deadlineSeconds.load (std::memory_order_relaxed);
+
+    return stats;
+}
+
+void LockFreeMultiThreadedNodePlayer::enableCostMeasurement (bool shouldMeasure)
+{
+    isMeasuringCosts.store (shouldMeasure, std::memory_order_relaxed);
+}
+
+double LockFreeMultiThreadedNodePlayer::getNodePriority (const Node& node) const
+{
+    for (auto& playbackNode : preparedNode.playbackNodes)
+        if (&playbackNode->node == &node)
+            return playbackNode->priority.load (std::memory_order_relaxed);
+
+    return 0.0;
+}
+
+int LockFreeMultiThreadedNodePlayer::getNumMidiOverflows() const
+{
+    return numMidiOverflows.load (std::memory_order_relaxed);
+}
+
+//==============================================================================
+void LockFreeMultiThreadedNodePlayer::setNodeOwnerFunction (NodeOwnerFunction newFunction)
+{
+    nodeOwnerFunction = std::move (newFunction);
+}
+
 //==============================================================================
 void LockFreeMultiThreadedNodePlayer::enablePooledMemoryAllocations (bool usePool)
 {
@@ -158,6 +223,36 @@ void LockFreeMultiThreadedNodePlayer::enablePooledMemoryAllocations (bool usePoo
         prepareToPlay (sampleRate, blockSize);
 }
 
+//==============================================================================
+void LockFreeMultiThreadedNodePlayer::runTasks (size_t numTasks, ParallelTasks::TaskCallback callback, void* context)
+{
+    std::unique_lock<RealTimeSpinLock> tryLock (clearNodesLock, std::try_to_lock);
+
+    // If the threads are being cleared or there's nothing to share, run the tasks on this thread
+    if (! tryLock.owns_lock() || numTasks < 2 || numThreadsToUse.load (std::memory_order_acquire) == 0)
+    {
+        for (size_t i = 0; i < numTasks; ++i)
+            callback (context, i);
+
+        return;
+    }
+
+    tasks.start (numTasks, callback, context);
+    threadPool->signalAll();
+
+    while (tasks.processNextTask())
+    {}
+
+    // Then wait for any tasks still being run by the other threads
+    while (! tasks.hasFinished())
+        pause();
+}
+
+bool LockFreeMultiThreadedNodePlayer::hasTasksToProcess() const
+{
+    return tasks.hasTasksToProcess();
+}
+
 //==============================================================================
 //==============================================================================
 std::vector<Node*> LockFreeMultiThreadedNodePlayer::prepareToPlay (Node* node, Node* oldNode,
@@ -190,8 +285,16 @@ void LockFreeMultiThreadedNodePlayer::updatePreparedNode()
     isUpdatingPreparedNode = true;
 
     if (auto newPreparedNode = pendingPreparedNode.exchange (nullptr))
+    {
         std::swap (preparedNode, *newPreparedNode);
 
+        // Now the old graph has stopped, point any Nodes it shared with this one at their new PlaybackNodes
+        for (auto& playbackNode : preparedNode.playbackNodes)
+            playbackNode->node.internal = playbackNode.get();
+
+        updateCostStatistics (preparedNode.costs);
+    }
+
     isUpdatingPreparedNode = false;
 }
 
@@ -204,6 +307,9 @@ void LockFreeMultiThreadedNodePlayer::clearThreads()
 void LockFreeMultiThreadedNodePlayer::createThreads()
 {
     threadPool->createThreads (numThreadsToUse.load());
+
+    // The pool's threads plus the thread calling process, with one spare in case that changes
+    profiler.setNumThreads (numThreadsToUse.load() + 2);
 }
 
 inline void LockFreeMultiThreadedNodePlayer::pause()
@@ -226,6 +332,10 @@ void LockFreeMultiThreadedNodePlayer::setNewCurrentNode (std::unique_ptr<Node> n
 
     const bool useAudioBufferPool = useMemoryPool;
     auto currentRoot = preparedNode.rootNode.get();
+
+    // Find these before preparing as the Nodes shared with the current graph won't be prepared again
+    const auto sharedNodes = newRoot != nullptr ? node_player_utils::getPreparedSharedNodes (*newRoot, sampleRateToUse, blockSizeToUse)
+                                                : std::unordered_set<Node*>();
     auto newNodes = prepareToPlay (newRoot.get(), currentRoot,
                                    sampleRateToUse, blockSizeToUse,
                                    useAudioBufferPool ? pendingPreparedNodeStorage.audioBufferPool.get() : nullptr);
@@ -240,8 +350,21 @@ void LockFreeMultiThreadedNodePlayer::setNewCurrentNode (std::unique_ptr<Node> n
     rootNode = newRoot.get();
     pendingPreparedNodeStorage.rootNode = std::move (newRoot);
     pendingPreparedNodeStorage.allNodes = std::move (newNodes);
-    pendingPreparedNodeStorage.nodesReadyToBeProcessed = std::make_unique<LockFreeFifo<Node*>> ((int) pendingPreparedNodeStorage.allNodes.size());
-    buildNodesOutputLists (pendingPreparedNodeStorage);
+    pendingPreparedNodeStorage.nodesReadyToBeProcessed = std::make_unique<PriorityFifo> ((int) pendingPreparedNodeStorage.allNodes.size());
+    pendingPreparedNodeStorage.workerQueues.clear();
+
+    if (useWorkStealing)
+    {
+        // One queue for the audio thread and one for each of the pool's threads
+        for (size_t i = 0; i < numThreadsToUse + 1; ++i)
+            pendingPreparedNodeStorage.workerQueues.push_back (std::make_unique<WorkStealingQueue> (pendingPreparedNodeStorage.allNodes.size()));
+    }
+
+    const auto playbackNodeMap = buildNodesOutputLists (pendingPreparedNodeStorage, sharedNodes);
+    updateNodeProfileInfo (pendingPreparedNodeStorage, playbackNodeMap, nodeOwnerFunction);
+
+    // Rank the Nodes before they're played, these will be refined if their costs are measured
+    pendingPreparedNodeStorage.costs = updateNodePriorities (pendingPreparedNodeStorage);
     
     if (useAudioBufferPool)
     {
@@ -266,10 +389,17 @@ void LockFreeMultiThreadedNodePlayer::setNewCurrentNode (std::unique_ptr<Node> n
 }
 
 //==============================================================================
-void LockFreeMultiThreadedNodePlayer::buildNodesOutputLists (PreparedNode& preparedNode)
+std::unordered_map<Node*, LockFreeMultiThreadedNodePlayer::PlaybackNode*>
+LockFreeMultiThreadedNodePlayer::buildNodesOutputLists (PreparedNode& preparedNode, const std::unordered_set<Node*>& sharedNodes)
 {
     preparedNode.playbackNodes.clear();
     preparedNode.playbackNodes.reserve (preparedNode.allNodes.size());
+    preparedNode.leafNodes.clear();
+
+    // Shared Nodes are still being processed by the current graph so the Nodes aren't
+    // pointed at their PlaybackNodes until this graph is swapped in by updatePreparedNode
+    std::unordered_map<Node*, PlaybackNode*> playbackNodeMap;
+    playbackNodeMap.reserve (preparedNode.allNodes.size());
 
     for (auto n : preparedNode.allNodes)
     {
@@ -281,7 +411,10 @@ void LockFreeMultiThreadedNodePlayer::buildNodesOutputLists (PreparedNode& prepa
         jassert (std::count (preparedNode.allNodes.begin(), preparedNode.allNodes.end(), n) == 1);
 
         preparedNode.playbackNodes.push_back (std::make_unique<PlaybackNode> (*n));
-        n->internal = preparedNode.playbackNodes.back().get();
+        playbackNodeMap[n] = preparedNode.playbackNodes.back().get();
+
+        if (preparedNode.playbackNodes.back()->numInputs == 0)
+            preparedNode.leafNodes.push_back (preparedNode.playbackNodes.back().get());
     }
 
     // Iterate all nodes, for each input, add to the current Nodes output list
@@ -290,11 +423,100 @@ void LockFreeMultiThreadedNodePlayer::buildNodesOutputLists (PreparedNode& prepa
         for (auto inputNode : node->getDirectInputNodes())
         {
             // Check the input is actually still in the graph
-            jassert (std::find (preparedNode.allNodes.begin(), preparedNode.allNodes.end(), inputNode) != preparedNode.allNodes.end());
-            static_cast<PlaybackNode*> (inputNode->internal)->outputs.push_back (node);
-            inputNode->numOutputNodes++;
+            jassert (playbackNodeMap.count (inputNode) > 0);
+            playbackNodeMap[inputNode]->outputs.push_back (playbackNodeMap[node]);
+
+            // Shared Nodes already counted their outputs when they were first prepared
+            if (sharedNodes.count (inputNode) == 0)
+                inputNode->numOutputNodes++;
         }
     }
+
+    return playbackNodeMap;
+}
+
+void LockFreeMultiThreadedNodePlayer::updateNodeProfileInfo (PreparedNode& preparedNode,
+                                                             const std::unordered_map<Node*, PlaybackNode*>& playbackNodeMap,
+                                                             const NodeOwnerFunction& ownerFunction)
+{
+    // allNodes is in topological order so a Node's inputs will already have their owners
+    for (auto node : preparedNode.allNodes)
+    {
+        auto& info = playbackNodeMap.at (node)->profileInfo;
+        info.typeName = typeid (*node).name();
+        info.nodeID = node->getNodeProperties().nodeID;
+        info.ownerID = ownerFunction ? ownerFunction (*node) : 0;
+
+        if (info.ownerID != 0)
+            continue;
+
+        // Otherwise take the owner of the inputs if they all agree
+        bool hasFoundOwner = false;
+
+        for (auto input : node->getDirectInputNodes())
+        {
+            const auto inputOwner = playbackNodeMap.at (input)->profileInfo.ownerID;
+
+            if (inputOwner == 0)
+                continue;
+
+            if (hasFoundOwner && inputOwner != info.ownerID)
+            {
+                info.ownerID = 0;
+                break;
+            }
+
+            info.ownerID = inputOwner;
+            hasFoundOwner = true;
+        }
+    }
+}
+
+LockFreeMultiThreadedNodePlayer::CostStatistics LockFreeMultiThreadedNodePlayer::updateNodePriorities (PreparedNode& preparedNode)
+{
+    // playbackNodes is in topological order so iterating backwards means
+    // all of a Node's outputs will have been updated before it
+    CostStatistics costs;
+
+    for (auto iter = preparedNode.playbackNodes.rbegin(); iter != preparedNode.playbackNodes.rend(); ++iter)
+    {
+        auto& playbackNode = **iter;
+        const double cost = playbackNode.averageCost.load (std::memory_order_relaxed);
+        double longestOutputPath = 0.0;
+
+        for (auto output : playbackNode.outputs)
+            longestOutputPath = std::max (longestOutputPath, output->priority.load (std::memory_order_relaxed));
+
+        const double priority = cost + longestOutputPath;
+        playbackNode.priority.store (priority, std::memory_order_relaxed);
+
+        costs.criticalPathSeconds = std::max (costs.criticalPathSeconds, priority);
+        costs.totalWorkSeconds += cost;
+    }
+
+    // Band the Nodes by their share of the critical path so ready Nodes can be queued in order
+    for (auto& playbackNode : preparedNode.playbackNodes)
+    {
+        const auto proportion = costs.criticalPathSeconds > 0.0 ? playbackNode->priority.load (std::memory_order_relaxed) / costs.criticalPathSeconds
+                                                                : 0.0;
+        playbackNode->priorityLevel.store (std::min (PriorityFifo::numLevels - 1, (size_t) (proportion * PriorityFifo::numLevels)),
+                                           std::memory_order_relaxed);
+    }
+
+    // Queue the leaves with the longest paths first so they get picked up first
+    std::sort (preparedNode.leafNodes.begin(), preparedNode.leafNodes.end(),
+               [] (auto n1, auto n2)
+               {
+                   return n1->priority.load (std::memory_order_relaxed) > n2->priority.load (std::memory_order_relaxed);
+               });
+
+    return costs;
+}
+
+void LockFreeMultiThreadedNodePlayer::updateCostStatistics (const CostStatistics& costs)
+{
+    criticalPathSeconds.store (costs.criticalPathSeconds, std::memory_order_relaxed);
+    totalWorkSeconds.store (costs.totalWorkSeconds, std::memory_order_relaxed);
 }
 
 void LockFreeMultiThreadedNodePlayer::resetProcessQueue()
@@ -310,6 +532,11 @@ void LockFreeMultiThreadedNodePlayer::resetProcessQueue()
 
     numNodesQueued.store (0, std::memory_order_release);
 
+   #if JUCE_DEBUG
+    for (auto& queue : preparedNode.workerQueues)
+        jassert (queue->isEmpty());
+   #endif
+
     // Reset all the counters
     // And then move any Nodes that are ready to the correct queue
     for (auto& playbackNode : preparedNode.playbackNodes)
@@ -341,15 +568,13 @@ void LockFreeMultiThreadedNodePlayer::resetProcessQueue()
     size_t numNodesJustQueued = 0;
 
     // Make sure the counters are reset for all nodes before queueing any
-    for (auto& playbackNode : preparedNode.playbackNodes)
+    for (auto playbackNode : preparedNode.leafNodes)
     {
-        if (playbackNode->numInputsToBeProcessed.load (std::memory_order_acquire) == 0)
-        {
-            jassert (! playbackNode->hasBeenQueued);
-            playbackNode->hasBeenQueued = true;
-            preparedNode.nodesReadyToBeProcessed->try_enqueue (&playbackNode->node);
-            ++numNodesJustQueued;
-        }
+        jassert (playbackNode->numInputsToBeProcessed.load (std::memory_order_acquire) == 0);
+        jassert (! playbackNode->hasBeenQueued);
+        playbackNode->hasBeenQueued = true;
+        queueNode (playbackNode->node, 0);
+        ++numNodesJustQueued;
     }
 
     // Make sure this is only incremented after all the nodes have been queued
@@ -358,14 +583,13 @@ void LockFreeMultiThreadedNodePlayer::resetProcessQueue()
     threadPool->signalAll();
 }
 
-Node* LockFreeMultiThreadedNodePlayer::updateProcessQueueForNode (Node& node)
+Node* LockFreeMultiThreadedNodePlayer::updateProcessQueueForNode (Node& node, size_t workerIndex)
 {
     auto playbackNode = static_cast<PlaybackNode*> (node.internal);
+    PlaybackNode* nodeToContinueWith = nullptr;
 
-    for (auto output : playbackNode->outputs)
+    for (auto outputPlaybackNode : playbackNode->outputs)
     {
-        auto outputPlaybackNode = static_cast<PlaybackNode*> (output->internal);
-
         // fetch_sub returns the previous value so it will now be 0
         if (outputPlaybackNode->numInputsToBeProcessed.fetch_sub (1, std::memory_order_acq_rel) == 1)
         {
@@ -373,42 +597,105 @@ Node* LockFreeMultiThreadedNodePlayer::updateProcessQueueForNode (Node& node)
             jassert (! outputPlaybackNode->hasBeenQueued);
             outputPlaybackNode->hasBeenQueued = true;
 
-            // If there is only one Node or we're at the last Node we can reutrn this to be processed by the same thread
-            if (playbackNode->outputs.size() == 1
-                || output == playbackNode->outputs.back())
-               return &outputPlaybackNode->node;
-            
-            preparedNode.nodesReadyToBeProcessed->try_enqueue (&outputPlaybackNode->node);
+            // Keep the Node with the longest remaining path to be processed by this thread and queue the others
+            if (nodeToContinueWith == nullptr)
+            {
+                nodeToContinueWith = outputPlaybackNode;
+                continue;
+            }
+
+            if (outputPlaybackNode->priority.load (std::memory_order_relaxed) > nodeToContinueWith->priority.load (std::memory_order_relaxed))
+                std::swap (outputPlaybackNode, nodeToContinueWith);
+
+            queueNode (outputPlaybackNode->node, workerIndex);
             numNodesQueued.fetch_add (1, std::memory_order_acq_rel);
             threadPool->signalOne();
         }
     }
 
+    return nodeToContinueWith != nullptr ? &nodeToContinueWith->node : nullptr;
+}
+
+void LockFreeMultiThreadedNodePlayer::queueNode (Node& node, size_t workerIndex)
+{
+    // Workers without their own queue (or when not work-stealing) use the shared fifo
+    if (workerIndex < preparedNode.workerQueues.size())
+        preparedNode.workerQueues[workerIndex]->push (&node);
+    else
+        preparedNode.nodesReadyToBeProcessed->try_enqueue (&node, static_cast<PlaybackNode*> (node.internal)->priorityLevel.load (std::memory_order_relaxed));
+}
+
+Node* LockFreeMultiThreadedNodePlayer::findNodeToProcess (size_t workerIndex)
+{
+    auto& queues = preparedNode.workerQueues;
+    const auto numQueues = queues.size();
+
+    // First take the most recently readied Node from our own queue as its inputs are likely still in cache
+    if (workerIndex < numQueues)
+        if (auto node = queues[workerIndex]->pop())
+            return node;
+
+    // Then try and steal the oldest Node from the other workers, starting with our neighbour
+    if (numQueues > 0)
+    {
+        const size_t firstVictim = workerIndex < numQueues ? workerIndex + 1 : 0;
+
+        for (size_t i = 0; i < numQueues; ++i)
+        {
+            const auto victim = (firstVictim + i) % numQueues;
+
+            if (victim == workerIndex)
+                continue;
+
+            if (auto node = queues[victim]->steal())
+                return node;
+        }
+    }
+
+    // Finally check the shared queue
+    Node* node = nullptr;
+
+    if (preparedNode.nodesReadyToBeProcessed->try_dequeue (node))
+        return node;
+
     return nullptr;
 }
 
 //==============================================================================
-bool LockFreeMultiThreadedNodePlayer::processNextFreeNode()
+bool LockFreeMultiThreadedNodePlayer::processNextFreeNode (size_t workerIndex)
 {
+    if (tasks.processNextTask())
+        return true;
+
     Node* nodeToProcess = nullptr;
 
     if (numNodesQueued.load (std::memory_order_acquire) == 0)
         return false;
 
-    if (! preparedNode.nodesReadyToBeProcessed->try_dequeue (nodeToProcess))
+    if (useWorkStealing)
+    {
+        nodeToProcess = findNodeToProcess (workerIndex);
+
+        if (nodeToProcess == nullptr)
+            return false;
+    }
+    else if (! preparedNode.nodesReadyToBeProcessed->try_dequeue (nodeToProcess))
+    {
         return false;
+    }
 
     numNodesQueued.fetch_sub (1, std::memory_order_acq_rel);
 
     assert (nodeToProcess != nullptr);
-    processNode (*nodeToProcess);
+    processNode (*nodeToProcess, workerIndex);
 
     return true;
 }
 
-void LockFreeMultiThreadedNodePlayer::processNode (Node& node)
+void LockFreeMultiThreadedNodePlayer::processNode (Node& node, size_t workerIndex)
 {
     auto* nodeToProcess = &node;
+    const bool shouldMeasure = isMeasuringBlock.load (std::memory_order_relaxed);
 
     // Attempt to process serial Node chains on this thread
     // to reduce context switches and overhead
@@ -420,12 +707,36 @@ void LockFreeMultiThreadedNodePlayer::processNode (Node& node)
         #endif
 
         // Process Node
-        nodeToProcess->process (referenceSampleRange);
-        nodeToProcess = updateProcessQueueForNode (*nodeToProcess);
+        processAndMeasure (*nodeToProcess, referenceSampleRange, profiler, shouldMeasure);
+        nodeToProcess = updateProcessQueueForNode (*nodeToProcess, workerIndex);
 
         if (! nodeToProcess)
             break;
     }
 }
 
+void LockFreeMultiThreadedNodePlayer::processAndMeasure (Node& node, juce::Range<int64_t> referenceSampleRange,
+                                                         NodeProfiler& profiler, bool shouldMeasure)
+{
+    if (! shouldMeasure)
+    {
+        node.process (referenceSampleRange);
+        return;
+    }
+
+    const auto startTime = NodeProfiler::Clock::now();
+    node.process (referenceSampleRange);
+    const auto endTime = NodeProfiler::Clock::now();
+    const auto elapsed = std::chrono::duration<double> (endTime - startTime).count();
+
+    // Only the thread processing the Node writes to this so a load/store is fine
+    constexpr double smoothing = 0.1;
+    auto playbackNode = static_cast<PlaybackNode*> (node.internal);
+    const auto lastCost = playbackNode->averageCost.load (std::memory_order_relaxed);
+    playbackNode->averageCost.store (lastCost + smoothing * (elapsed - lastCost), std::memory_order_relaxed);
+
+    if (profiler.isEnabled())
+        profiler.addEvent (playbackNode->profileInfo, startTime, endTime);
+}
+
 }
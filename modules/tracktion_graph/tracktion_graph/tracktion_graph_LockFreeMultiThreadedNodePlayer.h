@@ -74,6 +74,12 @@ public:
         */
         virtual void waitForFinalNode() = 0;
 
+        /** Subclasses can return true here if their threads call process (size_t) with
+            their own worker index. The player will then give each worker its own queue
+            of ready Nodes and let idle workers steal from the others.
+        */
+        virtual bool usesWorkStealing() const       { return false; }
+
         //==============================================================================
         /** Signals the pool that all the threads should exit. */
         void signalShouldExit()
@@ -102,7 +108,7 @@ public:
             if (shouldExit())
                 return false;
             
-            return player.numNodesQueued == 0;
+            return player.numNodesQueued == 0 && ! player.hasTasksToProcess();
         }
 
         /** Returns true if all the Nodes have been processed. */
@@ -120,7 +126,17 @@ public:
         */
         bool process()
         {
-            return player.processNextFreeNode();
+            return player.processNextFreeNode (noWorkerIndex);
+        }
+
+        /** Process the next chain of Nodes as a specific worker.
+            Index 0 is reserved for the thread calling LockFreeMultiThreadedNodePlayer::process
+            so pool threads should use 1 to N. Nodes that become ready whilst processing
+            are pushed to this worker's queue to keep them local to this thread's cache.
+        */
+        bool process (size_t workerIndex)
+        {
+            return player.processNextFreeNode (workerIndex);
         }
         
     private:
@@ -181,6 +197,81 @@ public:
         return sampleRate.load (std::memory_order_acquire);
     }
 
+    //==============================================================================
+    /** Describes how much parallelism the current Node has, based on the average
+        time each Node has recently taken to process.
+    */
+    struct CostStatistics
+    {
+        double criticalPathSeconds = 0.0;   /**< The cost of the longest chain of dependant Nodes. */
+        double totalWorkSeconds = 0.0;      /**< The cost of all the Nodes summed. */
+        double deadlineSeconds = 0.0;       /**< The duration of the last block processed. */
+
+        /** Returns the maximum speed-up that could be achieved by adding more threads. */
+        double getParallelism() const       { return criticalPathSeconds > 0.0 ? totalWorkSeconds / criticalPathSeconds : 1.0; }
+    };
+
+    /** Returns the costs from the last time the Nodes were ranked.
+        Ready Nodes are dispatched in order of their remaining critical path so the
+        critical path should be close to the best achievable time for each block.
+    */
+    CostStatistics getCostStatistics() const;
+
+    /** Enables or disables timing the Nodes as they're processed.
+        Nodes are ranked by the number of Nodes between them and the root when they're
+        prepared. Whilst this is enabled, they are timed every few blocks and re-ranked
+        by their smoothed costs at a lower rate. This is enabled by default.
+    */
+    void enableCostMeasurement (bool);
+
+    /** Returns the priority a Node in the current graph is dispatched with. This is its
+        cost plus the cost of the longest chain of Nodes from it to the root.
+        Returns 0 if the Node isn't in the graph being played. This shouldn't be called
+        concurrently with process.
+    */
+    double getNodePriority (const Node&) const;
+
+    /** Returns the total number of MIDI messages the Nodes have dropped because their
+        output buffers were full. This should be zero, if not the MIDI capacity reserved
+        by the Nodes is too small for the events being played.
+    */
+    int getNumMidiOverflows() const;
+
+    //==============================================================================
+    /** Runs a number of independent tasks on the player's threads and the calling thread,
+        returning once they have all finished.
+
+        This can be used to spread work that has to be done before the Nodes are processed
+        over the threads that will process them. The function is called once with each
+        task index from 0 to numTasks - 1, possibly concurrently. It doesn't allocate so
+        is real-time safe but it shouldn't be called concurrently with process.
+        If the player doesn't have any threads the tasks are run on the calling thread.
+    */
+    template<typename TaskFunction>
+    void runTasks (size_t numTasks, TaskFunction&& taskFunction)
+    {
+        using FunctionType = std::remove_reference_t<TaskFunction>;
+
+        runTasks (numTasks,
+                  [] (void* function, size_t taskIndex) { (*static_cast<FunctionType*> (function)) (taskIndex); },
+                  const_cast<void*> (static_cast<const void*> (std::addressof (taskFunction))));
+    }
+
+    //==============================================================================
+    /** Returns the profiler that records the time each Node takes to process.
+        This is disabled by default so call NodeProfiler::setEnabled to start recording.
+    */
+    NodeProfiler& getProfiler()                     { return profiler; }
+
+    /** A function that returns the ID of the object that owns a Node, or 0 if it doesn't know. */
+    using NodeOwnerFunction = std::function<size_t (Node&)>;
+
+    /** Sets a function used to tag the profiled Nodes with the ID of the object that owns them.
+        Nodes without an owner take the owner of their inputs if they all have the same one.
+        This will be used the next time a Node is set.
+    */
+    void setNodeOwnerFunction (NodeOwnerFunction);
+
     //==============================================================================
     /** Enables or disables the use on an AudioBufferPool to reduce memory consumption.
         Don't rely on this, it is a temporary method used for benchmarking and will go
@@ -205,10 +296,133 @@ private:
         std::unique_ptr<farbot::fifo<Type>> fifo;
     };
 
+    //==============================================================================
+    /** A set of fifos, one for each band of priority, so the Nodes with the
+        longest remaining paths are always dequeued first.
+    */
+    class PriorityFifo
+    {
+    public:
+        static constexpr size_t numLevels = 8;
+
+        PriorityFifo (int capacity)
+        {
+            for (size_t i = 0; i < numLevels; ++i)
+                levels.push_back (std::make_unique<LockFreeFifo<Node*>> (capacity));
+        }
+
+        bool try_enqueue (Node* item, size_t level)     { return levels[level]->try_enqueue (std::move (item)); }
+
+        bool try_dequeue (Node*& item)
+        {
+            for (auto level = numLevels; level-- > 0;)
+                if (levels[level]->try_dequeue (item))
+                    return true;
+
+            return false;
+        }
+
+    private:
+        std::vector<std::unique_ptr<LockFreeFifo<Node*>>> levels;
+    };
+
+    //==============================================================================
+    /** A fixed capacity Chase-Lev work-stealing deque.
+        The owning worker pushes and pops Nodes at the bottom (LIFO) whilst other
+        workers steal the oldest Nodes from the top. The indicies are never reset
+        so a stale thief can't succeed in stealing from a re-used slot.
+    */
+    class WorkStealingQueue
+    {
+    public:
+        WorkStealingQueue (size_t capacity)
+            : nodes ((size_t) juce::nextPowerOfTwo ((int) std::max ((size_t) 1, capacity))),
+              mask ((int64_t) nodes.size() - 1)
+        {}
+
+        /** Adds a Node to the bottom of the queue. Only the owner should call this. */
+        void push (Node* node)
+        {
+            const auto b = bottom.load (std::memory_order_relaxed);
+            jassert (b - top.load (std::memory_order_relaxed) <= mask);
+            nodes[(size_t) (b & mask)].store (node, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_release);
+            bottom.store (b + 1, std::memory_order_relaxed);
+        }
+
+        /** Removes the most recently pushed Node. Only the owner should call this. */
+        Node* pop()
+        {
+            const auto b = bottom.load (std::memory_order_relaxed) - 1;
+            bottom.store (b, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+            auto t = top.load (std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                bottom.store (b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            auto node = nodes[(size_t) (b & mask)].load (std::memory_order_relaxed);
+
+            if (t == b)
+            {
+                // Last Node so race any thieves for it
+                if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    node = nullptr;
+
+                bottom.store (b + 1, std::memory_order_relaxed);
+            }
+
+            return node;
+        }
+
+        /** Removes the oldest Node. This can be called from any thread.
+            Returns nullptr if the queue was empty or another thread won the race.
+        */
+        Node* steal()
+        {
+            auto t = top.load (std::memory_order_acquire);
+            std::atomic_thread_fence (std::memory_order_seq_cst);
+            const auto b = bottom.load (std::memory_order_acquire);
+
+            if (t >= b)
+                return nullptr;
+
+            auto node = nodes[(size_t) (t & mask)].load (std::memory_order_relaxed);
+
+            if (! top.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr;
+
+            return node;
+        }
+
+        /** Returns true if the queue is empty. */
+        bool isEmpty() const
+        {
+            return bottom.load (std::memory_order_acquire) <= top.load (std::memory_order_acquire);
+        }
+
+    private:
+        std::vector<std::atomic<Node*>> nodes;
+        const int64_t mask;
+        alignas (64) std::atomic<int64_t> top { 0 };
+        alignas (64) std::atomic<int64_t> bottom { 0 };
+    };
+
     //==============================================================================
     std::atomic<size_t> numThreadsToUse { std::max ((size_t) 0, (size_t) std::thread::hardware_concurrency() - 1) };
     juce::Range<int64_t> referenceSampleRange;
     std::atomic<bool> threadsShouldExit { false }, useMemoryPool { false };
+    std::atomic<bool> isMeasuringCosts { true }, isMeasuringBlock { false };
+    bool useWorkStealing = false;
+    size_t numBlocksProcessed = 0;
+    static constexpr size_t noWorkerIndex = std::numeric_limits<size_t>::max();
+
+    // Timing a Node costs two clock reads so they're only timed every few blocks
+    // and re-ranked at a lower rate still as their smoothed costs change slowly
+    static constexpr size_t blocksPerCostMeasurement = 4, blocksPerPriorityUpdate = 64;
 
     std::unique_ptr<ThreadPool> threadPool;
     
@@ -220,9 +434,15 @@ private:
         
         Node& node;
         const size_t numInputs;
-        std::vector<Node*> outputs;
-        std::atomic<size_t> numInputsToBeProcessed { 0 };
+        std::vector<PlaybackNode*> outputs;
+
+        // Aligned to avoid false sharing between threads decrementing neighbouring Nodes' counts
+        alignas (64) std::atomic<size_t> numInputsToBeProcessed { 0 };
         std::atomic<bool> hasBeenQueued { true };
+        std::atomic<double> averageCost { 1.0e-6 }; // A moving average of process time in seconds, starting at a nominal cost
+        std::atomic<double> priority { 0.0 };       // The averageCost plus the longest path cost to the root
+        std::atomic<size_t> priorityLevel { 0 };    // The PriorityFifo level the Node is queued in
+        NodeProfiler::NodeInfo profileInfo;
        #if JUCE_DEBUG
         std::atomic<bool> hasBeenDequeued { false };
        #endif
@@ -233,8 +453,11 @@ private:
         std::unique_ptr<Node> rootNode;
         std::vector<Node*> allNodes;
         std::vector<std::unique_ptr<PlaybackNode>> playbackNodes;
-        std::unique_ptr<LockFreeFifo<Node*>> nodesReadyToBeProcessed;
+        std::vector<PlaybackNode*> leafNodes;
+        std::unique_ptr<PriorityFifo> nodesReadyToBeProcessed;
+        std::vector<std::unique_ptr<WorkStealingQueue>> workerQueues;
         std::unique_ptr<AudioBufferPool> audioBufferPool;
+        CostStatistics costs;
     };
     
     Node* rootNode = nullptr;
@@ -243,6 +466,11 @@ private:
     std::atomic<bool> isUpdatingPreparedNode { false };
     std::atomic<size_t> numNodesQueued { 0 };
     RealTimeSpinLock clearNodesLock;
+    std::atomic<double> criticalPathSeconds { 0.0 }, totalWorkSeconds { 0.0 }, deadlineSeconds { 0.0 };
+    std::atomic<int> numMidiOverflows { 0 };
+    NodeProfiler profiler;
+    NodeOwnerFunction nodeOwnerFunction;
+    ParallelTasks tasks;
 
     //==============================================================================
     std::atomic<double> sampleRate { 44100.0 };
@@ -266,13 +494,23 @@ private:
     void setNewCurrentNode (std::unique_ptr<Node> newRoot, double sampleRateToUse, int blockSizeToUse);
     
     //==============================================================================
-    static void buildNodesOutputLists (PreparedNode&);
+    static std::unordered_map<Node*, PlaybackNode*> buildNodesOutputLists (PreparedNode&, const std::unordered_set<Node*>& sharedNodes);
+    static void updateNodeProfileInfo (PreparedNode&, const std::unordered_map<Node*, PlaybackNode*>&, const NodeOwnerFunction&);
+    static CostStatistics updateNodePriorities (PreparedNode&);
+    void updateCostStatistics (const CostStatistics&);
     void resetProcessQueue();
-    Node* updateProcessQueueForNode (Node&);
-    void processNode (Node&);
+    Node* updateProcessQueueForNode (Node&, size_t workerIndex);
+    void processNode (Node&, size_t workerIndex);
+    static void processAndMeasure (Node&, juce::Range<int64_t> referenceSampleRange, NodeProfiler&, bool shouldMeasure);
+    void queueNode (Node&, size_t workerIndex);
+    Node* findNodeToProcess (size_t workerIndex);
+
+    //==============================================================================
+    void runTasks (size_t numTasks, ParallelTasks::TaskCallback, void* context);
+    bool hasTasksToProcess() const;
 
     //==============================================================================
-    bool processNextFreeNode();
+    bool processNextFreeNode (size_t workerIndex);
 };
 
 }
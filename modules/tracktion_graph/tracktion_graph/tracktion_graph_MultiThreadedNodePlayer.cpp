@@ -346,6 +346,11 @@ void MultiThreadedNodePlayer::setNewCurrentNode (std::unique_ptr<Node> newRoot,
 
     // Then swap the storage under the lock so the old Node isn't being processed whilst it is deleted
     const std::lock_guard<RealTimeSpinLock> lock (preparedNodeMutex);
+
+    // Nodes shared with the old graph can only be pointed at their new PlaybackNodes once it has stopped
+    for (auto& playbackNode : newPreparedNode->playbackNodes)
+        playbackNode->node.internal = playbackNode.get();
+
     preparedNode = std::move (newPreparedNode);
 }
 
@@ -356,6 +361,9 @@ void MultiThreadedNodePlayer::buildNodesOutputLists (std::vector<Node*>& allNode
     playbackNodes.clear();
     playbackNodes.reserve (allNodes.size());
 
+    std::unordered_map<Node*, PlaybackNode*> playbackNodeMap;
+    playbackNodeMap.reserve (allNodes.size());
+
     // Create a PlaybackNode for each Node
     for (auto n : allNodes)
     {
@@ -368,7 +376,7 @@ void MultiThreadedNodePlayer::buildNodesOutputLists (std::vector<Node*>& allNode
         jassert (std::count (allNodes.begin(), allNodes.end(), n) == 1);
 
         playbackNodes.push_back (std::make_unique<PlaybackNode> (*n));
-        n->internal = playbackNodes.back().get();
+        playbackNodeMap[n] = playbackNodes.back().get();
     }
 
     // Iterate all Nodes, for each input, add to the current Nodes output list
@@ -377,8 +385,8 @@ void MultiThreadedNodePlayer::buildNodesOutputLists (std::vector<Node*>& allNode
         for (auto inputNode : node->getDirectInputNodes())
         {
             // Check the input is actually still in the graph
-            jassert (std::find (allNodes.begin(), allNodes.end(), inputNode) != allNodes.end());
-            static_cast<PlaybackNode*> (inputNode->internal)->outputs.push_back (node);
+            jassert (playbackNodeMap.count (inputNode) > 0);
+            playbackNodeMap[inputNode]->outputs.push_back (node);
         }
     }
 }
@@ -95,6 +95,54 @@ struct NodeBuffer
     choc::buffer::ChannelArrayBuffer<float> data;
 };
 
+//==============================================================================
+/** Holds the Nodes of a graph keyed by their nodeIDs.
+    Players build one of these for the graph being replaced so that Nodes in the new
+    graph can find the Node they are taking over from without visiting the whole old graph.
+    Graph builders can also use one to find SharedNodes to reuse.
+*/
+class NodeIDIndex
+{
+public:
+    /** Creates an empty index. */
+    NodeIDIndex() = default;
+
+    /** Creates an index of all the Nodes in a graph that have a non-zero nodeID. */
+    explicit NodeIDIndex (Node& rootNode);
+
+    /** Returns the first Node of the given type with this nodeID for which the predicate
+        returns true, or nullptr if there isn't one.
+    */
+    template<typename NodeType, typename Predicate>
+    NodeType* find (size_t nodeID, Predicate&& predicate) const
+    {
+        if (nodeID == 0)
+            return nullptr;
+
+        auto range = nodes.equal_range (nodeID);
+
+        for (auto iter = range.first; iter != range.second; ++iter)
+            if (auto node = dynamic_cast<NodeType*> (iter->second))
+                if (predicate (*node))
+                    return node;
+
+        return nullptr;
+    }
+
+    /** Returns the first Node of the given type with this nodeID or nullptr if there isn't one. */
+    template<typename NodeType>
+    NodeType* find (size_t nodeID) const
+    {
+        return find<NodeType> (nodeID, [] (NodeType&) { return true; });
+    }
+
+    /** Returns the number of Nodes in the index. */
+    size_t size() const     { return nodes.size(); }
+
+private:
+    std::unordered_multimap<size_t, Node*> nodes;
+};
+
 //==============================================================================
 /** Passed into Nodes when they are being initialised, to give them useful
     contextual information that they may need
@@ -107,6 +155,12 @@ struct PlaybackInitialisationInfo
     Node* rootNodeToReplace = nullptr;
     std::function<NodeBuffer (choc::buffer::Size)> allocateAudioBuffer = nullptr;
     std::function<void (NodeBuffer&&)> deallocateAudioBuffer = nullptr;
+
+    /** The Nodes of the graph being replaced, keyed by nodeID.
+        Use this rather than visiting rootNodeToReplace to find a Node's previous
+        counterpart so that rebuilding large graphs stays linear.
+    */
+    const NodeIDIndex* nodesToReplace = nullptr;
 };
 
 /** Holds some really basic properties of a node */
@@ -189,6 +243,18 @@ public:
     */
     AudioAndMidiBuffer getProcessedOutput();
 
+    /** Returns the number of MIDI messages dropped because the output buffer was full,
+        and resets the count. Players call this between blocks to report the total.
+    */
+    int takeNumMidiOverflows() noexcept;
+
+    /** Returns the number of MIDI messages to reserve for this Node's output.
+        This is enough for an event per sample or for everything the direct inputs
+        can hold, whichever is larger, so merging inputs won't overflow unless they do.
+        Inputs are initialised before their outputs so this can be used in prepareToPlay.
+    */
+    int getMidiCapacityForInputs (int blockSize);
+
     //==============================================================================
     /** Called after construction to give the node a chance to modify its topology.
         This should return true if any changes were made to the topology as this
@@ -320,8 +386,10 @@ static inline std::vector<Node*> getNodes (Node&, VertexOrdering);
     Call this once after construction and it will call the Node::transform() method
     repeatedly for Node until they all return false indicating no topological
     changes have been made.
+    Any nodesToSkip, e.g. those shared with a graph that's already been prepared,
+    won't be transformed.
 */
-static inline void transformNodes (Node& rootNode)
+static inline void transformNodes (Node& rootNode, const std::unordered_set<Node*>& nodesToSkip = {})
 {
     for (;;)
     {
@@ -330,7 +398,7 @@ static inline void transformNodes (Node& rootNode)
         auto allNodes = getNodes (rootNode, VertexOrdering::postordering);
 
         for (auto node : allNodes)
-            if (node->transform (rootNode))
+            if (nodesToSkip.count (node) == 0 && node->transform (rootNode))
                 needToTransformAgain = true;
 
         if (! needToTransformAgain)
@@ -358,6 +426,10 @@ inline void Node::initialise (const PlaybackInitialisationInfo& info)
     {
         audioBuffer.resize (audioBufferSize);
     }
+
+    // Reserve enough MIDI for everything the inputs can pass on so busy blocks don't allocate
+    if (props.hasMidi)
+        midiBuffer.setFixedCapacity (getMidiCapacityForInputs (info.blockSize));
     
     directInputNodes = getDirectInputNodes();
 }
@@ -463,10 +535,29 @@ inline Node::AudioAndMidiBuffer Node::getProcessedOutput()
              midiBuffer };
 }
 
+inline int Node::takeNumMidiOverflows() noexcept
+{
+    const auto numOverflows = midiBuffer.getNumOverflows();
+    midiBuffer.resetNumOverflows();
+    return numOverflows;
+}
+
+inline int Node::getMidiCapacityForInputs (int blockSize)
+{
+    using tracktion_engine::MidiMessageArray;
+    int inputCapacity = 0;
+
+    for (auto input : getDirectInputNodes())
+        inputCapacity += std::max (0, input->midiBuffer.getFixedCapacity());
+
+    return std::min (std::max (MidiMessageArray::getFixedCapacityForNumSamples (blockSize), inputCapacity),
+                     MidiMessageArray::maxFixedCapacity);
+}
+
 inline size_t Node::getAllocatedBytes() const
 {
     return audioBuffer.getView().data.getBytesNeeded (audioBuffer.getSize())
-        + (size_t (midiBuffer.size()) * sizeof (tracktion_engine::MidiMessageArray::MidiMessageWithSource));
+        + (size_t (std::max (midiBuffer.size(), midiBuffer.getFixedCapacity())) * sizeof (tracktion_engine::MidiMessageArray::MidiMessageWithSource));
 }
 
 inline void Node::setOptimisations (NodeOptimisations newOptimisations)
@@ -512,22 +603,36 @@ namespace detail
         template<typename Visitor>
         static void visit (std::vector<Node*>& visitedNodes, Node& visitingNode, Visitor&& visitor, bool preordering)
         {
-            if (std::find (visitedNodes.begin(), visitedNodes.end(), &visitingNode) != visitedNodes.end())
+            std::unordered_set<Node*> visitedSet;
+            visit (visitedNodes, visitedSet, visitingNode, visitor, preordering);
+        }
+
+        template<typename Visitor>
+        static void visit (std::vector<Node*>& visitedNodes, std::unordered_set<Node*>& visitedSet,
+                           Node& visitingNode, Visitor&& visitor, bool preordering)
+        {
+            // The set keeps the visited check constant time, the vector keeps the order
+            if (visitedSet.count (&visitingNode) > 0)
                 return;
-            
+
             if (preordering)
             {
+                visitedSet.insert (&visitingNode);
                 visitedNodes.push_back (&visitingNode);
                 visitor (visitingNode);
             }
 
             for (auto n : visitingNode.getDirectInputNodes())
-                visit  (visitedNodes, *n, visitor, preordering);
+                visit  (visitedNodes, visitedSet, *n, visitor, preordering);
 
             if (! preordering)
             {
-                visitedNodes.push_back (&visitingNode);
-                visitor (visitingNode);
+                // A Node can't be an input of itself so it's safe to only mark it as visited here
+                if (visitedSet.insert (&visitingNode).second)
+                {
+                    visitedNodes.push_back (&visitingNode);
+                    visitor (visitingNode);
+                }
             }
         }
     };
@@ -602,4 +707,16 @@ inline std::vector<Node*> getNodes (Node& node, VertexOrdering vertexOrdering)
     return visitedNodes;
 }
 
+//==============================================================================
+inline NodeIDIndex::NodeIDIndex (Node& rootNode)
+{
+    for (auto node : getNodes (rootNode, VertexOrdering::preordering))
+    {
+        const auto nodeID = node->getNodeProperties().nodeID;
+
+        if (nodeID != 0)
+            nodes.emplace (nodeID, node);
+    }
+}
+
 }
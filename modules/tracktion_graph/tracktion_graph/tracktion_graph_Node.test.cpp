@@ -52,6 +52,9 @@ public:
             runRebuildTests (setup);
             runCycleTests (setup);
         }
+
+        runTaskTests();
+        runPriorityTests();
     }
 
 private:
@@ -665,6 +668,113 @@ private:
             expectAudioBuffer (*this, testContext->buffer, 0, 1.0f, 0.707f);
         }
     }
+
+    void runTaskTests()
+    {
+        for (auto strategy : getThreadPoolStrategies())
+        {
+            beginTest ("Tasks: " + getName (strategy));
+
+            LockFreeMultiThreadedNodePlayer player (getPoolCreatorFunction (strategy));
+            player.setNumThreads (0);
+            player.setNumThreads (4);
+
+            std::vector<std::atomic<int>> numTimesRun (100);
+
+            for (int batch = 0; batch < 100; ++batch)
+            {
+                const auto numTasks = (size_t) (batch % 2 == 0 ? 100 : 7);
+
+                player.runTasks (numTasks, [&numTimesRun] (size_t taskIndex)
+                                 {
+                                     numTimesRun[taskIndex].fetch_add (1);
+                                 });
+            }
+
+            // Even batches run all 100 tasks and odd batches only the first 7
+            for (size_t i = 0; i < numTimesRun.size(); ++i)
+                expectEquals (numTimesRun[i].load(), i < 7 ? 100 : 50);
+        }
+    }
+
+    void runPriorityTests()
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr int blockSize = 256;
+
+        // sinA -> gainA1 -> gainA2 -> sum
+        //                     sinB -> sum
+        auto sinA = makeNode<SinNode> (220.0f);
+        auto sinB = makeNode<SinNode> (440.0f);
+        auto sinAPtr = sinA.get();
+        auto sinBPtr = sinB.get();
+
+        auto gainA1 = makeGainNode (std::move (sinA), 0.5f);
+        auto gainA1Ptr = gainA1.get();
+        auto gainA2 = makeGainNode (std::move (gainA1), 0.5f);
+        auto gainA2Ptr = gainA2.get();
+
+        std::vector<std::unique_ptr<Node>> inputs;
+        inputs.push_back (std::move (gainA2));
+        inputs.push_back (std::move (sinB));
+        auto sum = makeNode<BasicSummingNode> (std::move (inputs));
+        auto sumPtr = sum.get();
+
+        LockFreeMultiThreadedNodePlayer player;
+        player.setNumThreads (2);
+        player.enableCostMeasurement (false);
+        player.setNode (std::move (sum), sampleRate, blockSize);
+
+        choc::buffer::ChannelArrayBuffer<float> audio (1, (choc::buffer::FrameCount) blockSize);
+        tracktion_engine::MidiMessageArray midi;
+        int64_t referenceSamplePosition = 0;
+
+        auto processBlocks = [&] (int numBlocks)
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                player.process ({ juce::Range<int64_t>::withStartAndLength (referenceSamplePosition, blockSize),
+                                  { audio.getView(), midi } });
+                referenceSamplePosition += blockSize;
+            }
+        };
+
+        beginTest ("Critical path priorities");
+        {
+            // Unmeasured Nodes all have the same cost so are ranked by their distance from the root
+            processBlocks (200);
+            const auto rootPriority = player.getNodePriority (*sumPtr);
+            expect (rootPriority > 0.0);
+
+            expectWithinAbsoluteError (player.getNodePriority (*gainA2Ptr) / rootPriority, 2.0, 1.0e-9);
+            expectWithinAbsoluteError (player.getNodePriority (*gainA1Ptr) / rootPriority, 3.0, 1.0e-9);
+            expectWithinAbsoluteError (player.getNodePriority (*sinAPtr) / rootPriority, 4.0, 1.0e-9);
+            expectWithinAbsoluteError (player.getNodePriority (*sinBPtr) / rootPriority, 2.0, 1.0e-9);
+
+            const auto costs = player.getCostStatistics();
+            expectWithinAbsoluteError (costs.criticalPathSeconds / rootPriority, 4.0, 1.0e-9);
+            expectWithinAbsoluteError (costs.totalWorkSeconds / rootPriority, 5.0, 1.0e-9);
+            expectWithinAbsoluteError (costs.getParallelism(), 1.25, 1.0e-9);
+        }
+
+        beginTest ("Measured critical path priorities");
+        {
+            // Once measured, each Node still ranks above the Nodes on its path to the root
+            player.enableCostMeasurement (true);
+            processBlocks (200);
+
+            expect (player.getNodePriority (*sinAPtr) > player.getNodePriority (*gainA1Ptr));
+            expect (player.getNodePriority (*gainA1Ptr) > player.getNodePriority (*gainA2Ptr));
+            expect (player.getNodePriority (*gainA2Ptr) > player.getNodePriority (*sumPtr));
+            expect (player.getNodePriority (*sinBPtr) > player.getNodePriority (*sumPtr));
+
+            const auto costs = player.getCostStatistics();
+            expectWithinAbsoluteError (costs.criticalPathSeconds, std::max (player.getNodePriority (*sinAPtr), player.getNodePriority (*sinBPtr)), 1.0e-12);
+            expect (costs.totalWorkSeconds >= costs.criticalPathSeconds);
+        }
+
+        player.clearNode();
+    }
 };
 
 static NodeTests nodeTests;
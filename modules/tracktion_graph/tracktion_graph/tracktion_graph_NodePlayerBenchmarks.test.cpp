@@ -0,0 +1,95 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#if TRACKTION_GRAPH_PERFORMANCE_TESTS
+
+namespace tracktion_graph
+{
+
+using namespace test_utilities;
+
+//==============================================================================
+//==============================================================================
+class NodePlayerBenchmarks : public juce::UnitTest
+{
+public:
+    NodePlayerBenchmarks()
+        : juce::UnitTest ("NodePlayer Benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        TestSetup ts;
+        ts.sampleRate = 96000.0;
+        ts.blockSize = 128;
+
+        // Wide and shallow, narrow and deep and somewhere in between
+        const std::pair<int, int> shapes[] = { { 256, 1 }, { 64, 8 }, { 8, 64 }, { 2, 256 } };
+
+        for (auto shape : shapes)
+            for (size_t numThreads : { 2, 4, 8, 16, 32 })
+                for (auto strategy : { ThreadPoolStrategy::lightweightSemHybrid, ThreadPoolStrategy::workStealing })
+                    runGraphShapeTest (ts, shape.first, shape.second, numThreads, strategy);
+    }
+
+private:
+    /** Creates a number of parallel chains of GainNodes fed by SinNodes and then sums them. */
+    static std::unique_ptr<Node> createGraph (int width, int depth)
+    {
+        std::vector<std::unique_ptr<Node>> chains;
+
+        for (int i = 0; i < width; ++i)
+        {
+            std::unique_ptr<Node> node = std::make_unique<SinNode> (220.0f, 2);
+
+            for (int j = 0; j < depth; ++j)
+                node = std::make_unique<GainNode> (std::move (node), [] { return 0.99f; });
+
+            chains.push_back (std::move (node));
+        }
+
+        return std::make_unique<BasicSummingNode> (std::move (chains));
+    }
+
+    void runGraphShapeTest (TestSetup ts, int width, int depth, size_t numThreads, ThreadPoolStrategy strategy)
+    {
+        const auto description = juce::String ("width: ") + juce::String (width) + ", depth: " + juce::String (depth)
+                                    + ", threads: " + juce::String ((int) numThreads) + ", " + getName (strategy);
+
+        beginTest ("Graph shape - " + description);
+
+        auto player = std::make_unique<LockFreeMultiThreadedNodePlayer> (getPoolCreatorFunction (strategy));
+        player->setNumThreads (numThreads);
+        player->setNode (createGraph (width, depth), ts.sampleRate, ts.blockSize);
+
+        TestProcess<LockFreeMultiThreadedNodePlayer> testContext (std::move (player), ts, 2, 10.0, false);
+
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+        testContext.processAll();
+        const auto elapsedMs = juce::Time::getMillisecondCounterHiRes() - startTime;
+
+        std::cout << description << ": " << juce::String (elapsedMs, 2) << "ms\n";
+        std::cout << testContext.getStatisticsAndReset().toString() << "\n";
+
+        const auto costs = testContext.getNodePlayer().getCostStatistics();
+        std::cout << "Critical path: " << juce::String (costs.criticalPathSeconds * 1000.0, 3) << "ms"
+                  << ", total work: " << juce::String (costs.totalWorkSeconds * 1000.0, 3) << "ms"
+                  << ", deadline: " << juce::String (costs.deadlineSeconds * 1000.0, 3) << "ms"
+                  << ", parallelism: " << juce::String (costs.getParallelism(), 2) << "\n";
+        expect (true);
+    }
+};
+
+static NodePlayerBenchmarks nodePlayerBenchmarks;
+
+}
+
+#endif //TRACKTION_GRAPH_PERFORMANCE_TESTS
@@ -591,6 +591,133 @@ private:
         }
     }
 };
+
+
+//==============================================================================
+//==============================================================================
+/**
+    Uses the same spin/yield/semaphore waiting as ThreadPoolSemHybrid but gives
+    each thread its own worker index so the player can use per-thread work-stealing
+    queues rather than a single shared queue.
+*/
+struct ThreadPoolWorkStealing : public LockFreeMultiThreadedNodePlayer::ThreadPool
+{
+    ThreadPoolWorkStealing (LockFreeMultiThreadedNodePlayer& p)
+        : ThreadPool (p)
+    {
+    }
+
+    bool usesWorkStealing() const override
+    {
+        return true;
+    }
+
+    void createThreads (size_t numThreads) override
+    {
+        if (threads.size() == numThreads)
+            return;
+
+        resetExitSignal();
+        semaphore = std::make_unique<LightweightSemaphore> ((int) numThreads);
+
+        for (size_t i = 0; i < numThreads; ++i)
+        {
+            // Worker 0 is the audio thread so pool threads start from 1
+            threads.emplace_back ([this, workerIndex = i + 1] { runThread (workerIndex); });
+            setThreadPriority (threads.back(), 10);
+        }
+    }
+
+    void clearThreads() override
+    {
+        signalShouldExit();
+
+        for (auto& t : threads)
+            t.join();
+
+        threads.clear();
+        semaphore.reset();
+    }
+
+    void signalOne() override
+    {
+        if (semaphore) semaphore->signal();
+    }
+
+    void signalAll() override
+    {
+        if (semaphore) semaphore->signal ((int) threads.size());
+    }
+
+    void wait()
+    {
+        thread_local int pauseCount = 0;
+
+        if (shouldExit())
+            return;
+
+        if (shouldWait())
+        {
+            ++pauseCount;
+
+            if (pauseCount < 25)
+            {
+                pause();
+            }
+            else if (pauseCount < 50)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                pauseCount = 0;
+
+                // Fall back to locking
+                if (timeOutMilliseconds < 0)
+                {
+                    semaphore->wait();
+                }
+                else
+                {
+                    using namespace std::chrono;
+                    semaphore->timed_wait ((std::uint64_t) duration_cast<microseconds> (milliseconds (timeOutMilliseconds)).count());
+                }
+            }
+        }
+        else
+        {
+            pauseCount = 0;
+        }
+    }
+
+    void waitForFinalNode() override
+    {
+        if (isFinalNodeReady())
+            return;
+
+        if (! shouldWait())
+            return;
+
+        pause();
+    }
+
+private:
+    std::vector<std::thread> threads;
+    std::unique_ptr<LightweightSemaphore> semaphore;
+
+    void runThread (size_t workerIndex)
+    {
+        for (;;)
+        {
+            if (shouldExit())
+                return;
+
+            if (! process (workerIndex))
+                wait();
+        }
+    }
+};
+
 //==============================================================================
 //==============================================================================
 LockFreeMultiThreadedNodePlayer::ThreadPoolCreator getPoolCreatorFunction (ThreadPoolStrategy poolType)
@@ -607,6 +734,8 @@ LockFreeMultiThreadedNodePlayer::ThreadPoolCreator getPoolCreatorFunction (Threa
             return [] (LockFreeMultiThreadedNodePlayer& p) { return std::make_unique<ThreadPoolSem<LightweightSemaphore>> (p); };
         case ThreadPoolStrategy::lightweightSemHybrid:
             return [] (LockFreeMultiThreadedNodePlayer& p) { return std::make_unique<ThreadPoolSemHybrid<LightweightSemaphore>> (p); };
+        case ThreadPoolStrategy::workStealing:
+            return [] (LockFreeMultiThreadedNodePlayer& p) { return std::make_unique<ThreadPoolWorkStealing> (p); };
         case ThreadPoolStrategy::realTime:
         default:
             return [] (LockFreeMultiThreadedNodePlayer& p) { return std::make_unique<ThreadPoolRT> (p); };
@@ -614,6 +743,174 @@ LockFreeMultiThreadedNodePlayer::ThreadPoolCreator getPoolCreatorFunction (Threa
 }
 
 
+//==============================================================================
+//==============================================================================
+/** Forwards a player's signals to the shared pool and adds it to the pool's
+    list of players whilst it has threads.
+*/
+struct SharedNodePlayerThreadPool::PlayerThreadPool : public LockFreeMultiThreadedNodePlayer::ThreadPool
+{
+    PlayerThreadPool (LockFreeMultiThreadedNodePlayer& p, SharedNodePlayerThreadPool& o)
+        : ThreadPool (p), owner (o)
+    {
+    }
+
+    ~PlayerThreadPool() override
+    {
+        owner.removePlayer (*this);
+    }
+
+    void createThreads (size_t numThreads) override
+    {
+        resetExitSignal();
+
+        if (numThreads > 0)
+            owner.addPlayer (*this);
+        else
+            owner.removePlayer (*this);
+    }
+
+    void clearThreads() override
+    {
+        signalShouldExit();
+        owner.removePlayer (*this);
+    }
+
+    void signalOne() override
+    {
+        owner.signal (1);
+    }
+
+    void signalAll() override
+    {
+        owner.signal ((int) owner.getNumThreads());
+    }
+
+    void waitForFinalNode() override
+    {
+        pause();
+    }
+
+    SharedNodePlayerThreadPool& owner;
+};
+
+//==============================================================================
+SharedNodePlayerThreadPool::SharedNodePlayerThreadPool (size_t numThreads)
+{
+    for (size_t i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back ([this] { runThread(); });
+        setThreadPriority (threads.back(), 10);
+    }
+}
+
+SharedNodePlayerThreadPool::~SharedNodePlayerThreadPool()
+{
+    jassert (players.empty());
+
+    threadsShouldExit.store (true, std::memory_order_release);
+    signal ((int) threads.size());
+
+    for (auto& t : threads)
+        t.join();
+}
+
+LockFreeMultiThreadedNodePlayer::ThreadPoolCreator SharedNodePlayerThreadPool::getPoolCreatorFunction()
+{
+    return [this] (LockFreeMultiThreadedNodePlayer& p) { return std::make_unique<PlayerThreadPool> (p, *this); };
+}
+
+void SharedNodePlayerThreadPool::addPlayer (PlayerThreadPool& player)
+{
+    std::unique_lock<std::shared_mutex> lock (playersMutex);
+
+    if (std::find (players.begin(), players.end(), &player) == players.end())
+        players.push_back (&player);
+}
+
+void SharedNodePlayerThreadPool::removePlayer (PlayerThreadPool& player)
+{
+    std::unique_lock<std::shared_mutex> lock (playersMutex);
+    players.erase (std::remove (players.begin(), players.end(), &player), players.end());
+}
+
+void SharedNodePlayerThreadPool::signal (int numThreadsToWake)
+{
+    if (numThreadsToWake > 0)
+        semaphore.signal (numThreadsToWake);
+}
+
+void SharedNodePlayerThreadPool::runTasks (size_t numTasks, ParallelTasks::TaskCallback callback, void* context)
+{
+    if (numTasks < 2 || threads.empty())
+    {
+        for (size_t i = 0; i < numTasks; ++i)
+            callback (context, i);
+
+        return;
+    }
+
+    tasks.start (numTasks, callback, context);
+    signal ((int) std::min (numTasks - 1, threads.size()));
+
+    while (tasks.processNextTask())
+    {}
+
+    // Help with the other tasks' Nodes until they've finished. This never blocks
+    // so the calling thread can be the audio thread
+    while (! tasks.hasFinished())
+        if (! processNextNode (false))
+            pause();
+}
+
+bool SharedNodePlayerThreadPool::processNextNode (bool canBlock)
+{
+    std::shared_lock<std::shared_mutex> lock (playersMutex, std::defer_lock);
+
+    if (canBlock)
+        lock.lock();
+    else if (! lock.try_lock())
+        return false;
+
+    for (auto player : players)
+        if (player->process())
+            return true;
+
+    return false;
+}
+
+void SharedNodePlayerThreadPool::runThread()
+{
+    int pauseCount = 0;
+
+    while (! threadsShouldExit.load (std::memory_order_acquire))
+    {
+        if (tasks.processNextTask() || processNextNode (true))
+        {
+            pauseCount = 0;
+            continue;
+        }
+
+        ++pauseCount;
+
+        if (pauseCount < 25)
+        {
+            pause();
+        }
+        else if (pauseCount < 50)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            // Fall back to waiting for a player or task to signal
+            pauseCount = 0;
+            semaphore.wait();
+        }
+    }
+}
+
+
 #ifdef _MSC_VER
  #pragma warning (pop)
 #endif
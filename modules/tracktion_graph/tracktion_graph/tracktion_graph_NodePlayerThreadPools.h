@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <shared_mutex>
 
 namespace tracktion_graph
 {
@@ -27,10 +28,76 @@ enum class ThreadPoolStrategy
     hybrid,                 /**< Uses a combination of the above, avoiding CVs on the audio thread. */
     semaphore,              /**< Uses a semaphore to suspend threads. */
     lightweightSemaphore,   /**< Uses a semaphore/spin mechanism to suspend threads.*/
-    lightweightSemHybrid    /**< Uses a combination of semaphores/spin and yields to suspend threads.*/
+    lightweightSemHybrid,   /**< Uses a combination of semaphores/spin and yields to suspend threads.*/
+    workStealing            /**< As lightweightSemHybrid but with per-thread queues that idle threads can steal from. */
 };
 
 /** Returns a function to create a ThreadPool for the given stategy. */
 LockFreeMultiThreadedNodePlayer::ThreadPoolCreator getPoolCreatorFunction (ThreadPoolStrategy);
 
+
+//==============================================================================
+//==============================================================================
+/**
+    A pool of threads that can be shared by a number of LockFreeMultiThreadedNodePlayers.
+
+    Rather than each player creating its own threads, which oversubscribes the CPU
+    when several are processing at once, players created with getPoolCreatorFunction()
+    have their Nodes processed by these threads. The pool can also run tasks such as
+    processing each of the players concurrently.
+*/
+class SharedNodePlayerThreadPool
+{
+public:
+    /** Creates a pool with a number of threads. */
+    SharedNodePlayerThreadPool (size_t numThreads);
+
+    /** Destructor. Any players using this pool must be deleted first. */
+    ~SharedNodePlayerThreadPool();
+
+    /** Returns the number of threads in the pool. */
+    size_t getNumThreads() const                { return threads.size(); }
+
+    /** Returns a function to create ThreadPools for players that should use these threads. */
+    LockFreeMultiThreadedNodePlayer::ThreadPoolCreator getPoolCreatorFunction();
+
+    /** Runs a number of independent tasks on the pool's threads and the calling thread,
+        returning once they have all finished.
+        Whilst other threads finish their tasks, the calling thread helps process any
+        Nodes that are ready. This doesn't allocate so can be called from the audio thread
+        but only one thread should call it at once.
+    */
+    template<typename TaskFunction>
+    void runTasks (size_t numTasks, TaskFunction&& taskFunction)
+    {
+        using FunctionType = std::remove_reference_t<TaskFunction>;
+
+        runTasks (numTasks,
+                  [] (void* function, size_t taskIndex) { (*static_cast<FunctionType*> (function)) (taskIndex); },
+                  const_cast<void*> (static_cast<const void*> (std::addressof (taskFunction))));
+    }
+
+private:
+    //==============================================================================
+    struct PlayerThreadPool;
+
+    std::vector<std::thread> threads;
+    std::atomic<bool> threadsShouldExit { false };
+    LightweightSemaphore semaphore;
+    ParallelTasks tasks;
+
+    // Players are only added or removed whilst holding the exclusive lock
+    // so a removed player's Nodes can't still be being processed
+    std::shared_mutex playersMutex;
+    std::vector<PlayerThreadPool*> players;
+
+    void addPlayer (PlayerThreadPool&);
+    void removePlayer (PlayerThreadPool&);
+    void signal (int numThreadsToWake);
+
+    void runTasks (size_t numTasks, ParallelTasks::TaskCallback, void* context);
+    bool processNextNode (bool canBlock);
+    void runThread();
+};
+
 }
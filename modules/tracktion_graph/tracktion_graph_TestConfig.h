@@ -15,8 +15,10 @@
 #define GRAPH_UNIT_TESTS_NODEVISITING      1
 #define GRAPH_UNIT_TESTS_SAMPLECONVERSION  1
 #define GRAPH_UNIT_TESTS_CONNECTEDNODE     1
+#define GRAPH_UNIT_TESTS_SHAREDNODE        1
 
 #define GRAPH_UNIT_TESTS_AUDIOBUFFERPOOL   1
+#define GRAPH_UNIT_TESTS_NODEPROFILER      1
 #define GRAPH_UNIT_TESTS_SEMAPHORE         1
 #define GRAPH_UNIT_TESTS_ALLOCATION        1
 
@@ -25,3 +27,5 @@
 #define GRAPH_UNIT_TESTS_MIDINODE          1
 #define GRAPH_UNIT_TESTS_RACKNODE          1
 #define GRAPH_UNIT_TESTS_EDITNODE          1
+#define GRAPH_UNIT_TESTS_TIMESTRETCHINGWAVENODE 1
+#define GRAPH_UNIT_TESTS_NODERENDERCONTEXT 1
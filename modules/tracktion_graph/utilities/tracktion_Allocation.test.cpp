@@ -11,6 +11,46 @@
 #include "../../3rd_party/rpmalloc/rpallocator.h"
 
 
+#if GRAPH_UNIT_TESTS_ALLOCATION && GRAPH_UNIT_TESTS_COUNT_ALLOCATIONS
+namespace tracktion_graph
+{
+    /** Counts the allocations made on the calling thread whilst it's in scope. */
+    struct ScopedAllocationCounter
+    {
+        ScopedAllocationCounter()       { getCounter() = &numAllocations; }
+        ~ScopedAllocationCounter()      { getCounter() = nullptr; }
+
+        static void notifyAllocation() noexcept
+        {
+            if (auto counter = getCounter())
+                ++(*counter);
+        }
+
+        static int*& getCounter() noexcept
+        {
+            thread_local int* counter = nullptr;
+            return counter;
+        }
+
+        int numAllocations = 0;
+    };
+}
+
+void* operator new (std::size_t size)
+{
+    tracktion_graph::ScopedAllocationCounter::notifyAllocation();
+
+    if (auto p = std::malloc (size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete (void* p) noexcept                 { std::free (p); }
+void operator delete (void* p, std::size_t) noexcept    { std::free (p); }
+#endif
+
+
 namespace tracktion_graph
 {
 
@@ -26,9 +66,261 @@ public:
     void runTest() override
     {
         runRPMallocTests();
+        runMidiProcessingTests();
     }
     
 private:
+    //==============================================================================
+    /** Creates a sequence with an event every couple of milliseconds. */
+    static juce::MidiMessageSequence createDenseSequence (double durationSeconds, int channel, juce::Random& r)
+    {
+        juce::MidiMessageSequence sequence;
+        int noteNumber = -1;
+
+        for (double time = 0.0; time < durationSeconds; time += 0.002)
+        {
+            if (noteNumber != -1)
+            {
+                sequence.addEvent (juce::MidiMessage::noteOff (channel, noteNumber), time);
+                noteNumber = -1;
+            }
+            else if (r.nextBool())
+            {
+                noteNumber = r.nextInt ({ 1, 127 });
+                sequence.addEvent (juce::MidiMessage::noteOn (channel, noteNumber, 1.0f), time);
+            }
+            else
+            {
+                sequence.addEvent (juce::MidiMessage::controllerEvent (channel, r.nextInt ({ 1, 32 }), r.nextInt (128)), time);
+            }
+        }
+
+        return sequence;
+    }
+
+    void runMidiProcessingTests()
+    {
+        beginTest ("MIDI-heavy processing doesn't allocate");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int blockSize = 512;
+            constexpr int numInputs = 32;
+            constexpr double durationSeconds = 5.0;
+
+            juce::Random r (42);
+            std::vector<std::unique_ptr<Node>> inputs;
+            int numEventsExpected = 0;
+
+            for (int i = 0; i < numInputs; ++i)
+            {
+                auto sequence = createDenseSequence (durationSeconds, (i % 16) + 1, r);
+                numEventsExpected += sequence.getNumEvents();
+                inputs.push_back (std::make_unique<MidiNode> (std::move (sequence)));
+            }
+
+            NodePlayer player (std::make_unique<SummingNode> (std::move (inputs)));
+            player.prepareToPlay (sampleRate, blockSize);
+
+            choc::buffer::ChannelArrayBuffer<float> audio (0, (choc::buffer::FrameCount) blockSize);
+            tracktion_engine::MidiMessageArray midi;
+            midi.setFixedCapacity (tracktion_engine::MidiMessageArray::defaultFixedCapacity);
+
+            const auto totalNumSamples = (int64_t) (durationSeconds * sampleRate) + blockSize;
+            int numEventsProcessed = 0;
+            bool allBlocksSorted = true;
+
+           #if GRAPH_UNIT_TESTS_COUNT_ALLOCATIONS
+            ScopedAllocationCounter allocationCounter;
+           #endif
+
+            for (int64_t start = 0; start < totalNumSamples; start += blockSize)
+            {
+                midi.clear();
+                player.process ({ juce::Range<int64_t>::withStartAndLength (start, (int64_t) blockSize), { audio.getView(), midi } });
+
+                numEventsProcessed += midi.size();
+                allBlocksSorted = allBlocksSorted && std::is_sorted (midi.begin(), midi.end(),
+                                                                     [] (auto& a, auto& b) { return a.getTimeStamp() < b.getTimeStamp(); });
+            }
+
+           #if GRAPH_UNIT_TESTS_COUNT_ALLOCATIONS
+            expectEquals (allocationCounter.numAllocations, 0, "Allocations made on the audio thread");
+           #endif
+
+            expectEquals (midi.getNumOverflows(), 0);
+            expectEquals (numEventsProcessed, numEventsExpected);
+            expect (allBlocksSorted, "MIDI not sorted");
+        }
+
+        beginTest ("MidiMessageArray overflows rather than allocating");
+        {
+            tracktion_engine::MidiMessageArray source, dest;
+            source.setFixedCapacity (8);
+            dest.setFixedCapacity (8);
+
+            for (int i = 0; i < 10; ++i)
+                source.addMidiMessage (juce::MidiMessage::noteOn (1, 60 + i, 1.0f), i, tracktion_engine::MidiMessageArray::notMPE);
+
+            expectEquals (source.size(), 8);
+            expectEquals (source.getNumOverflows(), 2);
+
+            dest.addMidiMessage (juce::MidiMessage::noteOn (1, 40, 1.0f), 0.5, tracktion_engine::MidiMessageArray::notMPE);
+            dest.mergeFrom (source);
+            expectEquals (dest.size(), 8);
+            expectEquals (dest.getNumOverflows(), 1);
+
+            dest.sortByTimestamp();
+            expectEquals (dest[0].getNoteNumber(), 60);
+            expectEquals (dest[1].getNoteNumber(), 40);
+            expectEquals (dest[2].getNoteNumber(), 61);
+        }
+
+        beginTest ("Full MidiMessageArrays keep note-offs");
+        {
+            using tracktion_engine::MidiMessageArray;
+            MidiMessageArray midi;
+            midi.setFixedCapacity (4);
+
+            midi.addMidiMessage (juce::MidiMessage::noteOn (1, 60, 1.0f), 0.0, MidiMessageArray::notMPE);
+            midi.addMidiMessage (juce::MidiMessage::noteOff (1, 50), 1.0, MidiMessageArray::notMPE);
+            midi.addMidiMessage (juce::MidiMessage::controllerEvent (1, 1, 64), 2.0, MidiMessageArray::notMPE);
+            midi.addMidiMessage (juce::MidiMessage::noteOn (1, 61, 1.0f), 3.0, MidiMessageArray::notMPE);
+
+            // Other messages are dropped
+            midi.addMidiMessage (juce::MidiMessage::noteOn (1, 62, 1.0f), 4.0, MidiMessageArray::notMPE);
+            expectEquals (midi.size(), 4);
+            expectEquals (midi[3].getNoteNumber(), 61);
+
+            // Note-offs replace the latest message that isn't one
+            midi.addMidiMessage (juce::MidiMessage::noteOff (1, 60), 5.0, MidiMessageArray::notMPE);
+            expectEquals (midi.size(), 4);
+            expect (midi[2].isController());
+            expect (midi[3].isNoteOff());
+            expectEquals (midi[3].getNoteNumber(), 60);
+
+            midi.addMidiMessage (juce::MidiMessage::allNotesOff (1), 6.0, MidiMessageArray::notMPE);
+            expect (midi[0].isNoteOn());
+            expect (midi[1].isNoteOff());
+            expect (midi[2].isNoteOff());
+            expect (midi[3].isAllNotesOff());
+
+            // Until there's nothing left to replace
+            midi.addMidiMessage (juce::MidiMessage::noteOff (1, 61), 7.0, MidiMessageArray::notMPE);
+            midi.addMidiMessage (juce::MidiMessage::noteOff (1, 62), 8.0, MidiMessageArray::notMPE);
+            expectEquals (midi.size(), 4);
+            expectEquals (midi[3].getNoteNumber(), 61);
+            expectEquals (midi.getNumOverflows(), 5);
+
+            // The same goes for merging
+            MidiMessageArray source;
+
+            for (int i = 0; i < 4; ++i)
+                source.addMidiMessage (juce::MidiMessage::noteOn (1, 70 + i, 1.0f), i, MidiMessageArray::notMPE);
+
+            source.addMidiMessage (juce::MidiMessage::noteOff (1, 70), 4.0, MidiMessageArray::notMPE);
+            source.isAllNotesOff = true;
+
+            MidiMessageArray dest;
+            dest.setFixedCapacity (4);
+            dest.mergeFrom (source);
+            expectEquals (dest.size(), 4);
+            expectEquals (dest.getNumOverflows(), 1);
+            expect (dest.isAllNotesOff);
+            expectEquals (dest[2].getNoteNumber(), 72);
+            expect (dest[3].isNoteOff());
+        }
+
+        beginTest ("Summing MIDI doesn't lose note-offs");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int blockSize = 256;
+            constexpr int numInputs = 8;
+            constexpr int numNotesPerInput = 100;
+            const int inputCapacity = tracktion_engine::MidiMessageArray::getFixedCapacityForNumSamples (blockSize);
+
+            // Each input is well within its own capacity but together they'd overflow an input's worth
+            std::vector<std::unique_ptr<Node>> inputs;
+
+            for (int i = 0; i < numInputs; ++i)
+            {
+                juce::MidiMessageSequence sequence;
+
+                for (int note = 0; note < numNotesPerInput; ++note)
+                {
+                    const double time = note * 0.00005;
+                    sequence.addEvent (juce::MidiMessage::noteOn (i + 1, note, 1.0f), time);
+                    sequence.addEvent (juce::MidiMessage::controllerEvent (i + 1, 1, note), time);
+                    sequence.addEvent (juce::MidiMessage::controllerEvent (i + 1, 2, note), time);
+                    sequence.addEvent (juce::MidiMessage::noteOff (i + 1, note), time + 0.00002);
+                }
+
+                inputs.push_back (std::make_unique<MidiNode> (std::move (sequence)));
+            }
+
+            constexpr int numEventsPerInput = numNotesPerInput * 4;
+            constexpr int numNoteOffs = numInputs * numNotesPerInput;
+            expect (numEventsPerInput < inputCapacity);
+            expect (numInputs * numEventsPerInput > inputCapacity);
+
+            LockFreeMultiThreadedNodePlayer player (getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+            player.setNode (std::make_unique<SummingNode> (std::move (inputs)), sampleRate, blockSize);
+
+            // Give the output less space than the graph so it has to drop messages
+            choc::buffer::ChannelArrayBuffer<float> audio (0, (choc::buffer::FrameCount) blockSize);
+            tracktion_engine::MidiMessageArray midi, firstBlock;
+            midi.setFixedCapacity (numNoteOffs + 24);
+
+            for (int64_t start = 0; start < blockSize * 2; start += blockSize)
+            {
+                midi.clear();
+                player.process ({ juce::Range<int64_t>::withStartAndLength (start, (int64_t) blockSize), { audio.getView(), midi } });
+
+                if (start == 0)
+                    firstBlock.copyFrom (midi);
+            }
+
+            // The graph itself is sized for all its inputs
+            expectEquals (player.getNumMidiOverflows(), 0);
+
+            const auto numNoteOffsReceived = std::count_if (firstBlock.begin(), firstBlock.end(),
+                                                            [] (auto& m) { return m.isNoteOff(); });
+            expectEquals ((int) numNoteOffsReceived, numNoteOffs);
+            expectEquals (firstBlock.size(), numNoteOffs + 24);
+            expectEquals (midi.getNumOverflows(), numInputs * numEventsPerInput - (numNoteOffs + 24));
+            expect (std::is_sorted (firstBlock.begin(), firstBlock.end(),
+                                    [] (auto& a, auto& b) { return a.getTimeStamp() < b.getTimeStamp(); }),
+                    "MIDI not sorted");
+        }
+
+        beginTest ("Players report Nodes' MIDI overflows");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int blockSize = 256;
+            const int capacity = tracktion_engine::MidiMessageArray::getFixedCapacityForNumSamples (blockSize);
+            const int numEvents = capacity + 100;
+
+            juce::MidiMessageSequence sequence;
+
+            for (int i = 0; i < numEvents; ++i)
+                sequence.addEvent (juce::MidiMessage::controllerEvent (1, 1, i % 128), 0.0);
+
+            LockFreeMultiThreadedNodePlayer player (getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+            player.setNode (std::make_unique<MidiNode> (std::move (sequence)), sampleRate, blockSize);
+
+            choc::buffer::ChannelArrayBuffer<float> audio (0, (choc::buffer::FrameCount) blockSize);
+            tracktion_engine::MidiMessageArray midi;
+
+            // The counts are collected at the start of the following block
+            for (int64_t start = 0; start < blockSize * 2; start += blockSize)
+            {
+                midi.clear();
+                player.process ({ juce::Range<int64_t>::withStartAndLength (start, (int64_t) blockSize), { audio.getView(), midi } });
+            }
+
+            expectEquals (player.getNumMidiOverflows(), numEvents - capacity);
+        }
+    }
+
     void runRPMallocTests()
     {
         beginTest ("rpmalloc single thread");
@@ -38,74 +38,159 @@ struct MidiMessageArray
         MPESourceID mpeSourceID = 0;
     };
 
-    bool isEmpty() const noexcept                                   { return messages.isEmpty(); }
-    bool isNotEmpty() const noexcept                                { return ! messages.isEmpty(); }
+    //==============================================================================
+    MidiMessageArray() = default;
+    MidiMessageArray (MidiMessageArray&&) = default;
+    MidiMessageArray& operator= (MidiMessageArray&&) = default;
 
-    int size() const noexcept                                       { return messages.size(); }
-    MidiMessageWithSource& operator[] (int i)                       { return messages.getReference (i); }
-    const MidiMessageWithSource& operator[] (int i) const           { return messages.getReference (i); }
+    /** Copies the messages and the fixed capacity of another array. */
+    MidiMessageArray (const MidiMessageArray& other)
+    {
+        if (other.isFixedCapacity())
+            setFixedCapacity (other.maxNumMessages);
+
+        copyFrom (other);
+    }
+
+    /** Copies the messages from another array, keeping this array's capacity. */
+    MidiMessageArray& operator= (const MidiMessageArray& other)
+    {
+        if (this != &other)
+            copyFrom (other);
+
+        return *this;
+    }
+
+    //==============================================================================
+    /** Preallocates space for a number of messages and stops the array from ever
+        growing past it. This should be called from prepareToPlay so that adding,
+        merging and sorting don't touch the heap on the audio thread. Any messages
+        that don't fit are dropped and counted so they can be reported later, but
+        note-offs and all-notes-off messages take the place of other messages so
+        notes are never left hanging.
+
+        Messages are stored by value and juce::MidiMessage keeps anything up to 8
+        bytes inline. There's no preallocated storage for longer messages though,
+        so copying a sysex message in to the array will still allocate its data.
+
+        Pass -1 to go back to an array that grows as needed.
+    */
+    void setFixedCapacity (int maxNumMessagesToHold)
+    {
+        maxNumMessages = maxNumMessagesToHold;
+
+        if (maxNumMessages >= 0)
+        {
+            messages.reserve ((size_t) maxNumMessages);
+            scratch.reserve ((size_t) maxNumMessages);
+        }
+    }
+
+    /** Returns true if setFixedCapacity has been used to limit the size of the array. */
+    bool isFixedCapacity() const noexcept                           { return maxNumMessages >= 0; }
+
+    /** Returns the maximum number of messages or -1 if the array can grow. */
+    int getFixedCapacity() const noexcept                           { return maxNumMessages; }
+
+    /** Returns the number of messages that have been dropped because the array was full.
+        This isn't reset by clear() so it can be polled from time to time.
+    */
+    int getNumOverflows() const noexcept                            { return numOverflows; }
+
+    /** Resets the count returned by getNumOverflows. */
+    void resetNumOverflows() noexcept                               { numOverflows = 0; }
 
-    MidiMessageWithSource* begin() noexcept                         { return messages.begin(); }
-    const MidiMessageWithSource* begin() const noexcept             { return messages.begin(); }
-    MidiMessageWithSource* end() noexcept                           { return messages.end(); }
-    const MidiMessageWithSource* end() const noexcept               { return messages.end(); }
+    /** The capacity nodes reserve for their output buffers by default. */
+    static constexpr int defaultFixedCapacity = 512;
 
-    void remove (int index)                                         { messages.remove (index); }
+    /** Returns the capacity to reserve for a block of this many samples.
+        This allows for an event per sample, but never less than defaultFixedCapacity.
+    */
+    static int getFixedCapacityForNumSamples (int numSamples) noexcept
+    {
+        return std::max (defaultFixedCapacity, numSamples);
+    }
+
+    /** The most nodes will reserve when sizing their buffers from their inputs.
+        This stops graphs where lots of paths join up again from reserving huge buffers.
+    */
+    static constexpr int maxFixedCapacity = 32 * defaultFixedCapacity;
+
+    //==============================================================================
+    bool isEmpty() const noexcept                                   { return messages.empty(); }
+    bool isNotEmpty() const noexcept                                { return ! messages.empty(); }
+
+    int size() const noexcept                                       { return (int) messages.size(); }
+    MidiMessageWithSource& operator[] (int i)                       { return messages[(size_t) i]; }
+    const MidiMessageWithSource& operator[] (int i) const           { return messages[(size_t) i]; }
+
+    MidiMessageWithSource* begin() noexcept                         { return messages.data(); }
+    const MidiMessageWithSource* begin() const noexcept             { return messages.data(); }
+    MidiMessageWithSource* end() noexcept                           { return messages.data() + messages.size(); }
+    const MidiMessageWithSource* end() const noexcept               { return messages.data() + messages.size(); }
+
+    void remove (int index)                                         { messages.erase (messages.begin() + index); }
 
     void swapWith (MidiMessageArray& other) noexcept
     {
         std::swap (isAllNotesOff, other.isAllNotesOff);
-        messages.swapWith (other.messages);
+        std::swap (maxNumMessages, other.maxNumMessages);
+        messages.swap (other.messages);
+        scratch.swap (other.scratch);
     }
 
     void clear() noexcept
     {
         isAllNotesOff = false;
-        messages.clearQuick();
+        messages.clear();
     }
 
     void addMidiMessage (const juce::MidiMessage& m, MPESourceID mpeSourceID)
     {
-        messages.add ({ m, mpeSourceID });
+        if (makeSpaceFor (m))
+            messages.emplace_back (m, mpeSourceID);
     }
 
     void addMidiMessage (juce::MidiMessage&& m, MPESourceID mpeSourceID)
     {
-        messages.add ({ std::move (m), mpeSourceID });
+        if (makeSpaceFor (m))
+            messages.emplace_back (std::move (m), mpeSourceID);
     }
 
     void addMidiMessage (const juce::MidiMessage& m, double time, MPESourceID mpeSourceID)
     {
-        messages.add ({ m, mpeSourceID });
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        if (makeSpaceFor (m))
+            messages.emplace_back (m, mpeSourceID).setTimeStamp (time);
     }
 
     void addMidiMessage (juce::MidiMessage&& m, double time, MPESourceID mpeSourceID)
     {
-        messages.add ({ std::move (m), mpeSourceID });
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        if (makeSpaceFor (m))
+            messages.emplace_back (std::move (m), mpeSourceID).setTimeStamp (time);
     }
 
     void add (const MidiMessageWithSource& m)
     {
-        messages.add (m);
+        if (makeSpaceFor (m))
+            messages.push_back (m);
     }
 
     void add (MidiMessageWithSource&& m)
     {
-        messages.add (std::move (m));
+        if (makeSpaceFor (m))
+            messages.push_back (std::move (m));
     }
 
     void add (const MidiMessageWithSource& m, double time)
     {
-        messages.add (m);
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        if (makeSpaceFor (m))
+            messages.emplace_back (m).setTimeStamp (time);
     }
 
     void add (MidiMessageWithSource&& m, double time)
     {
-        messages.add (std::move (m));
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        if (makeSpaceFor (m))
+            messages.emplace_back (std::move (m)).setTimeStamp (time);
     }
 
     void copyFrom (const MidiMessageArray& source)
@@ -114,6 +199,9 @@ struct MidiMessageArray
         mergeFrom (source);
     }
 
+    /** Appends the messages from another array.
+        If both arrays were sorted, sortByTimestamp() will merge them in a single pass.
+    */
     void mergeFrom (const MidiMessageArray& source)
     {
         isAllNotesOff = isAllNotesOff || source.isAllNotesOff;
@@ -121,10 +209,9 @@ struct MidiMessageArray
         if (source.isEmpty())
             return;
 
-        messages.ensureStorageAllocated (messages.size() + source.size());
-
-        for (auto& m : source)
-            messages.add (m);
+        for (auto& m : source.messages)
+            if (makeSpaceFor (m))
+                messages.push_back (m);
     }
     
     void mergeFromWithOffset (const MidiMessageArray& source, double delta)
@@ -134,28 +221,24 @@ struct MidiMessageArray
         if (source.isEmpty())
             return;
 
-        messages.ensureStorageAllocated (messages.size() + source.size());
-
-        for (auto& m : source)
-        {
-            messages.add (m);
-            messages.getReference (messages.size() - 1).addToTimeStamp (delta);
-        }
+        for (auto& m : source.messages)
+            if (makeSpaceFor (m))
+                messages.emplace_back (m).addToTimeStamp (delta);
     }
 
     void mergeFromAndClear (MidiMessageArray& source)
     {
-        if (isEmpty())
+        if (isEmpty() && canTakeStorageOf (source))
         {
             swapWith (source);
         }
         else
         {
             isAllNotesOff = isAllNotesOff || source.isAllNotesOff;
-            messages.ensureStorageAllocated (messages.size() + source.size());
 
-            for (auto& m : source)
-                messages.add (std::move (m));
+            for (auto& m : source.messages)
+                if (makeSpaceFor (m))
+                    messages.push_back (std::move (m));
 
             source.clear();
         }
@@ -163,7 +246,7 @@ struct MidiMessageArray
 
     void mergeFromAndClearWithOffset (MidiMessageArray& source, double delta)
     {
-        if (isEmpty())
+        if (isEmpty() && canTakeStorageOf (source))
         {
             swapWith (source);
             addToTimestamps (delta);
@@ -171,13 +254,10 @@ struct MidiMessageArray
         else
         {
             isAllNotesOff = isAllNotesOff || source.isAllNotesOff;
-            messages.ensureStorageAllocated (messages.size() + source.size());
 
-            for (auto& m : source)
-            {
-                messages.add (std::move (m));
-                messages.getReference (messages.size() - 1).addToTimeStamp (delta);
-            }
+            for (auto& m : source.messages)
+                if (makeSpaceFor (m))
+                    messages.emplace_back (std::move (m)).addToTimeStamp (delta);
 
             source.clear();
         }
@@ -189,32 +269,28 @@ struct MidiMessageArray
             return mergeFromAndClearWithOffset (source, delta);
 
         isAllNotesOff = isAllNotesOff || source.isAllNotesOff;
-        messages.ensureStorageAllocated (messages.size() + numItemsToTake);
 
         for (int i = 0; i < numItemsToTake; ++i)
-        {
-            messages.add (std::move (source.messages.getReference(i)));
-            messages.getReference (messages.size() - 1).addToTimeStamp (delta);
-        }
+            if (makeSpaceFor (source.messages[(size_t) i]))
+                messages.emplace_back (std::move (source.messages[(size_t) i])).addToTimeStamp (delta);
 
-        source.messages.removeRange (0, numItemsToTake);
+        source.messages.erase (source.messages.begin(), source.messages.begin() + numItemsToTake);
     }
 
     void mergeFromAndClear (juce::Array<juce::MidiMessage>& source, MPESourceID mpeSourceID)
     {
-        messages.ensureStorageAllocated (messages.size() + source.size());
-
         for (auto& m : source)
-            addMidiMessage (m, mpeSourceID);
+            if (makeSpaceFor (m))
+                messages.emplace_back (std::move (m), mpeSourceID);
 
-        source.clear();
+        source.clearQuick();
     }
 
     void removeNoteOnsAndOffs()
     {
-        for (int i = messages.size(); --i >= 0;)
-            if (messages.getReference (i).isNoteOnOrOff())
-                messages.remove (i);
+        messages.erase (std::remove_if (messages.begin(), messages.end(),
+                                        [] (const MidiMessageWithSource& m) { return m.isNoteOnOrOff(); }),
+                        messages.end());
     }
 
     void addToTimestamps (double delta) noexcept
@@ -235,32 +311,108 @@ struct MidiMessageArray
             m.multiplyVelocity (factor);
     }
 
+    /** Sorts the messages by time, keeping messages at the same time in order
+        except that note-offs are moved before note-ons.
+
+        This is a natural merge sort, so an array made by appending already sorted
+        arrays is sorted with one merge pass per doubling of the number of inputs.
+        When the array has a fixed capacity this never allocates.
+    */
     void sortByTimestamp()
     {
-        std::stable_sort (messages.begin(), messages.end(), [] (const juce::MidiMessage& a, const juce::MidiMessage& b)
+        if (std::is_sorted (messages.begin(), messages.end(), isEarlier))
+            return;
+
+        scratch.reserve (messages.size());
+
+        for (;;)
         {
-            auto t1 = a.getTimeStamp();
-            auto t2 = b.getTimeStamp();
+            scratch.clear();
+            int numRuns = 0;
 
-            if (t1 == t2)
+            for (auto runStart = messages.begin(); runStart != messages.end(); ++numRuns)
             {
-                if (a.isNoteOff() && b.isNoteOn()) return true;
-                if (a.isNoteOn() && b.isNoteOff()) return false;
+                auto runEnd = std::is_sorted_until (runStart, messages.end(), isEarlier);
+                auto nextRunEnd = std::is_sorted_until (runEnd, messages.end(), isEarlier);
+
+                std::merge (std::make_move_iterator (runStart), std::make_move_iterator (runEnd),
+                            std::make_move_iterator (runEnd), std::make_move_iterator (nextRunEnd),
+                            std::back_inserter (scratch), isEarlier);
+
+                runStart = nextRunEnd;
             }
-            return t1 < t2;
-        });
+
+            messages.swap (scratch);
+
+            if (numRuns <= 1)
+                break;
+        }
+
+        scratch.clear();
     }
 
     void reserve (int size)
     {
-        messages.ensureStorageAllocated (size);
+        messages.reserve ((size_t) size);
     }
 
     bool isAllNotesOff = false;
 
 private:
+    std::vector<MidiMessageWithSource> messages, scratch;
+    int maxNumMessages = -1, numOverflows = 0;
+
+    static bool isEarlier (const juce::MidiMessage& a, const juce::MidiMessage& b) noexcept
+    {
+        auto t1 = a.getTimeStamp();
+        auto t2 = b.getTimeStamp();
+
+        if (t1 == t2)
+        {
+            if (a.isNoteOff() && b.isNoteOn()) return true;
+            if (a.isNoteOn() && b.isNoteOff()) return false;
+        }
+
+        return t1 < t2;
+    }
+
+    /** Returns true if a message can be added, counting it as an overflow if it can't.
+        When the array is full, messages that stop notes make room for themselves by
+        dropping the most recently added message that doesn't.
+    */
+    bool makeSpaceFor (const juce::MidiMessage& m)
+    {
+        if (maxNumMessages < 0 || size() < maxNumMessages)
+            return true;
+
+        ++numOverflows;
+
+        if (! stopsNotes (m))
+            return false;
 
-    juce::Array<MidiMessageWithSource> messages;
+        for (auto i = messages.size(); i > 0; --i)
+        {
+            if (! stopsNotes (messages[i - 1]))
+            {
+                // Moves the following messages down so never allocates
+                messages.erase (messages.begin() + (std::ptrdiff_t) (i - 1));
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    static bool stopsNotes (const juce::MidiMessage& m) noexcept
+    {
+        return m.isNoteOff() || m.isAllNotesOff() || m.isAllSoundOff();
+    }
+
+    /** Swapping is only allowed if it won't leave either array with less capacity than it had. */
+    bool canTakeStorageOf (const MidiMessageArray& source) const noexcept
+    {
+        return maxNumMessages == source.maxNumMessages;
+    }
 };
 
 } // namespace tracktion_engine
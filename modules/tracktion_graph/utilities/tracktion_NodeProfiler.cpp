@@ -0,0 +1,375 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+#if defined (__GNUC__) || defined (__clang__)
+ #include <cxxabi.h>
+#endif
+
+namespace tracktion_graph
+{
+
+namespace
+{
+    std::string escapeJSONString (const std::string& s)
+    {
+        std::string escaped;
+        escaped.reserve (s.size());
+
+        for (auto c : s)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+
+            escaped += c;
+        }
+
+        return escaped;
+    }
+
+    double getPercentile (const std::vector<double>& sortedValues, double percentile)
+    {
+        jassert (! sortedValues.empty());
+        const auto rank = (size_t) std::ceil (percentile * (double) sortedValues.size());
+        return sortedValues[std::min (sortedValues.size(), std::max ((size_t) 1, rank)) - 1];
+    }
+}
+
+//==============================================================================
+/** A single producer, single consumer FIFO of events for one thread. */
+struct NodeProfiler::ThreadBuffer
+{
+    ThreadBuffer (size_t capacity, size_t threadIndex)
+        : events ((size_t) juce::nextPowerOfTwo ((int) std::max ((size_t) 1, capacity))),
+          mask (events.size() - 1),
+          index (threadIndex)
+    {
+    }
+
+    /** Adds an event. Only the thread that owns this buffer should call this. */
+    bool push (const Event& event) noexcept
+    {
+        const auto w = writePos.load (std::memory_order_relaxed);
+
+        if (w - readPos.load (std::memory_order_acquire) > mask)
+            return false;
+
+        events[w & mask] = event;
+        writePos.store (w + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Removes all the events, passing them to a function. Only one thread should call this at once. */
+    template<typename Function>
+    size_t popAll (Function&& fn)
+    {
+        const auto r = readPos.load (std::memory_order_relaxed);
+        const auto w = writePos.load (std::memory_order_acquire);
+
+        for (auto i = r; i != w; ++i)
+            fn (events[i & mask]);
+
+        readPos.store (w, std::memory_order_release);
+        return w - r;
+    }
+
+    std::vector<Event> events;
+    const size_t mask, index;
+    std::atomic<std::thread::id> threadID { std::thread::id() };
+
+    // Aligned to avoid false sharing between the owner and the collecting thread
+    alignas (64) std::atomic<size_t> writePos { 0 };
+    alignas (64) std::atomic<size_t> readPos { 0 };
+};
+
+//==============================================================================
+NodeProfiler::NodeProfiler (size_t eventsPerThread, size_t threads)
+    : profilerID ([] { static std::atomic<uint64_t> nextID { 1 }; return nextID++; }()),
+      numEventsPerThread (eventsPerThread),
+      numThreads (threads)
+{
+}
+
+NodeProfiler::~NodeProfiler()
+{
+}
+
+void NodeProfiler::setNumThreads (size_t newNumThreads)
+{
+    std::lock_guard<std::mutex> sl (recordingMutex);
+    numThreads = newNumThreads;
+
+    if (isEnabled())
+        allocateThreadBuffersIfNeeded();
+}
+
+void NodeProfiler::setEnabled (bool shouldBeEnabled)
+{
+    if (shouldBeEnabled)
+    {
+        std::lock_guard<std::mutex> sl (recordingMutex);
+        allocateThreadBuffersIfNeeded();
+    }
+
+    enabled.store (shouldBeEnabled, std::memory_order_relaxed);
+}
+
+void NodeProfiler::addEvent (const NodeInfo& node, Clock::time_point start, Clock::time_point end) noexcept
+{
+    auto buffer = getBufferForThisThread();
+
+    if (buffer == nullptr)
+    {
+        numDroppedEvents.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event event;
+    event.node = node;
+    event.startNanos = std::chrono::duration_cast<std::chrono::nanoseconds> (start - epoch).count();
+    event.endNanos = std::chrono::duration_cast<std::chrono::nanoseconds> (end - epoch).count();
+    event.threadIndex = buffer->index;
+
+    if (! buffer->push (event))
+        numDroppedEvents.fetch_add (1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+size_t NodeProfiler::collect()
+{
+    std::lock_guard<std::mutex> sl (recordingMutex);
+    return collectLocked();
+}
+
+void NodeProfiler::clear()
+{
+    std::lock_guard<std::mutex> sl (recordingMutex);
+
+    for (auto& buffers : allThreadBuffers)
+        for (auto& buffer : *buffers)
+            buffer->popAll ([] (const Event&) {});
+
+    recording.clear();
+    numDroppedEvents.store (0, std::memory_order_relaxed);
+}
+
+std::vector<NodeProfiler::Event> NodeProfiler::getEvents()
+{
+    std::lock_guard<std::mutex> sl (recordingMutex);
+    collectLocked();
+
+    return recording;
+}
+
+//==============================================================================
+std::vector<NodeProfiler::NodeStatistics> NodeProfiler::getStatistics()
+{
+    using Key = std::tuple<std::string, size_t, size_t>;
+    std::map<Key, std::pair<NodeInfo, std::vector<double>>> durations;
+
+    for (auto& event : getEvents())
+    {
+        auto& entry = durations[Key (event.node.typeName != nullptr ? event.node.typeName : "",
+                                     event.node.nodeID, event.node.ownerID)];
+        entry.first = event.node;
+        entry.second.push_back ((double) (event.endNanos - event.startNanos) / 1.0e9);
+    }
+
+    std::vector<NodeStatistics> allStats;
+    allStats.reserve (durations.size());
+
+    for (auto& entry : durations)
+    {
+        auto& times = entry.second.second;
+        std::sort (times.begin(), times.end());
+
+        NodeStatistics stats;
+        stats.node = entry.second.first;
+        stats.name = getReadableTypeName (stats.node.typeName);
+        stats.numEvents = times.size();
+        stats.minSeconds = times.front();
+        stats.maxSeconds = times.back();
+
+        for (auto t : times)
+            stats.totalSeconds += t;
+
+        stats.meanSeconds = stats.totalSeconds / (double) times.size();
+        stats.percentile50Seconds = getPercentile (times, 0.5);
+        stats.percentile95Seconds = getPercentile (times, 0.95);
+        stats.percentile99Seconds = getPercentile (times, 0.99);
+
+        allStats.push_back (std::move (stats));
+    }
+
+    std::sort (allStats.begin(), allStats.end(),
+               [] (auto& s1, auto& s2) { return s1.totalSeconds > s2.totalSeconds; });
+
+    return allStats;
+}
+
+//==============================================================================
+void NodeProfiler::writeChromeTrace (std::ostream& os)
+{
+    const auto events = getEvents();
+    std::map<const char*, std::string> names;
+    size_t numThreads = 0;
+
+    for (auto& event : events)
+        numThreads = std::max (numThreads, event.threadIndex + 1);
+
+    auto getName = [&names] (const char* typeName) -> const std::string&
+    {
+        auto found = names.find (typeName);
+
+        if (found == names.end())
+            found = names.emplace (typeName, escapeJSONString (getReadableTypeName (typeName))).first;
+
+        return found->second;
+    };
+
+    // Timestamps are in microseconds
+    std::ostringstream trace;
+    trace.setf (std::ios::fixed);
+    trace.precision (3);
+    trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (size_t i = 0; i < numThreads; ++i)
+        trace << (i == 0 ? "\n" : ",\n")
+              << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+              << ",\"args\":{\"name\":\"Thread " << i << "\"}}";
+
+    for (auto& event : events)
+        trace << ",\n{\"name\":\"" << getName (event.node.typeName) << "\",\"cat\":\"node\",\"ph\":\"X\",\"pid\":1"
+              << ",\"tid\":" << event.threadIndex
+              << ",\"ts\":" << ((double) event.startNanos / 1000.0)
+              << ",\"dur\":" << ((double) (event.endNanos - event.startNanos) / 1000.0)
+              << ",\"args\":{\"nodeID\":\"" << event.node.nodeID << "\",\"ownerID\":\"" << event.node.ownerID << "\"}}";
+
+    trace << "\n]}\n";
+    os << trace.str();
+}
+
+std::string NodeProfiler::getChromeTrace()
+{
+    std::ostringstream os;
+    writeChromeTrace (os);
+    return os.str();
+}
+
+//==============================================================================
+std::string NodeProfiler::getReadableTypeName (const char* typeName)
+{
+    if (typeName == nullptr)
+        return {};
+
+   #if defined (__GNUC__) || defined (__clang__)
+    int status = 0;
+
+    if (auto demangled = abi::__cxa_demangle (typeName, nullptr, nullptr, &status))
+    {
+        std::string name (demangled);
+        std::free (demangled);
+        return name;
+    }
+   #endif
+
+    std::string name (typeName);
+
+    for (auto prefix : { "class ", "struct " })
+        if (name.rfind (prefix, 0) == 0)
+            return name.substr (std::strlen (prefix));
+
+    return name;
+}
+
+//==============================================================================
+NodeProfiler::ThreadBuffer* NodeProfiler::getBufferForThisThread() noexcept
+{
+    // Cache the last buffer used by this thread to avoid searching on each event
+    struct CachedBuffer
+    {
+        uint64_t profilerID = 0;
+        ThreadBuffers* threadBuffers = nullptr;
+        size_t index = 0;
+    };
+
+    auto threadBuffers = activeThreadBuffers.load (std::memory_order_acquire);
+
+    if (threadBuffers == nullptr)
+        return nullptr;
+
+    thread_local CachedBuffer cachedBuffer;
+    const auto thisThread = std::this_thread::get_id();
+
+    if (cachedBuffer.profilerID == profilerID
+        && cachedBuffer.threadBuffers == threadBuffers
+        && (*threadBuffers)[cachedBuffer.index]->threadID.load (std::memory_order_relaxed) == thisThread)
+        return (*threadBuffers)[cachedBuffer.index].get();
+
+    for (size_t i = 0; i < threadBuffers->size(); ++i)
+    {
+        auto& buffer = (*threadBuffers)[i];
+        auto bufferThread = buffer->threadID.load (std::memory_order_acquire);
+
+        if (bufferThread == std::thread::id()
+            && ! buffer->threadID.compare_exchange_strong (bufferThread, thisThread, std::memory_order_acq_rel))
+            continue;
+
+        if (bufferThread == std::thread::id() || bufferThread == thisThread)
+        {
+            cachedBuffer = { profilerID, threadBuffers, i };
+            return buffer.get();
+        }
+    }
+
+    return nullptr;
+}
+
+void NodeProfiler::allocateThreadBuffersIfNeeded()
+{
+    auto current = activeThreadBuffers.load (std::memory_order_relaxed);
+
+    if (current != nullptr && current->size() >= numThreads)
+        return;
+
+    // Threads carry on with the thread indexes from any previous buffers
+    size_t firstThreadIndex = 0;
+
+    for (auto& buffers : allThreadBuffers)
+        firstThreadIndex += buffers->size();
+
+    auto newBuffers = std::make_unique<ThreadBuffers>();
+
+    for (size_t i = 0; i < numThreads; ++i)
+        newBuffers->push_back (std::make_unique<ThreadBuffer> (numEventsPerThread, firstThreadIndex + i));
+
+    activeThreadBuffers.store (newBuffers.get(), std::memory_order_release);
+    allThreadBuffers.push_back (std::move (newBuffers));
+}
+
+size_t NodeProfiler::collectLocked()
+{
+    size_t numCollected = 0;
+
+    for (auto& buffers : allThreadBuffers)
+        for (auto& buffer : *buffers)
+            numCollected += buffer->popAll ([this] (const Event& event) { recording.push_back (event); });
+
+    return numCollected;
+}
+
+} // namespace tracktion_graph
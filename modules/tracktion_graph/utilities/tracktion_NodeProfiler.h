@@ -0,0 +1,175 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    Records the time each Node takes to process so they can be inspected after a
+    glitch or exported to a trace viewer.
+
+    Node players add an event each time a Node is processed. Each thread writes
+    to its own lock-free buffer so adding events is real-time safe. The buffers
+    aren't allocated until the profiler is first enabled and there's one for each
+    of the threads set with setNumThreads().
+    The events are moved out of these buffers when collect() is called, which
+    should be done periodically from a non real-time thread if recording for
+    longer than the buffers can hold, otherwise the newest events are dropped.
+
+    This is disabled by default. When it is, players only check the enabled flag.
+
+    e.g. @code
+        player.getProfiler().setEnabled (true);
+        // ... play for a bit
+        player.getProfiler().setEnabled (false);
+
+        std::ofstream os ("trace.json");
+        player.getProfiler().writeChromeTrace (os);
+    @endcode
+*/
+class NodeProfiler
+{
+public:
+    //==============================================================================
+    using Clock = std::chrono::steady_clock;
+
+    /** Describes a Node being profiled. */
+    struct NodeInfo
+    {
+        const char* typeName = nullptr;     /**< The Node's type as returned by typeid. This must be a static string. */
+        size_t nodeID = 0;                  /**< The Node's NodeProperties::nodeID. */
+        size_t ownerID = 0;                 /**< The ID of the object that owns the Node, or 0 if it isn't known. */
+    };
+
+    /** A single call to a Node's process method. */
+    struct Event
+    {
+        NodeInfo node;
+        int64_t startNanos = 0, endNanos = 0;   /**< Relative to when the profiler was created. */
+        size_t threadIndex = 0;                 /**< The thread the Node was processed on, in the order threads were first seen. */
+    };
+
+    //==============================================================================
+    /** Creates a disabled NodeProfiler.
+        This doesn't allocate any space for events until it's enabled.
+        @param numEventsPerThread   the number of events each thread can hold before collect() needs to be called
+        @param numThreads           the number of different threads that can add events
+    */
+    NodeProfiler (size_t numEventsPerThread = 16384, size_t numThreads = 2);
+
+    /** Destructor. */
+    ~NodeProfiler();
+
+    //==============================================================================
+    /** Sets the number of different threads that can add events.
+        Players call this with the number of threads they process Nodes on. If the
+        profiler is enabled and this is more than it has buffers for, new buffers
+        are allocated so this shouldn't be called from a real-time thread.
+    */
+    void setNumThreads (size_t);
+
+    /** Starts or stops recording events.
+        The first time this is enabled it allocates the buffers for the threads so
+        this shouldn't be called from a real-time thread.
+    */
+    void setEnabled (bool);
+
+    /** Returns true if events should be added. */
+    bool isEnabled() const noexcept                 { return enabled.load (std::memory_order_relaxed); }
+
+    /** Adds an event for the calling thread.
+        This is real-time safe and lock-free. If the thread's buffer is full, or the
+        buffers haven't been allocated yet, the event is dropped.
+    */
+    void addEvent (const NodeInfo&, Clock::time_point start, Clock::time_point end) noexcept;
+
+    //==============================================================================
+    /** Moves any events added since the last call out of the threads' buffers
+        in to the recording. Returns the number of events collected.
+    */
+    size_t collect();
+
+    /** Clears the recording and any events waiting to be collected. */
+    void clear();
+
+    /** Collects and returns all the recorded events. */
+    std::vector<Event> getEvents();
+
+    /** Returns the number of events that have been dropped because a thread's
+        buffer was full or too many threads added events.
+    */
+    size_t getNumDroppedEvents() const noexcept     { return numDroppedEvents.load (std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** Holds the timings of all the recorded events for a Node. */
+    struct NodeStatistics
+    {
+        NodeInfo node;
+        std::string name;                   /**< The readable name of the Node's type. */
+        size_t numEvents = 0;
+        double minSeconds = 0.0, meanSeconds = 0.0, maxSeconds = 0.0, totalSeconds = 0.0;
+        double percentile50Seconds = 0.0, percentile95Seconds = 0.0, percentile99Seconds = 0.0;
+    };
+
+    /** Collects the events and returns the statistics for each Node, slowest total first.
+        Nodes are identified by their type, nodeID and ownerID so Nodes of the same
+        type without a nodeID that have the same owner will be combined.
+    */
+    std::vector<NodeStatistics> getStatistics();
+
+    //==============================================================================
+    /** Collects the events and writes them as a Chrome trace event JSON file.
+        This can be opened in chrome://tracing or https://ui.perfetto.dev
+    */
+    void writeChromeTrace (std::ostream&);
+
+    /** Collects the events and returns them as a Chrome trace event JSON string. */
+    std::string getChromeTrace();
+
+    //==============================================================================
+    /** Returns a readable version of a name returned by typeid. */
+    static std::string getReadableTypeName (const char* typeName);
+
+private:
+    //==============================================================================
+    struct ThreadBuffer;
+    using ThreadBuffers = std::vector<std::unique_ptr<ThreadBuffer>>;
+
+    const uint64_t profilerID;
+    const Clock::time_point epoch { Clock::now() };
+    const size_t numEventsPerThread;
+    size_t numThreads;
+    std::atomic<ThreadBuffers*> activeThreadBuffers { nullptr };
+    std::atomic<bool> enabled { false };
+    std::atomic<size_t> numDroppedEvents { 0 };
+
+    // Replaced sets of buffers are kept as other threads may still be adding to them
+    std::mutex recordingMutex;
+    std::vector<std::unique_ptr<ThreadBuffers>> allThreadBuffers;
+    std::vector<Event> recording;
+
+    void allocateThreadBuffersIfNeeded();
+    ThreadBuffer* getBufferForThisThread() noexcept;
+    size_t collectLocked();
+};
+
+} // namespace tracktion_graph
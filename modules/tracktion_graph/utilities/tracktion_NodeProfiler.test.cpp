@@ -0,0 +1,210 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_graph
+{
+
+#if GRAPH_UNIT_TESTS_NODEPROFILER
+
+class NodeProfilerTests : public juce::UnitTest
+{
+public:
+    NodeProfilerTests()
+        : juce::UnitTest ("NodeProfiler", "tracktion_graph") {}
+
+    //==============================================================================
+    void runTest() override
+    {
+        runThreadBufferTests();
+        runPlayerTests();
+    }
+
+private:
+    void runThreadBufferTests()
+    {
+        beginTest ("Thread buffers");
+        {
+            NodeProfiler profiler (4, 2);
+            const NodeProfiler::NodeInfo info { "test", 1, 2 };
+
+            auto addEvents = [&] (int num)
+            {
+                for (int i = 0; i < num; ++i)
+                {
+                    const auto start = NodeProfiler::Clock::now();
+                    profiler.addEvent (info, start, NodeProfiler::Clock::now());
+                }
+            };
+
+            // Nothing is allocated until the profiler is enabled so these are dropped
+            addEvents (3);
+            expectEquals<int> ((int) profiler.getNumDroppedEvents(), 3);
+            profiler.clear();
+
+            profiler.setEnabled (true);
+
+            // Each thread can only hold 4 events and there are only buffers for two threads
+            addEvents (6);
+            std::thread t1 ([&] { addEvents (6); });
+            t1.join();
+            std::thread t2 ([&] { addEvents (6); });
+            t2.join();
+
+            expectEquals<int> ((int) profiler.getNumDroppedEvents(), 10);
+
+            const auto events = profiler.getEvents();
+            expectEquals<int> ((int) events.size(), 8);
+
+            std::vector<size_t> threadIndicies;
+
+            for (auto& e : events)
+            {
+                if (std::find (threadIndicies.begin(), threadIndicies.end(), e.threadIndex) == threadIndicies.end())
+                    threadIndicies.push_back (e.threadIndex);
+
+                expectEquals<int> ((int) e.node.nodeID, 1);
+                expectEquals<int> ((int) e.node.ownerID, 2);
+                expect (e.endNanos >= e.startNanos);
+            }
+
+            expectEquals<int> ((int) threadIndicies.size(), 2);
+
+            // Collecting should make room again
+            addEvents (1);
+            expectEquals<int> ((int) profiler.collect(), 1);
+
+            // Adding threads whilst enabled makes room for them
+            profiler.clear();
+            profiler.setNumThreads (3);
+            std::thread t3 ([&] { addEvents (1); });
+            t3.join();
+            expectEquals<int> ((int) profiler.collect(), 1);
+            expectEquals<int> ((int) profiler.getNumDroppedEvents(), 0);
+
+            profiler.clear();
+            expect (profiler.getEvents().empty());
+            expectEquals<int> ((int) profiler.getNumDroppedEvents(), 0);
+        }
+    }
+
+    void runPlayerTests()
+    {
+        const double sampleRate = 44100.0;
+        const int blockSize = 256;
+        const int numBlocks = 10;
+
+        LockFreeMultiThreadedNodePlayer player (getPoolCreatorFunction (ThreadPoolStrategy::realTime));
+        player.setNumThreads (2);
+        player.setNodeOwnerFunction ([] (Node& n) -> size_t
+                                     {
+                                         if (dynamic_cast<SinNode*> (&n) != nullptr)
+                                             return n.getNodeProperties().nodeID;
+
+                                         return 0;
+                                     });
+
+        {
+            std::vector<std::unique_ptr<Node>> nodes;
+            nodes.push_back (makeNode<GainNode> (makeNode<SinNode> (220.0f, 1, 1), [] { return 0.5f; }));
+            nodes.push_back (makeNode<SinNode> (440.0f, 1, 2));
+            player.setNode (makeNode<BasicSummingNode> (std::move (nodes)), sampleRate, blockSize);
+        }
+
+        auto& profiler = player.getProfiler();
+        choc::buffer::ChannelArrayBuffer<float> audio (1, (choc::buffer::FrameCount) blockSize);
+        tracktion_engine::MidiMessageArray midi;
+
+        auto processBlocks = [&]
+        {
+            for (int i = 0; i < numBlocks; ++i)
+            {
+                audio.clear();
+                midi.clear();
+                player.process ({ juce::Range<int64_t>::withStartAndLength ((int64_t) i * blockSize, (int64_t) blockSize),
+                                 { audio.getView(), midi } });
+            }
+        };
+
+        beginTest ("Disabled");
+        {
+            processBlocks();
+            expect (profiler.getEvents().empty());
+        }
+
+        beginTest ("Recording");
+        {
+            profiler.setEnabled (true);
+            processBlocks();
+            profiler.setEnabled (false);
+
+            // Each of the four Nodes plus the player's process call
+            expectEquals<int> ((int) profiler.getEvents().size(), numBlocks * 5);
+            expectEquals<int> ((int) profiler.getNumDroppedEvents(), 0);
+        }
+
+        beginTest ("Statistics");
+        {
+            const auto stats = profiler.getStatistics();
+            expectEquals<int> ((int) stats.size(), 5);
+
+            auto findStats = [&] (const std::string& name, size_t ownerID) -> const NodeProfiler::NodeStatistics*
+            {
+                for (auto& s : stats)
+                    if (s.name.find (name) != std::string::npos && s.node.ownerID == ownerID)
+                        return &s;
+
+                return nullptr;
+            };
+
+            for (auto& s : stats)
+            {
+                expectEquals<int> ((int) s.numEvents, numBlocks);
+                expect (s.minSeconds <= s.percentile50Seconds);
+                expect (s.percentile50Seconds <= s.percentile95Seconds);
+                expect (s.percentile95Seconds <= s.percentile99Seconds);
+                expect (s.percentile99Seconds <= s.maxSeconds);
+                expectWithinAbsoluteError (s.meanSeconds * (double) s.numEvents, s.totalSeconds, 1.0e-9);
+            }
+
+            // The GainNode should take the owner of its input but the summing node has two
+            expect (findStats ("SinNode", 1) != nullptr);
+            expect (findStats ("SinNode", 2) != nullptr);
+            expect (findStats ("GainNode", 1) != nullptr);
+            expect (findStats ("BasicSummingNode", 0) != nullptr);
+            expect (findStats ("LockFreeMultiThreadedNodePlayer::process", 0) != nullptr);
+        }
+
+        beginTest ("Chrome trace");
+        {
+            const auto trace = juce::String (profiler.getChromeTrace());
+            expect (trace.startsWith ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+            expect (trace.contains ("\"name\":\"thread_name\""));
+            expect (trace.contains ("GainNode"));
+
+            auto json = juce::JSON::parse (trace);
+            int numCompleteEvents = 0;
+
+            if (auto traceEvents = json.getProperty ("traceEvents", {}).getArray())
+                for (auto& e : *traceEvents)
+                    if (e.getProperty ("ph", {}).toString() == "X")
+                        ++numCompleteEvents;
+
+            expectEquals (numCompleteEvents, numBlocks * 5);
+        }
+
+        player.clearNode();
+    }
+};
+
+static NodeProfilerTests nodeProfilerTests;
+
+#endif
+
+} // namespace tracktion_graph
@@ -0,0 +1,98 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    A batch of independent tasks that a number of threads can claim and run.
+
+    One thread publishes a batch with start() and then any thread can call
+    processNextTask() to run one of them. Claiming and running tasks is lock-free
+    and doesn't allocate so this can be used from real-time threads.
+*/
+class ParallelTasks
+{
+public:
+    /** A function to call with a context pointer and the index of the task to run. */
+    using TaskCallback = void (*) (void* context, size_t taskIndex);
+
+    /** Publishes a new batch of tasks.
+        Only one thread should start batches and the previous batch must have finished.
+    */
+    void start (size_t numTasks, TaskCallback callback, void* context) noexcept
+    {
+        // Close the new generation before changing the number of tasks so a thread that
+        // sees the new number can't claim a task with an index from the last generation
+        const auto nextGeneration = ((state.load (std::memory_order_relaxed) >> 32) + 1) << 32;
+        state.store (nextGeneration | indexMask, std::memory_order_relaxed);
+
+        taskCallback = callback;
+        taskContext = context;
+        numFinished.store (0, std::memory_order_relaxed);
+        numTasksInBatch.store (numTasks, std::memory_order_release);
+
+        // Then opening it at index 0 publishes the tasks to the other threads
+        state.store (nextGeneration, std::memory_order_release);
+    }
+
+    /** Returns true if there are tasks that haven't been claimed yet. */
+    bool hasTasksToProcess() const noexcept
+    {
+        return (size_t) (state.load (std::memory_order_acquire) & indexMask)
+                 < numTasksInBatch.load (std::memory_order_acquire);
+    }
+
+    /** Claims and runs the next task, returning false if there weren't any left. */
+    bool processNextTask()
+    {
+        auto currentState = state.load (std::memory_order_acquire);
+
+        for (;;)
+        {
+            const auto taskIndex = (size_t) (currentState & indexMask);
+
+            if (taskIndex >= numTasksInBatch.load (std::memory_order_acquire))
+                return false;
+
+            if (state.compare_exchange_weak (currentState, currentState + 1,
+                                             std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                taskCallback (taskContext, taskIndex);
+                numFinished.fetch_add (1, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    /** Returns true once all the tasks in the current batch have finished running. */
+    bool hasFinished() const noexcept
+    {
+        return numFinished.load (std::memory_order_acquire) >= numTasksInBatch.load (std::memory_order_acquire);
+    }
+
+private:
+    // The generation of the batch is held in the top bits of the state
+    // so a thread with a stale index can't claim a task from the next batch
+    static constexpr uint64_t indexMask = 0xffffffff;
+    std::atomic<uint64_t> state { 0 };
+    std::atomic<size_t> numTasksInBatch { 0 }, numFinished { 0 };
+    TaskCallback taskCallback = nullptr;
+    void* taskContext = nullptr;
+};
+
+} // namespace tracktion_graph
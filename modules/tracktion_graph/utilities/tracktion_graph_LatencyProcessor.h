@@ -53,6 +53,8 @@ struct LatencyProcessor
         fifo.setSize ((choc::buffer::ChannelCount) numChannels, (choc::buffer::FrameCount) (latencyNumSamples + blockSize + 1));
         fifo.writeSilence ((choc::buffer::FrameCount) latencyNumSamples);
         jassert (fifo.getNumReady() == latencyNumSamples);
+
+        midi.setFixedCapacity (tracktion_engine::MidiMessageArray::getFixedCapacityForNumSamples (latencyNumSamples + blockSize));
     }
     
     void writeAudio (choc::buffer::ChannelArrayView<float> src)
@@ -92,17 +94,13 @@ struct LatencyProcessor
         // And read out any delayed items
         const double blockTimeSeconds = sampleToTime (numSamples, sampleRate);
 
+        for (auto& m : midi)
+            if (m.getTimeStamp() <= blockTimeSeconds)
+                dst.add (m);
+
         for (int i = midi.size(); --i >= 0;)
-        {
-           auto& m = midi[i];
-           
-           if (m.getTimeStamp() <= blockTimeSeconds)
-           {
-               dst.add (m);
+           if (midi[i].getTimeStamp() <= blockTimeSeconds)
                midi.remove (i);
-               // TODO: This will deallocate, we need a MIDI message array that doesn't adjust its storage
-           }
-        }
 
         // Shuffle down remaining items by block time
         midi.addToTimestamps (-blockTimeSeconds);
@@ -125,7 +123,6 @@ struct LatencyProcessor
         // And read out any delayed items
         const double blockTimeSeconds = sampleToTime (numSamples, sampleRate);
 
-        // TODO: This will deallocate, we need a MIDI message array that doesn't adjust its storage
         for (int i = midi.size(); --i >= 0;)
            if (midi[i].getTimeStamp() <= blockTimeSeconds)
                midi.remove (i);